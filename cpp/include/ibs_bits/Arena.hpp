@@ -0,0 +1,108 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Position in a ScratchArena, restored by ScratchArena::Release.
+ */
+struct ArenaMark {
+  /** index of the current block */
+  size_t block;
+  /** offset in the current block */
+  size_t offset;
+};
+
+/**
+ * Monotonic scratch memory for temporaries of the hot paths. Allocation bumps
+ * a pointer, memory is only returned by resetting to a mark. Blocks are kept
+ * after a reset, such that repeated tasks of the same size do not touch the
+ * heap once the arena has grown to their working set.
+ */
+class ScratchArena {
+public:
+  /**
+   * @param blocksize minimum size of the blocks requested from the heap
+   */
+  explicit ScratchArena(size_t blocksize = 1 << 16);
+  ~ScratchArena();
+
+  /**
+   * Allocate uninitialized memory, valid until the arena is reset to a mark
+   * taken before the allocation.
+   *
+   * @param bytes size in bytes
+   * @param align alignment (power of two)
+   *
+   * @return pointer to the memory
+   */
+  void *Allocate(size_t bytes, size_t align = alignof(max_align_t));
+
+  /** Allocate uninitialized memory for n objects of a trivial type. */
+  template <typename T> T *Allocate(size_t n) {
+    return static_cast<T *>(Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /** Current position. */
+  ArenaMark Mark() const { return {block, offset}; }
+
+  /** Free everything allocated after the mark was taken. */
+  void Release(const ArenaMark &mark);
+
+  /** Free everything, the blocks are kept. */
+  void Reset() { Release({0, 0}); }
+
+  /** Bytes in use (including alignment padding and skipped block ends). */
+  size_t Used() const;
+
+  /** Bytes held from the heap. */
+  size_t Capacity() const;
+
+  /** Number of blocks held from the heap. */
+  size_t Blocks() const { return blocks.size(); }
+
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena &operator=(const ScratchArena &) = delete;
+
+private:
+  struct Block {
+    char *data;
+    size_t size;
+  };
+  vector<Block> blocks;
+  size_t block;
+  size_t offset;
+  size_t blocksize;
+};
+
+/**
+ * Scratch arena of the calling thread.
+ *
+ * @return arena owned by the calling thread
+ */
+ScratchArena &ThreadArena();
+
+/**
+ * Scoped use of a scratch arena, everything allocated during the lifetime of
+ * the scope is released on destruction. Scopes nest.
+ */
+class ArenaScope {
+public:
+  /**
+   * @param arena arena to release, the calling thread's arena by default
+   */
+  explicit ArenaScope(ScratchArena &arena = ThreadArena())
+      : arena(arena), mark(arena.Mark()) {}
+  ~ArenaScope() { arena.Release(mark); }
+
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+  ScratchArena &arena;
+  ArenaMark mark;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Execution configuration selected by the autotuner.
+ */
+struct AutotuneConfig {
+  /** number of OpenMP threads for the lattice loops (1 is serial) */
+  int threads;
+  /** measured wall time of one growth rate evaluation (s) */
+  double seconds;
+};
+
+/**
+ * Signature of a lattice for the autotuning cache, a hash of the number of
+ * elements and the L, BETX, BETY, DX and DY columns.
+ *
+ * @param twissdata Twiss Table Map
+ *
+ * @return 64 bit signature
+ */
+uint64_t LatticeSignature(map<string, vector<double>> &twissdata);
+
+/**
+ * Enable or disable the automatic use of the autotuner. While enabled, the ODE
+ * runs call Autotune with their initial beam state before the first step, such
+ * that the cached configuration is applied for the run (or measured once per
+ * host, lattice and model).
+ *
+ * @param enable switch automatic tuning on or off
+ */
+void AutotuneEnable(bool enable);
+
+/**
+ * Automatic tuning state.
+ *
+ * @return true if the ODE runs apply the autotuner
+ */
+bool AutotuneEnabled();
+
+/**
+ * Set the cache file. The default is the environment variable
+ * IBS_AUTOTUNE_CACHE, else $HOME/.ibslib_autotune.
+ *
+ * @param filename cache file, empty to restore the default
+ */
+void AutotuneSetCacheFile(string filename);
+
+/**
+ * Cache file in use.
+ *
+ * @return cache file name
+ */
+string AutotuneCacheFile();
+
+/**
+ * Look up the configuration for this host, lattice and model in the cache
+ * file.
+ *
+ * @param model IBS model (1-13)
+ * @param twissdata Twiss Table Map
+ * @param[out] config cached configuration
+ *
+ * @return true if an entry was found
+ */
+bool AutotuneLookup(int model, map<string, vector<double>> &twissdata,
+                    AutotuneConfig &config);
+
+/**
+ * Apply a configuration to the calling thread.
+ *
+ * @param config configuration
+ */
+void AutotuneApply(const AutotuneConfig &config);
+
+/**
+ * Select the fastest execution configuration for the model on the lattice and
+ * apply it. The thread counts 1, 2, 4, ... up to the number of processors are
+ * timed on IBSRates at the given beam state, the winner is appended to the
+ * cache file. If the cache already holds an entry for this host, lattice and
+ * model it is applied without measuring.
+ *
+ * @param model IBS model (1-13)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param force measure even if a cached entry exists
+ *
+ * @return applied configuration
+ *
+ * @note Without OpenMP support only the serial configuration is available.
+ */
+AutotuneConfig Autotune(int model, double pnumber, double ex, double ey,
+                        double sigs, double dponp,
+                        map<string, double> &twissheader,
+                        map<string, vector<double>> &twissdata, double r0,
+                        double aatom, bool force = false);
+
+/**
+ * Autotuned section of a run. While automatic tuning is enabled the
+ * constructor applies the configuration of Autotune and the destructor
+ * restores the OpenMP thread count the calling thread had before, such that
+ * the tuned configuration does not outlive the run. Without automatic tuning
+ * the scope does nothing.
+ */
+class AutotuneScope {
+public:
+  /**
+   * Apply the tuned configuration if automatic tuning is enabled.
+   *
+   * @see Autotune
+   */
+  AutotuneScope(int model, double pnumber, double ex, double ey, double sigs,
+                double dponp, map<string, double> &twissheader,
+                map<string, vector<double>> &twissdata, double r0,
+                double aatom);
+  ~AutotuneScope();
+
+  AutotuneScope(const AutotuneScope &) = delete;
+  AutotuneScope &operator=(const AutotuneScope &) = delete;
+
+private:
+  bool active;
+  int threads;
+};
+
+#endif
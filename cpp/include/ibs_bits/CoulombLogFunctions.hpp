@@ -127,4 +127,33 @@ void CoulombLog(double pnumber, double ex, double ey,
 void TailCutCoulombLog(double pnumber, double ex, double ey,
                        map<string, double> &twissheader, double sige,
                        double sigt, double tauradx, double taurady,
-                       double taurads, double r0, bool printout, double *clog);
\ No newline at end of file
+                       double taurads, double r0, bool printout, double *clog);
+
+/**
+ * Ring averaged Coulomb log of an IBS model, used to scale growth rates from
+ * one population to another at fixed beam sizes. The tailcut models (5, 7, 10,
+ * 12) use TailCutCoulombLog, the other models CoulombLog. The Piwinski models
+ * (1-3) have no Coulomb log, their rates only scale with the population and 1
+ * is returned.
+ *
+ * @param model IBS model (1-13)
+ * @param pnumber Number of particles in the bunch
+ * @param ex Horizontal emittance
+ * @param ey Vertical emittance
+ * @param twissheader Twiss Header Map
+ * @param sige Energy spread
+ * @param sigt Bunch length
+ * @param tauradx Horizontal Radiation Damping Time (only used by the tailcut
+ * models)
+ * @param taurady Vertical Radiation Damping Time (only used by the tailcut
+ * models)
+ * @param taurads Longitudinal Radiation Damping Time (only used by the tailcut
+ * models)
+ * @param r0 Classical radius of the particles in the bunch
+ *
+ * @return Coulomb log
+ */
+double ModelCoulombLog(int model, double pnumber, double ex, double ey,
+                       map<string, double> &twissheader, double sige,
+                       double sigt, double tauradx, double taurady,
+                       double taurads, double r0);
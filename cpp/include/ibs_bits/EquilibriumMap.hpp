@@ -0,0 +1,103 @@
+#ifndef EQUILIBRIUM_MAP_HPP
+#define EQUILIBRIUM_MAP_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Precomputed equilibrium emittances and bunch length on a tensor grid in
+ * (pnumber, coupling percentage, RF voltage scale factor).
+ *
+ * values holds three entries (ex, ey, sigs) per node, the node (i, j, k) is
+ * stored at ((i * n1 + j) * n2 + k) * 3. curvatures holds the estimated second
+ * derivatives along the three axes for every output, nine entries per node
+ * stored at ((i * n1 + j) * n2 + k) * 9 + 3 * axis + output.
+ */
+struct EquilibriumMap {
+  int model = 0;
+  vector<double> axes[3];
+  vector<double> values;
+  vector<double> curvatures;
+};
+
+/**
+ * Calculate the ODE equilibria on an adaptively refined grid.
+ *
+ * Starting from an equidistant grid, intervals are bisected where the
+ * estimated linear interpolation error (from second differences of the
+ * neighbouring nodes) exceeds the relative tolerance. Every bisection inserts
+ * a plane of nodes, new nodes are calculated in parallel.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems (scaled by the voltage
+ * axis)
+ * @param model IBS model (1-13)
+ * @param ex0 initial horizontal emittance of the ODE runs
+ * @param ey0 initial vertical emittance of the ODE runs
+ * @param sigs0 initial bunch length of the ODE runs
+ * @param lower lower bounds of the three axes
+ * @param upper upper bounds of the three axes
+ * @param ninitial initial number of nodes per axis (1 for a fixed value)
+ * @param tolerance relative interpolation tolerance
+ * @param maxnodes maximum total number of nodes
+ * @param threshold ODE stop threshold
+ * @param[out] emap equilibrium map
+ *
+ * @return number of ODE runs
+ *
+ * @note The coupling axis only has integer nodes as used by the ODE. The
+ * tolerance should be well above the ODE threshold, otherwise the convergence
+ * noise of the equilibria triggers refinement.
+ */
+int BuildEquilibriumMap(map<string, double> &twiss,
+                        map<string, vector<double>> &twissdata, int nrf,
+                        double harmon[], double voltages[], int model,
+                        double ex0, double ey0, double sigs0, double *lower,
+                        double *upper, int *ninitial, double tolerance,
+                        int maxnodes, double threshold, EquilibriumMap &emap);
+
+/**
+ * Interpolated equilibrium for a given bunch population, coupling and voltage
+ * scale. Queries outside the grid are clamped to the grid boundaries.
+ *
+ * The error estimate is the linear interpolation error bound
+ * sum_d |f''_d| (x_d - x_i) (x_i+1 - x_d) / 2 with the largest curvature of the
+ * cell corners, it vanishes at the nodes.
+ *
+ * @param emap equilibrium map
+ * @param pnumber number of real particles in the bunch
+ * @param coupling coupling in percent
+ * @param voltage RF voltage scale factor
+ * @param[out] out interpolated ex, ey, sigs
+ * @param[out] error estimated absolute interpolation errors of ex, ey, sigs
+ */
+void EquilibriumMapLookup(EquilibriumMap &emap, double pnumber,
+                          double coupling, double voltage, double *out,
+                          double *error);
+
+/**
+ * Write an equilibrium map to a binary file (native byte order).
+ *
+ * @param filename output file
+ * @param emap equilibrium map
+ *
+ * @return true on success
+ */
+bool WriteEquilibriumMap(string filename, EquilibriumMap &emap);
+
+/**
+ * Read an equilibrium map from a binary file written by WriteEquilibriumMap.
+ *
+ * @param filename input file
+ * @param[out] emap equilibrium map
+ *
+ * @return true on success
+ */
+bool ReadEquilibriumMap(string filename, EquilibriumMap &emap);
+
+#endif
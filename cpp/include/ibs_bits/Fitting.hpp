@@ -0,0 +1,151 @@
+#ifndef FITTING_HPP
+#define FITTING_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** Index of the fit parameters. */
+enum FitParameterIndex {
+  /** hor/ver coupling in percent, continuous */
+  FIT_COUPLING = 0,
+  /** calibration factor of the bunch population */
+  FIT_PNUMBER = 1,
+  /** correction factor of the Coulomb log, scales all growth rates */
+  FIT_CLOG = 2,
+  FIT_NPARAMETERS = 3
+};
+
+/**
+ * Measured emittance evolution. Every series (ex, ey, sigs) is either empty or
+ * has one value per time. Without errors the residuals are relative to the
+ * measured values.
+ */
+struct FitMeasurement {
+  /** measurement times, increasing */
+  vector<double> time;
+  /** horizontal emittances */
+  vector<double> ex;
+  /** vertical emittances */
+  vector<double> ey;
+  /** bunch lengths */
+  vector<double> sigs;
+  /** errors of the horizontal emittances, empty for relative residuals */
+  vector<double> exerr;
+  /** errors of the vertical emittances, empty for relative residuals */
+  vector<double> eyerr;
+  /** errors of the bunch lengths, empty for relative residuals */
+  vector<double> sigserr;
+};
+
+/** Result of one Levenberg-Marquardt run. */
+struct FitResult {
+  /** start values of the parameters */
+  double start[FIT_NPARAMETERS];
+  /** fitted parameters */
+  double parameters[FIT_NPARAMETERS];
+  /** covariance of the parameters, zero for fixed parameters */
+  double covariance[FIT_NPARAMETERS * FIT_NPARAMETERS];
+  /** sum of the squared residuals */
+  double chi2;
+  /** number of residuals */
+  int nresiduals;
+  /** number of Levenberg-Marquardt iterations */
+  int iterations;
+  /** number of model runs with sensitivities */
+  int evaluations;
+  /** total number of growth rate evaluations */
+  long rateevaluations;
+  /** true if the relative change of chi2 or of the parameters dropped below
+   * the tolerance */
+  bool converged;
+};
+
+/**
+ * Emittance evolution of the "der" equations of the ODE together with its
+ * forward sensitivities with respect to the fit parameters.
+ *
+ * The state (ex, ey, sige) and its Jacobian S = du/dp are advanced with the
+ * auto time step of the ODE, clipped to the measurement times, with
+ * S' = S + dt (J_u S + J_p). The derivatives of the growth rates with respect
+ * to the state and the bunch population are forward differences, one step
+ * costs 4 growth rate evaluations (5 with the population derivative). The
+ * time steps depend on the parameters through the rates but are not
+ * differentiated.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param model IBS model (1-13)
+ * @param pnumber nominal number of particles per bunch
+ * @param p FIT_NPARAMETERS parameters (coupling in percent, population factor,
+ * Coulomb log factor)
+ * @param t0 initial time
+ * @param ex0 initial horizontal emittance
+ * @param ey0 initial vertical emittance
+ * @param sigs0 initial bunch length
+ * @param times output times, increasing
+ * @param[out] out ex, ey and sigs for every output time
+ * @param[out] dout derivatives, entry 9 * i + 3 * k + j is the derivative of
+ * output k at time i with respect to parameter j
+ * @param pnumberderivative calculate the derivatives with respect to the
+ * population factor
+ *
+ * @return number of growth rate evaluations
+ */
+long FitModelSensitivities(map<string, double> &twiss,
+                           map<string, vector<double>> &twissdata, int nrf,
+                           double harmon[], double voltages[], int model,
+                           double pnumber, const double *p, double t0,
+                           double ex0, double ey0, double sigs0,
+                           const vector<double> &times, vector<double> &out,
+                           vector<double> &dout,
+                           bool pnumberderivative = true);
+
+/**
+ * Fit the coupling, the bunch population calibration and the Coulomb log
+ * correction to a measured emittance evolution with Levenberg-Marquardt.
+ *
+ * Every iteration runs the model once with FitModelSensitivities, the
+ * Jacobian of the residuals follows from the forward sensitivities without
+ * finite differences of ODE runs. It approximates the derivative of the
+ * integration scheme, as the time steps are kept fixed and the rate
+ * derivatives are forward differences. The starts are fitted in
+ * parallel, the coupling is kept in [0, 100] and the factors positive.
+ *
+ * The covariance is (J^T J)^-1 at the solution, scaled with chi2 / (m - n)
+ * for m residuals and n free parameters if any series has no errors.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param model IBS model (1-13)
+ * @param pnumber nominal number of particles per bunch
+ * @param t0 initial time
+ * @param ex0 initial horizontal emittance
+ * @param ey0 initial vertical emittance
+ * @param sigs0 initial bunch length
+ * @param data measured evolution
+ * @param free FIT_NPARAMETERS flags of the fitted parameters, the others stay
+ * at their start values
+ * @param starts FIT_NPARAMETERS start values per start
+ * @param maxiter maximum number of iterations per start
+ * @param tolerance relative change of chi2 or of the parameters for
+ * convergence
+ * @param[out] results one result per start, sorted by chi2
+ */
+void FitEmittanceEvolution(map<string, double> &twiss,
+                           map<string, vector<double>> &twissdata, int nrf,
+                           double harmon[], double voltages[], int model,
+                           double pnumber, double t0, double ex0, double ey0,
+                           double sigs0, FitMeasurement &data,
+                           const bool *free, const vector<double> &starts,
+                           int maxiter, double tolerance,
+                           vector<FitResult> &results);
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef IBS_C_API_H
+#define IBS_C_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opaque ring context holding the prepared Twiss data, the selected model and
+ * the current beam moments. Contexts are independent of each other and can be
+ * used concurrently from different threads, a single context must not be
+ * shared between threads without synchronisation.
+ */
+typedef struct IBSContext IBSContext;
+
+/** Return codes of the C API. */
+enum IBSStatus {
+  IBS_OK = 0,
+  IBS_ERROR_ARGUMENT = 1,
+  IBS_ERROR_FILE = 2,
+  IBS_ERROR_STATE = 3,
+  IBS_ERROR_INTERNAL = 4
+};
+
+/**
+ * Create an empty context, to be filled with ibs_set_header and
+ * ibs_set_column and finalised with ibs_prepare.
+ *
+ * @return new context or NULL on failure
+ */
+IBSContext *ibs_create(void);
+
+/**
+ * Create a prepared context from a MADX Twiss file.
+ *
+ * @param filename path to the Twiss file
+ *
+ * @return new context or NULL if the file could not be read
+ */
+IBSContext *ibs_create_from_file(const char *filename);
+
+/**
+ * Create a prepared context from a MADX Twiss output held in memory, e.g. read
+ * from a pipe of the optics code.
+ *
+ * @param data content of the Twiss file (not necessarily null terminated)
+ * @param size number of bytes
+ *
+ * @return new context or NULL if the data could not be parsed
+ */
+IBSContext *ibs_create_from_buffer(const char *data, size_t size);
+
+/**
+ * Release a context and all its data.
+ *
+ * @param ctx context, NULL is ignored
+ */
+void ibs_destroy(IBSContext *ctx);
+
+/**
+ * Set a Twiss header value (e.g. GAMMA, LENGTH, CHARGE, MASS, ENERGY).
+ *
+ * @param ctx context
+ * @param key header key
+ * @param value header value
+ *
+ * @return status code
+ */
+int ibs_set_header(IBSContext *ctx, const char *key, double value);
+
+/**
+ * Set a Twiss table column (L, BETX, ALFX, BETY, ALFY, DX, DPX, DY, DPY, K1L,
+ * K1SL, ANGLE). The values are copied.
+ *
+ * @param ctx context
+ * @param name column name
+ * @param n number of elements
+ * @param values column values
+ *
+ * @return status code
+ */
+int ibs_set_column(IBSContext *ctx, const char *name, int n,
+                   const double *values);
+
+/**
+ * Check the Twiss data and calculate the derived columns (see updateTwiss).
+ * Must be called after the last ibs_set_column and before any evaluation.
+ *
+ * @param ctx context
+ *
+ * @return status code
+ */
+int ibs_prepare(IBSContext *ctx);
+
+/**
+ * Number of lattice elements of a prepared context.
+ *
+ * @param ctx context
+ *
+ * @return number of elements, negative on error
+ */
+int ibs_number_of_elements(const IBSContext *ctx);
+
+/**
+ * Select the IBS model and the beam species. The header CHARGE and MASS are
+ * set to the species, ENERGY and PC (if present) follow at fixed GAMMA.
+ *
+ * @param ctx context
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param pnumber number of real particles in the bunch
+ * @param charge particle charge in units of the elementary charge
+ * @param aatom particle mass in units of the proton mass
+ *
+ * @return status code
+ */
+int ibs_set_model(IBSContext *ctx, int model, double pnumber, double charge,
+                  double aatom);
+
+/**
+ * Select the element where moments are defined and kicks are applied.
+ *
+ * @param ctx context
+ * @param element element index in the Twiss table
+ *
+ * @return status code
+ */
+int ibs_set_reference_element(IBSContext *ctx, int element);
+
+/**
+ * Update the beam moments.
+ *
+ * @param ctx context
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param sige relative momentum spread
+ *
+ * @return status code
+ */
+int ibs_set_moments(IBSContext *ctx, double ex, double ey, double sigs,
+                    double sige);
+
+/**
+ * IBS amplitude growth rates for the current moments, summed over the element
+ * optics gathered by ibs_prepare (see IBSRatesElements). The rates are cached
+ * and only recalculated after the moments, the header or the model changed.
+ *
+ * @param ctx context
+ * @param[out] rates growth rates (longitudinal, horizontal, vertical)
+ *
+ * @return status code
+ */
+int ibs_evaluate(IBSContext *ctx, double *rates);
+
+/**
+ * Contribution of a single element to the growth rates for the current
+ * moments.
+ *
+ * @param ctx context
+ * @param element element index in the Twiss table
+ * @param[out] rates growth rate contributions (longitudinal, horizontal,
+ * vertical)
+ *
+ * @return status code
+ */
+int ibs_element_rates(IBSContext *ctx, int element, double *rates);
+
+/**
+ * Apply IBS kicks for the current moments and rates at the reference element.
+ *
+ * @param ctx context
+ * @param npart number of macro-particles
+ * @param[in, out] x horizontal positions
+ * @param[in, out] px horizontal momenta
+ * @param[in, out] y vertical positions
+ * @param[in, out] py vertical momenta
+ * @param[in, out] dp relative momentum deviations
+ * @param dt time interval the kick represents
+ * @param seed seed of the random number generator
+ * @param turn turn number
+ *
+ * @return status code
+ */
+int ibs_kick(IBSContext *ctx, int npart, double *x, double *px, double *y,
+             double *py, double *dp, double dt, uint64_t seed, uint64_t turn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
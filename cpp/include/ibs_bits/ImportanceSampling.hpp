@@ -0,0 +1,67 @@
+#ifndef IMPORTANCE_SAMPLING_HPP
+#define IMPORTANCE_SAMPLING_HPP
+#include "Models.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Sampling weight of a lattice element used as cheap proxy for its
+ * contribution to the IBS growth rates: element length times curly H over the
+ * transverse beam size.
+ *
+ * @param i element index in the Twiss table
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param dponp energy spread
+ * @param twissdata Twiss Table Map
+ *
+ * @return @f$ L (1 + \mathcal{H}_x \delta^2 / \epsilon_x) / (\sigma_x
+ * \sigma_y) @f$
+ */
+double ImportanceSamplingWeight(int i, double ex, double ey, double dponp,
+                                map<string, vector<double>> &twissdata);
+
+/**
+ * Approximate IBS growth rates of a lattice model from an importance sampled
+ * subset of the lattice elements.
+ *
+ * Elements are drawn with probability proportional to
+ * ImportanceSamplingWeight and the lattice sums are estimated with the
+ * unbiased importance sampling estimator. After a pilot batch, the sample size
+ * is chosen such that the 95% confidence interval is within the requested
+ * relative error. The interval is estimated from the samples themselves and
+ * is therefore approximate. If the requested accuracy needs more element
+ * evaluations than the lattice has elements, the exact lattice sum is
+ * returned instead.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param relerr target relative half width of the 95% confidence interval
+ * @param seed seed of the random number generator
+ * @param[out] rates estimated IBS amplitude growth rates (longitudinal,
+ * horizontal, vertical)
+ * @param[out] errors half width of the 95% confidence intervals of the rates
+ *
+ * @return number of elements that were evaluated
+ *
+ * @see IBSElementRates
+ */
+int ImportanceSampledRates(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double relerr, unsigned long seed,
+                           double *rates, double *errors);
+
+#endif
@@ -26,6 +26,23 @@ void SimpsonDecade(double a, double b, double c, double cl, double cx,
                    double cy, double cprime, double cyy, double tl1, double tl2,
                    double tx1, double tx2, double ty1, double ty2, double *tau);
 
+/**
+ * Closed form Bjorken-Mtingwa integrals for a dispersion-free element in terms
+ * of Carlson's elliptic integral RD (rds). This is the limit of the
+ * Conte-Martini, MADX Zimmerman and twsint integrands for DX = DPX = DY = DPY
+ * = 0, where these integrators use it instead of the Simpson decades.
+ * BjorkenMtingwaInt uses a closed form of its own integrand.
+ *
+ * @param c3 betx / ex
+ * @param cy bety / ey
+ * @param cl (gamma / sige)**2
+ * @param[in,out] tau outputArray, same normalisation as SimpsonDecade
+ *  0 -> IBS amplitude growth rate longitudinal
+ *  1 -> IBS amplitude growth rate horizontal
+ *  2 -> IBS amplitude growth rate vertical
+ */
+void DispersionFreeInt(double c3, double cy, double cl, double *tau);
+
 /**
  * The IBS integral integrand function.
  *
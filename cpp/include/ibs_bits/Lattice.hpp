@@ -0,0 +1,168 @@
+#ifndef LATTICE_HPP
+#define LATTICE_HPP
+#include "Views.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Owning Twiss header and table. A lattice is moved, never copied, the maps
+ * are taken over from the caller and the columns are handed out as views.
+ * The map based functions of the library work on HeaderMap() and TableMap()
+ * without copies.
+ */
+class Lattice {
+public:
+  Lattice() = default;
+
+  /**
+   * Take over a Twiss header and table.
+   *
+   * @param twissheader Twiss Header Map, moved from
+   * @param twisstable Twiss Table Map, moved from
+   */
+  Lattice(map<string, double> &&twissheader,
+          map<string, vector<double>> &&twisstable)
+      : header(move(twissheader)), table(move(twisstable)) {}
+
+  Lattice(const Lattice &) = delete;
+  Lattice &operator=(const Lattice &) = delete;
+  Lattice(Lattice &&) = default;
+  Lattice &operator=(Lattice &&) = default;
+
+  /** number of elements, 0 for a lattice without L column */
+  size_t Size() const;
+
+  /** header value, 0 if the key is missing */
+  double Header(const string &key) const;
+
+  /** view of a column, empty if the column is missing */
+  Span<const double> Column(const string &key) const;
+
+  /**
+   * Mutable view of a column, empty if the column is missing. After changing
+   * optics columns Prepare() updates the derived columns.
+   */
+  Span<double> MutableColumn(const string &key);
+
+  /** calculate the derived columns with updateTwiss, in place */
+  void Prepare();
+
+  /** Twiss Header Map */
+  map<string, double> &HeaderMap() { return header; }
+
+  /** Twiss Table Map */
+  map<string, vector<double>> &TableMap() { return table; }
+
+  /**
+   * Hand the header and table back to the caller, the lattice is empty
+   * afterwards.
+   *
+   * @param[out] twissheader Twiss Header Map
+   * @param[out] twisstable Twiss Table Map
+   */
+  void Release(map<string, double> &twissheader,
+               map<string, vector<double>> &twisstable);
+
+private:
+  map<string, double> header;
+  map<string, vector<double>> table;
+};
+
+/**
+ * Read a Twiss file into a lattice with ReadTwiss and prepare it.
+ *
+ * @param filename Path to the Twiss file.
+ * @param[out] lattice lattice, replaced
+ *
+ * @return true on success
+ */
+bool ReadLattice(const string &filename, Lattice &lattice);
+
+/**
+ * IBS growth rates of the selected model on a lattice.
+ *
+ * @param model IBS model (1-13)
+ * @param state beam state
+ * @param lattice prepared lattice
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out IBS amplitude growth rates (longitudinal, horizontal,
+ * vertical), at least 3 entries
+ *
+ * @return false for unknown models (zero rates) or a too short output
+ */
+bool IBSRates(int model, const BeamState &state, Lattice &lattice, double r0,
+              double aatom, Span<double> out);
+
+/**
+ * IBS growth rates of many beam states in one pass over a lattice.
+ *
+ * @param model IBS model (1-13)
+ * @param states columns of the beam states
+ * @param lattice prepared lattice
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out one row per state, columns (longitudinal, horizontal,
+ * vertical) IBS amplitude growth rates
+ *
+ * @return false for unknown models (zero rates) or an output of the wrong
+ * shape
+ */
+bool IBSRatesBatch(int model, const BeamStates &states, Lattice &lattice,
+                   double r0, double aatom, MatrixView<double> out);
+
+/**
+ * Trajectory of an ODE run, owned by the caller and reused across runs. The
+ * buffers keep their capacity, repeated runs only allocate when a trajectory
+ * is longer than all previous ones.
+ */
+struct ODEResult {
+  /** timesteps */
+  vector<double> t;
+  /** horizontal emittance */
+  vector<double> ex;
+  /** vertical emittance */
+  vector<double> ey;
+  /** bunch length */
+  vector<double> sigs;
+  /** energy spread */
+  vector<double> sige;
+
+  ODEResult() = default;
+  ODEResult(const ODEResult &) = delete;
+  ODEResult &operator=(const ODEResult &) = delete;
+  ODEResult(ODEResult &&) = default;
+  ODEResult &operator=(ODEResult &&) = default;
+};
+
+/**
+ * Run ODE simulation using auto time step on a lattice, the trajectory is
+ * written to the result.
+ *
+ * @param lattice prepared lattice
+ * @param harmon harmonic numbers of the rf systems
+ * @param voltages voltages of the rf systems, same size as harmon
+ * @param pnumber number of particles per bunch
+ * @param ex0 initial horizontal emittance
+ * @param ey0 initial vertical emittance
+ * @param sigs0 initial bunch length
+ * @param model IBS model (1-13)
+ * @param couplingpercentage hor/ver coupling in percentage
+ * @param threshold evolution stop threshold
+ * @param method simulation method (rlx or der)
+ * @param[out] result trajectory, starting at t = 0
+ *
+ * @return false if the rf systems are empty or differ in size, or the lattice
+ * is empty
+ *
+ * @see ODE
+ */
+bool RunODE(Lattice &lattice, Span<const double> harmon,
+            Span<const double> voltages, double pnumber, double ex0,
+            double ey0, double sigs0, int model, int couplingpercentage,
+            double threshold, const string &method, ODEResult &result);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef LINEAR_OPTICS_HPP
+#define LINEAR_OPTICS_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Uncoupled transfer matrices of one element. The horizontal matrix acts on
+ * (x, px, delta), only its first two rows are stored, the vertical one on
+ * (y, py).
+ */
+struct ElementMatrix {
+  /** horizontal rows (m11, m12, m13, m21, m22, m23) */
+  double x[6];
+  /** vertical matrix (m11, m12, m21, m22) */
+  double y[4];
+};
+
+/**
+ * Transfer matrices of element i of a Twiss table from L, ANGLE and K1L.
+ *
+ * Elements with a length are thick quadrupoles, sector bends with combined
+ * function gradient or drifts, elements without a length are thin multipole
+ * kicks. Bends get the edge focusing of the optional columns E1 and E2 (edge
+ * angles relative to the sector bend), with the fringe field correction of
+ * the optional columns HGAP and FINT in the vertical plane. Skew gradients and
+ * sextupoles are ignored.
+ *
+ * @param table Twiss Table Map
+ * @param i element index
+ * @param[out] m transfer matrices
+ */
+void LinearOpticsElementMatrix(map<string, vector<double>> &table, size_t i,
+                               ElementMatrix &m);
+
+/**
+ * Recompute the periodic uncoupled optics of a ring from the element strengths
+ * and prepare the table for the models.
+ *
+ * The one-turn matrices give the periodic BETX, ALFX, DX, DPX, BETY and ALFY
+ * at the start of the ring, which are propagated element by element (values
+ * at the element exits as in MAD-X). DY and DPY are set to zero. updateTwiss
+ * is applied to the new optics and the header values Q1, Q2, ALFA and GAMMATR
+ * are updated, ALFA from the dispersion integrated over the bends.
+ *
+ * A quadrupole knob is applied by changing K1L in the table and calling this
+ * function again, no other step is needed before calculating growth rates.
+ * Temporaries come from the thread arena, a prepared table is updated without
+ * heap allocations.
+ *
+ * @param twiss Twiss Header Map
+ * @param table Twiss Table Map with L, ANGLE and K1L
+ *
+ * @return false if the lattice has no stable periodic solution in one of the
+ * planes, the table is then unchanged
+ */
+bool PeriodicLinearOptics(map<string, double> &twiss,
+                          map<string, vector<double>> &table);
+
+#endif
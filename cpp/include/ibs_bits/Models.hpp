@@ -1,6 +1,9 @@
+#ifndef MODELS_HPP
+#define MODELS_HPP
 #include "CoulombLogFunctions.hpp"
 #include "Integrators.hpp"
 #include "NumericFunctions.hpp"
+#include "Views.hpp"
 #include <iostream>
 #include <map>
 #include <math.h>
@@ -297,4 +300,190 @@ double *ConteMartinitailcut(double pnumber, double ex, double ey, double sigs,
  */
 double *MadxIBS(double pnumber, double ex, double ey, double sigs, double dponp,
                 map<string, double> &twissheader,
-                map<string, vector<double>> &twissdata, double r0);
\ No newline at end of file
+                map<string, vector<double>> &twissdata, double r0);
+/**
+ * IBS growth rates of the selected model, using the same model numbering as
+ * the ODE.
+ *
+ * @param model IBS model (1-13)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ *
+ * @return IBS amplitude growth rates (longitudinal, horizontal, vertical),
+ * zero for unknown models, in a buffer of the calling thread that is
+ * overwritten by the next call
+ */
+double *IBSRates(int model, double pnumber, double ex, double ey, double sigs,
+                 double dponp, map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, double r0,
+                 double aatom);
+
+/**
+ * IBS growth rates of the selected model written to a caller provided view.
+ *
+ * @param model IBS model (1-13)
+ * @param state beam state
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out IBS amplitude growth rates (longitudinal, horizontal,
+ * vertical), at least 3 entries
+ *
+ * @return false for unknown models (zero rates) or a too short output
+ */
+bool IBSRates(int model, const BeamState &state,
+              map<string, double> &twissheader,
+              map<string, vector<double>> &twissdata, double r0, double aatom,
+              Span<double> out);
+/*
+================================================================================
+
+ELEMENT BY ELEMENT CONTRIBUTIONS
+
+================================================================================
+*/
+/**
+ * Contribution of a single lattice element to the IBS growth rates of the
+ * selected model. The model normalisation is applied, such that summing the
+ * output over all elements of the Twiss table gives the model growth rates.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param i element index in the Twiss table
+ * @param pnumber numper of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out IBS amplitude growth rate contributions (longitudinal,
+ * horizontal, vertical)
+ *
+ * @note The smooth approximation (model 1) has no lattice sum, its ring
+ * averaged rates are weighted with the element length.
+ */
+void IBSElementRates(int model, int i, double pnumber, double ex, double ey,
+                     double sigs, double dponp,
+                     map<string, double> &twissheader,
+                     map<string, vector<double>> &twissdata, double r0,
+                     double aatom, double *out);
+
+/**
+ * IBS growth rates of many beam states in one pass over the lattice. The
+ * optics of every element are read once and the element kernel of the model
+ * is evaluated for all states, the result for state k equals the growth rates
+ * of the model up to the summation order.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param nstates number of beam states
+ * @param pnumber number of real particles in the bunch per state
+ * @param ex horizontal emittance per state
+ * @param ey vertical emittance per state
+ * @param sigs bunch length per state
+ * @param dponp energy spread per state, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out 3 * nstates IBS amplitude growth rates, entry 3 * k + j is
+ * rate j (longitudinal, horizontal, vertical) of state k, zero for unknown
+ * models
+ */
+void IBSRatesBatch(int model, int nstates, const double *pnumber,
+                   const double *ex, const double *ey, const double *sigs,
+                   const double *dponp, map<string, double> &twissheader,
+                   map<string, vector<double>> &twissdata, double r0,
+                   double aatom, double *out);
+
+/**
+ * IBS growth rates of many beam states in one pass over the lattice, with
+ * views of the states and a strided output view.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param states columns of the beam states
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out one row per state, columns (longitudinal, horizontal,
+ * vertical) IBS amplitude growth rates
+ *
+ * @return false for unknown models (zero rates) or an output of the wrong
+ * shape
+ */
+bool IBSRatesBatch(int model, const BeamStates &states,
+                   map<string, double> &twissheader,
+                   map<string, vector<double>> &twissdata, double r0,
+                   double aatom, MatrixView<double> out);
+
+/**
+ * Ring constants used by the element kernels of the lattice models.
+ */
+struct IBSElementRing {
+  double gamma, charge, circ, en0, amass, betar;
+};
+
+/**
+ * Optics of one lattice element as read by the element kernels. Only the
+ * tailcut models use angle, k1l and k1sl.
+ */
+struct IBSElementOptics {
+  double l, bx, by, ax, ay, dx, dpx, dy, dpy;
+  double angle, k1l, k1sl;
+};
+
+/**
+ * Ring constants of the element kernels from a Twiss header.
+ *
+ * @param twissheader Twiss Header Map (GAMMA, CHARGE, LENGTH, ENERGY, MASS)
+ * @param[out] ring ring constants
+ */
+void IBSElementRingSetup(map<string, double> &twissheader,
+                         IBSElementRing &ring);
+
+/**
+ * Optics of all elements of a Twiss table, to evaluate the rates of a fixed
+ * lattice repeatedly with IBSRatesElements. Elements without length do not
+ * contribute to the lattice sums and are skipped, missing ANGLE, K1L and K1SL
+ * columns are taken as zero.
+ *
+ * @param twissdata Twiss Table Map
+ * @param[out] elements optics of the elements with non-zero length
+ */
+void IBSElementTable(map<string, vector<double>> &twissdata,
+                     vector<IBSElementOptics> &elements);
+
+/**
+ * IBS growth rates of the selected model from precomputed element optics,
+ * equal to IBSRates on the Twiss table the elements were taken from up to the
+ * summation order.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param state beam state
+ * @param twissheader Twiss Header Map (only used by model 1)
+ * @param ring ring constants, see IBSElementRingSetup
+ * @param elements element optics, see IBSElementTable
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] out IBS amplitude growth rates (longitudinal, horizontal,
+ * vertical), at least 3 entries
+ *
+ * @return false for unknown models (zero rates) or a too short output
+ */
+bool IBSRatesElements(int model, const BeamState &state,
+                      map<string, double> &twissheader,
+                      const IBSElementRing &ring,
+                      Span<const IBSElementOptics> elements, double r0,
+                      double aatom, Span<double> out);
+
+#endif
@@ -1,3 +1,5 @@
+#ifndef ORD_DIFF_EQ_HPP
+#define ORD_DIFF_EQ_HPP
 #include <algorithm>
 #include <map>
 #include <math.h>
@@ -31,7 +33,8 @@ void WriteToFile(string filename, vector<double> &t, vector<double> &ex,
  * @param[in, out] ex horizontal emittance
  * @param[in, out] ey vertical emittance
  * @param[in, out] sigs bunch length
- * @param[in, out] sige energy spread
+ * @param[out] sige energy spread for every entry of t, previous contents are
+ * replaced
  * @param model IBS model (1-13)
  * @param pnumber number of particles per bunch
  * @param couplingpercentage hor/ver coupling in percentage
@@ -44,8 +47,28 @@ void WriteToFile(string filename, vector<double> &t, vector<double> &ex,
 void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
          int nrf, double harmon[], double voltages[], vector<double> &t,
          vector<double> &ex, vector<double> &ey, vector<double> &sigs,
-         vector<double> sige, int model, double pnumber, int couplingpercentage,
-         double threshold, string method, bool debug_output=false);
+         vector<double> &sige, int model, double pnumber,
+         int couplingpercentage, double threshold, string method,
+         bool debug_output = false);
+
+/**
+ * Run ODE simulation using auto time step and record the Laslett tune shifts
+ * along the trajectory. The tune shifts are accumulated in the same lattice
+ * pass as the growth rates of the selected model.
+ *
+ * @param[in, out] sige energy spread, the energy spread used for the rates and
+ * tune shifts for every entry of t on return
+ * @param[out] dqx horizontal Laslett tune shift for every entry of t
+ * @param[out] dqy vertical Laslett tune shift for every entry of t
+ *
+ * @see ODE, IBSRatesWithTuneShift
+ */
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> &sige, int model, double pnumber,
+         int couplingpercentage, double threshold, string method,
+         bool debug_output, vector<double> &dqx, vector<double> &dqy);
 /**
  *
  * Run ODE simulation using auto time step.
@@ -59,7 +82,8 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
  * @param[in, out] ex horizontal emittance
  * @param[in, out] ey vertical emittance
  * @param[in, out] sigs bunch length
- * @param[in, out] sige energy spread
+ * @param[out] sige energy spread for every entry of t, previous contents are
+ * replaced
  * @param model IBS model (1-13)
  * @param pnumber number of particles per bunch
  * @param nsteps number of simulation steps
@@ -72,5 +96,465 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
 void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
          int nrf, double harmon[], double voltages[], vector<double> &t,
          vector<double> &ex, vector<double> &ey, vector<double> &sigs,
-         vector<double> sige, int model, double pnumber, int nsteps,
-         double stepsize, int couplingpercentage, string method, bool debug_output=false);
+         vector<double> &sige, int model, double pnumber, int nsteps,
+         double stepsize, int couplingpercentage, string method,
+         bool debug_output = false);
+
+/**
+ * Run ODE simulation for hadron and ion rings. Radiation damping and quantum
+ * excitation are neglected and the time step is chosen from the IBS growth
+ * rates alone, such that the emittances and the energy spread change by at
+ * most the relative tolerance per step. The steps are second order
+ * (predictor-corrector on the rates) and cost two model evaluations each.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param[in, out] t timesteps
+ * @param[in, out] ex horizontal emittance
+ * @param[in, out] ey vertical emittance
+ * @param[in, out] sigs bunch length
+ * @param sige energy spread (derived from the initial bunch length)
+ * @param model IBS model (1-13)
+ * @param pnumber number of particles per bunch
+ * @param charge particle charge in units of the elementary charge
+ * @param aatom particle mass in units of the proton mass
+ * @param tmax simulated time
+ * @param tolerance maximum relative change of the emittances and the energy
+ * spread per step
+ * @param debug_output: print debug output
+ *
+ */
+void ODEHadron(map<string, double> &twiss,
+               map<string, vector<double>> &twissdata, int nrf,
+               double harmon[], double voltages[], vector<double> &t,
+               vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+               vector<double> sige, int model, double pnumber, double charge,
+               double aatom, double tmax, double tolerance = 0.05,
+               bool debug_output = false);
+
+/**
+ * Trajectory buffers for scan tasks that only need the final state of ODE runs.
+ */
+struct ODEScratch {
+  /** timesteps */
+  vector<double> t;
+  /** horizontal emittance */
+  vector<double> ex;
+  /** vertical emittance */
+  vector<double> ey;
+  /** bunch length */
+  vector<double> sigs;
+  /** energy spread (input of ODE, kept empty) */
+  vector<double> sige;
+};
+
+/**
+ * Trajectory buffers of the calling thread, reset to the initial state. The
+ * buffers keep their storage across tasks, so repeated runs on a thread do
+ * not allocate once the buffers have grown to the longest trajectory.
+ *
+ * @param ex0 initial horizontal emittance
+ * @param ey0 initial vertical emittance
+ * @param sigs0 initial bunch length
+ *
+ * @return buffers owned by the calling thread
+ */
+ODEScratch &ThreadODEScratch(double ex0, double ey0, double sigs0);
+
+/**
+ * Ring quantities of the ODE that do not depend on the beam state. They are
+ * calculated once per lattice and shared by the ODE runs, the model fits and
+ * the resumable runs of the scheduler.
+ */
+struct ODERing {
+  /** relativistic gamma */
+  double gamma;
+  /** transition gamma */
+  double gammatr;
+  /** angular revolution frequency */
+  double omega;
+  /** synchrotron tune */
+  double qs;
+  /** angular synchrotron frequency */
+  double omegas;
+  /** atomic mass number */
+  double aatom;
+  /** classical particle radius */
+  double r0;
+  /** energy loss per turn */
+  double U0;
+  /** synchronous phase */
+  double phis;
+  /** horizontal radiation damping time */
+  double tauradx;
+  /** vertical radiation damping time */
+  double taurady;
+  /** longitudinal radiation damping time */
+  double taurads;
+  /** horizontal radiation equilibrium emittance */
+  double ex0;
+  /** vertical equilibrium emittance, at least the coupled horizontal one */
+  double ey0;
+  /** radiation equilibrium energy spread */
+  double sige0;
+  /** radiation equilibrium bunch length */
+  double sigs0;
+  /** hor/ver coupling as a fraction */
+  double coupling;
+};
+
+/**
+ * Ring quantities of the ODE from given radiation integrals, e.g. interpolated
+ * ones.
+ *
+ * @param twiss Twiss Header Map
+ * @param radint radiation integrals I1, I2, I3, I4x, I4y, I5x and I5y
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param couplingpercentage hor/ver coupling in percentage, 0 outside
+ * [0, 100]
+ * @param[out] ring ring quantities
+ */
+void ODERingFromIntegrals(map<string, double> &twiss, const double *radint,
+                          int nrf, double harmon[], double voltages[],
+                          int couplingpercentage, ODERing &ring);
+
+/**
+ * Ring quantities of the ODE with the radiation integrals of the lattice.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map, prepared with updateTwiss
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param couplingpercentage hor/ver coupling in percentage, 0 outside
+ * [0, 100]
+ * @param[out] ring ring quantities
+ *
+ * @see ODERingFromIntegrals
+ */
+void ODERingSetup(map<string, double> &twiss,
+                  map<string, vector<double>> &twissdata, int nrf,
+                  double harmon[], double voltages[], int couplingpercentage,
+                  ODERing &ring);
+
+/**
+ * Right hand side of the "der" equations, or the distance to the relaxation
+ * target of the "rlx" form. Shared by the ODE steps and the equilibrium
+ * residual.
+ *
+ * @param ring ring quantities
+ * @param method simulation method (rlx or der, anything else is der)
+ * @param ibs IBS amplitude growth rates (longitudinal, horizontal, vertical)
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sige energy spread
+ * @param[out] F rates of change of ex, ey and sige
+ */
+void ODERingDerivatives(const ODERing &ring, const string &method,
+                        const double *ibs, double ex, double ey, double sige,
+                        double *F);
+
+/**
+ * One Euler step of the "der" equations or of the relaxation form "rlx".
+ *
+ * @param ring ring quantities
+ * @param method simulation method (rlx or der, anything else is der)
+ * @param ibs IBS amplitude growth rates (longitudinal, horizontal, vertical)
+ * @param ddt time step
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sige energy spread
+ * @param[out] exn horizontal emittance after the step
+ * @param[out] eyn vertical emittance after the step
+ * @param[out] sigen energy spread after the step
+ */
+void ODERingStep(const ODERing &ring, const string &method, const double *ibs,
+                 double ddt, double ex, double ey, double sige, double &exn,
+                 double &eyn, double &sigen);
+
+/**
+ * Auto time step of the ODE, half the shortest damping or growth time, four
+ * times that for the relaxation form.
+ *
+ * @param ring ring quantities
+ * @param method simulation method (rlx or der)
+ * @param ibs IBS amplitude growth rates (longitudinal, horizontal, vertical)
+ *
+ * @return time step
+ */
+double ODEAutoTimeStep(const ODERing &ring, const string &method,
+                       const double *ibs);
+
+/**
+ * Step limit of an auto time step run from the rates of the initial state,
+ * ten times the longest time constant (at most 1 s) over the shortest one,
+ * capped at 10000 steps.
+ *
+ * @param ring ring quantities
+ * @param ibs IBS amplitude growth rates of the initial state
+ * @param[out] taum longest time constant, at most 1 s
+ * @param[out] dtmin shortest time constant
+ *
+ * @return maximum number of steps
+ */
+int ODEAutoMaxSteps(const ODERing &ring, const double *ibs, double &taum,
+                    double &dtmin);
+
+/**
+ * Stop criterion of an auto time step run.
+ *
+ * @param i index of the last point of the trajectory, at least 1
+ * @param maxsteps maximum number of steps
+ * @param ex horizontal emittances
+ * @param ey vertical emittances
+ * @param sigs bunch lengths
+ * @param threshold evolution stop threshold
+ *
+ * @return true while i < maxsteps and the relative change of ex, ey or sigs
+ * in the last step exceeds the threshold
+ */
+bool ODEAutoContinue(int i, int maxsteps, const vector<double> &ex,
+                     const vector<double> &ey, const vector<double> &sigs,
+                     double threshold);
+
+/**
+ * Injection into the bunch at a given time, used by the ODE with an event
+ * schedule.
+ */
+struct InjectionEvent {
+  /** time of the injection */
+  double time;
+  /** number of injected particles */
+  double pnumber;
+  /** horizontal emittance of the injected beam */
+  double ex;
+  /** vertical emittance of the injected beam */
+  double ey;
+  /** bunch length of the injected beam */
+  double sigs;
+};
+
+/**
+ * Particle losses of the ODE with a time dependent bunch population. The
+ * relative loss rate -dN/dt / N is the sum of the tabulated rate, the gas rate
+ * and the Touschek rate, the latter scaled with the bunch density
+ * N / (sqrt(ex ey) sigs) from the reference state.
+ */
+struct LossModel {
+  /** times of the tabulated loss rates, empty for none */
+  vector<double> time;
+  /** tabulated relative loss rates (1/s), linearly interpolated in time and
+   * constant outside the table */
+  vector<double> rate;
+  /** gas lifetime (s), 0 for none */
+  double taugas = 0.0;
+  /** Touschek lifetime at the reference state (s), 0 for none */
+  double tautouschek = 0.0;
+  /** reference number of particles of the Touschek lifetime */
+  double pnumber0 = 0.0;
+  /** reference horizontal emittance of the Touschek lifetime */
+  double ex0 = 0.0;
+  /** reference vertical emittance of the Touschek lifetime */
+  double ey0 = 0.0;
+  /** reference bunch length of the Touschek lifetime */
+  double sigs0 = 0.0;
+  /** maximum relative change of the population per step at equilibrium */
+  double dnmax = 0.01;
+};
+
+/**
+ * Run ODE simulation with injection events and particle losses up to tmax.
+ *
+ * Between events the auto time step is used until the relative changes per
+ * step are below the threshold. At equilibrium the population N(t) is advanced
+ * in steps of at most losses.dnmax relative change and the beam relaxes to the
+ * new equilibrium. While the beam state moved by less than the threshold since
+ * the last growth rate evaluation, the rates are scaled with N and the Coulomb
+ * log (N only for the Piwinski models 1-3) instead of being recalculated. At
+ * an event the injected particles are added and the emittances and the
+ * squared energy spread are mixed with the particle numbers as weights.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param[in, out] t timesteps, event times appear twice (before and after)
+ * @param[in, out] ex horizontal emittance
+ * @param[in, out] ey vertical emittance
+ * @param[in, out] sigs bunch length
+ * @param sige energy spread (derived from the initial bunch length)
+ * @param model IBS model (1-13)
+ * @param pnumber initial number of particles per bunch
+ * @param couplingpercentage hor/ver coupling in percentage
+ * @param threshold relative change per step below which the beam is at
+ * equilibrium
+ * @param method simulation method (rlx or der)
+ * @param events injection schedule
+ * @param losses particle loss model
+ * @param tmax end time of the simulation
+ * @param[out] n number of particles for every entry of t
+ * @param debug_output: print debug output
+ */
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, vector<InjectionEvent> events,
+         const LossModel &losses, double tmax, vector<double> &n,
+         bool debug_output = false);
+
+/**
+ * Run ODE simulation with injection (top-up) events up to tmax.
+ *
+ * Between events the auto time step is used until the relative changes per
+ * step are below the threshold, the beam then stays at its equilibrium until
+ * the next event. At an event the injected particles are added and the
+ * emittances and the squared energy spread are mixed with the particle numbers
+ * as weights. Lattice and RF data are calculated once for the whole schedule.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param[in, out] t timesteps, event times appear twice (before and after)
+ * @param[in, out] ex horizontal emittance
+ * @param[in, out] ey vertical emittance
+ * @param[in, out] sigs bunch length
+ * @param sige energy spread (derived from the initial bunch length)
+ * @param model IBS model (1-13)
+ * @param pnumber initial number of particles per bunch
+ * @param couplingpercentage hor/ver coupling in percentage
+ * @param threshold relative change per step below which the beam is at
+ * equilibrium
+ * @param method simulation method (rlx or der)
+ * @param events injection schedule
+ * @param tmax end time of the simulation
+ * @param[out] n number of particles for every entry of t
+ * @param debug_output: print debug output
+ */
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, vector<InjectionEvent> events,
+         double tmax, vector<double> &n, bool debug_output = false);
+
+/**
+ * Optics ramp of the ODE, a sequence of prepared lattices (e.g. the steps of a
+ * beta squeeze or an energy ramp) and the times at which they apply. The
+ * lattices must have the same elements, tables without the updateTwiss columns
+ * are prepared on a copy, the ramp is not modified by ODE.
+ */
+struct OpticsRamp {
+  /** times of the lattices, increasing */
+  vector<double> time;
+  /** Twiss Header Maps */
+  vector<map<string, double>> twiss;
+  /** Twiss Table Maps */
+  vector<map<string, vector<double>>> twissdata;
+  /** maximum change of the interpolation weight per lattice update */
+  double dwmax = 0.01;
+};
+
+/**
+ * Run ODE simulation through an optics ramp up to tmax.
+ *
+ * The optics columns and numeric header values common to all lattices, and the
+ * radiation integrals, are interpolated linearly in time between the lattices
+ * and held constant before the first and after the last one. The derived
+ * columns are recalculated with updateTwiss and the damping times, equilibrium
+ * emittances and synchrotron tune with the interpolated integrals, whenever the
+ * interpolation weight changed by ramp.dwmax. The auto time step is used until
+ * the relative changes per step are below the threshold, a step ends at the
+ * next lattice update or lattice time at the latest. At equilibrium the optics
+ * advance to the next update and the beam relaxes to the new equilibrium.
+ *
+ * @param ramp lattices and their times
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param[in, out] t timesteps
+ * @param[in, out] ex horizontal emittance
+ * @param[in, out] ey vertical emittance
+ * @param[in, out] sigs bunch length
+ * @param sige energy spread (derived from the initial bunch length)
+ * @param model IBS model (1-13)
+ * @param pnumber number of particles per bunch
+ * @param couplingpercentage hor/ver coupling in percentage
+ * @param threshold relative change per step below which the beam is at
+ * equilibrium
+ * @param method simulation method (rlx or der)
+ * @param tmax end time of the simulation
+ * @param debug_output: print debug output
+ */
+void ODE(const OpticsRamp &ramp, int nrf, double harmon[], double voltages[],
+         vector<double> &t, vector<double> &ex, vector<double> &ey,
+         vector<double> &sigs, vector<double> sige, int model, double pnumber,
+         int couplingpercentage, double threshold, string method, double tmax,
+         bool debug_output = false);
+
+/**
+ * Sensitivities of the IBS equilibrium (ex, ey, sigs) of the ODE with respect
+ * to the bunch population, coupling percentage, RF voltage scale factor and
+ * beam energy (GeV).
+ *
+ * Uses the implicit function theorem at the equilibrium F(u, p) = 0 of the
+ * equations of the given method, du/dp = -(dF/du)^-1 dF/dp, with the
+ * Jacobians from central differences. This costs 15 growth rate evaluations,
+ * about the same as one ODE solve.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems
+ * @param model IBS model (1-13)
+ * @param pnumber number of particles per bunch
+ * @param couplingpercentage hor/ver coupling in percentage
+ * @param ex equilibrium horizontal emittance
+ * @param ey equilibrium vertical emittance
+ * @param sigs equilibrium bunch length
+ * @param[out] sensitivities DEX, DEY and DSIGS with the derivatives with
+ * respect to (pnumber, coupling percentage, voltage scale, energy), RATES
+ * (longitudinal, horizontal, vertical) at the equilibrium, DRATES with the
+ * partial derivatives of the rates with respect to the same parameters at fixed
+ * ex, ey, sigs (entry 4 * k + j for rate k and parameter j) and RESIDUAL of the
+ * equations of motion at the given state (dex/dt, dey/dt, dsige/dt for "der",
+ * the relaxation targets minus the state for "rlx")
+ * @param method equations the equilibrium was solved with, "der" or "rlx"
+ * (others are taken as "der")
+ *
+ * @note The linearisation is only meaningful at a converged equilibrium, the
+ * residual indicates how well it is converged.
+ */
+void EquilibriumSensitivities(map<string, double> &twiss,
+                              map<string, vector<double>> &twissdata, int nrf,
+                              double harmon[], double voltages[], int model,
+                              double pnumber, int couplingpercentage,
+                              double ex, double ey, double sigs,
+                              map<string, vector<double>> &sensitivities,
+                              const string &method = "der");
+
+/**
+ * Run ODE simulation using auto time step and calculate the sensitivities of
+ * the final state with EquilibriumSensitivities.
+ *
+ * @param sensitivities output of EquilibriumSensitivities
+ *
+ * @see ODE, EquilibriumSensitivities
+ */
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, bool debug_output,
+         map<string, vector<double>> &sensitivities);
+
+#endif
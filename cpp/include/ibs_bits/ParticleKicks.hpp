@@ -0,0 +1,149 @@
+#ifndef PARTICLE_KICKS_HPP
+#define PARTICLE_KICKS_HPP
+#include "Models.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Four standard normal random numbers from a counter based Philox4x32-10
+ * generator. The numbers only depend on the arguments, such that every
+ * particle, turn and element has its own reproducible stream independent of
+ * the number of threads.
+ *
+ * @param seed key of the generator
+ * @param particle particle index (lower 32 bits are used)
+ * @param turn turn number (lower 32 bits are used)
+ * @param stream additional stream index, e.g. element index (lower 32 bits are
+ * used)
+ * @param[out] out four independent standard normal numbers
+ */
+void GaussianRandomNumbers(unsigned long seed, unsigned long particle,
+                           unsigned long turn, unsigned long stream,
+                           double *out);
+
+/**
+ * Rms beam parameters of a macro-particle distribution. The dispersive
+ * contribution is removed with the dispersion at the reference element before
+ * the statistical emittances are calculated.
+ *
+ * @param npart number of macro-particles
+ * @param x horizontal positions
+ * @param px horizontal momenta
+ * @param y vertical positions
+ * @param py vertical momenta
+ * @param z longitudinal positions
+ * @param dp relative momentum deviations
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param element index of the reference element in the Twiss table
+ * @param[out] moments horizontal emittance, vertical emittance, bunch length
+ * and relative momentum spread
+ */
+void BeamMoments(int npart, double *x, double *px, double *y, double *py,
+                 double *z, double *dp, map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, int element,
+                 double *moments);
+
+/**
+ * Apply random IBS momentum kicks to a macro-particle distribution, such that
+ * the rms emittances and momentum spread grow with the given amplitude growth
+ * rates.
+ *
+ * The transverse kick variances are @f$ 4 a \epsilon \Delta t / \beta @f$ and
+ * the momentum kick variance is @f$ 4 a \sigma_\delta^2 \Delta t @f$. A kick
+ * changes the emittance by @f$ \beta \langle k^2 \rangle / 2 @f$ after phase
+ * mixing, such that the emittances grow with @f$ 2 a @f$ independent of the
+ * alpha function at the element. Momentum kicks move the particle by the
+ * dispersion such that the betatron amplitudes are not changed, the dispersive
+ * heating is already part of the transverse rates.
+ *
+ * @param npart number of macro-particles
+ * @param[in, out] x horizontal positions
+ * @param[in, out] px horizontal momenta
+ * @param[in, out] y vertical positions
+ * @param[in, out] py vertical momenta
+ * @param[in, out] dp relative momentum deviations
+ * @param rates IBS amplitude growth rates (longitudinal, horizontal, vertical)
+ * @param moments beam parameters as returned by BeamMoments
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param element index of the element where the kick is applied
+ * @param dt time interval the kick represents
+ * @param seed seed of the random number generator
+ * @param turn turn number
+ * @param stream additional random stream index
+ *
+ * @note Negative rates can not be represented by a diffusion and are ignored.
+ */
+void IBSKick(int npart, double *x, double *px, double *y, double *py,
+             double *dp, double *rates, double *moments,
+             map<string, double> &twissheader,
+             map<string, vector<double>> &twissdata, int element, double dt,
+             unsigned long seed, unsigned long turn, unsigned long stream);
+
+/**
+ * Apply the IBS kick of one full turn at a single reference element. The beam
+ * parameters are taken from the distribution and the rates from the selected
+ * model.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param npart number of macro-particles
+ * @param[in, out] x horizontal positions
+ * @param[in, out] px horizontal momenta
+ * @param[in, out] y vertical positions
+ * @param[in, out] py vertical momenta
+ * @param z longitudinal positions
+ * @param[in, out] dp relative momentum deviations
+ * @param pnumber number of real particles in the bunch
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number
+ * @param element index of the reference element in the Twiss table
+ * @param seed seed of the random number generator
+ * @param turn turn number
+ * @param[out] rates IBS amplitude growth rates used for the kick
+ *
+ * @see IBSRates, BeamMoments, IBSKick
+ */
+void IBSKickTurn(int model, int npart, double *x, double *px, double *y,
+                 double *py, double *z, double *dp, double pnumber,
+                 map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, double r0,
+                 double aatom, int element, unsigned long seed,
+                 unsigned long turn, double *rates);
+
+/**
+ * Apply the IBS kick of a single element, to be called by a tracking code
+ * after transporting the particles to that element. The element contributions
+ * of one turn add up to the kick of IBSKickTurn.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param i element index in the Twiss table
+ * @param npart number of macro-particles
+ * @param[in, out] x horizontal positions
+ * @param[in, out] px horizontal momenta
+ * @param[in, out] y vertical positions
+ * @param[in, out] py vertical momenta
+ * @param[in, out] dp relative momentum deviations
+ * @param moments beam parameters of the turn as returned by BeamMoments
+ * @param pnumber number of real particles in the bunch
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number
+ * @param seed seed of the random number generator
+ * @param turn turn number
+ *
+ * @see IBSElementRates, IBSKick
+ */
+void IBSKickElement(int model, int i, int npart, double *x, double *px,
+                    double *y, double *py, double *dp, double *moments,
+                    double pnumber, map<string, double> &twissheader,
+                    map<string, vector<double>> &twissdata, double r0,
+                    double aatom, unsigned long seed, unsigned long turn);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+#include <map>
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/** Number of hardware counters per region. */
+#define PERF_NCOUNTERS 6
+
+/**
+ * Enable or disable the profiling mode. While enabled, the lattice loops of
+ * the models, the integrators, updateTwiss and the TFS reader accumulate wall
+ * time and user-space hardware counters (cycles, instructions, last level
+ * cache misses, L1 data cache read misses, data TLB read misses and branch
+ * mispredicts) per region.
+ *
+ * The counters use Linux perf_event_open on the calling thread, no root
+ * privileges are needed with perf_event_paranoid <= 2. Counters that can not
+ * be opened (other platforms, virtual machines without PMU) are omitted from
+ * the report, the wall time is always recorded.
+ *
+ * @param enable switch profiling on or off
+ *
+ * @return true if at least one hardware counter is available
+ *
+ * @note Every region costs a few system calls, the integrators are called per
+ * element and their overhead is visible in the enclosing model region. With
+ * OpenMP only the share of the calling thread is counted.
+ */
+bool PerfCountersEnable(bool enable);
+
+/**
+ * Profiling mode state.
+ *
+ * @return true if profiling is enabled
+ */
+bool PerfCountersEnabled();
+
+/** Clear all accumulated regions. */
+void PerfCountersReset();
+
+/**
+ * Accumulated counters per region.
+ *
+ * @param[out] report map from region name to CALLS, ELEMENTS, TIME (s) and the
+ * available counters CYCLES, INSTRUCTIONS, CACHE_MISSES, L1D_MISSES,
+ * DTLB_MISSES, BRANCH_MISSES, each also divided by the number of elements
+ * (key suffix _PER_ELEMENT), and IPC
+ */
+void PerfCountersReport(map<string, map<string, double>> &report);
+
+/** Print the accumulated counters per element as a table. */
+void PerfCountersPrint();
+
+/**
+ * Scoped profiling region, counters are read on construction and accumulated
+ * under the region name on destruction. With tracing enabled (Trace.hpp) the
+ * region is also recorded as a timeline span. Does nothing when both are
+ * disabled.
+ */
+class PerfRegion {
+public:
+  /**
+   * @param name region name (string literal)
+   * @param elements number of lattice elements handled by the region
+   * @param category trace category (string literal)
+   */
+  PerfRegion(const char *name, long elements, const char *category = "ibs");
+  ~PerfRegion();
+
+  /** Set the number of elements when only known at the end of the region. */
+  void SetElements(long n) { elements = n; }
+
+  PerfRegion(const PerfRegion &) = delete;
+  PerfRegion &operator=(const PerfRegion &) = delete;
+
+private:
+  const char *name;
+  const char *category;
+  long elements;
+  bool counting;
+  bool tracing;
+  double start_time;
+  uint64_t start[PERF_NCOUNTERS];
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef RANGE_QUERIES_HPP
+#define RANGE_QUERIES_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Cumulative IBS growth rate contributions and radiation integrals along the
+ * lattice for a fixed beam state. Entry i of the prefix sums holds the sum over
+ * the elements 0 .. i - 1.
+ */
+struct IBSPrefixSums {
+  /** IBS model (1-13) */
+  int model;
+  /** ring circumference */
+  double circumference;
+  /** element exit positions (S column or cumulative lengths) */
+  vector<double> s;
+  /** element lengths */
+  vector<double> length;
+  /** 3 * (n + 1) growth rate sums (longitudinal, horizontal, vertical) */
+  vector<double> rates;
+  /** 7 * (n + 1) radiation integral sums (I1, I2, I3, I4x, I4y, I5x, I5y) */
+  vector<double> radiation;
+};
+
+/**
+ * Evaluate the element contributions of the selected model once and store
+ * their prefix sums over s, together with the prefix sums of the radiation
+ * integral columns added by updateTwiss (zero if these are missing).
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] prefix prefix sums
+ *
+ * @see IBSElementRates
+ */
+void BuildIBSPrefixSums(int model, double pnumber, double ex, double ey,
+                        double sigs, double dponp,
+                        map<string, double> &twissheader,
+                        map<string, vector<double>> &twissdata, double r0,
+                        double aatom, IBSPrefixSums &prefix);
+
+/**
+ * Contributions of the elements first .. last - 1 in O(1). A range with
+ * last < first wraps around the end of the lattice.
+ *
+ * @param prefix prefix sums
+ * @param first first element index
+ * @param last element index after the range
+ * @param[out] rates IBS amplitude growth rate contributions (longitudinal,
+ * horizontal, vertical)
+ * @param[out] radiation radiation integral contributions (I1, I2, I3, I4x, I4y,
+ * I5x, I5y)
+ */
+void IBSRangeByIndex(const IBSPrefixSums &prefix, int first, int last,
+                     double *rates, double *radiation);
+
+/**
+ * Contributions of the lattice section s0 <= s < s1. Elements cut by the range
+ * boundaries contribute with the fraction of their length inside the range,
+ * zero length elements at s0 are included. A range with s1 < s0 wraps around
+ * the end of the ring. The cost is one binary search per boundary.
+ *
+ * @param prefix prefix sums
+ * @param s0 start of the section
+ * @param s1 end of the section
+ * @param[out] rates IBS amplitude growth rate contributions (longitudinal,
+ * horizontal, vertical)
+ * @param[out] radiation radiation integral contributions (I1, I2, I3, I4x, I4y,
+ * I5x, I5y)
+ */
+void IBSRangeByS(const IBSPrefixSums &prefix, double s0, double s1,
+                 double *rates, double *radiation);
+
+#endif
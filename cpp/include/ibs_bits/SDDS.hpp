@@ -0,0 +1,91 @@
+#ifndef SDDS_HPP
+#define SDDS_HPP
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+ * First page of an SDDS file. Numeric parameters and columns of any integer or
+ * floating point type are stored as double.
+ */
+struct SDDSPage {
+  /** numeric parameters */
+  map<string, double> parameters;
+  /** string and character parameters */
+  map<string, string> stringparameters;
+  /** numeric columns */
+  map<string, vector<double>> columns;
+  /** string and character columns */
+  map<string, vector<string>> stringcolumns;
+};
+
+/**
+ * Parse the first page of an SDDS file held in memory. Binary (little or big
+ * endian, row or column major) and ASCII data modes are supported. Binary
+ * columns are copied from the buffer without text conversion, column major
+ * double columns of native byte order with a single copy.
+ *
+ * @param buffer content of the SDDS file
+ * @param[out] page parameters and columns of the first page
+ *
+ * @return true on success, false for malformed files and files with arrays or
+ * include statements
+ */
+bool ParseSDDS(string_view buffer, SDDSPage &page);
+
+/**
+ * Read an SDDS file with one read of the file and ParseSDDS.
+ *
+ * @param filename Path to the SDDS file.
+ * @param[out] page parameters and columns of the first page
+ *
+ * @return true on success
+ */
+bool ReadSDDS(string filename, SDDSPage &page);
+
+/**
+ * Map an elegant twiss_output page onto the Twiss header and table of the TFS
+ * loaders.
+ *
+ * The table gets S, L (from the s differences), BETX, ALFX, BETY, ALFY, DX,
+ * DPX, DY and DPY from s, betax, alphax, betay, alphay, etax, etaxp, etay and
+ * etayp. ANGLE, K1L, K1SL, K2L, K2SL, E1 and E2 are taken from the element
+ * parameters if given, else they are zero.
+ *
+ * The header keeps all numeric parameters under their elegant names and adds
+ * GAMMA, PC, ENERGY and MASS (from pCentral, elegant tracks electrons),
+ * CHARGE (from a CHARGE parameter, -1 if the file has none), LENGTH, Q1, Q2,
+ * DQ1, DQ2, ALFA, GAMMATR and SYNCH_1 to SYNCH_5 (from I1 to I5).
+ *
+ * @param twiss twiss_output page
+ * @param parameters page of the elegant parameters output (run_setup
+ * parameters), joined on ElementName and ElementOccurence, NULL if not
+ * available
+ * @param[out] header map of twiss header parameters and their values
+ * @param[out] table map of column names to column values
+ *
+ * @return true if all optics columns were found
+ */
+bool ElegantTwissToMaps(SDDSPage &twiss, SDDSPage *parameters,
+                        map<string, double> &header,
+                        map<string, vector<double>> &table);
+
+/**
+ * Read an elegant twiss_output file and optionally its parameters output and
+ * map them with ElegantTwissToMaps.
+ *
+ * @param filename Path to the twiss_output file.
+ * @param[out] header map of twiss header parameters and their values
+ * @param[out] table map of column names to column values
+ * @param parameterfile Path to the parameters output, empty if not available
+ *
+ * @return true on success
+ */
+bool ReadElegantTwiss(string filename, map<string, double> &header,
+                      map<string, vector<double>> &table,
+                      string parameterfile = "");
+
+#endif
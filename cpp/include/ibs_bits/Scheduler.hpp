@@ -0,0 +1,139 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+#include "OrdDiffEq.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Growth rate request of a suspended ODEStepper, the beam state at which the
+ * rates of the model are needed to continue.
+ */
+struct ODERateRequest {
+  /** Twiss Header Map of the run */
+  map<string, double> *twiss;
+  /** Twiss Table Map of the run */
+  map<string, vector<double>> *twissdata;
+  /** IBS model (1-13) */
+  int model;
+  /** classical particle radius */
+  double r0;
+  /** atomic mass number */
+  double aatom;
+  /** number of particles per bunch */
+  double pnumber;
+  /** horizontal emittance */
+  double ex;
+  /** vertical emittance */
+  double ey;
+  /** bunch length */
+  double sigs;
+  /** energy spread */
+  double sige;
+};
+
+/**
+ * ODE run with the auto time step as a resumable state machine.
+ *
+ * The stepper suspends whenever it needs the growth rates of the model,
+ * Request() holds the beam state and Resume() continues the run with the
+ * rates until the next request or the end of the run. The equations, time
+ * step and stop criterion are those of ODE with the auto time step, the rates
+ * of the initial state are used for the first step instead of being
+ * recalculated. Growth rates can come from any source, ODESchedule serves the
+ * requests of many steppers with batched lattice passes.
+ */
+class ODEStepper {
+public:
+  /**
+   * Prepare the run, the first request is the initial state.
+   *
+   * @param twiss Twiss Header Map, referenced by the requests
+   * @param twissdata Twiss Table Map, referenced by the requests
+   * @param nrf number of rf systems
+   * @param harmon list of harmonic numbers for the rf systems
+   * @param voltages list of voltages for the rf systems
+   * @param ex0 initial horizontal emittance
+   * @param ey0 initial vertical emittance
+   * @param sigs0 initial bunch length
+   * @param model IBS model (1-13)
+   * @param pnumber number of particles per bunch
+   * @param couplingpercentage hor/ver coupling in percentage
+   * @param threshold evolution stop threshold
+   * @param method simulation method (rlx or der)
+   * @param t0 initial time
+   */
+  ODEStepper(map<string, double> &twiss,
+             map<string, vector<double>> &twissdata, int nrf, double harmon[],
+             double voltages[], double ex0, double ey0, double sigs0,
+             int model, double pnumber, int couplingpercentage,
+             double threshold, string method, double t0 = 0.0);
+
+  /** true when the run is finished, there is no request then */
+  bool Done() const { return phase == DONE; }
+
+  /** pending growth rate request */
+  const ODERateRequest &Request() const { return request; }
+
+  /**
+   * Continue the run with the growth rates of the pending request.
+   *
+   * @param rates IBS amplitude growth rates (longitudinal, horizontal,
+   * vertical) at the requested state
+   */
+  void Resume(const double *rates);
+
+  /** timesteps */
+  vector<double> t;
+  /** horizontal emittance */
+  vector<double> ex;
+  /** vertical emittance */
+  vector<double> ey;
+  /** bunch length */
+  vector<double> sigs;
+  /** energy spread */
+  vector<double> sige;
+
+private:
+  enum Phase { INITIAL, STEPPING, DONE };
+
+  void Step(const double *rates);
+
+  Phase phase;
+  ODERateRequest request;
+  string method;
+  double threshold;
+  ODERing ring;
+  int maxsteps;
+  double ibs[3];
+};
+
+/** Statistics of ODESchedule. */
+struct ODEScheduleStats {
+  /** number of batched lattice passes */
+  long passes;
+  /** number of served growth rate requests */
+  long requests;
+  /** largest number of requests served by one pass */
+  int maxbatch;
+};
+
+/**
+ * Run ODE steppers to completion with batched growth rate evaluations.
+ *
+ * In every round the pending requests of all unfinished steppers are grouped
+ * by lattice (Twiss header and table objects), model, particle radius and
+ * atomic mass number. Every group is served by one IBSRatesBatch pass and its
+ * steppers are resumed. Runs of different length simply drop out of the
+ * rounds when they finish.
+ *
+ * @param steppers runs to complete, the trajectories are in the steppers
+ * @param maxbatch maximum number of requests per pass, 0 for no limit
+ *
+ * @return number of passes and requests
+ */
+ODEScheduleStats ODESchedule(vector<ODEStepper> &steppers, int maxbatch = 0);
+
+#endif
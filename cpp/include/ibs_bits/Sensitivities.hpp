@@ -0,0 +1,47 @@
+#ifndef SENSITIVITIES_HPP
+#define SENSITIVITIES_HPP
+#include "Models.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * IBS growth rates of the selected model together with their derivatives with
+ * respect to the optics functions of every element (BETX, ALFX, BETY, ALFY,
+ * DX, DPX, DY, DPY).
+ *
+ * All lattice models are sums of independent element contributions, the
+ * derivative with respect to the optics of element i therefore only involves
+ * the contribution of element i. These are obtained with central differences of
+ * the element kernels, the total cost is 17 element evaluations per element,
+ * independent of the lattice size.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map (restored on return)
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] rates IBS amplitude growth rates (longitudinal, horizontal,
+ * vertical)
+ * @param[out] gradients map from column name to the derivatives of the rates,
+ * the entry 3 * i + k is the derivative of rate k with respect to the column
+ * value of element i
+ *
+ * @note The smooth approximation (model 1) does not depend on the element
+ * optics, all its derivatives are zero.
+ */
+void IBSRatesSensitivities(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double *rates,
+                           map<string, vector<double>> &gradients);
+
+#endif
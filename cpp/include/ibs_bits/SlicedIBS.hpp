@@ -0,0 +1,65 @@
+#ifndef SLICED_IBS_HPP
+#define SLICED_IBS_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Local IBS growth rates of the longitudinal slices of a bunch.
+ */
+struct SliceRates {
+  /** rms bunch length of the profile */
+  double sigs;
+  /** slice centres */
+  vector<double> z;
+  /** fraction of the particles in each slice */
+  vector<double> weight;
+  /** line density of each slice (particles per m) */
+  vector<double> density;
+  /** 3 * K local growth rates (longitudinal, horizontal, vertical) */
+  vector<double> rates;
+};
+
+/**
+ * IBS growth rates of a bunch with an arbitrary longitudinal line-density
+ * profile. The profile is cut into K slices of equal length, each slice is
+ * evaluated with the selected model at the population of a Gaussian bunch of
+ * the profile's rms length with the same mean density as the slice. The bunch
+ * averaged rates are the particle weighted mean of the slice rates, which
+ * reproduces the Gaussian rates for a Gaussian profile.
+ *
+ * The slices share the emittances and the energy spread, so the element
+ * contributions only differ by the population and the Coulomb log. The
+ * lattice is therefore evaluated once, the slice rates follow from the N
+ * scaling of the prefactor and the ratio of the ring averaged Coulomb logs of
+ * the model (see ModelCoulombLog, N only for the Piwinski models).
+ *
+ * @param model IBS model (1-13)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param z longitudinal positions of the profile samples (strictly
+ * increasing)
+ * @param profile line density at the samples (any normalization, linearly
+ * interpolated)
+ * @param nslices number of slices K
+ * @param[out] slices slice positions, weights, densities and local rates
+ *
+ * @return double[3] bunch averaged growth rates (longitudinal, horizontal,
+ * vertical), zero for an invalid profile or unsorted positions
+ */
+double *SlicedIBSRates(int model, double pnumber, double ex, double ey,
+                       double dponp, map<string, double> &twissheader,
+                       map<string, vector<double>> &twissdata, double r0,
+                       double aatom, const vector<double> &z,
+                       const vector<double> &profile, int nslices,
+                       SliceRates &slices);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SPACE_CHARGE_HPP
+#define SPACE_CHARGE_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Maximum incoherent (Laslett) space-charge tune shifts of a Gaussian bunch
+ *
+ *   dQx = - N r0 / ((2 pi)^(3/2) beta^2 gamma^3 sigs)
+ *         * sum_i L_i betx_i / (sigx_i (sigx_i + sigy_i))
+ *
+ * with the element beam sizes sigx = sqrt(betx ex + (dx dponp)^2), sigy
+ * likewise.
+ *
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp relative momentum spread
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ *
+ * @return pointer to thread local array (dQx, dQy)
+ */
+double *LaslettTuneShift(double pnumber, double ex, double ey, double sigs,
+                         double dponp, map<string, double> &twissheader,
+                         map<string, vector<double>> &twissdata, double r0);
+
+/**
+ * IBS growth rates of the selected model and the Laslett tune shifts in a
+ * single pass over the lattice. The rates are the sums of IBSElementRates and
+ * agree with IBSRates to rounding.
+ *
+ * @param model IBS model (1-13, same numbering as in ODE)
+ * @param pnumber number of real particles in the bunch
+ * @param ex horizontal emittance
+ * @param ey vertical emittance
+ * @param sigs bunch length
+ * @param dponp energy spread, same convention as the selected model
+ * @param twissheader Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param r0 Classical particle radius
+ * @param aatom Atomic Mass Number (only used by the tailcut models)
+ * @param[out] rates IBS amplitude growth rates (longitudinal, horizontal,
+ * vertical)
+ * @param[out] tuneshift Laslett tune shifts (dQx, dQy)
+ *
+ * @see LaslettTuneShift
+ */
+void IBSRatesWithTuneShift(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double *rates, double *tuneshift);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include <stddef.h>
+#include <string>
+
+using namespace std;
+
+/**
+ * Start recording timeline spans. Every PerfRegion (lattice load,
+ * updateTwiss, RF setup, model evaluations, integrator calls, file writes, ODE
+ * runs and scan tasks) records a span with its thread. The spans are kept in a
+ * ring buffer, once it is full the oldest spans are overwritten.
+ *
+ * @param capacity maximum number of spans kept
+ *
+ * @note When tracing is disabled a region only costs the check of the flag.
+ */
+void TraceEnable(size_t capacity = 1 << 20);
+
+/** Stop recording spans, the recorded spans are kept. */
+void TraceDisable();
+
+/**
+ * Tracing state.
+ *
+ * @return true if spans are recorded
+ */
+bool TraceEnabled();
+
+/** Remove all recorded spans. */
+void TraceClear();
+
+/**
+ * Number of spans in the buffer.
+ *
+ * @return number of spans
+ */
+size_t TraceSize();
+
+/**
+ * Number of spans overwritten because the buffer was full.
+ *
+ * @return number of lost spans
+ */
+size_t TraceDropped();
+
+/**
+ * Record a span, used by PerfRegion.
+ *
+ * @param name span name (string literal)
+ * @param category span category (string literal)
+ * @param start start time (s, steady clock)
+ * @param stop stop time (s, steady clock)
+ * @param elements number of elements, stored as argument of the span
+ */
+void TraceRecord(const char *name, const char *category, double start,
+                 double stop, long elements);
+
+/**
+ * Write the recorded spans in Chrome trace event JSON format (viewable in
+ * Perfetto or chrome://tracing).
+ *
+ * @param filename output file
+ *
+ * @return true on success
+ */
+bool TraceWrite(string filename);
+
+#endif
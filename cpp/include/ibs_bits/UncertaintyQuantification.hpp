@@ -0,0 +1,98 @@
+#ifndef UNCERTAINTY_QUANTIFICATION_HPP
+#define UNCERTAINTY_QUANTIFICATION_HPP
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** Index of the uncertain parameters. */
+enum UQParameterIndex {
+  UQ_PNUMBER = 0,
+  UQ_COUPLING = 1,
+  UQ_VOLTAGE = 2,
+  UQ_EX = 3,
+  UQ_EY = 4,
+  UQ_SIGS = 5,
+  UQ_NPARAMETERS = 6
+};
+
+/** Type of the parameter distributions. */
+enum UQDistributionType { UQ_FIXED = 0, UQ_UNIFORM = 1, UQ_NORMAL = 2 };
+
+/**
+ * Distribution of an uncertain parameter.
+ *
+ * - UQ_FIXED : value a
+ * - UQ_UNIFORM : uniform between a and b
+ * - UQ_NORMAL : normal with mean a and standard deviation b
+ */
+struct UQDistribution {
+  int type;
+  double a;
+  double b;
+};
+
+/**
+ * Point of a scrambled Sobol sequence (Joe-Kuo direction numbers, random
+ * digital shift).
+ *
+ * @param index index of the point in the sequence
+ * @param dim number of dimensions (1-12)
+ * @param shift digital shift per dimension
+ * @param[out] out point in the unit hypercube
+ */
+void SobolPoint(unsigned int index, int dim, unsigned int *shift,
+                double *out);
+
+/**
+ * Propagate the uncertainty of the bunch population, coupling, RF voltage and
+ * initial beam parameters through an IBS model.
+ *
+ * The parameter space is sampled with a scrambled Sobol sequence or Latin
+ * hypercube. Samples are evaluated in parallel batches on the shared
+ * lattice and the outputs are fed to streaming estimators in sample order, the
+ * results only depend on the seed and not on the number of threads. Samples are
+ * not stored.
+ *
+ * In mode "rates" the output are the IBS growth rates (longitudinal,
+ * horizontal, vertical) at the sampled beam parameters, with the energy spread
+ * derived from the bunch length and the sampled RF voltage. In mode
+ * "equilibrium" the output are the final emittances and bunch length (ex, ey,
+ * sigs) of the ODE.
+ *
+ * @param twiss Twiss Header Map
+ * @param twissdata Twiss Table Map
+ * @param nrf number of rf systems
+ * @param harmon list of harmonic numbers for the rf systems
+ * @param voltages list of voltages for the rf systems, scaled by the sampled
+ * voltage factor
+ * @param model IBS model (1-13)
+ * @param distributions UQ_NPARAMETERS parameter distributions (pnumber,
+ * coupling in percent, voltage scale factor, ex, ey, sigs)
+ * @param nsamples number of samples
+ * @param sampling "sobol" or "lhs"
+ * @param mode "rates" or "equilibrium"
+ * @param threshold ODE stop threshold (mode "equilibrium")
+ * @param sensitivities calculate Sobol sensitivity indices
+ * @param quantiles probabilities of the quantiles to estimate
+ * @param seed seed of the scrambling and of the Latin hypercube
+ * @param[out] results MEAN and VARIANCE (3 outputs), QUANTILES (per output
+ * all quantiles), S1 and ST (first order and total Sobol indices, per output
+ * all UQ_NPARAMETERS parameters), NEVALUATIONS
+ *
+ * @note With sensitivities the Saltelli scheme is used and every sample costs
+ * k + 2 evaluations for k uncertain parameters. Mean, variance and quantiles
+ * then use the 2 nsamples base evaluations. The coupling is rounded to an
+ * integer percentage as used by the ODE.
+ */
+void UncertaintyQuantification(map<string, double> &twiss,
+                               map<string, vector<double>> &twissdata, int nrf,
+                               double harmon[], double voltages[], int model,
+                               UQDistribution *distributions, int nsamples,
+                               string sampling, string mode, double threshold,
+                               bool sensitivities, vector<double> &quantiles,
+                               unsigned long seed,
+                               map<string, vector<double>> &results);
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef VIEWS_HPP
+#define VIEWS_HPP
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Non-owning view of a contiguous sequence, the C++17 counterpart of
+ * std::span. Views of const elements are created from const vectors and from
+ * views of mutable elements.
+ */
+template <typename T> class Span {
+public:
+  Span() : ptr(NULL), n(0) {}
+  Span(T *data, size_t size) : ptr(data), n(size) {}
+  template <size_t N> Span(T (&array)[N]) : ptr(array), n(N) {}
+  Span(vector<remove_const_t<T>> &v) : ptr(v.data()), n(v.size()) {}
+  template <typename U = T, enable_if_t<is_const<U>::value, int> = 0>
+  Span(const vector<remove_const_t<T>> &v) : ptr(v.data()), n(v.size()) {}
+  template <typename U, enable_if_t<is_same<const U, T>::value, int> = 0>
+  Span(const Span<U> &other) : ptr(other.data()), n(other.size()) {}
+
+  T *data() const { return ptr; }
+  size_t size() const { return n; }
+  bool empty() const { return n == 0; }
+  T &operator[](size_t i) const { return ptr[i]; }
+  T *begin() const { return ptr; }
+  T *end() const { return ptr + n; }
+
+  /** view of count elements starting at offset */
+  Span subspan(size_t offset, size_t count) const {
+    return Span(ptr + offset, count);
+  }
+
+private:
+  T *ptr;
+  size_t n;
+};
+
+/**
+ * Non-owning two-dimensional view with strides in elements, the C++17
+ * counterpart of a std::mdspan with strided layout. The default strides are
+ * row-major, a column stride other than one views e.g. one vector per column.
+ */
+template <typename T> class MatrixView {
+public:
+  MatrixView() : ptr(NULL), nrows(0), ncols(0), rs(0), cs(0) {}
+  MatrixView(T *data, size_t rows, size_t cols)
+      : ptr(data), nrows(rows), ncols(cols), rs(cols), cs(1) {}
+  MatrixView(T *data, size_t rows, size_t cols, ptrdiff_t rowstride,
+             ptrdiff_t colstride)
+      : ptr(data), nrows(rows), ncols(cols), rs(rowstride), cs(colstride) {}
+
+  T *data() const { return ptr; }
+  size_t rows() const { return nrows; }
+  size_t cols() const { return ncols; }
+  ptrdiff_t rowstride() const { return rs; }
+  ptrdiff_t colstride() const { return cs; }
+  T &operator()(size_t i, size_t j) const { return ptr[i * rs + j * cs]; }
+
+private:
+  T *ptr;
+  size_t nrows, ncols;
+  ptrdiff_t rs, cs;
+};
+
+/** Beam state at which growth rates are evaluated. */
+struct BeamState {
+  /** number of real particles in the bunch */
+  double pnumber;
+  /** horizontal emittance */
+  double ex;
+  /** vertical emittance */
+  double ey;
+  /** bunch length */
+  double sigs;
+  /** energy spread, same convention as the selected model */
+  double dponp;
+};
+
+/** Views of the columns of many beam states, all of the same size. */
+struct BeamStates {
+  /** numbers of real particles in the bunch */
+  Span<const double> pnumber;
+  /** horizontal emittances */
+  Span<const double> ex;
+  /** vertical emittances */
+  Span<const double> ey;
+  /** bunch lengths */
+  Span<const double> sigs;
+  /** energy spreads, same convention as the selected model */
+  Span<const double> dponp;
+
+  /** number of states, 0 if the columns differ in size */
+  size_t size() const {
+    size_t n = pnumber.size();
+    if (ex.size() != n || ey.size() != n || sigs.size() != n ||
+        dponp.size() != n) {
+      return 0;
+    }
+    return n;
+  }
+};
+
+#endif
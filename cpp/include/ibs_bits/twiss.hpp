@@ -8,6 +8,7 @@
 #include <sstream>
 #include <stdio.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -48,9 +49,51 @@ vector<vector<double>> GetTable(string filename, vector<string> columns);
  *
  * @note Twiss file needs to be produced with Madx.
  * @warning Pre-selection of columns is taken : {"L",    "BETX", "ALFX",
- "BETY","ALFY", "DX",   "DPX",  "DY", "DPY", "K1L", "K1SL", "ANGLE"}
+ "BETY","ALFY", "DX",   "DPX",  "DY", "DPY", "K1L", "K1SL", "ANGLE", "K2L",
+ "K2SL", "E1", "E2"}
  *
  */
 map<string, vector<double>> GetTwissTableAsMap(string filename);
 
+/**
+ * Parse a MADX TFS Twiss output held in memory, header and table in one pass.
+ *
+ * Lines starting with @ are header entries (only numeric ones are kept), * the
+ * column names, $ the column formats and all other lines table rows. The table
+ * has the same column pre-selection as GetTwissTableAsMap.
+ *
+ * @param buffer content of the Twiss file
+ * @param[out] header map of twiss header parameters and their values
+ * @param[out] table map of column names to column values
+ *
+ * @return true if a column line was found and all rows could be parsed
+ */
+bool ParseTwiss(string_view buffer, map<string, double> &header,
+                map<string, vector<double>> &table);
+
+/**
+ * Read a Twiss file with one read of the file and ParseTwiss.
+ *
+ * @param filename Path to the Twiss file.
+ * @param[out] header map of twiss header parameters and their values
+ * @param[out] table map of column names to column values
+ *
+ * @return true on success
+ */
+bool ReadTwiss(string filename, map<string, double> &header,
+               map<string, vector<double>> &table);
+
+/**
+ * Read a Twiss output from a file descriptor (e.g. a pipe from MADX) until end
+ * of file and parse it with ParseTwiss.
+ *
+ * @param fd open file descriptor, not closed
+ * @param[out] header map of twiss header parameters and their values
+ * @param[out] table map of column names to column values
+ *
+ * @return true on success
+ */
+bool ReadTwissFromDescriptor(int fd, map<string, double> &header,
+                             map<string, vector<double>> &table);
+
 #endif
\ No newline at end of file
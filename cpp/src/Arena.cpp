@@ -0,0 +1,78 @@
+#include "../include/ibs_bits/Arena.hpp"
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+// offset of the first aligned address at or after data + offset
+static inline size_t AlignedOffset(const char *data, size_t offset,
+                                   size_t align) {
+  uintptr_t base = (uintptr_t)data;
+  return ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+}
+
+ScratchArena::ScratchArena(size_t blocksize)
+    : block(0), offset(0), blocksize(max(blocksize, (size_t)1024)) {}
+
+ScratchArena::~ScratchArena() {
+  for (size_t k = 0; k < blocks.size(); k++) {
+    ::operator delete(blocks[k].data);
+  }
+}
+
+/*
+================================================================================
+  BUMP ALLOCATION IN THE CURRENT BLOCK, MOVING ON TO THE NEXT BLOCK (KEPT FROM
+  EARLIER TASKS OR NEWLY REQUESTED FROM THE HEAP) IF THE REQUEST DOES NOT FIT.
+================================================================================
+*/
+void *ScratchArena::Allocate(size_t bytes, size_t align) {
+  while (block < blocks.size()) {
+    size_t start = AlignedOffset(blocks[block].data, offset, align);
+    if (start + bytes <= blocks[block].size) {
+      offset = start + bytes;
+      return blocks[block].data + start;
+    }
+    block++;
+    offset = 0;
+  }
+
+  // blocks from operator new are aligned for any fundamental type
+  Block b;
+  b.size = max(blocksize, bytes + align);
+  b.data = static_cast<char *>(::operator new(b.size));
+  blocks.push_back(b);
+  block = blocks.size() - 1;
+
+  size_t start = AlignedOffset(b.data, 0, align);
+  offset = start + bytes;
+  return b.data + start;
+}
+
+void ScratchArena::Release(const ArenaMark &mark) {
+  block = mark.block;
+  offset = mark.offset;
+}
+
+size_t ScratchArena::Used() const {
+  size_t used = 0;
+  for (size_t k = 0; k < block && k < blocks.size(); k++) {
+    used += blocks[k].size;
+  }
+  return used + offset;
+}
+
+size_t ScratchArena::Capacity() const {
+  size_t capacity = 0;
+  for (size_t k = 0; k < blocks.size(); k++) {
+    capacity += blocks[k].size;
+  }
+  return capacity;
+}
+
+ScratchArena &ThreadArena() {
+  static thread_local ScratchArena arena;
+  return arena;
+}
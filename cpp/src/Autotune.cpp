@@ -0,0 +1,327 @@
+#include "../include/ibs_bits/Autotune.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static atomic<bool> autotune_enabled(false);
+static mutex autotune_mutex;
+static string autotune_file;
+
+// minimum measuring time and number of calls per configuration
+static const double autotune_min_time = 0.05;
+static const int autotune_min_calls = 3;
+
+static string HostName() {
+  char name[256] = "unknown";
+#ifdef __linux__
+  if (gethostname(name, sizeof(name)) != 0) {
+    strcpy(name, "unknown");
+  }
+  name[sizeof(name) - 1] = '\0';
+#endif
+  return string(name);
+}
+
+static int MaxThreads() {
+#ifdef _OPENMP
+  return omp_get_num_procs();
+#else
+  return 1;
+#endif
+}
+
+// thread count of the next parallel region of the calling thread
+static int CurrentThreads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+static bool InParallel() {
+#ifdef _OPENMP
+  return omp_in_parallel();
+#else
+  return false;
+#endif
+}
+
+/*
+================================================================================
+  FNV-1A HASH OF THE LATTICE SIZE AND THE BYTES OF THE OPTICS COLUMNS
+================================================================================
+*/
+uint64_t LatticeSignature(map<string, vector<double>> &twissdata) {
+  const char *columns[5] = {"L", "BETX", "BETY", "DX", "DY"};
+  uint64_t hash = 14695981039346656037ULL;
+
+  auto update = [&hash](const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t k = 0; k < size; k++) {
+      hash ^= bytes[k];
+      hash *= 1099511628211ULL;
+    }
+  };
+
+  uint64_t n = twissdata["L"].size();
+  update(&n, sizeof(n));
+  for (int c = 0; c < 5; c++) {
+    if (twissdata.count(columns[c]) == 0) {
+      continue;
+    }
+    vector<double> &col = twissdata[columns[c]];
+    update(col.data(), col.size() * sizeof(double));
+  }
+  return hash;
+}
+
+void AutotuneEnable(bool enable) { autotune_enabled = enable; }
+
+bool AutotuneEnabled() { return autotune_enabled; }
+
+void AutotuneSetCacheFile(string filename) {
+  lock_guard<mutex> lock(autotune_mutex);
+  autotune_file = filename;
+}
+
+string AutotuneCacheFile() {
+  lock_guard<mutex> lock(autotune_mutex);
+  if (!autotune_file.empty()) {
+    return autotune_file;
+  }
+  const char *env = getenv("IBS_AUTOTUNE_CACHE");
+  if (env != NULL && env[0] != '\0') {
+    return string(env);
+  }
+  const char *home = getenv("HOME");
+  return string(home != NULL ? home : ".") + "/.ibslib_autotune";
+}
+
+/*
+================================================================================
+  CACHE FILE
+
+  ONE ENTRY PER LINE : host signature(hex) model threads seconds
+  LATER ENTRIES OVERRIDE EARLIER ONES FOR THE SAME HOST, LATTICE AND MODEL.
+================================================================================
+*/
+static bool ReadCacheEntry(const string &filename, const string &host,
+                           uint64_t signature, int model,
+                           AutotuneConfig &config) {
+  ifstream file(filename);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  bool found = false;
+  string line;
+  while (getline(file, line)) {
+    istringstream iss(line);
+    string h, sig;
+    int m, threads;
+    double seconds;
+    if (!(iss >> h >> sig >> m >> threads >> seconds)) {
+      continue;
+    }
+    if (h == host && m == model &&
+        strtoull(sig.c_str(), NULL, 16) == signature && threads > 0) {
+      config.threads = threads;
+      config.seconds = seconds;
+      found = true;
+    }
+  }
+  return found;
+}
+
+static void WriteCacheEntry(const string &filename, const string &host,
+                            uint64_t signature, int model,
+                            const AutotuneConfig &config) {
+  FILE *file = fopen(filename.c_str(), "a");
+  if (file == NULL) {
+    return;
+  }
+  fprintf(file, "%s %016llx %d %d %.6e\n", host.c_str(),
+          (unsigned long long)signature, model, config.threads,
+          config.seconds);
+  fclose(file);
+}
+
+bool AutotuneLookup(int model, map<string, vector<double>> &twissdata,
+                    AutotuneConfig &config) {
+  string filename = AutotuneCacheFile();
+  uint64_t signature = LatticeSignature(twissdata);
+  lock_guard<mutex> lock(autotune_mutex);
+  return ReadCacheEntry(filename, HostName(), signature, model, config);
+}
+
+void AutotuneApply(const AutotuneConfig &config) {
+#ifdef _OPENMP
+  omp_set_num_threads(max(1, min(config.threads, MaxThreads())));
+#endif
+}
+
+// wall time of one IBSRates call with the given number of threads
+static double TimeConfiguration(int threads, int model, double pnumber,
+                                double ex, double ey, double sigs,
+                                double dponp,
+                                map<string, double> &twissheader,
+                                map<string, vector<double>> &twissdata,
+                                double r0, double aatom) {
+  AutotuneConfig config = {threads, 0.0};
+  AutotuneApply(config);
+
+  // warm up caches and the thread pool
+  IBSRates(model, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+           aatom);
+
+  double best = 1e300, total = 0.0;
+  int calls = 0;
+  while (calls < autotune_min_calls || total < autotune_min_time) {
+    auto start = chrono::steady_clock::now();
+    IBSRates(model, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+             aatom);
+    double dt =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    best = min(best, dt);
+    total += dt;
+    calls++;
+  }
+  return best;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO SELECT AND APPLY THE FASTEST EXECUTION CONFIGURATION OF A MODEL ON A
+LATTICE, CACHED ON DISK PER HOST, LATTICE SIGNATURE AND MODEL.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - bool force
+        measure even if the configuration is cached
+
+  Returns:
+  --------
+    AutotuneConfig
+      applied configuration
+
+================================================================================
+================================================================================
+*/
+AutotuneConfig Autotune(int model, double pnumber, double ex, double ey,
+                        double sigs, double dponp,
+                        map<string, double> &twissheader,
+                        map<string, vector<double>> &twissdata, double r0,
+                        double aatom, bool force) {
+  PerfRegion perf("Autotune", twissdata["L"].size(), "autotune");
+
+  AutotuneConfig best = {1, 0.0};
+  string filename = AutotuneCacheFile();
+  string host = HostName();
+  uint64_t signature = LatticeSignature(twissdata);
+
+  {
+    lock_guard<mutex> lock(autotune_mutex);
+    if (!force && ReadCacheEntry(filename, host, signature, model, best)) {
+      AutotuneApply(best);
+      return best;
+    }
+  }
+
+  // timings inside a parallel region would not be meaningful
+  if (InParallel()) {
+    return best;
+  }
+
+  int nmax = MaxThreads();
+  vector<int> candidates;
+  for (int threads = 1; threads < nmax; threads *= 2) {
+    candidates.push_back(threads);
+  }
+  candidates.push_back(nmax);
+
+  best.seconds = 1e300;
+  for (size_t k = 0; k < candidates.size(); k++) {
+    double seconds =
+        TimeConfiguration(candidates[k], model, pnumber, ex, ey, sigs, dponp,
+                          twissheader, twissdata, r0, aatom);
+    if (seconds < best.seconds) {
+      best.threads = candidates[k];
+      best.seconds = seconds;
+    }
+  }
+
+  AutotuneApply(best);
+
+  lock_guard<mutex> lock(autotune_mutex);
+  WriteCacheEntry(filename, host, signature, model, best);
+  return best;
+}
+
+AutotuneScope::AutotuneScope(int model, double pnumber, double ex, double ey,
+                             double sigs, double dponp,
+                             map<string, double> &twissheader,
+                             map<string, vector<double>> &twissdata, double r0,
+                             double aatom)
+    : active(AutotuneEnabled()), threads(CurrentThreads()) {
+  if (active) {
+    Autotune(model, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+             aatom);
+  }
+}
+
+AutotuneScope::~AutotuneScope() {
+#ifdef _OPENMP
+  if (active) {
+    omp_set_num_threads(threads);
+  }
+#endif
+}
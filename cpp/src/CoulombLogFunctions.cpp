@@ -571,4 +571,63 @@ void TailCutCoulombLog(double pnumber, double ex, double ey,
 
   clog[0] = coulog;
   clog[1] = constt;
-}
\ No newline at end of file
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO SELECT THE RING AVERAGED COULOMB LOG OF AN IBS MODEL.
+
+  THE PIWINSKI MODELS HAVE NO COULOMB LOG, 1 IS RETURNED SUCH THAT RATIOS OF
+  THE LOG ONLY LEAVE THE SCALING WITH THE POPULATION.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - map<string, double> &twissheader
+        twiss header madx
+    - double sige
+        energy spread
+    - double sigt
+        bunch length
+    - double tauradx, taurady, taurads
+        radiation damping times, only used by the tailcut models
+    - double r0
+        classical particle radius
+
+  Returns:
+  --------
+    double
+      Coulomb log
+
+================================================================================
+================================================================================
+*/
+double ModelCoulombLog(int model, double pnumber, double ex, double ey,
+                       map<string, double> &twissheader, double sige,
+                       double sigt, double tauradx, double taurady,
+                       double taurads, double r0) {
+  if (model >= 1 && model <= 3) {
+    return 1.0;
+  }
+  double clog[2];
+  if (model == 5 || model == 7 || model == 10 || model == 12) {
+    TailCutCoulombLog(pnumber, ex, ey, twissheader, sige, sigt, tauradx,
+                      taurady, taurads, r0, false, clog);
+  } else {
+    CoulombLog(pnumber, ex, ey, twissheader, sige, sigt, r0, false, clog);
+  }
+  return clog[0];
+}
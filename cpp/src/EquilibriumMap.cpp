@@ -0,0 +1,481 @@
+#include "../include/ibs_bits/EquilibriumMap.hpp"
+#include "../include/ibs_bits/Arena.hpp"
+#include "../include/ibs_bits/OrdDiffEq.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char EQMAP_MAGIC[8] = {'I', 'B', 'S', 'E', 'Q', 'M', 'A', 'P'};
+static const int32_t EQMAP_VERSION = 1;
+
+// index of node (i, j, k)
+static inline size_t EqMapIndex(EquilibriumMap &emap, size_t i, size_t j,
+                                size_t k) {
+  return (i * emap.axes[1].size() + j) * emap.axes[2].size() + k;
+}
+
+static size_t EqMapSize(EquilibriumMap &emap) {
+  return emap.axes[0].size() * emap.axes[1].size() * emap.axes[2].size();
+}
+
+/*
+================================================================================
+  SECOND DERIVATIVES ALONG THE AXES FROM SECOND DIVIDED DIFFERENCES
+
+    f''(x_j) = 2 [ (f_j+1 - f_j) / h_j - (f_j - f_j-1) / h_j-1 ] / (h_j + h_j-1)
+
+  BOUNDARY NODES USE THE VALUE OF THEIR INTERIOR NEIGHBOUR, AXES WITH LESS THAN
+  THREE NODES HAVE ZERO CURVATURE.
+================================================================================
+*/
+static void EqMapCurvatures(EquilibriumMap &emap) {
+  size_t n[3] = {emap.axes[0].size(), emap.axes[1].size(),
+                 emap.axes[2].size()};
+  emap.curvatures.assign(9 * EqMapSize(emap), 0.0);
+
+  for (int d = 0; d < 3; d++) {
+    if (n[d] < 3) {
+      continue;
+    }
+    vector<double> &x = emap.axes[d];
+    size_t idx[3];
+    for (idx[0] = 0; idx[0] < n[0]; idx[0]++) {
+      for (idx[1] = 0; idx[1] < n[1]; idx[1]++) {
+        for (idx[2] = 0; idx[2] < n[2]; idx[2]++) {
+          size_t j = idx[d];
+          size_t jc = min(max(j, (size_t)1), n[d] - 2);
+          size_t node = EqMapIndex(emap, idx[0], idx[1], idx[2]);
+
+          size_t lidx[3] = {idx[0], idx[1], idx[2]};
+          lidx[d] = jc - 1;
+          size_t nl = EqMapIndex(emap, lidx[0], lidx[1], lidx[2]);
+          lidx[d] = jc;
+          size_t nc = EqMapIndex(emap, lidx[0], lidx[1], lidx[2]);
+          lidx[d] = jc + 1;
+          size_t nr = EqMapIndex(emap, lidx[0], lidx[1], lidx[2]);
+
+          double hl = x[jc] - x[jc - 1];
+          double hr = x[jc + 1] - x[jc];
+          for (int o = 0; o < 3; o++) {
+            double fl = emap.values[3 * nl + o];
+            double fc = emap.values[3 * nc + o];
+            double fr = emap.values[3 * nr + o];
+            emap.curvatures[9 * node + 3 * d + o] =
+                2.0 * ((fr - fc) / hr - (fc - fl) / hl) / (hl + hr);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+================================================================================
+  RELATIVE LINEAR INTERPOLATION ERROR |f''| h^2 / 8 / |f| OF EVERY INTERVAL
+  ALONG AXIS d, MAXIMUM OVER ALL GRID LINES AND OUTPUTS.
+================================================================================
+*/
+static vector<double> EqMapIntervalErrors(EquilibriumMap &emap, int d) {
+  size_t n[3] = {emap.axes[0].size(), emap.axes[1].size(),
+                 emap.axes[2].size()};
+  vector<double> &x = emap.axes[d];
+  vector<double> err(n[d] > 0 ? n[d] - 1 : 0, 0.0);
+
+  // no curvature information, bisect to obtain it
+  if (n[d] == 2) {
+    err[0] = HUGE_VAL;
+    return err;
+  }
+
+  size_t idx[3];
+  for (idx[0] = 0; idx[0] < n[0]; idx[0]++) {
+    for (idx[1] = 0; idx[1] < n[1]; idx[1]++) {
+      for (idx[2] = 0; idx[2] < n[2]; idx[2]++) {
+        if (idx[d] + 1 >= n[d]) {
+          continue;
+        }
+        size_t a = EqMapIndex(emap, idx[0], idx[1], idx[2]);
+        size_t ridx[3] = {idx[0], idx[1], idx[2]};
+        ridx[d]++;
+        size_t b = EqMapIndex(emap, ridx[0], ridx[1], ridx[2]);
+        double h = x[idx[d] + 1] - x[idx[d]];
+        for (int o = 0; o < 3; o++) {
+          double c = max(fabs(emap.curvatures[9 * a + 3 * d + o]),
+                         fabs(emap.curvatures[9 * b + 3 * d + o]));
+          double f = max(fabs(emap.values[3 * a + o]),
+                         fabs(emap.values[3 * b + o]));
+          if (f > 0.0) {
+            err[idx[d]] = max(err[idx[d]], c * h * h / 8.0 / f);
+          }
+        }
+      }
+    }
+  }
+  return err;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO PRECOMPUTE THE IBS EQUILIBRIUM ON AN ADAPTIVELY REFINED GRID IN
+(PNUMBER, COUPLING, RF VOLTAGE SCALE).
+
+  1. EQUIDISTANT INITIAL GRID
+  2. EQUILIBRIA OF ALL NEW NODES WITH ODE (PARALLEL)
+  3. INTERVAL ERRORS FROM SECOND DIFFERENCES, BISECT INTERVALS ABOVE TOLERANCE
+     (LARGEST ERRORS FIRST, AS LONG AS THE NODE BUDGET ALLOWS)
+  4. REPEAT 2-3 UNTIL NO INTERVAL IS REFINED
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers
+    - double voltages[]
+        rf voltages
+    - int model
+        IBS model (1-13)
+    - double ex0, ey0, sigs0
+        initial values of the ODE runs
+    - double *lower, *upper
+        axis bounds
+    - int *ninitial
+        initial number of nodes per axis
+    - double tolerance
+        relative interpolation tolerance
+    - int maxnodes
+        maximum number of nodes
+    - double threshold
+        ODE stop threshold
+    - EquilibriumMap &emap
+        output variable - equilibrium map
+
+  Returns:
+  --------
+    int
+      number of ODE runs
+
+================================================================================
+================================================================================
+*/
+int BuildEquilibriumMap(map<string, double> &twiss,
+                        map<string, vector<double>> &twissdata, int nrf,
+                        double harmon[], double voltages[], int model,
+                        double ex0, double ey0, double sigs0, double *lower,
+                        double *upper, int *ninitial, double tolerance,
+                        int maxnodes, double threshold, EquilibriumMap &emap) {
+  emap.model = model;
+  for (int d = 0; d < 3; d++) {
+    vector<double> &x = emap.axes[d];
+    x.clear();
+    int n = max(ninitial[d], 1);
+    if (n == 1 || upper[d] == lower[d]) {
+      x.push_back(lower[d]);
+    } else {
+      for (int j = 0; j < n; j++) {
+        x.push_back(lower[d] + (upper[d] - lower[d]) * j / (n - 1));
+      }
+    }
+    // the ODE only accepts integer coupling percentages
+    if (d == 1) {
+      for (double &c : x) {
+        c = round(c);
+      }
+    }
+    sort(x.begin(), x.end());
+    x.erase(unique(x.begin(), x.end()), x.end());
+  }
+
+  emap.values.assign(3 * EqMapSize(emap), 0.0);
+  vector<char> done(EqMapSize(emap), 0);
+  int nruns = 0;
+
+  while (true) {
+    // equilibria of the new nodes
+    vector<size_t> todo;
+    for (size_t node = 0; node < done.size(); node++) {
+      if (!done[node]) {
+        todo.push_back(node);
+      }
+    }
+
+    size_t n1 = emap.axes[1].size(), n2 = emap.axes[2].size();
+#pragma omp parallel for schedule(dynamic) shared(twiss, twissdata, emap)
+    for (int m = 0; m < (int)todo.size(); m++) {
+      size_t node = todo[m];
+      PerfRegion perf("EquilibriumMapNode", 1, "scan");
+      size_t i = node / (n1 * n2), j = (node / n2) % n1, k = node % n2;
+
+      // task temporaries from the thread's scratch memory
+      ArenaScope scope;
+      double *v = ThreadArena().Allocate<double>(nrf);
+      for (int r = 0; r < nrf; r++) {
+        v[r] = voltages[r] * emap.axes[2][k];
+      }
+      ODEScratch &run = ThreadODEScratch(ex0, ey0, sigs0);
+      ODE(twiss, twissdata, nrf, harmon, v, run.t, run.ex, run.ey, run.sigs,
+          run.sige, model, emap.axes[0][i], (int)emap.axes[1][j], threshold,
+          "der", false);
+      emap.values[3 * node] = run.ex.back();
+      emap.values[3 * node + 1] = run.ey.back();
+      emap.values[3 * node + 2] = run.sigs.back();
+    }
+    nruns += todo.size();
+    fill(done.begin(), done.end(), 1);
+
+    EqMapCurvatures(emap);
+
+    // candidate intervals, largest error first
+    vector<pair<double, pair<int, size_t>>> candidates;
+    for (int d = 0; d < 3; d++) {
+      vector<double> err = EqMapIntervalErrors(emap, d);
+      vector<double> &x = emap.axes[d];
+      for (size_t j = 0; j < err.size(); j++) {
+        double h = x[j + 1] - x[j];
+        bool splittable = (d == 1) ? (h >= 2.0)
+                                   : (h > 1.0e-9 * (x.back() - x.front()));
+        if (err[j] > tolerance && splittable) {
+          candidates.push_back(make_pair(err[j], make_pair(d, j)));
+        }
+      }
+    }
+    sort(candidates.rbegin(), candidates.rend());
+
+    size_t n[3] = {emap.axes[0].size(), emap.axes[1].size(),
+                   emap.axes[2].size()};
+    vector<double> added[3];
+    for (auto &c : candidates) {
+      int d = c.second.first;
+      size_t nnew[3] = {n[0], n[1], n[2]};
+      nnew[d]++;
+      if ((int)(nnew[0] * nnew[1] * nnew[2]) > maxnodes) {
+        continue;
+      }
+      vector<double> &x = emap.axes[d];
+      size_t j = c.second.second;
+      double mid = 0.5 * (x[j] + x[j + 1]);
+      added[d].push_back(d == 1 ? round(mid) : mid);
+      n[d] = nnew[d];
+    }
+    if (added[0].empty() && added[1].empty() && added[2].empty()) {
+      break;
+    }
+
+    // insert the new planes and move the known values
+    EquilibriumMap refined;
+    refined.model = model;
+    vector<size_t> position[3];
+    for (int d = 0; d < 3; d++) {
+      refined.axes[d] = emap.axes[d];
+      refined.axes[d].insert(refined.axes[d].end(), added[d].begin(),
+                             added[d].end());
+      sort(refined.axes[d].begin(), refined.axes[d].end());
+      for (double xo : emap.axes[d]) {
+        position[d].push_back(
+            lower_bound(refined.axes[d].begin(), refined.axes[d].end(), xo) -
+            refined.axes[d].begin());
+      }
+    }
+    refined.values.assign(3 * EqMapSize(refined), 0.0);
+    done.assign(EqMapSize(refined), 0);
+    for (size_t i = 0; i < emap.axes[0].size(); i++) {
+      for (size_t j = 0; j < emap.axes[1].size(); j++) {
+        for (size_t k = 0; k < emap.axes[2].size(); k++) {
+          size_t from = EqMapIndex(emap, i, j, k);
+          size_t to = EqMapIndex(refined, position[0][i], position[1][j],
+                                 position[2][k]);
+          copy(&emap.values[3 * from], &emap.values[3 * from + 3],
+               &refined.values[3 * to]);
+          done[to] = 1;
+        }
+      }
+    }
+    emap = refined;
+  }
+
+  return nruns;
+}
+
+/*
+================================================================================
+  TRILINEAR INTERPOLATION OF THE EQUILIBRIUM MAP
+================================================================================
+*/
+void EquilibriumMapLookup(EquilibriumMap &emap, double pnumber,
+                          double coupling, double voltage, double *out,
+                          double *error) {
+  double q[3] = {pnumber, coupling, voltage};
+  size_t lo[3];
+  double w[3], spread[3];
+
+  for (int d = 0; d < 3; d++) {
+    vector<double> &x = emap.axes[d];
+    double xq = min(max(q[d], x.front()), x.back());
+    if (x.size() == 1) {
+      lo[d] = 0;
+      w[d] = 0.0;
+      spread[d] = 0.0;
+      continue;
+    }
+    size_t j = upper_bound(x.begin(), x.end(), xq) - x.begin();
+    j = min(max(j, (size_t)1), x.size() - 1) - 1;
+    double h = x[j + 1] - x[j];
+    lo[d] = j;
+    w[d] = (xq - x[j]) / h;
+    spread[d] = 0.5 * (xq - x[j]) * (x[j + 1] - xq);
+  }
+
+  double curv[9] = {0.0};
+  for (int o = 0; o < 3; o++) {
+    out[o] = 0.0;
+  }
+  for (int c = 0; c < 8; c++) {
+    size_t idx[3];
+    double weight = 1.0;
+    bool valid = true;
+    for (int d = 0; d < 3; d++) {
+      int bit = (c >> d) & 1;
+      if (bit && emap.axes[d].size() == 1) {
+        valid = false;
+        break;
+      }
+      idx[d] = lo[d] + bit;
+      weight *= bit ? w[d] : 1.0 - w[d];
+    }
+    if (!valid) {
+      continue;
+    }
+    size_t node = EqMapIndex(emap, idx[0], idx[1], idx[2]);
+    for (int o = 0; o < 3; o++) {
+      out[o] += weight * emap.values[3 * node + o];
+    }
+    for (int e = 0; e < 9; e++) {
+      curv[e] = max(curv[e], fabs(emap.curvatures[9 * node + e]));
+    }
+  }
+
+  for (int o = 0; o < 3; o++) {
+    error[o] = 0.0;
+    for (int d = 0; d < 3; d++) {
+      error[o] += curv[3 * d + o] * spread[d];
+    }
+  }
+}
+
+/*
+================================================================================
+  BINARY FILE FORMAT (NATIVE BYTE ORDER)
+
+    char[8]   "IBSEQMAP"
+    int32     version
+    int32     model
+    uint64[3] number of nodes per axis
+    double[]  axis nodes
+    double[]  values (3 per node)
+    double[]  curvatures (9 per node)
+================================================================================
+*/
+bool WriteEquilibriumMap(string filename, EquilibriumMap &emap) {
+  ofstream file(filename, ios::binary);
+  if (!file) {
+    return false;
+  }
+  int32_t model = emap.model;
+  file.write(EQMAP_MAGIC, 8);
+  file.write((const char *)&EQMAP_VERSION, sizeof(int32_t));
+  file.write((const char *)&model, sizeof(int32_t));
+  for (int d = 0; d < 3; d++) {
+    uint64_t n = emap.axes[d].size();
+    file.write((const char *)&n, sizeof(uint64_t));
+  }
+  for (int d = 0; d < 3; d++) {
+    file.write((const char *)emap.axes[d].data(),
+               emap.axes[d].size() * sizeof(double));
+  }
+  file.write((const char *)emap.values.data(),
+             emap.values.size() * sizeof(double));
+  file.write((const char *)emap.curvatures.data(),
+             emap.curvatures.size() * sizeof(double));
+  return (bool)file;
+}
+
+bool ReadEquilibriumMap(string filename, EquilibriumMap &emap) {
+  ifstream file(filename, ios::binary);
+  if (!file) {
+    return false;
+  }
+  char magic[8];
+  int32_t version, model;
+  uint64_t n[3];
+  file.read(magic, 8);
+  file.read((char *)&version, sizeof(int32_t));
+  file.read((char *)&model, sizeof(int32_t));
+  file.read((char *)n, 3 * sizeof(uint64_t));
+  if (!file || memcmp(magic, EQMAP_MAGIC, 8) != 0 ||
+      version != EQMAP_VERSION) {
+    return false;
+  }
+  for (int d = 0; d < 3; d++) {
+    if (n[d] == 0 || n[d] > (1u << 20)) {
+      return false;
+    }
+  }
+
+  // the node count is checked against the remaining data before allocating,
+  // every node holds 3 values and 9 curvatures
+  streampos start = file.tellg();
+  file.seekg(0, ios::end);
+  uint64_t remaining = (uint64_t)(file.tellg() - start) / sizeof(double);
+  file.seekg(start);
+  uint64_t naxes = n[0] + n[1] + n[2];
+  if (!file || naxes > remaining) {
+    return false;
+  }
+  uint64_t nodes = n[0];
+  for (int d = 1; d < 3; d++) {
+    if (nodes > UINT64_MAX / n[d]) {
+      return false;
+    }
+    nodes *= n[d];
+  }
+  if (nodes > (remaining - naxes) / 12) {
+    return false;
+  }
+
+  EquilibriumMap result;
+  result.model = model;
+  for (int d = 0; d < 3; d++) {
+    result.axes[d].resize(n[d]);
+    file.read((char *)result.axes[d].data(), n[d] * sizeof(double));
+  }
+  result.values.resize(3 * EqMapSize(result));
+  result.curvatures.resize(9 * EqMapSize(result));
+  file.read((char *)result.values.data(),
+            result.values.size() * sizeof(double));
+  file.read((char *)result.curvatures.data(),
+            result.curvatures.size() * sizeof(double));
+  if (!file) {
+    return false;
+  }
+  emap = result;
+  return true;
+}
@@ -0,0 +1,480 @@
+#include "../include/ibs_bits/Fitting.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/OrdDiffEq.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include "../include/ibs_bits/RadiationDamping.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+METHOD TO INTEGRATE THE "der" EQUATIONS TOGETHER WITH THEIR FORWARD
+SENSITIVITIES WITH RESPECT TO THE FIT PARAMETERS.
+
+  STATE u = (ex, ey, sige), RATES a = (a_s, a_x, a_y) :
+
+    f_k = -c_k (u_k - u0_k) / tau_k + c_L c_k u_k a_m(k)
+
+  WITH c = (2, 2, 1), m = (1, 2, 0), u0_1 = max(kappa ex_rad, ey_rad) AND
+  N = c_N pnumber IN THE RATES. ONE EULER STEP OF THE STATE AND OF ITS
+  JACOBIAN S = du/dp :
+
+    u' = u + dt f
+    S' = S + dt (df/du S + df/dp)
+
+  THE RATE DERIVATIVES ARE FORWARD DIFFERENCES. THE TIME STEPS DEPEND ON THE
+  PARAMETERS THROUGH THE RATES AND ARE NOT DIFFERENTIATED, S IS THE
+  SENSITIVITY OF THE SCHEME AT FIXED STEPS.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers
+    - double voltages[]
+        rf voltages
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        nominal number of particles
+    - const double *p
+        fit parameters
+    - double t0, ex0, ey0, sigs0
+        initial state
+    - const vector<double> &times
+        output times
+    - vector<double> &out
+        output variable - ex, ey, sigs at the output times
+    - vector<double> &dout
+        output variable - derivatives
+    - bool pnumberderivative
+        calculate the population derivatives
+
+  Returns:
+  --------
+    long
+      number of growth rate evaluations
+
+================================================================================
+================================================================================
+*/
+long FitModelSensitivities(map<string, double> &twiss,
+                           map<string, vector<double>> &twissdata, int nrf,
+                           double harmon[], double voltages[], int model,
+                           double pnumber, const double *p, double t0,
+                           double ex0, double ey0, double sigs0,
+                           const vector<double> &times, vector<double> &out,
+                           vector<double> &dout, bool pnumberderivative) {
+  PerfRegion perf("FitModelSensitivities", times.size(), "fit");
+  const double c[3] = {2.0, 2.0, 1.0};
+  const int m[3] = {1, 2, 0};
+  const double h = 1.0e-6;
+  const long MaxSteps = 1000000;
+
+  // ring quantities without coupling, the coupling is a fit parameter
+  ODERing ring;
+  ODERingSetup(twiss, twissdata, nrf, harmon, voltages, 0, ring);
+  // state order (ex, ey, sige)
+  double taurad[3] = {ring.tauradx, ring.taurady, ring.taurads};
+
+  double kappa = p[FIT_COUPLING] / 100.0;
+  double N = p[FIT_PNUMBER] * pnumber;
+  double cl = p[FIT_CLOG];
+
+  // sigs is proportional to sige
+  double ratio = sigsfromsige(1.0, ring.gamma, ring.gammatr, ring.omegas);
+
+  double u0[3] = {ring.ex0, max(kappa * ring.ex0, ring.ey0), ring.sige0};
+  double du0dkappa = (kappa * ring.ex0 > ring.ey0) ? ring.ex0 / 100.0 : 0;
+
+  double u[3] = {ex0, ey0, sigs0 / ratio};
+  double S[3][FIT_NPARAMETERS] = {{0.0}};
+
+  out.assign(3 * times.size(), 0.0);
+  dout.assign(9 * times.size(), 0.0);
+
+  long nrates = 0;
+  long steps = 0;
+  double t = t0;
+  size_t j = 0;
+  while (j < times.size() && steps < MaxSteps) {
+    // record all output times reached
+    while (j < times.size() && times[j] <= t) {
+      for (int k = 0; k < 3; k++) {
+        double scale = (k == 2) ? ratio : 1.0;
+        out[3 * j + k] = scale * u[k];
+        for (int l = 0; l < FIT_NPARAMETERS; l++) {
+          dout[9 * j + 3 * k + l] = scale * S[k][l];
+        }
+      }
+      j++;
+    }
+    if (j >= times.size()) {
+      break;
+    }
+
+    double a[3];
+    double *r = IBSRates(model, N, u[0], u[1], ratio * u[2], u[2], twiss,
+                         twissdata, ring.r0, ring.aatom);
+    copy(r, r + 3, a);
+    nrates++;
+
+    // rate derivatives with respect to the state and the population
+    double da[3][3], dadn[3] = {0.0, 0.0, 0.0};
+    for (int l = 0; l < 3; l++) {
+      double up[3] = {u[0], u[1], u[2]};
+      double dl = h * fabs(u[l]);
+      up[l] += dl;
+      r = IBSRates(model, N, up[0], up[1], ratio * up[2], up[2], twiss,
+                   twissdata, ring.r0, ring.aatom);
+      for (int q = 0; q < 3; q++) {
+        da[q][l] = (r[q] - a[q]) / dl;
+      }
+      nrates++;
+    }
+    if (pnumberderivative) {
+      double dn = h * N;
+      r = IBSRates(model, N + dn, u[0], u[1], ratio * u[2], u[2], twiss,
+                   twissdata, ring.r0, ring.aatom);
+      for (int q = 0; q < 3; q++) {
+        dadn[q] = (r[q] - a[q]) / dn;
+      }
+      nrates++;
+    }
+
+    // auto time step of the ODE, clipped to the next output time
+    double ddt = min(taurad[0], min(taurad[1], taurad[2]));
+    for (int q = 0; q < 3; q++) {
+      if (cl * a[q] > 0.0) {
+        ddt = min(ddt, 1.0 / (cl * a[q]));
+      }
+    }
+    ddt /= 2.0;
+    bool last = ddt >= times[j] - t;
+    if (last) {
+      ddt = times[j] - t;
+    }
+
+    double f[3], Sn[3][FIT_NPARAMETERS];
+    for (int k = 0; k < 3; k++) {
+      double ak = a[m[k]];
+      f[k] = -c[k] * (u[k] - u0[k]) / taurad[k] + cl * c[k] * u[k] * ak;
+
+      double Ju[3];
+      for (int l = 0; l < 3; l++) {
+        Ju[l] = cl * c[k] * u[k] * da[m[k]][l];
+      }
+      Ju[k] += -c[k] / taurad[k] + cl * c[k] * ak;
+
+      double Jp[FIT_NPARAMETERS];
+      Jp[FIT_COUPLING] = (k == 1) ? c[k] * du0dkappa / taurad[k] : 0.0;
+      Jp[FIT_PNUMBER] = cl * c[k] * u[k] * dadn[m[k]] * pnumber;
+      Jp[FIT_CLOG] = c[k] * u[k] * ak;
+
+      for (int l = 0; l < FIT_NPARAMETERS; l++) {
+        double dS = Jp[l];
+        for (int q = 0; q < 3; q++) {
+          dS += Ju[q] * S[q][l];
+        }
+        Sn[k][l] = S[k][l] + ddt * dS;
+      }
+    }
+    for (int k = 0; k < 3; k++) {
+      u[k] += ddt * f[k];
+      copy(Sn[k], Sn[k] + FIT_NPARAMETERS, S[k]);
+    }
+    t = last ? times[j] : t + ddt;
+    steps++;
+  }
+  perf.SetElements(steps);
+  return nrates;
+}
+
+/*
+================================================================================
+  RESIDUALS AND THEIR JACOBIAN WITH RESPECT TO THE FREE PARAMETERS
+================================================================================
+*/
+static double FitResiduals(FitMeasurement &data, const vector<double> &out,
+                           const vector<double> &dout, const int *index,
+                           int nfree, vector<double> &res,
+                           vector<double> &jac) {
+  vector<double> *values[3] = {&data.ex, &data.ey, &data.sigs};
+  vector<double> *errors[3] = {&data.exerr, &data.eyerr, &data.sigserr};
+  size_t n = data.time.size();
+
+  res.clear();
+  jac.clear();
+  double chi2 = 0.0;
+  for (int k = 0; k < 3; k++) {
+    if (values[k]->size() != n) {
+      continue;
+    }
+    bool relative = errors[k]->size() != n;
+    for (size_t i = 0; i < n; i++) {
+      double d = (*values[k])[i];
+      double err = relative ? fabs(d) : (*errors[k])[i];
+      if (!(err > 0.0)) {
+        continue;
+      }
+      double r = (out[3 * i + k] - d) / err;
+      res.push_back(r);
+      for (int q = 0; q < nfree; q++) {
+        jac.push_back(dout[9 * i + 3 * k + index[q]] / err);
+      }
+      chi2 += r * r;
+    }
+  }
+  return chi2;
+}
+
+// solve A x = b in place (x in b), Gaussian elimination with pivoting
+static bool FitSolve(int n, double *A, double *b) {
+  for (int k = 0; k < n; k++) {
+    int piv = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(A[i * n + k]) > fabs(A[piv * n + k])) {
+        piv = i;
+      }
+    }
+    if (A[piv * n + k] == 0.0) {
+      return false;
+    }
+    for (int j = 0; j < n; j++) {
+      swap(A[k * n + j], A[piv * n + j]);
+    }
+    swap(b[k], b[piv]);
+    for (int i = k + 1; i < n; i++) {
+      double f = A[i * n + k] / A[k * n + k];
+      for (int j = k; j < n; j++) {
+        A[i * n + j] -= f * A[k * n + j];
+      }
+      b[i] -= f * b[k];
+    }
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    double s = b[i];
+    for (int j = i + 1; j < n; j++) {
+      s -= A[i * n + j] * b[j];
+    }
+    b[i] = s / A[i * n + i];
+  }
+  return true;
+}
+
+// normal equations J^T J and J^T r of the free parameters
+static void FitNormalEquations(const vector<double> &res,
+                               const vector<double> &jac, int nfree, double *A,
+                               double *g) {
+  fill(A, A + nfree * nfree, 0.0);
+  fill(g, g + nfree, 0.0);
+  for (size_t i = 0; i < res.size(); i++) {
+    const double *row = &jac[i * nfree];
+    for (int a = 0; a < nfree; a++) {
+      g[a] += row[a] * res[i];
+      for (int b = 0; b < nfree; b++) {
+        A[a * nfree + b] += row[a] * row[b];
+      }
+    }
+  }
+}
+
+static void FitClamp(double *p) {
+  p[FIT_COUPLING] = min(max(p[FIT_COUPLING], 0.0), 100.0);
+  p[FIT_PNUMBER] = max(p[FIT_PNUMBER], 1.0e-6);
+  p[FIT_CLOG] = max(p[FIT_CLOG], 1.0e-6);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO FIT THE COUPLING, THE POPULATION CALIBRATION AND THE COULOMB LOG
+CORRECTION TO A MEASURED EMITTANCE EVOLUTION.
+
+  LEVENBERG-MARQUARDT WITH THE JACOBIAN FROM THE FORWARD SENSITIVITIES :
+
+    (J^T J + lambda diag(J^T J)) dp = -J^T r
+
+  lambda IS DIVIDED BY 10 AFTER AN ACCEPTED AND MULTIPLIED BY 10 AFTER A
+  REJECTED STEP. THE STARTS RUN IN PARALLEL.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers
+    - double voltages[]
+        rf voltages
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        nominal number of particles
+    - double t0, ex0, ey0, sigs0
+        initial state
+    - FitMeasurement &data
+        measured evolution
+    - const bool *free
+        fitted parameters
+    - const vector<double> &starts
+        start values
+    - int maxiter
+        maximum number of iterations
+    - double tolerance
+        convergence tolerance
+    - vector<FitResult> &results
+        output variable - fit results sorted by chi2
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void FitEmittanceEvolution(map<string, double> &twiss,
+                           map<string, vector<double>> &twissdata, int nrf,
+                           double harmon[], double voltages[], int model,
+                           double pnumber, double t0, double ex0, double ey0,
+                           double sigs0, FitMeasurement &data,
+                           const bool *free, const vector<double> &starts,
+                           int maxiter, double tolerance,
+                           vector<FitResult> &results) {
+  int nstarts = starts.size() / FIT_NPARAMETERS;
+  PerfRegion perf("FitEmittanceEvolution", nstarts, "fit");
+
+  int index[FIT_NPARAMETERS];
+  int nfree = 0;
+  for (int j = 0; j < FIT_NPARAMETERS; j++) {
+    if (free[j]) {
+      index[nfree++] = j;
+    }
+  }
+
+  // covariance scaled with the residual variance for relative residuals
+  size_t n = data.time.size();
+  bool scaled = (data.ex.size() == n && data.exerr.size() != n) ||
+                (data.ey.size() == n && data.eyerr.size() != n) ||
+                (data.sigs.size() == n && data.sigserr.size() != n);
+
+  results.assign(nstarts, FitResult());
+
+#pragma omp parallel for schedule(dynamic) shared(twiss, twissdata, data)
+  for (int s = 0; s < nstarts; s++) {
+    FitResult &fit = results[s];
+    copy(&starts[s * FIT_NPARAMETERS], &starts[(s + 1) * FIT_NPARAMETERS],
+         fit.start);
+    double p[FIT_NPARAMETERS];
+    copy(fit.start, fit.start + FIT_NPARAMETERS, p);
+    FitClamp(p);
+
+    vector<double> out, dout, res, jac, restrial, jactrial;
+    fit.rateevaluations = FitModelSensitivities(
+        twiss, twissdata, nrf, harmon, voltages, model, pnumber, p, t0, ex0,
+        ey0, sigs0, data.time, out, dout, free[FIT_PNUMBER]);
+    fit.evaluations = 1;
+    double chi2 = FitResiduals(data, out, dout, index, nfree, res, jac);
+
+    double lambda = 1.0e-3;
+    fit.converged = nfree == 0;
+    fit.iterations = 0;
+    double A[FIT_NPARAMETERS * FIT_NPARAMETERS], g[FIT_NPARAMETERS];
+    while (!fit.converged && fit.iterations < maxiter) {
+      fit.iterations++;
+      FitNormalEquations(res, jac, nfree, A, g);
+      for (int a = 0; a < nfree; a++) {
+        A[a * nfree + a] *= 1.0 + lambda;
+        g[a] = -g[a];
+      }
+      if (!FitSolve(nfree, A, g)) {
+        break;
+      }
+
+      double ptrial[FIT_NPARAMETERS];
+      copy(p, p + FIT_NPARAMETERS, ptrial);
+      for (int a = 0; a < nfree; a++) {
+        ptrial[index[a]] += g[a];
+      }
+      FitClamp(ptrial);
+
+      fit.rateevaluations += FitModelSensitivities(
+          twiss, twissdata, nrf, harmon, voltages, model, pnumber, ptrial, t0,
+          ex0, ey0, sigs0, data.time, out, dout, free[FIT_PNUMBER]);
+      fit.evaluations++;
+      double chi2trial =
+          FitResiduals(data, out, dout, index, nfree, restrial, jactrial);
+
+      if (chi2trial < chi2) {
+        double dpmax = 0.0;
+        for (int a = 0; a < nfree; a++) {
+          double scale = max(fabs(p[index[a]]), 1.0e-3);
+          dpmax = max(dpmax, fabs(ptrial[index[a]] - p[index[a]]) / scale);
+        }
+        fit.converged =
+            (chi2 - chi2trial) <= tolerance * chi2 || dpmax <= tolerance;
+        copy(ptrial, ptrial + FIT_NPARAMETERS, p);
+        chi2 = chi2trial;
+        res.swap(restrial);
+        jac.swap(jactrial);
+        lambda = max(lambda / 10.0, 1.0e-12);
+      } else {
+        lambda *= 10.0;
+        // no descent direction left at machine precision
+        fit.converged = lambda > 1.0e12;
+      }
+    }
+
+    copy(p, p + FIT_NPARAMETERS, fit.parameters);
+    fit.chi2 = chi2;
+    fit.nresiduals = res.size();
+
+    // covariance (J^T J)^-1 by solving for the unit vectors
+    fill(fit.covariance, fit.covariance + FIT_NPARAMETERS * FIT_NPARAMETERS,
+         0.0);
+    double factor = 1.0;
+    if (scaled && fit.nresiduals > nfree) {
+      factor = chi2 / (fit.nresiduals - nfree);
+    }
+    for (int b = 0; b < nfree; b++) {
+      double e[FIT_NPARAMETERS] = {0.0, 0.0, 0.0};
+      e[b] = 1.0;
+      FitNormalEquations(res, jac, nfree, A, g);
+      if (!FitSolve(nfree, A, e)) {
+        break;
+      }
+      for (int a = 0; a < nfree; a++) {
+        fit.covariance[index[a] * FIT_NPARAMETERS + index[b]] = factor * e[a];
+      }
+    }
+  }
+
+  sort(results.begin(), results.end(),
+       [](const FitResult &a, const FitResult &b) { return a.chi2 < b.chi2; });
+}
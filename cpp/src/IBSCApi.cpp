@@ -0,0 +1,342 @@
+#include "../include/ibs_bits/IBSCApi.h"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/ParticleKicks.hpp"
+#include "../include/ibs_bits/twiss.hpp"
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+C INTERFACE FOR EMBEDDING THE IBS RATES AND KICKS IN EXTERNAL CODES
+
+  A CONTEXT OWNS ITS TWISS DATA, THE DERIVED COLUMNS AND THE CONTIGUOUS TABLE
+  OF ELEMENT OPTICS ARE CALCULATED ONCE IN ibs_prepare. ibs_evaluate SUMS THE
+  ELEMENT KERNELS OVER THAT TABLE WITHOUT ANY MAP LOOKUP OR ALLOCATION. ALL
+  HEADER KEYS AND COLUMNS USED BY THE MODELS ARE PRESENT AFTER PREPARATION,
+  SUCH THAT THE MAP LOOKUPS OF THE ELEMENT RATES AND KICKS NEVER INSERT. THE
+  MODEL RETURN BUFFERS ARE THREAD LOCAL, DIFFERENT CONTEXTS CAN BE EVALUATED
+  CONCURRENTLY.
+
+  NO EXCEPTION CROSSES THE C BOUNDARY, ERRORS ARE REPORTED AS STATUS CODES.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : rates from the precomputed element table, the model sets
+                   CHARGE and MASS of the header
+
+================================================================================
+================================================================================
+*/
+struct IBSContext {
+  map<string, double> header;
+  map<string, vector<double>> table;
+  bool prepared = false;
+
+  // element optics and ring constants of the kernels, set by ibs_prepare
+  vector<IBSElementOptics> elements;
+  IBSElementRing ring;
+
+  int model = 0;
+  double pnumber = 0.0;
+  double r0 = 0.0;
+  double aatom = 0.0;
+  int element = 0;
+
+  double moments[4] = {0.0, 0.0, 0.0, 0.0};
+  double rates[3] = {0.0, 0.0, 0.0};
+  bool cached = false;
+};
+
+static const char *REQUIRED_HEADER[] = {"GAMMA", "LENGTH", "CHARGE", "MASS",
+                                        "ENERGY"};
+static const char *SMOOTH_HEADER[] = {"GAMMATR", "Q1", "Q2"};
+static const char *REQUIRED_COLUMNS[] = {"L",    "BETX", "ALFX", "BETY",
+                                         "ALFY", "DX",   "DPX"};
+static const char *OPTIONAL_COLUMNS[] = {"DY",  "DPY",   "K1L", "K1SL",
+                                         "ANGLE", "K2L", "K2SL"};
+
+static bool ready(const IBSContext *ctx) {
+  return ctx != NULL && ctx->prepared && ctx->model != 0;
+}
+
+// the ring constants follow the header once all required keys are present
+static void update_ring(IBSContext *ctx) {
+  if (ctx->prepared) {
+    IBSElementRingSetup(ctx->header, ctx->ring);
+  }
+}
+
+IBSContext *ibs_create(void) {
+  try {
+    return new IBSContext();
+  } catch (...) {
+    return NULL;
+  }
+}
+
+IBSContext *ibs_create_from_file(const char *filename) {
+  if (filename == NULL) {
+    return NULL;
+  }
+  IBSContext *ctx = NULL;
+  try {
+    ctx = new IBSContext();
+    if (!ReadTwiss(filename, ctx->header, ctx->table)) {
+      delete ctx;
+      return NULL;
+    }
+  } catch (...) {
+    delete ctx;
+    return NULL;
+  }
+  if (ibs_prepare(ctx) != IBS_OK) {
+    delete ctx;
+    return NULL;
+  }
+  return ctx;
+}
+
+IBSContext *ibs_create_from_buffer(const char *data, size_t size) {
+  if (data == NULL) {
+    return NULL;
+  }
+  IBSContext *ctx = NULL;
+  try {
+    ctx = new IBSContext();
+    if (!ParseTwiss(string_view(data, size), ctx->header, ctx->table)) {
+      delete ctx;
+      return NULL;
+    }
+  } catch (...) {
+    delete ctx;
+    return NULL;
+  }
+  if (ibs_prepare(ctx) != IBS_OK) {
+    delete ctx;
+    return NULL;
+  }
+  return ctx;
+}
+
+void ibs_destroy(IBSContext *ctx) { delete ctx; }
+
+int ibs_set_header(IBSContext *ctx, const char *key, double value) {
+  if (ctx == NULL || key == NULL) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  try {
+    ctx->header[key] = value;
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+  update_ring(ctx);
+  ctx->cached = false;
+  return IBS_OK;
+}
+
+int ibs_set_column(IBSContext *ctx, const char *name, int n,
+                   const double *values) {
+  if (ctx == NULL || name == NULL || n < 0 || (n > 0 && values == NULL)) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  try {
+    // reuses the storage when a column of the same size is replaced
+    ctx->table[name].assign(values, values + n);
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+  ctx->prepared = false;
+  ctx->cached = false;
+  return IBS_OK;
+}
+
+int ibs_prepare(IBSContext *ctx) {
+  if (ctx == NULL) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  ctx->prepared = false;
+  ctx->cached = false;
+
+  for (const char *key : REQUIRED_HEADER) {
+    if (ctx->header.find(key) == ctx->header.end()) {
+      return IBS_ERROR_STATE;
+    }
+  }
+
+  auto l = ctx->table.find("L");
+  if (l == ctx->table.end() || l->second.empty()) {
+    return IBS_ERROR_STATE;
+  }
+  size_t n = l->second.size();
+
+  try {
+    for (const char *name : REQUIRED_COLUMNS) {
+      auto col = ctx->table.find(name);
+      if (col == ctx->table.end() || col->second.size() != n) {
+        return IBS_ERROR_STATE;
+      }
+    }
+    for (const char *name : OPTIONAL_COLUMNS) {
+      auto col = ctx->table.find(name);
+      if (col == ctx->table.end()) {
+        ctx->table[name] = vector<double>(n, 0.0);
+      } else if (col->second.size() != n) {
+        return IBS_ERROR_STATE;
+      }
+    }
+    updateTwiss(ctx->table);
+    IBSElementTable(ctx->table, ctx->elements);
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+
+  if (ctx->element >= (int)n) {
+    ctx->element = 0;
+  }
+  ctx->prepared = true;
+  update_ring(ctx);
+  return IBS_OK;
+}
+
+int ibs_number_of_elements(const IBSContext *ctx) {
+  if (ctx == NULL || !ctx->prepared) {
+    return -1;
+  }
+  return ctx->table.find("L")->second.size();
+}
+
+int ibs_set_model(IBSContext *ctx, int model, double pnumber, double charge,
+                  double aatom) {
+  if (ctx == NULL || model < 1 || model > 13 || pnumber <= 0.0 ||
+      aatom <= 0.0) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  if (model == 1) {
+    for (const char *key : SMOOTH_HEADER) {
+      if (ctx->header.find(key) == ctx->header.end()) {
+        return IBS_ERROR_STATE;
+      }
+    }
+  }
+  try {
+    // species of the header, the energy follows at fixed GAMMA
+    double mass = aatom * pmass;
+    ctx->header["CHARGE"] = charge;
+    ctx->header["MASS"] = mass;
+    auto gamma = ctx->header.find("GAMMA");
+    if (gamma != ctx->header.end()) {
+      ctx->header["ENERGY"] = gamma->second * mass;
+      auto pc = ctx->header.find("PC");
+      if (pc != ctx->header.end()) {
+        pc->second = mass * sqrt(gamma->second * gamma->second - 1.0);
+      }
+    }
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+  update_ring(ctx);
+  ctx->model = model;
+  ctx->pnumber = pnumber;
+  ctx->aatom = aatom;
+  ctx->r0 = ParticleRadius(charge, aatom);
+  ctx->cached = false;
+  return IBS_OK;
+}
+
+int ibs_set_reference_element(IBSContext *ctx, int element) {
+  if (ctx == NULL || !ctx->prepared || element < 0 ||
+      element >= ibs_number_of_elements(ctx)) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  ctx->element = element;
+  return IBS_OK;
+}
+
+int ibs_set_moments(IBSContext *ctx, double ex, double ey, double sigs,
+                    double sige) {
+  if (ctx == NULL || !(ex > 0.0) || !(ey > 0.0) || !(sigs > 0.0) ||
+      !(sige > 0.0)) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  if (ex != ctx->moments[0] || ey != ctx->moments[1] ||
+      sigs != ctx->moments[2] || sige != ctx->moments[3]) {
+    ctx->moments[0] = ex;
+    ctx->moments[1] = ey;
+    ctx->moments[2] = sigs;
+    ctx->moments[3] = sige;
+    ctx->cached = false;
+  }
+  return IBS_OK;
+}
+
+int ibs_evaluate(IBSContext *ctx, double *rates) {
+  if (rates == NULL) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  if (!ready(ctx) || ctx->moments[0] <= 0.0) {
+    return IBS_ERROR_STATE;
+  }
+  if (!ctx->cached) {
+    try {
+      BeamState state = {ctx->pnumber, ctx->moments[0], ctx->moments[1],
+                         ctx->moments[2], ctx->moments[3]};
+      IBSRatesElements(ctx->model, state, ctx->header, ctx->ring,
+                       ctx->elements, ctx->r0, ctx->aatom, ctx->rates);
+    } catch (...) {
+      return IBS_ERROR_INTERNAL;
+    }
+    ctx->cached = true;
+  }
+  rates[0] = ctx->rates[0];
+  rates[1] = ctx->rates[1];
+  rates[2] = ctx->rates[2];
+  return IBS_OK;
+}
+
+int ibs_element_rates(IBSContext *ctx, int element, double *rates) {
+  if (rates == NULL) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  if (!ready(ctx) || ctx->moments[0] <= 0.0) {
+    return IBS_ERROR_STATE;
+  }
+  if (element < 0 || element >= ibs_number_of_elements(ctx)) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  try {
+    IBSElementRates(ctx->model, element, ctx->pnumber, ctx->moments[0],
+                    ctx->moments[1], ctx->moments[2], ctx->moments[3],
+                    ctx->header, ctx->table, ctx->r0, ctx->aatom, rates);
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+  return IBS_OK;
+}
+
+int ibs_kick(IBSContext *ctx, int npart, double *x, double *px, double *y,
+             double *py, double *dp, double dt, uint64_t seed, uint64_t turn) {
+  if (npart < 0 || (npart > 0 && (x == NULL || px == NULL || y == NULL ||
+                                  py == NULL || dp == NULL))) {
+    return IBS_ERROR_ARGUMENT;
+  }
+  double rates[3];
+  int status = ibs_evaluate(ctx, rates);
+  if (status != IBS_OK) {
+    return status;
+  }
+  try {
+    IBSKick(npart, x, px, y, py, dp, rates, ctx->moments, ctx->header,
+            ctx->table, ctx->element, dt, seed, turn, 0);
+  } catch (...) {
+    return IBS_ERROR_INTERNAL;
+  }
+  return IBS_OK;
+}
@@ -0,0 +1,240 @@
+#include "../include/ibs_bits/ImportanceSampling.hpp"
+#include "../include/ibs_bits/Arena.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE IMPORTANCE SAMPLING WEIGHT OF A LATTICE ELEMENT.
+
+  CHEAP PROXY FOR THE CONTRIBUTION OF THE ELEMENT TO THE IBS LATTICE SUMS :
+    LENGTH x (1 + CURLY H dp/p**2 / ex) / (SIGMA X x SIGMA Y)
+
+  ELEMENTS WITHOUT LENGTH DO NOT CONTRIBUTE TO THE LATTICE SUMS AND GET ZERO
+  WEIGHT, WHICH KEEPS THE ESTIMATOR UNBIASED.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int i
+        element index
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double dponp
+        energy spread
+    - map<string, vector<double>> twissdata
+        twiss table madx
+
+  Returns:
+  --------
+    double
+      sampling weight
+
+================================================================================
+================================================================================
+*/
+double ImportanceSamplingWeight(int i, double ex, double ey, double dponp,
+                                map<string, vector<double>> &twissdata) {
+  double l = twissdata["L"][i];
+  double bx = twissdata["BETX"][i];
+  double by = twissdata["BETY"][i];
+  double ax = twissdata["ALFX"][i];
+  double dx = twissdata["DX"][i];
+  double dpx = twissdata["DPX"][i];
+
+  // curly H
+  double hx = (dx * dx + (bx * dpx + ax * dx) * (bx * dpx + ax * dx)) / bx;
+
+  double sigx = sqrt(ex * bx + dx * dx * dponp * dponp);
+  double sigy = sqrt(ey * by);
+
+  return fabs(l) * (1.0 + hx * dponp * dponp / ex) / (sigx * sigy);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO ESTIMATE THE IBS GROWTH RATES OF A LATTICE MODEL USING IMPORTANCE
+SAMPLING OF THE LATTICE ELEMENTS.
+
+  ESTIMATOR :
+    rate = 1/m sum_k c(i_k) / q(i_k)  with i_k drawn from q(i) = w(i) / sum w
+
+  THE SAMPLE SIZE IS DERIVED FROM A PILOT BATCH AS
+    m = (z * sd / (relerr * |rate|))**2 (MAX OVER THE THREE PLANES)
+
+  IF m IS LARGER THAN THE NUMBER OF ELEMENTS THE EXACT SUM IS CHEAPER AND IS
+  RETURNED WITH ZERO ERROR.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - double relerr
+        target relative half width of the 95% confidence interval
+    - unsigned long seed
+        seed for the random number generator
+    - double* rates
+        output variable - estimated rates
+    - double* errors
+        output variable - half width of the 95% confidence intervals
+
+  Returns:
+  --------
+    int
+      number of evaluated elements
+
+================================================================================
+================================================================================
+*/
+int ImportanceSampledRates(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double relerr, unsigned long seed,
+                           double *rates, double *errors) {
+  // 95% confidence interval
+  const double z = 1.959963984540054;
+  const int npilot = 64;
+
+  int n = twissdata["L"].size();
+
+  // temporaries live in the thread's scratch arena for this call
+  ArenaScope scope;
+  ScratchArena &arena = ThreadArena();
+
+  // cumulative sampling weights
+  double *cumw = arena.Allocate<double>(n);
+  double wsum = 0.0;
+  for (int i = 0; i < n; i++) {
+    wsum += ImportanceSamplingWeight(i, ex, ey, dponp, twissdata);
+    cumw[i] = wsum;
+  }
+
+  // element contributions are cached, repeated draws are free
+  double *contrib = arena.Allocate<double>(3 * n);
+  bool *evaluated = arena.Allocate<bool>(n);
+  fill(evaluated, evaluated + n, false);
+  int nevaluated = 0;
+
+  auto evaluate = [&](int i) {
+    if (!evaluated[i]) {
+      IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                      twissdata, r0, aatom, &contrib[3 * i]);
+      evaluated[i] = true;
+      nevaluated++;
+    }
+  };
+
+  auto exactsum = [&]() {
+    for (int k = 0; k < 3; k++) {
+      rates[k] = 0.0;
+      errors[k] = 0.0;
+    }
+    for (int i = 0; i < n; i++) {
+      evaluate(i);
+      rates[0] += contrib[3 * i];
+      rates[1] += contrib[3 * i + 1];
+      rates[2] += contrib[3 * i + 2];
+    }
+    return nevaluated;
+  };
+
+  // pilot batch is already as expensive as the full lattice
+  if (wsum <= 0.0 || n <= npilot || model == 1) {
+    return exactsum();
+  }
+
+  mt19937_64 rng(seed);
+  uniform_real_distribution<double> uniform(0.0, wsum);
+
+  double sum[3] = {0.0, 0.0, 0.0};
+  double sum2[3] = {0.0, 0.0, 0.0};
+  int m = 0;
+
+  auto draw = [&](int count) {
+    for (int k = 0; k < count; k++) {
+      int i = lower_bound(cumw, cumw + n, uniform(rng)) - cumw;
+      i = min(i, n - 1);
+      evaluate(i);
+      double q = (i == 0 ? cumw[0] : cumw[i] - cumw[i - 1]) / wsum;
+      for (int p = 0; p < 3; p++) {
+        double y = contrib[3 * i + p] / q;
+        sum[p] += y;
+        sum2[p] += y * y;
+      }
+    }
+    m += count;
+  };
+
+  // required number of samples for the requested relative error
+  auto required = [&]() {
+    double mreq = 0.0;
+    for (int p = 0; p < 3; p++) {
+      double mean = sum[p] / m;
+      double var = max(sum2[p] / m - mean * mean, 0.0);
+      if (mean != 0.0) {
+        mreq = max(mreq, var * (z / (relerr * mean)) * (z / (relerr * mean)));
+      }
+    }
+    return mreq;
+  };
+
+  draw(npilot);
+  double mreq = required();
+
+  if (mreq >= n) {
+    return exactsum();
+  }
+
+  if (mreq > m) {
+    draw((int)ceil(mreq) - m);
+  }
+
+  for (int p = 0; p < 3; p++) {
+    double mean = sum[p] / m;
+    double var = max(sum2[p] / m - mean * mean, 0.0);
+    rates[p] = mean;
+    errors[p] = z * sqrt(var / (m - 1));
+  }
+
+  return nevaluated;
+}
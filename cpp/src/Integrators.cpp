@@ -1,5 +1,6 @@
 #include "../include/ibs_bits/CoulombLogFunctions.hpp"
 #include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
 #include <functional>
 #include <math.h>
 #include <stdio.h>
@@ -69,6 +70,7 @@ void SimpsonDecade(double a, double b, double c, double cl, double cx,
                    double cy, double cprime, double cyy, double tl1, double tl2,
                    double tx1, double tx2, double ty1, double ty2,
                    double *tau) {
+  PerfRegion perf("SimpsonDecade", 1, "integrator");
   const int maxdec = 30, ns = 50;
 
   const double ten = 10.0;
@@ -150,6 +152,208 @@ void SimpsonDecade(double a, double b, double c, double cl, double cx,
     tau[2] = 0.0;
   }
 }
+
+/*
+================================================================================
+================================================================================
+CLOSED FORM IBS INTEGRALS FOR DISPERSION-FREE ELEMENTS.
+
+DETAILS:
+        WITHOUT DISPERSION THE DENOMINATOR OF THE IBS INTEGRAL FACTORISES AS
+        (L + P1)(L + P2)(L + P3) AND AFTER A PARTIAL FRACTION EXPANSION OF THE
+        NUMERATOR EVERY TERM IS A CARLSON ELLIPTIC INTEGRAL
+
+        INT_0^INF SQRT(L) / ((L+P1)^(3/2) (L+P2)^(1/2) (L+P3)^(1/2)) DL
+          = 2/3 RD(1/P2, 1/P3, 1/P1) / (P1^(3/2) SQRT(P2 P3))
+
+        THE ARGUMENTS ARE SCALED WITH THE LARGEST POLE, RD IS HOMOGENEOUS OF
+        DEGREE -3/2.
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+  REF:
+    - PRSTAB 8, 064403 (2005)
+    - CERN NOTE CERN-AB-2006-002 EQ 8
+
+================================================================================
+*/
+static double DispersionFreeTerm(double p1, double p2, double p3) {
+  double s = fmax(p1, fmax(p2, p3));
+  double u1 = s / p1;
+  double u2 = s / p2;
+  double u3 = s / p3;
+  return 2.0 / 3.0 * rds(u2, u3, u1) * u1 * sqrt(u1 * u2 * u3) / s;
+}
+
+/*
+================================================================================
+  END POINT TERMS OF THE SIMPSON DECADE RULE.
+
+  THE DECADE RULE OF SimpsonDecade AND twsint (AS IN MADX) WEIGHTS THE FIRST
+  POINT OF EVERY DECADE WITH 3 INSTEAD OF 1 AND THE LAST INNER POINT WITH 3
+  INSTEAD OF 4, THE END POINT IS NOT EVALUATED. PER DECADE THIS ADDS
+  H / 3 (2 F(A) - F(B - H) - F(B)) TO THE SIMPSON VALUE. THESE TERMS ARE ADDED
+  TO THE CLOSED FORMS SUCH THAT DISPERSION-FREE AND DISPERSIVE ELEMENTS ARE
+  INTEGRATED CONSISTENTLY.
+================================================================================
+*/
+static void DecadeEndPoints(double a, double b, double c, const double *t1,
+                            const double *t2, double *correction) {
+  const int maxdec = 30, ns = 50;
+
+  auto weight = [a, b, c](double lambda) {
+    double cubic = ((lambda + a) * lambda + b) * lambda + c;
+    return sqrt(lambda) / (cubic * sqrt(cubic));
+  };
+
+  for (int k = 0; k < 3; k++) {
+    correction[k] = 0.0;
+  }
+
+  double lower = 0.0;
+  double upper = 1.0;
+  double fa = 0.0;
+  for (int iloop = 0; iloop < maxdec; iloop++) {
+    double h = (upper - lower) / ns;
+    double fm = weight(upper - h);
+    double fb = weight(upper);
+    for (int k = 0; k < 3; k++) {
+      correction[k] += h / 3.0 *
+                       (2.0 * fa * (t1[k] * lower + t2[k]) -
+                        fm * (t1[k] * (upper - h) + t2[k]) -
+                        fb * (t1[k] * upper + t2[k]));
+    }
+    fa = fb;
+    lower = upper;
+    upper *= 10.0;
+  }
+}
+
+/*
+================================================================================
+  INT_0^INF SQRT(L) (T1 L + T2) / (L^3 + A L^2 + B L + C)^(3/2) DL FOR THE
+  THREE PLANES, INCLUDING THE DECADE END POINT TERMS. RETURNS FALSE IF THE
+  CUBIC HAS COMPLEX OR (NEARLY) DEGENERATE ROOTS, THE CALLER FALLS BACK TO THE
+  SIMPSON DECADE INTEGRATOR.
+================================================================================
+*/
+static bool DispersionFreeCubic(double a, double b, double c, const double *t1,
+                                const double *t2, double *integral) {
+  // poles p > 0 are the roots of p^3 - a p^2 + b p - c
+  double q = (a * a - 3.0 * b) / 9.0;
+  double r = (2.0 * a * a * a - 9.0 * a * b + 27.0 * c) / 54.0;
+  if (q <= 0.0 || r * r >= q * q * q) {
+    return false;
+  }
+
+  // largest root from the trigonometric solution, the others from the
+  // remaining quadratic to avoid cancellation
+  double theta = acos(r / sqrt(q * q * q));
+  double p[3];
+  p[2] = a / 3.0 + 2.0 * sqrt(q) * cos(theta / 3.0);
+  double s = a - p[2];
+  double d = s * s - 4.0 * c / p[2];
+  if (s <= 0.0 || d <= 0.0) {
+    return false;
+  }
+  p[1] = 0.5 * (s + sqrt(d));
+  p[0] = c / (p[2] * p[1]);
+
+  // polish with Newton steps on the cubic
+  for (int i = 0; i < 3; i++) {
+    for (int it = 0; it < 2; it++) {
+      double f = ((p[i] - a) * p[i] + b) * p[i] - c;
+      double df = (3.0 * p[i] - 2.0 * a) * p[i] + b;
+      p[i] -= f / df;
+    }
+    if (p[i] <= 0.0) {
+      return false;
+    }
+  }
+
+  double j[3];
+  for (int i = 0; i < 3; i++) {
+    double pj = p[(i + 1) % 3];
+    double pk = p[(i + 2) % 3];
+    if (fabs(pj - p[i]) < 1.0e-4 * p[2] || fabs(pk - p[i]) < 1.0e-4 * p[2]) {
+      return false;
+    }
+    j[i] = DispersionFreeTerm(p[i], pj, pk) / ((pj - p[i]) * (pk - p[i]));
+  }
+
+  DecadeEndPoints(a, b, c, t1, t2, integral);
+  for (int k = 0; k < 3; k++) {
+    for (int i = 0; i < 3; i++) {
+      integral[k] += (t2[k] - t1[k] * p[i]) * j[i];
+    }
+  }
+  return true;
+}
+
+/*
+================================================================================
+================================================================================
+CLOSED FORM BJORKEN-MTINGWA INTEGRALS FOR DISPERSION-FREE ELEMENTS.
+
+DETAILS:
+        FOR A DIAGONAL BEAM MATRIX DIAG(C3, CY, CL) THE INTEGRAND OF PLANE K
+        REDUCES TO
+
+        SQRT(L) / SQRT((L+C3)(L+CY)(L+CL)) * CK * (SUM_I 1/(L+CI) - 3/(L+CK))
+
+        WHICH IS THE DISPERSION-FREE LIMIT OF THE CONTE-MARTINI, MADX
+        ZIMMERMAN AND TWSINT INTEGRANDS. NO PARTIAL FRACTIONS ARE NEEDED, THE
+        RESULT IS REGULAR FOR COINCIDING POLES (ROUND BEAMS).
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+  REF:
+    - PRSTAB 8, 064403 (2005)
+
+================================================================================
+  Arguments:
+  ----------
+    - double c3
+        betx / ex
+    - double cy
+        bety / ey
+    - double cl
+        (gamma / sige)**2
+
+  Returns:
+  --------
+    double [3] tau
+      IBS growth rates for AMPLITUDES (SIGMA NOT EMIT -> MULTIPLY WITH TWO FOR
+      EMIT), SAME NORMALISATION AND DECADE RULE AS SimpsonDecade
+      0 -> al
+      1 -> ax
+      2 -> ay
+
+================================================================================
+================================================================================
+*/
+void DispersionFreeInt(double c3, double cy, double cl, double *tau) {
+  double jx = DispersionFreeTerm(c3, cy, cl);
+  double jy = DispersionFreeTerm(cy, cl, c3);
+  double jl = DispersionFreeTerm(cl, c3, cy);
+  double sum = jx + jy + jl;
+
+  // the same integrands in polynomial form for the end point terms
+  const double t1[3] = {cl * (2.0 * cl - c3 - cy), c3 * (2.0 * c3 - cy - cl),
+                        cy * (2.0 * cy - c3 - cl)};
+  const double t2[3] = {cl * ((c3 + cy) * cl - 2.0 * c3 * cy),
+                        c3 * (c3 * cy + cl * (c3 - 2.0 * cy)),
+                        cy * (c3 * cy + cl * (cy - 2.0 * c3))};
+  double correction[3];
+  DecadeEndPoints(c3 + cy + cl, c3 * cy + (c3 + cy) * cl, c3 * cy * cl, t1, t2,
+                  correction);
+
+  tau[0] = cl * (sum - 3.0 * jl) + correction[0];
+  tau[1] = c3 * (sum - 3.0 * jx) + correction[1];
+  tau[2] = cy * (sum - 3.0 * jy) + correction[2];
+}
 /*
 ================================================================================
 ================================================================================
@@ -447,6 +651,7 @@ void BjorkenMtingwaInt(double pnumber, double ex, double ey, double sigs,
                        double sige, double gammas, double betx, double bety,
                        double alx, double aly, double dx, double dpx, double dy,
                        double dpy, double *tau) {
+  PerfRegion perf("BjorkenMtingwaInt", 1, "integrator");
   const double one = 1.0;
   const double two = 2.0;
   const double three = 3.0;
@@ -486,6 +691,19 @@ void BjorkenMtingwaInt(double pnumber, double ex, double ey, double sigs,
   al = ax;
   bl = b;
 
+  // dispersion-free element, closed form instead of the Simpson decades
+  if (dx == 0.0 && dpx == 0.0) {
+    const double t1[3] = {al, ax, ay};
+    const double t2[3] = {bl, bx, by};
+    double integral[3];
+    if (DispersionFreeCubic(a, b, c, t1, t2, integral)) {
+      tau[0] = cl * integral[0];
+      tau[1] = cx * integral[1];
+      tau[2] = cy * integral[2];
+      return;
+    }
+  }
+
   // rescaling
   cscale = one;
   chklog = log10(c3) + log10(cy) + log10(c1 + cl);
@@ -574,6 +792,7 @@ void ConteMartiniInt(double pnumber, double ex, double ey, double sigs,
                      double sige, double gammas, double betx, double bety,
                      double alx, double aly, double dx, double dpx, double dy,
                      double dpy, double *tau) {
+  PerfRegion perf("ConteMartiniInt", 1, "integrator");
 
   // const double zero = 0.0;
   const double one = 1.0;
@@ -616,6 +835,12 @@ void ConteMartiniInt(double pnumber, double ex, double ey, double sigs,
   cy = bety / ey;
   cl = (gammas / sige) * (gammas / sige);
 
+  // dispersion-free element, the 1 / hxg2obx terms below are singular
+  if (dx == 0.0 && dpx == 0.0) {
+    DispersionFreeInt(c3, cy, cl, tau);
+    return;
+  }
+
   hxg2 = hx * gammas2;
 
   hxg2obx = hxg2 / betx;
@@ -725,6 +950,7 @@ SIMPSON DECADE INTEGRAL FOR MADX ZIMMERMAN INTEGRAND.
 void MadxInt(double pnumber, double ex, double ey, double sigs, double sige,
              double gammas, double betx, double bety, double alx, double aly,
              double dx, double dpx, double dy, double dpy, double *tau) {
+  PerfRegion perf("MadxInt", 1, "integrator");
   // const int maxdec = 30, ns = 50;
 
   // const double zero = 0.0;
@@ -763,6 +989,12 @@ void MadxInt(double pnumber, double ex, double ey, double sigs, double sige,
   cl = (gammas / sige) * (gammas / sige);
   c2y = cy * (gammas * phiy) * (gammas * phiy);
 
+  // dispersion-free element, the 1 / hxg2obx terms below are singular
+  if (dx == 0.0 && dpx == 0.0 && dy == 0.0 && dpy == 0.0) {
+    DispersionFreeInt(c3, cy, cl, tau);
+    return;
+  }
+
   hxg2 = hx * gammas * gammas;
   hyg2 = hy * gammas * gammas;
 
@@ -894,6 +1126,7 @@ REF:
 void twsint(double pnumber, double ex, double ey, double sigs, double sige,
             double gammas, double betax, double betay, double alx, double aly,
             double dx, double dpx, double dy, double dpy, double *tau) {
+  PerfRegion perf("twsint", 1, "integrator");
 
   // int iiz, iloop;
   int maxdec = 30, ns = 50;
@@ -940,6 +1173,12 @@ void twsint(double pnumber, double ex, double ey, double sigs, double sige,
   c2y = cy * (gammas * phiy) * (gammas * phiy);
   chy = c1y + c2y;
   r1 = three / cy;
+
+  // dispersion-free element, closed form instead of the Simpson decades
+  if (dx == zero && dpx == zero && dy == zero && dpy == zero) {
+    DispersionFreeInt(c3, cy, cl, tau);
+    return;
+  }
   a = cx + cl + chy + c3 + cy;
   b = (c3 + cy) * (c1 + cl + c1y) + cy * c2 + c3 * c2y + c3 * cy;
 
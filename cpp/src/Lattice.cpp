@@ -0,0 +1,138 @@
+#include "../include/ibs_bits/Lattice.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/OrdDiffEq.hpp"
+#include "../include/ibs_bits/twiss.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+size_t Lattice::Size() const {
+  auto it = table.find("L");
+  return it == table.end() ? 0 : it->second.size();
+}
+
+double Lattice::Header(const string &key) const {
+  auto it = header.find(key);
+  return it == header.end() ? 0.0 : it->second;
+}
+
+Span<const double> Lattice::Column(const string &key) const {
+  auto it = table.find(key);
+  if (it == table.end()) {
+    return Span<const double>();
+  }
+  return Span<const double>(it->second);
+}
+
+Span<double> Lattice::MutableColumn(const string &key) {
+  auto it = table.find(key);
+  if (it == table.end()) {
+    return Span<double>();
+  }
+  return Span<double>(it->second);
+}
+
+void Lattice::Prepare() { updateTwiss(table); }
+
+void Lattice::Release(map<string, double> &twissheader,
+                      map<string, vector<double>> &twisstable) {
+  twissheader = move(header);
+  twisstable = move(table);
+  header.clear();
+  table.clear();
+}
+
+bool ReadLattice(const string &filename, Lattice &lattice) {
+  if (!ReadTwiss(filename, lattice.HeaderMap(), lattice.TableMap())) {
+    return false;
+  }
+  lattice.Prepare();
+  return true;
+}
+
+bool IBSRates(int model, const BeamState &state, Lattice &lattice, double r0,
+              double aatom, Span<double> out) {
+  return IBSRates(model, state, lattice.HeaderMap(), lattice.TableMap(), r0,
+                  aatom, out);
+}
+
+bool IBSRatesBatch(int model, const BeamStates &states, Lattice &lattice,
+                   double r0, double aatom, MatrixView<double> out) {
+  return IBSRatesBatch(model, states, lattice.HeaderMap(), lattice.TableMap(),
+                       r0, aatom, out);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO RUN THE AUTO TIME STEP ODE ON A LATTICE.
+
+  THE TRAJECTORY, INCLUDING THE ENERGY SPREAD, IS WRITTEN TO THE BUFFERS OF
+  THE RESULT AND THE MAPS OF THE LATTICE ARE PASSED TO ODE BY REFERENCE, SUCH
+  THAT NO INPUT IS COPIED.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : energy spread in the result
+
+================================================================================
+  Arguments:
+  ----------
+    - Lattice &lattice
+        prepared lattice
+    - Span<const double> harmon
+        harmonic numbers of the rf systems
+    - Span<const double> voltages
+        voltages of the rf systems
+    - double pnumber
+        number of particles in the bunch
+    - double ex0
+        initial horizontal emittance
+    - double ey0
+        initial vertical emittance
+    - double sigs0
+        initial bunch length
+    - int model
+        integer to select the IBS models
+    - int couplingpercentage
+        horizontal betatron coupling
+    - double threshold
+        cutoff for relative changes in the values
+    - const string &method
+        method to use : rlx or der
+    - ODEResult &result
+        trajectory
+
+  Returns:
+  --------
+    bool
+        false for invalid rf systems or an empty lattice
+================================================================================
+================================================================================
+*/
+bool RunODE(Lattice &lattice, Span<const double> harmon,
+            Span<const double> voltages, double pnumber, double ex0,
+            double ey0, double sigs0, int model, int couplingpercentage,
+            double threshold, const string &method, ODEResult &result) {
+  if (harmon.empty() || harmon.size() != voltages.size() ||
+      lattice.Size() == 0) {
+    return false;
+  }
+
+  result.t.assign(1, 0.0);
+  result.ex.assign(1, ex0);
+  result.ey.assign(1, ey0);
+  result.sigs.assign(1, sigs0);
+
+  // the rf arrays are only read by ODE
+  double *h = const_cast<double *>(harmon.data());
+  double *v = const_cast<double *>(voltages.data());
+  ODE(lattice.HeaderMap(), lattice.TableMap(), harmon.size(), h, v, result.t,
+      result.ex, result.ey, result.sigs, result.sige, model, pnumber,
+      couplingpercentage, threshold, method, false);
+  return true;
+}
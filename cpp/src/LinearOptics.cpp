@@ -0,0 +1,351 @@
+#include "../include/ibs_bits/LinearOptics.hpp"
+#include "../include/ibs_bits/Arena.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+  BODY OF A THICK ELEMENT WITH FOCUSING K OVER LENGTH L
+
+    x'' + K x = h delta
+
+  c, s ARE THE COSINE AND SINE LIKE SOLUTIONS, d = (1 - c) / K THE DISPERSION
+  LIKE SOLUTION AND w = (L - s) / K ITS INTEGRAL OVER THE ELEMENT (SERIES FOR
+  SMALL K L^2).
+================================================================================
+*/
+static void LinearOpticsBody(double K, double L, double &c, double &s,
+                             double &cp, double &d, double &w) {
+  double phi2 = K * L * L;
+  if (fabs(phi2) < 1.0e-8) {
+    c = 1.0 - phi2 / 2.0;
+    s = L * (1.0 - phi2 / 6.0);
+    cp = -K * L;
+    d = L * L / 2.0 * (1.0 - phi2 / 12.0);
+    w = L * L * L / 6.0 * (1.0 - phi2 / 20.0);
+  } else if (K > 0.0) {
+    double sk = sqrt(K);
+    c = cos(sk * L);
+    s = sin(sk * L) / sk;
+    cp = -sk * sin(sk * L);
+    d = (1.0 - c) / K;
+    w = (L - s) / K;
+  } else {
+    double sk = sqrt(-K);
+    c = cosh(sk * L);
+    s = sinh(sk * L) / sk;
+    cp = sk * sinh(sk * L);
+    d = (1.0 - c) / K;
+    w = (L - s) / K;
+  }
+}
+
+// a = b a for the horizontal (two stored rows of 3x3) matrices
+static void LinearOpticsMultiplyX(const double *b, double *a) {
+  double r[6];
+  r[0] = b[0] * a[0] + b[1] * a[3];
+  r[1] = b[0] * a[1] + b[1] * a[4];
+  r[2] = b[0] * a[2] + b[1] * a[5] + b[2];
+  r[3] = b[3] * a[0] + b[4] * a[3];
+  r[4] = b[3] * a[1] + b[4] * a[4];
+  r[5] = b[3] * a[2] + b[4] * a[5] + b[5];
+  for (int k = 0; k < 6; k++) {
+    a[k] = r[k];
+  }
+}
+
+// a = b a for the vertical 2x2 matrices
+static void LinearOpticsMultiplyY(const double *b, double *a) {
+  double r[4];
+  r[0] = b[0] * a[0] + b[1] * a[2];
+  r[1] = b[0] * a[1] + b[1] * a[3];
+  r[2] = b[2] * a[0] + b[3] * a[2];
+  r[3] = b[2] * a[1] + b[3] * a[3];
+  for (int k = 0; k < 4; k++) {
+    a[k] = r[k];
+  }
+}
+
+// column data or NULL if the column is not in the table
+static const double *LinearOpticsColumn(map<string, vector<double>> &table,
+                                        const char *name, size_t n) {
+  auto it = table.find(name);
+  if (it == table.end() || it->second.size() != n) {
+    return NULL;
+  }
+  return it->second.data();
+}
+
+// strength columns of a table, optional ones are NULL if missing
+struct LinearOpticsColumns {
+  const double *l, *angle, *k1l, *e1, *e2, *fint, *hgap;
+
+  LinearOpticsColumns(map<string, vector<double>> &table, size_t n)
+      : l(LinearOpticsColumn(table, "L", n)),
+        angle(LinearOpticsColumn(table, "ANGLE", n)),
+        k1l(LinearOpticsColumn(table, "K1L", n)),
+        e1(LinearOpticsColumn(table, "E1", n)),
+        e2(LinearOpticsColumn(table, "E2", n)),
+        fint(LinearOpticsColumn(table, "FINT", n)),
+        hgap(LinearOpticsColumn(table, "HGAP", n)) {}
+
+  double get(const double *column, size_t i) const {
+    return column != NULL ? column[i] : 0.0;
+  }
+};
+
+static void LinearOpticsMatrix(const LinearOpticsColumns &cols, size_t i,
+                               ElementMatrix &m) {
+  double l = cols.l[i];
+  double angle = cols.angle[i];
+  double k1l = cols.k1l[i];
+
+  if (l == 0.0) {
+    double x[6] = {1.0, 0.0, 0.0, -k1l, 1.0, angle};
+    double y[4] = {1.0, 0.0, k1l, 1.0};
+    copy(x, x + 6, m.x);
+    copy(y, y + 4, m.y);
+    return;
+  }
+
+  double h = angle / l;
+  double k1 = k1l / l;
+  double c, s, cp, d, w;
+
+  LinearOpticsBody(h * h + k1, l, c, s, cp, d, w);
+  double x[6] = {c, s, h * d, cp, c, h * s};
+  copy(x, x + 6, m.x);
+
+  LinearOpticsBody(-k1, l, c, s, cp, d, w);
+  double y[4] = {c, s, cp, c};
+  copy(y, y + 4, m.y);
+
+  if (h == 0.0) {
+    return;
+  }
+
+  // edge focusing at entrance (e1) and exit (e2)
+  double e[2] = {cols.get(cols.e1, i), cols.get(cols.e2, i)};
+  double fint = cols.get(cols.fint, i);
+  double hgap = cols.get(cols.hgap, i);
+  for (int k = 0; k < 2; k++) {
+    double psi = 0.0;
+    if (fint != 0.0 && hgap != 0.0) {
+      psi = 2.0 * h * hgap * fint * (1.0 + sin(e[k]) * sin(e[k])) / cos(e[k]);
+    }
+    if (e[k] == 0.0 && psi == 0.0) {
+      continue;
+    }
+    double ex[6] = {1.0, 0.0, 0.0, h * tan(e[k]), 1.0, 0.0};
+    double ey[4] = {1.0, 0.0, -h * tan(e[k] - psi), 1.0};
+    if (k == 0) {
+      // entrance edge acts first
+      LinearOpticsMultiplyX(m.x, ex);
+      LinearOpticsMultiplyY(m.y, ey);
+      copy(ex, ex + 6, m.x);
+      copy(ey, ey + 4, m.y);
+    } else {
+      LinearOpticsMultiplyX(ex, m.x);
+      LinearOpticsMultiplyY(ey, m.y);
+    }
+  }
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE UNCOUPLED TRANSFER MATRICES OF AN ELEMENT
+
+  THICK ELEMENTS :
+    HORIZONTAL K = h^2 + k1, VERTICAL K = -k1 WITH h = ANGLE / L, k1 = K1L / L
+    EDGES : HORIZONTAL m21 = h tan(e), VERTICAL m21 = -h tan(e - psi),
+            psi = 2 h HGAP FINT (1 + sin^2 e) / cos e
+
+  THIN ELEMENTS :
+    HORIZONTAL m21 = -K1L, m23 = ANGLE, VERTICAL m21 = K1L
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, vector<double>> &table
+        twiss table
+    - size_t i
+        element index
+    - ElementMatrix &m
+        output variable - transfer matrices
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void LinearOpticsElementMatrix(map<string, vector<double>> &table, size_t i,
+                               ElementMatrix &m) {
+  LinearOpticsColumns cols(table, table["L"].size());
+  if (cols.l == NULL || cols.angle == NULL || cols.k1l == NULL) {
+    ElementMatrix unit = {{1.0, 0.0, 0.0, 0.0, 1.0, 0.0}, {1.0, 0.0, 0.0, 1.0}};
+    m = unit;
+    return;
+  }
+  LinearOpticsMatrix(cols, i, m);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO RECOMPUTE THE PERIODIC UNCOUPLED OPTICS FROM THE ELEMENT STRENGTHS
+
+  ONE-TURN MATRIX M :
+    cos mu = (m11 + m22) / 2, sin mu = sign(m12) sqrt(1 - cos^2 mu)
+    beta = m12 / sin mu, alpha = (m11 - m22) / (2 sin mu)
+    (I - M) (D, D') = (m13, m23)
+
+  PROPAGATION THROUGH AN ELEMENT :
+    beta'  = m11^2 beta - 2 m11 m12 alpha + m12^2 gamma
+    alpha' = -m11 m21 beta + (m11 m22 + m12 m21) alpha - m12 m22 gamma
+    dmu    = atan2(m12, m11 beta - m12 alpha)
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &table
+        twiss table
+
+  Returns:
+  --------
+    bool
+      true if both planes are stable
+
+================================================================================
+================================================================================
+*/
+bool PeriodicLinearOptics(map<string, double> &twiss,
+                          map<string, vector<double>> &table) {
+  size_t n = table["L"].size();
+  PerfRegion perf("PeriodicLinearOptics", n, "lattice");
+  LinearOpticsColumns cols(table, n);
+  if (n == 0 || cols.l == NULL || cols.angle == NULL || cols.k1l == NULL) {
+    return false;
+  }
+
+  ArenaScope scope;
+  ElementMatrix *m = ThreadArena().Allocate<ElementMatrix>(n);
+
+  // one-turn matrices
+  double mx[6] = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  double my[4] = {1.0, 0.0, 0.0, 1.0};
+  for (size_t i = 0; i < n; i++) {
+    LinearOpticsMatrix(cols, i, m[i]);
+    LinearOpticsMultiplyX(m[i].x, mx);
+    LinearOpticsMultiplyY(m[i].y, my);
+  }
+
+  double cosx = (mx[0] + mx[4]) / 2.0;
+  double cosy = (my[0] + my[3]) / 2.0;
+  if (!(fabs(cosx) < 1.0 && fabs(cosy) < 1.0)) {
+    return false;
+  }
+  double sinx = copysign(sqrt(1.0 - cosx * cosx), mx[1]);
+  double siny = copysign(sqrt(1.0 - cosy * cosy), my[1]);
+
+  double bx = mx[1] / sinx;
+  double ax = (mx[0] - mx[4]) / (2.0 * sinx);
+  double by = my[1] / siny;
+  double ay = (my[0] - my[3]) / (2.0 * siny);
+  double det = (1.0 - mx[0]) * (1.0 - mx[4]) - mx[1] * mx[3];
+  double dx = ((1.0 - mx[4]) * mx[2] + mx[1] * mx[5]) / det;
+  double dpx = (mx[3] * mx[2] + (1.0 - mx[0]) * mx[5]) / det;
+
+  vector<double> *columns[8] = {&table["BETX"], &table["ALFX"], &table["BETY"],
+                                &table["ALFY"], &table["DX"],   &table["DPX"],
+                                &table["DY"],   &table["DPY"]};
+  for (int c = 0; c < 8; c++) {
+    columns[c]->resize(n);
+  }
+  double *betx = columns[0]->data(), *alfx = columns[1]->data();
+  double *bety = columns[2]->data(), *alfy = columns[3]->data();
+  double *disx = columns[4]->data(), *dispx = columns[5]->data();
+  double *disy = columns[6]->data(), *dispy = columns[7]->data();
+
+  auto propagate = [](const double *r, double &beta, double &alpha) {
+    double gamma = (1.0 + alpha * alpha) / beta;
+    double b = r[0] * r[0] * beta - 2.0 * r[0] * r[1] * alpha +
+               r[1] * r[1] * gamma;
+    double a = -r[0] * r[2] * beta + (r[0] * r[3] + r[1] * r[2]) * alpha -
+               r[1] * r[3] * gamma;
+    double dmu = atan2(r[1], r[0] * beta - r[1] * alpha);
+    beta = b;
+    alpha = a;
+    return dmu < 0.0 ? dmu + 2.0 * pi : dmu;
+  };
+
+  double mux = 0.0, muy = 0.0, i1 = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    // momentum compaction, dispersion integrated over the bends
+    double l = cols.l[i], angle = cols.angle[i];
+    if (angle != 0.0 && l == 0.0) {
+      i1 += angle * dx;
+    } else if (angle != 0.0) {
+      double h = angle / l;
+      double c, s, cp, d, w;
+      LinearOpticsBody(h * h + cols.k1l[i] / l, l, c, s, cp, d, w);
+      double dp0 = dpx + h * tan(cols.get(cols.e1, i)) * dx;
+      i1 += h * (dx * s + dp0 * d + h * w);
+    }
+
+    const double *r = m[i].x;
+    double rx[4] = {r[0], r[1], r[3], r[4]};
+    mux += propagate(rx, bx, ax);
+    muy += propagate(m[i].y, by, ay);
+    double d = r[0] * dx + r[1] * dpx + r[2];
+    dpx = r[3] * dx + r[4] * dpx + r[5];
+    dx = d;
+
+    betx[i] = bx;
+    alfx[i] = ax;
+    bety[i] = by;
+    alfy[i] = ay;
+    disx[i] = dx;
+    dispx[i] = dpx;
+    disy[i] = 0.0;
+    dispy[i] = 0.0;
+  }
+
+  updateTwiss(table);
+
+  twiss["Q1"] = mux / (2.0 * pi);
+  twiss["Q2"] = muy / (2.0 * pi);
+
+  double len = twiss["LENGTH"];
+  if (!(len > 0.0)) {
+    len = 0.0;
+    for (size_t i = 0; i < n; i++) {
+      len += cols.l[i];
+    }
+    twiss["LENGTH"] = len;
+  }
+  twiss["ALFA"] = i1 / len;
+  if (i1 > 0.0) {
+    twiss["GAMMATR"] = 1.0 / sqrt(twiss["ALFA"]);
+  }
+  return true;
+}
@@ -1,6 +1,10 @@
+#include "../include/ibs_bits/Arena.hpp"
 #include "../include/ibs_bits/CoulombLogFunctions.hpp"
 #include "../include/ibs_bits/Integrators.hpp"
+#include "../include/ibs_bits/Models.hpp"
 #include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include "../include/ibs_bits/Views.hpp"
 #include <iostream>
 #include <map>
 #include <math.h>
@@ -92,10 +96,11 @@ IBS MODEL PIWINSKI SMOOTH LATTICE APPROXIMATION USING RING AVERAGES
 */
 double *PiwinskiSmooth(double pnumber, double ex, double ey, double sigs,
                        double dponp, map<string, double> &twiss, double r0) {
+  PerfRegion perf("PiwinskiSmooth", 1, "model");
   const double c = 299792458.0;
   const double pi = 3.141592653589793;
 
-  static double output[3];
+  static thread_local double output[3];
 
   double gamma = twiss["GAMMA"];
   double len = twiss["LENGTH"];
@@ -145,6 +150,402 @@ double *PiwinskiSmooth(double pnumber, double ex, double ey, double sigs,
   return output;
 }
 
+/*
+================================================================================
+================================================================================
+ELEMENT KERNELS OF THE LATTICE MODELS
+
+  THE LOOP BODY OF EVERY LATTICE MODEL IS WRITTEN ONCE. IBSElementKernel
+  RETURNS THE TERMS OF ONE ELEMENT IN THE LATTICE SUMS OF THE MODEL AND
+  IBSElementNormalize APPLIES THE FACTORS THAT THE MODEL TAKES OUT OF THE
+  SUMS. THE MODEL FUNCTIONS, IBSElementRates AND IBSRatesBatch ARE ALL BUILT
+  FROM THESE TWO.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : lattice sums and normalisation separated, shared by the
+                   model functions
+
+================================================================================
+================================================================================
+*/
+// Twiss columns read by the element kernels, resolved once per lattice pass
+struct IBSElementColumns {
+  const double *l, *bx, *by, *ax, *ay, *dx, *dpx, *dy, *dpy;
+  const double *angle, *k1l, *k1sl;
+};
+
+static bool IBSElementTailcut(int model) {
+  return model == 5 || model == 7 || model == 10 || model == 12;
+}
+
+void IBSElementRingSetup(map<string, double> &twissheader,
+                         IBSElementRing &ring) {
+  ring.gamma = twissheader["GAMMA"];
+  ring.charge = twissheader["CHARGE"];
+  ring.circ = twissheader["LENGTH"];
+  ring.en0 = twissheader["ENERGY"];
+  ring.amass = twissheader["MASS"];
+  ring.betar = sqrt(1 - 1 / (ring.gamma * ring.gamma));
+}
+
+static void IBSElementColumnsSetup(int model,
+                                   map<string, vector<double>> &twissdata,
+                                   IBSElementColumns &cols) {
+  cols.l = twissdata["L"].data();
+  cols.bx = twissdata["BETX"].data();
+  cols.by = twissdata["BETY"].data();
+  cols.ax = twissdata["ALFX"].data();
+  cols.ay = twissdata["ALFY"].data();
+  cols.dx = twissdata["DX"].data();
+  cols.dpx = twissdata["DPX"].data();
+  cols.dy = twissdata["DY"].data();
+  cols.dpy = twissdata["DPY"].data();
+  cols.angle = NULL;
+  cols.k1l = NULL;
+  cols.k1sl = NULL;
+  if (IBSElementTailcut(model)) {
+    cols.angle = twissdata["ANGLE"].data();
+    cols.k1l = twissdata["K1L"].data();
+    cols.k1sl = twissdata["K1SL"].data();
+  }
+}
+
+static void IBSElementLoad(const IBSElementColumns &cols, int i,
+                           IBSElementOptics &e) {
+  e.l = cols.l[i];
+  e.bx = cols.bx[i];
+  e.by = cols.by[i];
+  e.ax = cols.ax[i];
+  e.ay = cols.ay[i];
+  e.dx = cols.dx[i];
+  e.dpx = cols.dpx[i];
+  e.dy = cols.dy[i];
+  e.dpy = cols.dpy[i];
+  e.angle = cols.angle != NULL ? cols.angle[i] : 0.0;
+  e.k1l = cols.k1l != NULL ? cols.k1l[i] : 0.0;
+  e.k1sl = cols.k1sl != NULL ? cols.k1sl[i] : 0.0;
+}
+
+// terms of one element in the lattice sums of the model (loop body)
+static void IBSElementKernel(int model, const IBSElementRing &ring,
+                             const IBSElementOptics &e, double pnumber,
+                             double ex, double ey, double sigs, double dponp,
+                             map<string, double> &twissheader, double r0,
+                             double aatom, double *out) {
+  double gamma = ring.gamma;
+  double charge = ring.charge;
+  double circ = ring.circ;
+  double en0 = ring.en0;
+  double amass = ring.amass;
+  double betar = ring.betar;
+
+  double l = e.l;
+  double bx = e.bx;
+  double by = e.by;
+  double ax = e.ax;
+  double ay = e.ay;
+  double dx = e.dx;
+  double dpx = e.dpx;
+  double dy = e.dy;
+  double dpy = e.dpy;
+
+  double integrals[3];
+  double clog[2];
+
+  switch (model) {
+  case 1: {
+    // smooth approximation has no lattice sum, weight the ring average
+    double *ibs = PiwinskiSmooth(pnumber, ex, ey, sigs, dponp, twissheader, r0);
+    out[0] = ibs[0] * l;
+    out[1] = ibs[1] * l;
+    out[2] = ibs[2] * l;
+    break;
+  }
+  case 2:
+  case 3: {
+    // fmohl accuracy
+    int npp = 1000;
+    double atop = r0 * r0 * clight * pnumber;
+    double abot = 64.0 * pi * pi * betar * betar * betar * gamma * gamma *
+                  gamma * gamma * ex * ey * sigs * dponp;
+    double ca = atop / abot;
+
+    double rmsx = sqrt(bx * ex);
+    double rmsy = sqrt(by * ey);
+    double d = (rmsx <= rmsy) ? rmsx : rmsy;
+
+    double sigh2inv;
+    if (model == 2) {
+      sigh2inv = (1.0 / (dponp * dponp)) + (dx * dx / (rmsx * rmsx));
+    } else {
+      // curly H with dpx
+      double H0 = dx;
+      double H1 = bx * dpx + ax * dx;
+      double H = (H0 * H0 + H1 * H1) / bx;
+      sigh2inv = (1.0 / (dponp * dponp)) + (H / ex);
+    }
+    double sigh = 1.0 / sqrt(sigh2inv);
+
+    double a = sigh * bx / (gamma * rmsx);
+    double b = sigh * by / (gamma * rmsy);
+    double q = sigh * betar * sqrt(2.0 * d / r0);
+
+    // calc fmohl values
+    double fmohlp = fmohl(a, b, q, npp);
+    double fmohlx = fmohl(1 / a, b / a, q / a, npp);
+    double fmohly = fmohl(1 / b, a / b, q / b, npp);
+
+    // calc IBS growth times ( AMPLITUDE - NOT EMITTANCE )
+    out[0] = ca * fmohlp * (sigh * sigh / (dponp * dponp)) * l;
+    out[1] = ca * (fmohlx + fmohlp * dx * dx * sigh * sigh / (rmsx * rmsx)) * l;
+    out[2] = ca * fmohly * l;
+    break;
+  }
+  case 4:
+  case 5: {
+    double phi = dpx + (ax * (dx / bx));
+    double axx = bx / ex;
+    double ayy = by / ey;
+
+    double sigmax = sqrt(dx * dx * dponp * dponp + ex * bx);
+    double sigmay = sqrt(ey * by);
+
+    double as =
+        axx * (dx * dx / (bx * bx) + phi * phi) + (1.0 / (dponp * dponp));
+    double a1 = 0.5 * (axx + gamma * gamma * as);
+    double a2 = 0.5 * (axx - gamma * gamma * as);
+    double b1 = sqrt(a2 * a2 + gamma * gamma * axx * axx * phi * phi);
+
+    double lambda1 = ayy;
+    double lambda2 = a1 + b1;
+    double lambda3 = a1 - b1;
+
+    double R1 = (1.0 / lambda1) *
+                rds((1.0 / lambda2), (1.0 / lambda3), (1.0 / lambda1));
+    double R2 = (1.0 / lambda2) *
+                rds((1.0 / lambda3), (1.0 / lambda1), (1.0 / lambda2));
+    double R3 = 3.0 * sqrt((lambda1 * lambda2) / lambda3) -
+                (lambda1 / lambda3) * R1 - (lambda2 / lambda3) * R2;
+
+    double sp = (gamma * gamma / 2.0) * (2.0 * R1 - R2 * (1.0 - 3.0 * a2 / b1) -
+                                         R3 * (1.0 + 3.0 * a2 / b1));
+    double sx = 0.5 * (2.0 * R1 - R2 * (1.0 + 3.0 * a2 / b1) -
+                       R3 * (1.0 - 3.0 * a2 / b1));
+    double sxp = (3.0 * gamma * gamma * phi * phi * axx) / b1 * (R3 - R2);
+
+    double alfapp = sp / (sigmax * sigmay);
+    double alfaxx = (bx / (sigmax * sigmay)) *
+                    (sx + sxp + sp * (dx * dx / (bx * bx) + phi * phi));
+    double alfayy = (by / (sigmax * sigmay)) * (-2.0 * R1 + R2 + R3);
+
+    if (model == 4) {
+      twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
+             dponp, sigs, clog);
+    } else {
+      twclogtail(pnumber, l, bx, by, dx, dpx, dy, dpy, ax, ay, e.angle,
+                 e.k1l, e.k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass,
+                 charge, dponp, sigs, clog);
+    }
+    out[0] = alfapp * l * clog[0];
+    out[1] = alfaxx * l * clog[0];
+    out[2] = alfayy * l * clog[0];
+    break;
+  }
+  case 6:
+    //---- IBSIntegrator calculates the Bjorken/Mtingwa integral.
+    twsint(pnumber, ex, ey, sigs, dponp, gamma, bx, by, ax, ay, betar * dx,
+           betar * dpx, betar * dy, betar * dpy, integrals);
+    twclog(pnumber, bx, by, betar * dx, betar * dy, ex, ey, r0, gamma, charge,
+           en0, amass, dponp, sigs, clog);
+    out[0] = integrals[0] * l * clog[1];
+    out[1] = integrals[1] * l * clog[1];
+    out[2] = integrals[2] * l * clog[1];
+    break;
+  case 7:
+    twsint(pnumber, ex, ey, sigs, dponp, gamma, bx, by, ax, ay, dx, dpx, dy,
+           dpy, integrals);
+    twclogtail(pnumber, l, bx, by, dx, dpx, dy, dpy, ax, ay, e.angle, e.k1l,
+               e.k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass, charge,
+               dponp, sigs, clog);
+    out[0] = integrals[0] * l * clog[1];
+    out[1] = integrals[1] * l * clog[1];
+    out[2] = integrals[2] * l * clog[1];
+    break;
+  case 8: {
+    double gamma2 = gamma * gamma;
+    double dponp2 = dponp * dponp;
+    double dx2 = dx * dx;
+    double bx2 = bx * bx;
+    double bxy = bx * by;
+    double exy = ex * ey;
+
+    double c1 = (bx / ex + by / ey);
+    double gd2 = gamma2 / dponp2;
+    double phix = dpx + (ax * (dx / bx));
+    double phix2 = phix * phix;
+    double hx = (dx2 + bx2 * phix2) / bx;
+
+    double a = (gamma2 * hx / ex) + gd2;
+    double b = c1 * (gamma2 * dx2 / (ex * bx) + gd2) +
+               (gamma2 * phix2 * bx * by / (ex * ey));
+    double c = (bxy / exy) * (gamma2 * dx2 / (ex * bx) + gd2);
+
+    double axx = 2.0 * gamma2 * hx / ex + 2.0 * gd2;
+    double bxx =
+        c1 * ((gamma2 * hx * hx / ex) + gd2) - bx2 / (ex * ex) * gamma2 * phix2;
+    double al = 2.0 * gamma2 * (hx / ex + 1.0 / dponp2);
+    double bl = b;
+    double ayy = -gamma2 * hx / ex - gd2;
+    double byy = b - 3.0 * bx / ex * (gamma2 * dx2 / (ex * bx) + gd2);
+
+    intSimpson(IBSIntegralIntegrand, axx, bxx, ayy, byy, al, bl, a, b, c,
+               integrals);
+    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
+           dponp, sigs, clog);
+
+    out[0] = l * gd2 * integrals[0] * clog[1];
+    out[1] = l * hx * integrals[1] * clog[1];
+    out[2] = l * by * integrals[2] * clog[1];
+    break;
+  }
+  case 9:
+    BjorkenMtingwaInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx,
+                      by, ax, ay, betar * dx, betar * dpx, betar * dy,
+                      betar * dpy, integrals);
+    twclog(pnumber, bx, by, betar * dx, 0.0, ex, ey, r0, gamma, charge, en0,
+           amass, dponp, sigs, clog);
+    out[0] = l * integrals[0] * clog[1];
+    out[1] = l * integrals[1] * clog[1];
+    out[2] = l * integrals[2] * clog[1];
+    break;
+  case 10:
+  case 12:
+    if (model == 10) {
+      BjorkenMtingwaInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma,
+                        bx, by, ax, ay, dx, dpx, dy, dpy, integrals);
+    } else {
+      ConteMartiniInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx,
+                      by, ax, ay, dx, dpx, dy, dpy, integrals);
+    }
+    twclogtail(pnumber, l, bx, by, dx, dpx, dy, dpy, ax, ay, e.angle, e.k1l,
+               e.k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass, charge,
+               dponp, sigs, clog);
+    out[0] = l * integrals[0] * clog[1];
+    out[1] = l * integrals[1] * clog[1];
+    out[2] = l * integrals[2] * clog[1];
+    break;
+  case 11:
+  case 13:
+    if (model == 11) {
+      ConteMartiniInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx,
+                      by, ax, ay, dx, dpx, betar * dy, betar * dpy, integrals);
+    } else {
+      MadxInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx, by, ax,
+              ay, dx, dpx, betar * dy, betar * dpy, integrals);
+    }
+    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
+           dponp, sigs, clog);
+    out[0] = l * integrals[0] * clog[1];
+    out[1] = l * integrals[1] * clog[1];
+    out[2] = l * integrals[2] * clog[1];
+    break;
+  default:
+    out[0] = 0.0;
+    out[1] = 0.0;
+    out[2] = 0.0;
+  }
+}
+
+// factors of the model outside the lattice sums, sum -> growth rates
+static void IBSElementNormalize(int model, const IBSElementRing &ring,
+                                double pnumber, double ex, double ey,
+                                double sigs, double dponp, double r0,
+                                const double *sum, double *out) {
+  double circ = ring.circ;
+  switch (model) {
+  case 1:
+  case 2:
+  case 3:
+    out[0] = sum[0] / circ;
+    out[1] = sum[1] / circ;
+    out[2] = sum[2] / circ;
+    break;
+  case 4:
+  case 5: {
+    double betar = ring.betar;
+    double gamma = ring.gamma;
+    double betar3 = betar * betar * betar;
+    double gamma5 = gamma * gamma * gamma * gamma * gamma;
+    // factor 2.0 is due to converstion to amplitudes from emittances
+    out[0] = sum[0] / (dponp * dponp) * (pnumber * r0 * r0 * clight) /
+             (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / circ;
+    out[1] = sum[1] / ex * (pnumber * r0 * r0 * clight) /
+             (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / circ;
+    out[2] = sum[2] / ey * (pnumber * r0 * r0 * clight) /
+             (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / circ;
+    break;
+  }
+  case 8: {
+    double gamma2 = ring.gamma * ring.gamma;
+    out[0] = sum[0] / circ / 2.0;
+    out[1] = sum[1] * (gamma2 / ex / circ) / 2.0;
+    out[2] = sum[2] * (1.0 / ey / circ) / 2.0;
+    break;
+  }
+  case 6:
+  case 7:
+  case 9:
+  case 10:
+  case 11:
+  case 12:
+  case 13:
+    // factor 2 for converting to amplitudes from emit growth rates
+    out[0] = sum[0] / circ / 2.0;
+    out[1] = sum[1] / circ / 2.0;
+    out[2] = sum[2] / circ / 2.0;
+    break;
+  default:
+    out[0] = 0.0;
+    out[1] = 0.0;
+    out[2] = 0.0;
+  }
+}
+
+// lattice sums of a model over the Twiss table, normalised to growth rates
+static void IBSLatticeRates(int model, double pnumber, double ex, double ey,
+                            double sigs, double dponp,
+                            map<string, double> &twissheader,
+                            map<string, vector<double>> &twissdata, double r0,
+                            double aatom, double *out) {
+  IBSElementRing ring;
+  IBSElementRingSetup(twissheader, ring);
+  IBSElementColumns cols;
+  IBSElementColumnsSetup(model, twissdata, cols);
+
+  double alfap0 = 0.0;
+  double alfax0 = 0.0;
+  double alfay0 = 0.0;
+
+  int n = twissdata["L"].size();
+#pragma omp parallel for reduction(+ : alfap0, alfax0, alfay0)
+  for (int i = 0; i < n; i++) {
+    IBSElementOptics e;
+    IBSElementLoad(cols, i, e);
+    double terms[3];
+    IBSElementKernel(model, ring, e, pnumber, ex, ey, sigs, dponp, twissheader,
+                     r0, aatom, terms);
+    alfap0 += terms[0];
+    alfax0 += terms[1];
+    alfay0 += terms[2];
+  }
+
+  double sum[3] = {alfap0, alfax0, alfay0};
+  IBSElementNormalize(model, ring, pnumber, ex, ey, sigs, dponp, r0, sum,
+                      out);
+}
+
 /*
 ================================================================================
 ================================================================================
@@ -159,6 +560,7 @@ IBS MODEL PIWINSKI LATTICE ELEMENT BY ELEMENT
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
     - HANDBOOK FOR ACCELERATOR PHYSICISTS AND ENGINEERS P.126
@@ -197,65 +599,11 @@ IBS MODEL PIWINSKI LATTICE ELEMENT BY ELEMENT
 double *PiwinskiLattice(double pnumber, double ex, double ey, double sigs,
                         double dponp, map<string, double> &twissheader,
                         map<string, vector<double>> &twissdata, double r0) {
-  const double c = clight;
-
-  static double output[3];
-  double gamma = twissheader["GAMMA"];
-  double len = twissheader["LENGTH"];
-
-  // necessary parameters
-  // double r0 = charge * charge / aatom * 1.54e-18;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-
-  double atop = r0 * r0 * c * pnumber;
-  double abot = 64.0 * pi * pi * betar * betar * betar * gamma * gamma * gamma *
-                gamma * ex * ey * sigs * dponp;
-  double ca = atop / abot;
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-
-  int n = twissdata["L"].size();
-#pragma omp parallel for shared(twissdata) reduction(+ : alfax0, alfay0, alfap0)
-  for (int i = 0; i < n; i++) {
-    // fmohl accuracy
-    int npp = 1000;
-
-    // local naming of twiss data
-    // making code more readable (?efficiency)
-    double *L = &twissdata["L"][i];
-    double *bx = &twissdata["BETX"][i];
-    double *by = &twissdata["BETY"][i];
-    double *dx = &twissdata["DX"][i];
-
-    double rmsx = sqrt(*bx * ex);
-    double rmsy = sqrt(*by * ey);
-    double d = (rmsx <= rmsy) ? rmsx : rmsy;
-
-    double sigh2inv = (1.0 / (dponp * dponp)) + (*dx * *dx / (rmsx * rmsx));
-    double sigh = 1.0 / sqrt(sigh2inv);
+  PerfRegion perf("PiwinskiLattice", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-    double a = sigh * *bx / (gamma * rmsx);
-    double b = sigh * *by / (gamma * rmsy);
-    double q = sigh * betar * sqrt(2.0 * d / r0);
-
-    // calc fmohl values
-    double fmohlp = fmohl(a, b, q, npp);
-    double fmohlx = fmohl(1 / a, b / a, q / a, npp);
-    double fmohly = fmohl(1 / b, a / b, q / b, npp);
-
-    // calc IBS growth times ( AMPLITUDE - NOT EMITTANCE )
-    alfap0 += ca * fmohlp * (sigh * sigh / (dponp * dponp)) * *L;
-    alfax0 +=
-        ca * (fmohlx + fmohlp * *dx * *dx * sigh * sigh / (rmsx * rmsx)) * *L;
-    alfay0 += ca * fmohly * *L;
-  }
-  // factor two is to convert to emittance growth rates
-  output[0] = alfap0 / len;
-  output[1] = alfax0 / len;
-  output[2] = alfay0 / len;
+  IBSLatticeRates(2, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -274,6 +622,7 @@ IBS MODEL PIWINSKI LATTICE MODIFIED TAKING DPX INTO ACCOUNT IN CURLY H
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
     - HANDBOOK FOR ACCELERATOR PHYSICISTS AND ENGINEERS P.126
@@ -314,70 +663,11 @@ double *PiwinskiLatticeModified(double pnumber, double ex, double ey,
                                 map<string, double> &twissheader,
                                 map<string, vector<double>> &twissdata,
                                 double r0) {
-  const double c = clight;
-
-  static double output[3];
-  double gamma = twissheader["GAMMA"];
-  double len = twissheader["LENGTH"];
-
-  // necessary parameters
-  // double r0 = charge * charge / aatom * 1.54e-18;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-
-  double atop = r0 * r0 * c * pnumber;
-  double abot = 64.0 * pi * pi * betar * betar * betar * gamma * gamma * gamma *
-                gamma * ex * ey * sigs * dponp;
-  double ca = atop / abot;
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfax0, alfay0, alfap0)
-  for (int i = 0; i < n; i++) {
-    // local naming
-    double *L = &twissdata["L"][i];
-    double *bx = &twissdata["BETX"][i];
-    double *by = &twissdata["BETY"][i];
-    double *dx = &twissdata["DX"][i];
-    double *dpx = &twissdata["DPX"][i];
-    double *alfx = &twissdata["ALFX"][i];
-
-    // fmohl accuracy
-    int npp = 1000;
-
-    double H0 = *dx;
-    double H1 = *bx * *dpx + *alfx * *dx;
-    double H = (H0 * H0 + H1 * H1) / *bx;
-
-    double rmsx = sqrt(*bx * ex);
-    double rmsy = sqrt(*by * ey);
-    double d = (rmsx <= rmsy) ? rmsx : rmsy;
-
-    double sigh2inv = (1.0 / (dponp * dponp)) + (H / ex);
-    double sigh = 1.0 / sqrt(sigh2inv);
-
-    double a = sigh * *bx / (gamma * rmsx);
-    double b = sigh * *by / (gamma * rmsy);
-    double q = sigh * betar * sqrt(2.0 * d / r0);
-
-    // calc fmohl values
-    double fmohlp = fmohl(a, b, q, npp);
-    double fmohlx = fmohl(1 / a, b / a, q / a, npp);
-    double fmohly = fmohl(1 / b, a / b, q / b, npp);
-
-    // calc IBS growth times ( AMPLITUDE - NOT EMITTANCE )
-    alfap0 += ca * fmohlp * (sigh * sigh / (dponp * dponp)) * *L;
-    alfax0 +=
-        ca * (fmohlx + fmohlp * *dx * *dx * sigh * sigh / (rmsx * rmsx)) * *L;
-    alfay0 += ca * fmohly * *L;
-  }
+  PerfRegion perf("PiwinskiLatticeModified", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  output[0] = alfap0 / len;
-  output[1] = alfax0 / len;
-  output[2] = alfay0 / len;
+  IBSLatticeRates(3, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -396,6 +686,7 @@ IBS MODEL NAGAITSEV
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         PRSTAB 8, 064403 (2005)
@@ -434,88 +725,11 @@ IBS MODEL NAGAITSEV
 double *Nagaitsev(double pnumber, double ex, double ey, double sigs,
                   double dponp, map<string, double> &twissheader,
                   map<string, vector<double>> &twissdata, double r0) {
-  const double c = clight;
-
-  static double output[3];
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double len = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // necessary parameters
-  // double r0 = charge * charge / aatom * 1.54e-18;
+  PerfRegion perf("Nagaitsev", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  // initialize
-  double alfax0 = 0.0f;
-  double alfay0 = 0.0f;
-  double alfap0 = 0.0f;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  double betar3 = betar * betar * betar;
-  double gamma5 = gamma * gamma * gamma * gamma * gamma;
-
-  int n = twissdata["L"].size();
-#pragma omp parallel for shared(twissdata,len) reduction(+: alfap0, alfax0,alfay0)
-  for (int i = 0; i < n; i++) {
-    // local naming
-    double *L = &twissdata["L"][i];
-    double *bx = &twissdata["BETX"][i];
-    double *by = &twissdata["BETY"][i];
-    double *dx = &twissdata["DX"][i];
-    double *dpx = &twissdata["DPX"][i];
-    double *alfx = &twissdata["ALFX"][i];
-
-    double phi = *dpx + (*alfx * (*dx / *bx));
-    double axx = *bx / ex;
-    double ayy = *by / ey;
-
-    double sigmax = sqrt(*dx * *dx * dponp * dponp + ex * *bx);
-    double sigmay = sqrt(ey * *by);
-
-    double as =
-        axx * (*dx * *dx / (*bx * *bx) + phi * phi) + (1.0 / (dponp * dponp));
-    double a1 = 0.5 * (axx + gamma * gamma * as);
-    double a2 = 0.5 * (axx - gamma * gamma * as);
-    double b1 = sqrt(a2 * a2 + gamma * gamma * axx * axx * phi * phi);
-
-    double lambda1 = ayy;
-    double lambda2 = a1 + b1;
-    double lambda3 = a1 - b1;
-
-    double R1 = (1.0 / lambda1) *
-                rds((1.0 / lambda2), (1.0 / lambda3), (1.0 / lambda1));
-    double R2 = (1.0 / lambda2) *
-                rds((1.0 / lambda3), (1.0 / lambda1), (1.0 / lambda2));
-    double R3 = 3.0 * sqrt((lambda1 * lambda2) / lambda3) -
-                (lambda1 / lambda3) * R1 - (lambda2 / lambda3) * R2;
-
-    double sp = (gamma * gamma / 2.0) * (2.0 * R1 - R2 * (1.0 - 3.0 * a2 / b1) -
-                                         R3 * (1.0 + 3.0 * a2 / b1));
-    double sx = 0.5 * (2.0 * R1 - R2 * (1.0 + 3.0 * a2 / b1) -
-                       R3 * (1.0 - 3.0 * a2 / b1));
-    double sxp = (3.0 * gamma * gamma * phi * phi * axx) / b1 * (R3 - R2);
-
-    double alfapp = sp / (sigmax * sigmay);
-    double alfaxx = (*bx / (sigmax * sigmay)) *
-                    (sx + sxp + sp * (*dx * *dx / (*bx * *bx) + phi * phi));
-    double alfayy = (*by / (sigmax * sigmay)) * (-2.0 * R1 + R2 + R3);
-
-    double clog[2];
-    twclog(pnumber, *bx, *by, *dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
-           dponp, sigs, clog);
-    alfap0 += (alfapp * *L * clog[0]);
-    alfax0 += (alfaxx * *L * clog[0]);
-    alfay0 += (alfayy * *L * clog[0]);
-    // printf("clog %12.6e\n", clog[0]);
-  }
-
-  // factor 2.0 is due to converstion to amplitudes from emittances
-  output[0] = alfap0 / (dponp * dponp) * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
-  output[1] = alfax0 / ex * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
-  output[2] = alfay0 / ey * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
+  IBSLatticeRates(4, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -534,6 +748,7 @@ IBS MODEL NAGAITSEV WITH TAILCUT
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         PRSTAB 8, 064403 (2005)
@@ -575,98 +790,11 @@ double *Nagaitsevtailcut(double pnumber, double ex, double ey, double sigs,
                          double dponp, map<string, double> &twissheader,
                          map<string, vector<double>> &twissdata, double r0,
                          double aatom) {
-  const double c = clight;
-
-  static double output[3];
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double len = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-  // necessary parameters
-  // double r0 = charge * charge / aatom * 1.54e-18;
+  PerfRegion perf("Nagaitsevtailcut", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  // initialize
-  double alfax0 = 0.0f;
-  double alfay0 = 0.0f;
-  double alfap0 = 0.0f;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  double betar3 = betar * betar * betar;
-  double gamma5 = gamma * gamma * gamma * gamma * gamma;
-
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata,len) reduction(+: alfap0, alfax0,alfay0)
-  for (int i = 0; i < n; i++) {
-    // local naming
-    double *L = &(twissdata["L"][i]);
-    double *bx = &(twissdata["BETX"][i]);
-    double *by = &(twissdata["BETY"][i]);
-    double *dx = &(twissdata["DX"][i]);
-    double *dpx = &(twissdata["DPX"][i]);
-    double *dy = &(twissdata["DY"][i]);
-    double *dpy = &(twissdata["DPY"][i]);
-    double *ax = &(twissdata["ALFX"][i]);
-    double *ay = &(twissdata["ALFY"][i]);
-    double *angle = &(twissdata["ANGLE"][i]);
-    double *k1l = &(twissdata["K1L"][i]);
-    double *k1sl = &(twissdata["K1SL"][i]);
-
-    double phi = *dpx + (*ax * (*dx / *bx));
-    double axx = *bx / ex;
-    double ayy = *by / ey;
-
-    double sigmax = sqrt(*dx * *dx * dponp * dponp + ex * *bx);
-    double sigmay = sqrt(ey * *by);
-
-    double as =
-        axx * (*dx * *dx / (*bx * *bx) + phi * phi) + (1.0 / (dponp * dponp));
-    double a1 = 0.5 * (axx + gamma * gamma * as);
-    double a2 = 0.5 * (axx - gamma * gamma * as);
-    double b1 = sqrt(a2 * a2 + gamma * gamma * axx * axx * phi * phi);
-
-    double lambda1 = ayy;
-    double lambda2 = a1 + b1;
-    double lambda3 = a1 - b1;
-
-    double R1 = (1.0f / lambda1) *
-                rds((1.0f / lambda2), (1.0f / lambda3), (1.0f / lambda1));
-    double R2 = (1.0f / lambda2) *
-                rds((1.0f / lambda3), (1.0f / lambda1), (1.0f / lambda2));
-    double R3 = 3.0f * sqrt((lambda1 * lambda2) / lambda3) -
-                (lambda1 / lambda3) * R1 - (lambda2 / lambda3) * R2;
-
-    double sp = (gamma * gamma / 2.0) * (2.0 * R1 - R2 * (1.0 - 3.0 * a2 / b1) -
-                                         R3 * (1.0 + 3.0 * a2 / b1));
-    double sx = 0.5 * (2.0 * R1 - R2 * (1.0 + 3.0 * a2 / b1) -
-                       R3 * (1.0 - 3.0 * a2 / b1));
-    double sxp = (3.0 * gamma * gamma * phi * phi * axx) / b1 * (R3 - R2);
-
-    double alfapp = sp / (sigmax * sigmay);
-    double alfaxx = (*bx / (sigmax * sigmay)) *
-                    (sx + sxp + sp * (*dx * *dx / (*bx * *bx) + phi * phi));
-    double alfayy = (*by / (sigmax * sigmay)) * (-2.0 * R1 + R2 + R3);
-
-    double clog[2];
-    twclogtail(pnumber, *L, *bx, *by, *dx, *dpx, *dy, *dpy, *ax, *ay, *angle,
-               *k1l, *k1sl, ex, ey, r0, aatom, gamma, en0, len, amass, charge,
-               dponp, sigs, clog);
-    alfap0 += (alfapp * *L * clog[0]);
-    alfax0 += (alfaxx * *L * clog[0]);
-    alfay0 += (alfayy * *L * clog[0]);
-    // printf("clog %12.6e\n", clog[0]);
-    // twclog(pnumber, *bx, *by, *dx, 0.0, ex, ey, r0, gamma, charge, en0,
-    // amass,
-    //     dponp, sigs, clog);
-    // printf("clog %12.6e\n", clog[0]);
-  }
-
-  output[0] = alfap0 / (dponp * dponp) * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
-  output[1] = alfax0 / ex * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
-  output[2] = alfay0 / ey * (pnumber * r0 * r0 * c) /
-              (12.0 * pi * betar3 * gamma5 * sigs) / 2.0 / len;
+  IBSLatticeRates(5, pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                  r0, aatom, output);
 
   return output;
 }
@@ -702,6 +830,7 @@ IBS MODEL ZIMMERMAN MADX
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -741,165 +870,39 @@ double *ibsmadx(double pnumber, double ex, double ey, double sigs, double sige,
                 map<string, double> &twissheader,
                 map<string, vector<double>> &twissdata, double r0,
                 bool printout) {
-  const double zero = 0.0;
-  const double one = 1.0;
-  const double two = 2.0;
+  PerfRegion perf("ibsmadx", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  static double output[3];
-
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // relativistic beta
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  // necessary parameters
-  // double r0 = charge * charge / aatom * 1.54e-18;
-  // NOTE:
-  // ****************************************************************
-  // Sige is the dE/E. dp/p needed as input for the IBS calculations
-  //   dp/p= (dE/E)/beta**2
-  // *****************************************************************
-
-  // sige /= (betar * betar);
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double alfas[3];
-
-  double sbxb = zero;
-  double sbxinv = zero;
-  double sbyb = zero;
-  double sbyinv = zero;
-  double salxb = zero;
-  double salyb = zero;
-  double sdxb = zero;
-  double sdpxb = zero;
-  double sdyb = zero;
-  double sdpyb = zero;
-  double wnorm = zero;
-  double dxwtd = zero;
-  double dpxwtd = zero;
-  double dywtd = zero;
-  double dpywtd = zero;
-  double bywtd = zero;
-  double alxwtd = zero;
-  double alywtd = zero;
-  // double hscrpt  = zero;
-  // double hscrpty = zero;
-  double hscwtd = zero;
-  double hscwtdy = zero;
-
-  // CoulombLog(pnumber, ex, ey, twissheader, sige, sigs, aatom, 0, clog);
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata,circ, alfas) reduction(+: alfap0, alfax0, alfay0, sbxb, sbyb, salxb, salyb,sdxb, sdyb )
-  for (int i = 0; i < n; i++) {
-    double dels = twissdata["L"][i]; // l
-    double betax = twissdata["BETX"][i];
-    double betay = twissdata["BETY"][i];
-    double alx = twissdata["ALFX"][i]; // alfx
-    double aly = twissdata["ALFY"][i]; // alfy
-    double dx = betar * twissdata["DX"][i];
-    double dpx = betar * twissdata["DPX"][i];
-    double dy = betar * twissdata["DY"][i];
-    double dpy = betar * twissdata["DPY"][i];
-
-    sbxb = sbxb + betax * dels;
-    sbxinv = sbxinv + dels / betax;
-    sbyb = sbyb + betay * dels;
-    sbyinv = sbyinv + dels / betay;
-    salxb = salxb + alx * dels;
-    salyb = salyb + aly * dels;
-    sdxb = sdxb + dx * dels;
-    sdpxb = sdpxb + dpx * dels;
-    sdyb = sdyb + dy * dels;
-    sdpyb = sdpyb + dpy * dels;
-
-    //---- Calculate weighted average in region of non-zero DX's.
-    //     These values are used to calculate "average" ring lifetimes
-    //     in TWSINT.
-    if (dx > zero) {
-      double wnorm = wnorm + dels;
-      double dxwtd = dxwtd + dels * dx;
-      double dpxwtd = dpxwtd + dels * dpx;
-      double dywtd = dywtd + dels * dy;
-      double dpywtd = dpywtd + dels * dpy;
-      double bywtd = bywtd + dels / sqrt(betay);
-      double alxwtd = alxwtd + dels * alx;
-      double alywtd = alywtd + dels * aly;
-      double hscrpt = betax * dpx * dpx + two * alx * dx * dpx +
-                      (one + alx * alx) * dx * dx / betax;
-      double hscrpty = betay * dpy * dpy + two * aly * dy * dpy +
-                       (one + aly * aly) * dy * dy / betay;
-      double hscwtd = hscwtd + dels * sqrt(hscrpt);
-      double hscwtdy = hscwtdy + dels * sqrt(hscrpty);
-    }
-
-    //---- IBSIntegrator calculates the Bjorken/Mtingwa integral.
-    twsint(pnumber, ex, ey, sigs, sige, gamma, betax, betay, alx, aly, dx, dpx,
-           dy, dpy, alfas);
-    double clog[2];
-    twclog(pnumber, betax, betay, dx, dy, ex, ey, r0, gamma, charge, en0, amass,
-           sige, sigs, clog);
-    alfap0 += alfas[0] * dels * clog[1];
-    alfax0 += alfas[1] * dels * clog[1];
-    alfay0 += alfas[2] * dels * clog[1];
-  }
-
-  // ---- We have finished reading the lattice
-  double bxbar = sbxb / circ;
-  double bybar = sbyb / circ;
-  double alxbar = salxb / circ;
-  double alybar = salyb / circ;
-  double dxbar = sdxb / circ;
-  double dpxbr = sdpxb / circ;
-  double dybar = sdyb / circ;
-  double dpybr = sdpyb / circ;
-  // double bxinv  = sbxinv / circ;
-  // double byinv  = sbyinv / circ;
-
-  dxwtd = dxwtd / wnorm;
-  dpxwtd = dpxwtd / wnorm;
-  dywtd = dywtd / wnorm;
-  dpywtd = dpywtd / wnorm;
-  bywtd = bywtd / wnorm;
-  bywtd = one / (bywtd * bywtd);
-  alxwtd = alxwtd / wnorm;
-  alywtd = alywtd / wnorm;
-  hscwtd = (hscwtd / wnorm) * (hscwtd / wnorm);
-
-  double beteff = dxwtd * dxwtd / hscwtd;
-  double beteffy = (hscwtdy != 0.0) ? dywtd * dywtd / hscwtdy : bywtd;
-  double tbar[3], twtd[3];
-
-  tbar[0] = zero;
-  tbar[1] = zero;
-  tbar[2] = zero;
-
-  twtd[0] = zero;
-  twtd[1] = zero;
-  twtd[2] = zero;
-
-  output[0] = alfap0 / circ / 2.0;
-  output[1] = alfax0 / circ / 2.0;
-  output[2] = alfay0 / circ / 2.0;
+  IBSLatticeRates(6, pnumber, ex, ey, sigs, sige, twissheader, twissdata, r0,
+                  0.0, output);
 
   if (printout) {
-    //---- Integral for averaged quantities.
-    twsint(pnumber, ex, ey, sigs, sige, gamma, bxbar, bybar, alxbar, alybar,
-           dxbar, dpxbr, dybar, dpybr, tbar);
-
-    // ---- Integral for effective quantities.
-    twsint(pnumber, ex, ey, sigs, sige, gamma, beteff, beteffy, alxwtd, alywtd,
-           dxwtd, dpxwtd, dywtd, dpywtd, twtd);
+    double gamma = twissheader["GAMMA"];
+    double charge = twissheader["CHARGE"];
+    double circ = twissheader["LENGTH"];
+    double en0 = twissheader["ENERGY"];
+    double amass = twissheader["MASS"];
+    double betar = sqrt(1 - 1 / (gamma * gamma));
+
+    //---- Ring average values of the optics.
+    double sbxb = 0.0;
+    double sbyb = 0.0;
+    double sdxb = 0.0;
+    double sdyb = 0.0;
+    int n = twissdata["L"].size();
+    for (int i = 0; i < n; i++) {
+      double dels = twissdata["L"][i];
+      sbxb += twissdata["BETX"][i] * dels;
+      sbyb += twissdata["BETY"][i] * dels;
+      sdxb += betar * twissdata["DX"][i] * dels;
+      sdyb += betar * twissdata["DY"][i] * dels;
+    }
+    double bxbar = sbxb / circ;
+    double bybar = sbyb / circ;
+    double dxbar = sdxb / circ;
+    double dybar = sdyb / circ;
 
     // ---- Calculate the Coulomb logarithm.
-
     double clog2[2];
     twclog(pnumber, bxbar, bybar, dxbar, dybar, ex, ey, r0, gamma, charge, en0,
            amass, sige, sigs, clog2);
@@ -917,8 +920,6 @@ double *ibsmadx(double pnumber, double ex, double ey, double sigs, double sige,
     printf("Ring average values \n");
     printf("    betx   = %.8e   bety   = %.8e   Dx  = %.8e   Dy  = %.8e \n",
            bxbar, bybar, dxbar, dybar);
-    // CoulombLog(pnumber, ex, ey, avgtwissheader, sige, sigs, aatom, 1,
-    // clog);
 
     // factors 2 and half are due to difference in
     // growth rates / times for emit or sig
@@ -953,6 +954,7 @@ IBS MODEL ZIMMERMAN MADX WITH TAILCUT
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -991,125 +993,12 @@ IBS MODEL ZIMMERMAN MADX WITH TAILCUT
 double *ibsmadxtailcut(double pnumber, double ex, double ey, double sigs,
                        double sige, map<string, double> &twissheader,
                        map<string, vector<double>> &twissdata, double r0,
-                       double aatom) {
-  const double zero = 0.0;
-  const double one = 1.0;
-  const double two = 2.0;
-
-  static double output[3];
-
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // relativistic beta
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  // NOTE:
-  // ****************************************************************
-  // Sige is the dE/E. dp/p needed as input for the IBS calculations
-  //   dp/p= (dE/E)/beta**2
-  // *****************************************************************
-
-  // sige /= (betar * betar);
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double alfas[3];
-
-  double sbxb = zero;
-  double sbxinv = zero;
-  double sbyb = zero;
-  double sbyinv = zero;
-  double salxb = zero;
-  double salyb = zero;
-  double sdxb = zero;
-  double sdpxb = zero;
-  double sdyb = zero;
-  double sdpyb = zero;
-  double wnorm = zero;
-  double dxwtd = zero;
-  double dpxwtd = zero;
-  double dywtd = zero;
-  double dpywtd = zero;
-  double bywtd = zero;
-  double alxwtd = zero;
-  double alywtd = zero;
-  // double hscrpt  = zero;
-  // double hscrpty = zero;
-  double hscwtd = zero;
-  double hscwtdy = zero;
-
-  int n = twissdata["L"].size();
-
-  // CoulombLog(pnumber, ex, ey, twissheader, sige, sigs, aatom, 0, clog);
-
-#pragma omp parallel for shared(twissdata,circ, alfas) reduction(+: alfap0, alfax0, alfay0, sbxb, sbyb, salxb, salyb,sdxb, sdyb )
-  for (int i = 0; i < n; i++) {
-    // local naming
-    double *L = &(twissdata["L"][i]);
-    double *bx = &(twissdata["BETX"][i]);
-    double *by = &(twissdata["BETY"][i]);
-    double *dx = &(twissdata["DX"][i]);
-    double *dpx = &(twissdata["DPX"][i]);
-    double *dy = &(twissdata["DY"][i]);
-    double *dpy = &(twissdata["DPY"][i]);
-    double *ax = &(twissdata["ALFX"][i]);
-    double *ay = &(twissdata["ALFY"][i]);
-    double *angle = &(twissdata["ANGLE"][i]);
-    double *k1l = &(twissdata["K1L"][i]);
-    double *k1sl = &(twissdata["K1SL"][i]);
-
-    sbxb = sbxb + *bx * *L;
-    sbxinv = sbxinv + *L / *bx;
-    sbyb = sbyb + *by * *L;
-    sbyinv = sbyinv + *L / *by;
-    salxb = salxb + *ax * *L;
-    salyb = salyb + *ay * *L;
-    sdxb = sdxb + *dx * *L;
-    sdpxb = sdpxb + *dpx * *L;
-    sdyb = sdyb + *dy * *L;
-    sdpyb = sdpyb + *dpy * *L;
-
-    //---- Calculate weighted average in region of non-zero DX's.
-    //     These values are used to calculate "average" ring lifetimes
-    //     in TWSINT.
-    if (*dx > zero) {
-      double wnorm = wnorm + *L;
-      double dxwtd = dxwtd + *L * *dx;
-      double dpxwtd = dpxwtd + *L * *dpx;
-      double dywtd = dywtd + *L * *dy;
-      double dpywtd = dpywtd + *L * *dpy;
-      double bywtd = bywtd + *L / sqrt(*by);
-      double alxwtd = alxwtd + *L * *ax;
-      double alywtd = alywtd + *L * *ay;
-      double hscrpt = *bx * *dpx * *dpx + two * *ax * *dx * *dpx +
-                      (one + *ax * *ax) * *dx * *dx / *bx;
-      double hscrpty = *by * *dpy * *dpy + two * *ay * *dy * *dpy +
-                       (one + *ay * *ay) * *dy * *dy / *by;
-      double hscwtd = hscwtd + *L * sqrt(hscrpt);
-      double hscwtdy = hscwtdy + *L * sqrt(hscrpty);
-    }
-
-    //---- IBSIntegrator calculates the Bjorken/Mtingwa integral.
-    twsint(pnumber, ex, ey, sigs, sige, gamma, *bx, *by, *ax, *ay, *dx, *dpx,
-           *dy, *dpy, alfas);
-    double clog[2];
-    twclogtail(pnumber, *L, *bx, *by, *dx, *dpx, *dy, *dpy, *ax, *ay, *angle,
-               *k1l, *k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass, charge,
-               sige, sigs, clog);
-    alfap0 += alfas[0] * *L * clog[1];
-    alfax0 += alfas[1] * *L * clog[1];
-    alfay0 += alfas[2] * *L * clog[1];
-  }
+                       double aatom) {
+  PerfRegion perf("ibsmadxtailcut", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  // factor 2 for converting to amplitudes from emit growth rates
-  output[0] = alfap0 / circ / 2.0;
-  output[1] = alfax0 / circ / 2.0;
-  output[2] = alfay0 / circ / 2.0;
+  IBSLatticeRates(7, pnumber, ex, ey, sigs, sige, twissheader, twissdata,
+                  r0, aatom, output);
 
   return output;
 }
@@ -1125,6 +1014,7 @@ IBS MODEL  BJORKEN-MTINGWA USING STANDARD SIMPSON => FAILNG!!!!!!!!!!!!!
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1163,85 +1053,11 @@ IBS MODEL  BJORKEN-MTINGWA USING STANDARD SIMPSON => FAILNG!!!!!!!!!!!!!
 double *BjorkenMtingwa2(double pnumber, double ex, double ey, double sigs,
                         double dponp, map<string, double> &twissheader,
                         map<string, vector<double>> &twissdata, double r0) {
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-  // initialize
-  double alfax0 = 0.0f;
-  double alfay0 = 0.0f;
-  double alfap0 = 0.0f;
-  double gamma2 = gamma * gamma;
-  double dponp2 = dponp * dponp;
-
-  static double output[3];
-
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
-  for (int i = 0; i < n; i++) {
-    double l = twissdata["L"][i];
-    double bx = twissdata["BETX"][i];
-    double by = twissdata["BETY"][i];
-    double dx = twissdata["DX"][i];
-    double dpx = twissdata["DPX"][i];
-    double ax = twissdata["ALFX"][i];
-
-    double dx2 = dx * dx;
-    // double dy2 = dy * dy;
-    double bx2 = bx * bx;
-    // double by2 = by * by;
-    double bxy = bx * by;
-    double exy = ex * ey;
-
-    double c1 = (bx / ex + by / ey);
-    double gd2 = gamma2 / dponp2;
-
-    double phix = dpx + (ax * (dx / bx));
-    // double phiy = dpy + (ay * (dy / by));
-
-    double phix2 = phix * phix;
-    // double phiy2 = fabs(phiy * phiy);
-
-    double hx = (dx2 + bx2 * phix2) / bx;
-    // double hy = (dy2 + by2 * phiy2) / by;
-
-    double a = (gamma2 * hx / ex) + gd2;
-    double b = c1 * (gamma2 * dx2 / (ex * bx) + gd2) +
-               (gamma2 * phix2 * bx * by / (ex * ey));
-    double c = (bxy / exy) * (gamma2 * dx2 / (ex * bx) + gd2);
-
-    double axx = 2.0 * gamma2 * hx / ex + 2.0 * gd2;
-    double bxx =
-        c1 * ((gamma2 * hx * hx / ex) + gd2) - bx2 / (ex * ex) * gamma2 * phix2;
-
-    double al = 2.0 * gamma2 * (hx / ex + 1.0 / dponp2);
-    double bl = b;
-
-    double ayy = -gamma2 * hx / ex - gd2;
-    double byy = b - 3.0 * bx / ex * (gamma2 * dx2 / (ex * bx) + gd2);
-
-    double integrals[3];
-
-    intSimpson(IBSIntegralIntegrand, axx, bxx, ayy, byy, al, bl, a, b, c,
-               integrals);
-
-    double clog[2];
-    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
-           dponp, sigs, clog);
-
-    alfap0 += l * gd2 * integrals[0] * clog[1];
-    alfax0 += l * hx * integrals[1] * clog[1];
-    alfay0 += l * by * integrals[2] * clog[1];
-  }
-  alfap0 /= circ;
-  alfax0 *= gamma2 / ex / circ;
-  alfay0 *= 1.0 / ey / circ;
+  PerfRegion perf("BjorkenMtingwa2", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  IBSLatticeRates(8, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -1257,6 +1073,7 @@ IBS MODEL  BJORKEN-MTINGWA USING STANDARD SIMPSON DECADE
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1295,56 +1112,11 @@ IBS MODEL  BJORKEN-MTINGWA USING STANDARD SIMPSON DECADE
 double *BjorkenMtingwa(double pnumber, double ex, double ey, double sigs,
                        double dponp, map<string, double> &twissheader,
                        map<string, vector<double>> &twissdata, double r0) {
-  // constants
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-
-  static double output[3];
-
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
-  for (int i = 0; i < n; i++) {
-    double l = twissdata["L"][i];
-    double bx = twissdata["BETX"][i];
-    double by = twissdata["BETY"][i];
-    double dx = betar * twissdata["DX"][i];
-    double dpx = betar * twissdata["DPX"][i];
-    double ax = twissdata["ALFX"][i];
-    double ay = twissdata["ALFY"][i];
-    double dy = betar * twissdata["DY"][i];
-    double dpy = betar * twissdata["DPY"][i];
-
-    double integrals[3];
-
-    BjorkenMtingwaInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx,
-                      by, ax, ay, dx, dpx, dy, dpy, integrals);
-
-    double clog[2];
-    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
-           dponp, sigs, clog);
-
-    alfap0 += l * integrals[0] * clog[1];
-    alfax0 += l * integrals[1] * clog[1];
-    alfay0 += l * integrals[2] * clog[1];
-  }
-
-  alfap0 /= circ;
-  alfax0 /= circ;
-  alfay0 /= circ;
+  PerfRegion perf("BjorkenMtingwa", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  IBSLatticeRates(9, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -1360,6 +1132,7 @@ IBS MODEL  BJORKEN-MTINGWA USING STANDARD SIMPSON DECADE WITH TAILCUT.
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1399,61 +1172,11 @@ double *BjorkenMtingwatailcut(double pnumber, double ex, double ey, double sigs,
                               double dponp, map<string, double> &twissheader,
                               map<string, vector<double>> &twissdata, double r0,
                               double aatom) {
-  // constants
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-
-  static double output[3];
+  PerfRegion perf("BjorkenMtingwatailcut", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
-  for (int i = 0; i < n; i++) {
-    double *L = &(twissdata["L"][i]);
-    double *bx = &(twissdata["BETX"][i]);
-    double *by = &(twissdata["BETY"][i]);
-    double *dx = &(twissdata["DX"][i]);
-    double *dpx = &(twissdata["DPX"][i]);
-    double *dy = &(twissdata["DY"][i]);
-    double *dpy = &(twissdata["DPY"][i]);
-    double *ax = &(twissdata["ALFX"][i]);
-    double *ay = &(twissdata["ALFY"][i]);
-    double *angle = &(twissdata["ANGLE"][i]);
-    double *k1l = &(twissdata["K1L"][i]);
-    double *k1sl = &(twissdata["K1SL"][i]);
-
-    double integrals[3];
-
-    BjorkenMtingwaInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, *bx,
-                      *by, *ax, *ay, *dx, *dpx, *dy, *dpy, integrals);
-
-    double clog[2];
-    twclogtail(pnumber, *L, *bx, *by, *dx, *dpx, *dy, *dpy, *ax, *ay, *angle,
-               *k1l, *k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass, charge,
-               dponp, sigs, clog);
-
-    alfap0 += *L * integrals[0] * clog[1];
-    alfax0 += *L * integrals[1] * clog[1];
-    alfay0 += *L * integrals[2] * clog[1];
-  }
-
-  // factor 2 for converting to amplitudes from emit growth rates
-  alfap0 /= circ;
-  alfax0 /= circ;
-  alfay0 /= circ;
-
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  IBSLatticeRates(10, pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                  r0, aatom, output);
 
   return output;
 }
@@ -1469,6 +1192,7 @@ IBS MODEL CONTE-MARTINI USING STANDARD SIMPSON DECADE
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1507,55 +1231,11 @@ IBS MODEL CONTE-MARTINI USING STANDARD SIMPSON DECADE
 double *ConteMartini(double pnumber, double ex, double ey, double sigs,
                      double dponp, map<string, double> &twissheader,
                      map<string, vector<double>> &twissdata, double r0) {
-  // constants
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  static double output[3];
-
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
-  for (int i = 0; i < n; i++) {
-    double l = twissdata["L"][i];
-    double bx = twissdata["BETX"][i];
-    double by = twissdata["BETY"][i];
-    double dx = twissdata["DX"][i];
-    double dpx = twissdata["DPX"][i];
-    double ax = twissdata["ALFX"][i];
-    double ay = twissdata["ALFY"][i];
-    double dy = betar * twissdata["DY"][i];
-    double dpy = betar * twissdata["DPY"][i];
-
-    double integrals[3];
-
-    ConteMartiniInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx, by,
-                    ax, ay, dx, dpx, dy, dpy, integrals);
-
-    double clog[2];
-    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
-           dponp, sigs, clog);
-
-    alfap0 += l * integrals[0] * clog[1];
-    alfax0 += l * integrals[1] * clog[1];
-    alfay0 += l * integrals[2] * clog[1];
-  }
-
-  alfap0 /= circ;
-  alfax0 /= circ;
-  alfay0 /= circ;
+  PerfRegion perf("ConteMartini", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  IBSLatticeRates(11, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
 
   return output;
 }
@@ -1570,6 +1250,7 @@ IBS MODEL CONTE-MARTINI USING STANDARD SIMPSON DECADE WITH TAILCUT
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1609,59 +1290,11 @@ double *ConteMartinitailcut(double pnumber, double ex, double ey, double sigs,
                             double dponp, map<string, double> &twissheader,
                             map<string, vector<double>> &twissdata, double r0,
                             double aatom) {
-  // constants
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
-  static double output[3];
-
-  int n = twissdata["L"].size();
-
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
-  for (int i = 0; i < n; i++) {
-    double *l = &(twissdata["L"][i]);
-    double *bx = &(twissdata["BETX"][i]);
-    double *by = &(twissdata["BETY"][i]);
-    double *dx = &(twissdata["DX"][i]);
-    double *dpx = &(twissdata["DPX"][i]);
-    double *dy = &(twissdata["DY"][i]);
-    double *dpy = &(twissdata["DPY"][i]);
-    double *ax = &(twissdata["ALFX"][i]);
-    double *ay = &(twissdata["ALFY"][i]);
-    double *angle = &(twissdata["ANGLE"][i]);
-    double *k1l = &(twissdata["K1L"][i]);
-    double *k1sl = &(twissdata["K1SL"][i]);
-
-    double integrals[3];
-
-    ConteMartiniInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, *bx,
-                    *by, *ax, *ay, *dx, *dpx, *dy, *dpy, integrals);
-
-    double clog[2];
-    twclogtail(pnumber, *l, *bx, *by, *dx, *dpx, *dy, *dpy, *ax, *ay, *angle,
-               *k1l, *k1sl, ex, ey, r0, aatom, gamma, en0, circ, amass, charge,
-               dponp, sigs, clog);
+  PerfRegion perf("ConteMartinitailcut", twissdata["L"].size(), "model");
+  static thread_local double output[3];
 
-    alfap0 += *l * integrals[0] * clog[1];
-    alfax0 += *l * integrals[1] * clog[1];
-    alfay0 += *l * integrals[2] * clog[1];
-  }
-
-  alfap0 /= circ;
-  alfax0 /= circ;
-  alfay0 /= circ;
-
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  IBSLatticeRates(12, pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                  r0, aatom, output);
 
   return output;
 }
@@ -1678,6 +1311,7 @@ IBS MODEL ZIMMERMAN USING STANDARD SIMPSON DECADE
 
   HISTORY:
     - 08/06/2021 : initial cpp version (Tom)
+    - 18/10/2026 : lattice sums from the shared element kernel
 
   REF:
         CERN NOTE AB-2006--002
@@ -1716,56 +1350,493 @@ IBS MODEL ZIMMERMAN USING STANDARD SIMPSON DECADE
 double *MadxIBS(double pnumber, double ex, double ey, double sigs, double dponp,
                 map<string, double> &twissheader,
                 map<string, vector<double>> &twissdata, double r0) {
-  // constants
-  double gamma = twissheader["GAMMA"];
-  double charge = twissheader["CHARGE"];
-  double circ = twissheader["LENGTH"];
-  double en0 = twissheader["ENERGY"];
-  double amass = twissheader["MASS"];
-
-  // initialize
-  double alfax0 = 0.0;
-  double alfay0 = 0.0;
-  double alfap0 = 0.0;
-  double betar = sqrt(1 - 1 / (gamma * gamma));
+  PerfRegion perf("MadxIBS", twissdata["L"].size(), "model");
+  static thread_local double output[3];
+
+  IBSLatticeRates(13, pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  0.0, output);
+
+  return output;
+}
+/*
+================================================================================
+================================================================================
+CONTRIBUTION OF A SINGLE LATTICE ELEMENT TO THE IBS GROWTH RATES
+
+  Evaluates the element kernel of the selected lattice model for element i
+  only and applies the model's normalisation, such that summing the output
+  over all elements reproduces the output of the model itself.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : kernel terms normalised by IBSElementNormalize
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13, same numbering as in ODE)
+    - int i
+        element index in the twiss table
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread (same convention as the selected model)
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number (only used by the tailcut models)
+    - double* out
+        output array
+
+  Returns:
+  --------
+    double[3] out
+        IBS GROWTH RATE CONTRIBUTIONS
+        0 -> al
+        1 -> ax
+        2 -> ay
+
+================================================================================
+================================================================================
+*/
+void IBSElementRates(int model, int i, double pnumber, double ex, double ey,
+                     double sigs, double dponp,
+                     map<string, double> &twissheader,
+                     map<string, vector<double>> &twissdata, double r0,
+                     double aatom, double *out) {
+  IBSElementRing ring;
+  IBSElementRingSetup(twissheader, ring);
+  IBSElementColumns cols;
+  IBSElementColumnsSetup(model, twissdata, cols);
+
+  IBSElementOptics e;
+  IBSElementLoad(cols, i, e);
+
+  double terms[3];
+  IBSElementKernel(model, ring, e, pnumber, ex, ey, sigs, dponp, twissheader,
+                   r0, aatom, terms);
+  IBSElementNormalize(model, ring, pnumber, ex, ey, sigs, dponp, r0, terms,
+                      out);
+}
+/*
+================================================================================
+================================================================================
+IBS GROWTH RATES OF MANY BEAM STATES IN ONE LATTICE PASS
+
+  The optics of an element are loaded once and the element kernel of the
+  selected model is evaluated for all states before moving to the next
+  element. Used by the ODE scheduler to serve the rate requests of many
+  simulations on the same lattice together.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : views of the states and strided output
+    - 18/10/2026 : sums normalised per state after the pass
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13, same numbering as in ODE)
+    - const BeamStates &states
+        views of the particle numbers, emittances, bunch lengths and energy
+        spreads (same convention as the selected model) of the states
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number (only used by the tailcut models)
+    - MatrixView<double> out
+        output view, one row per state and at least 3 columns
+
+  Returns:
+  --------
+    bool
+        false for unknown models (zero rates) or an output of the wrong shape
+    MatrixView<double> out
+        IBS GROWTH RATES, entry (k, j) for state k
+        0 -> al
+        1 -> ax
+        2 -> ay
+
+================================================================================
+================================================================================
+*/
+bool IBSRatesBatch(int model, const BeamStates &states,
+                   map<string, double> &twissheader,
+                   map<string, vector<double>> &twissdata, double r0,
+                   double aatom, MatrixView<double> out) {
+  int nstates = states.size();
+  PerfRegion perf("IBSRatesBatch", nstates, "model");
+
+  if ((size_t)nstates != out.rows() || out.cols() < 3) {
+    return false;
+  }
+  for (int k = 0; k < nstates; k++) {
+    out(k, 0) = 0.0;
+    out(k, 1) = 0.0;
+    out(k, 2) = 0.0;
+  }
+  if (model < 1 || model > 13) {
+    return false;
+  }
+
+  // the smooth approximation has no lattice sum
+  if (model == 1) {
+    for (int k = 0; k < nstates; k++) {
+      double *ibs =
+          PiwinskiSmooth(states.pnumber[k], states.ex[k], states.ey[k],
+                         states.sigs[k], states.dponp[k], twissheader, r0);
+      out(k, 0) = ibs[0];
+      out(k, 1) = ibs[1];
+      out(k, 2) = ibs[2];
+    }
+    return true;
+  }
+
+  IBSElementRing ring;
+  IBSElementRingSetup(twissheader, ring);
+
+  // column pointers are resolved once for the whole pass
+  IBSElementColumns cols;
+  IBSElementColumnsSetup(model, twissdata, cols);
+  const double *pnumber = states.pnumber.data();
+  const double *ex = states.ex.data();
+  const double *ey = states.ey.data();
+  const double *sigs = states.sigs.data();
+  const double *dponp = states.dponp.data();
+
+  // contiguous sums for the reduction, normalised into the strided output
+  ArenaScope scope;
+  double *sum = ThreadArena().Allocate<double>(3 * nstates);
+  for (int k = 0; k < 3 * nstates; k++) {
+    sum[k] = 0.0;
+  }
+
+  int n = twissdata["L"].size();
+  perf.SetElements((long)n * nstates);
+#pragma omp parallel for reduction(+ : sum[:3 * nstates])
+  for (int i = 0; i < n; i++) {
+    IBSElementOptics e;
+    IBSElementLoad(cols, i, e);
+
+    for (int k = 0; k < nstates; k++) {
+      double contribution[3];
+      IBSElementKernel(model, ring, e, pnumber[k], ex[k], ey[k], sigs[k],
+                       dponp[k], twissheader, r0, aatom, contribution);
+      sum[3 * k] += contribution[0];
+      sum[3 * k + 1] += contribution[1];
+      sum[3 * k + 2] += contribution[2];
+    }
+  }
+
+  for (int k = 0; k < nstates; k++) {
+    double rates[3];
+    IBSElementNormalize(model, ring, pnumber[k], ex[k], ey[k], sigs[k],
+                        dponp[k], r0, &sum[3 * k], rates);
+    out(k, 0) = rates[0];
+    out(k, 1) = rates[1];
+    out(k, 2) = rates[2];
+  }
+  return true;
+}
+
+// pointer interface, one array per state column and a row-major output
+void IBSRatesBatch(int model, int nstates, const double *pnumber,
+                   const double *ex, const double *ey, const double *sigs,
+                   const double *dponp, map<string, double> &twissheader,
+                   map<string, vector<double>> &twissdata, double r0,
+                   double aatom, double *out) {
+  size_t n = nstates > 0 ? nstates : 0;
+  BeamStates states;
+  states.pnumber = Span<const double>(pnumber, n);
+  states.ex = Span<const double>(ex, n);
+  states.ey = Span<const double>(ey, n);
+  states.sigs = Span<const double>(sigs, n);
+  states.dponp = Span<const double>(dponp, n);
+  IBSRatesBatch(model, states, twissheader, twissdata, r0, aatom,
+                MatrixView<double>(out, n, 3));
+}
+/*
+================================================================================
+================================================================================
+IBS GROWTH RATES FROM PRECOMPUTED ELEMENT OPTICS
+
+  For codes that evaluate the rates of a fixed lattice many times (e.g. the C
+  interface called by a tracker), the element optics are gathered once in a
+  contiguous table. Elements without length are dropped, their terms in the
+  lattice sums vanish. The rates are the normalised sums of the element
+  kernels, as in the model functions.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13, same numbering as in ODE)
+    - const BeamState &state
+        particle number, emittances, bunch length and energy spread (same
+        convention as the selected model)
+    - map<string, double> &twissheader
+        twiss header madx (only used by model 1)
+    - const IBSElementRing &ring
+        ring constants of the element kernels
+    - Span<const IBSElementOptics> elements
+        optics of the elements
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number (only used by the tailcut models)
+    - Span<double> out
+        output view, at least 3 entries
+
+  Returns:
+  --------
+    bool
+        false for unknown models (zero rates) or a too short output
+    Span<double> out
+        IBS GROWTH RATES
+        0 -> al
+        1 -> ax
+        2 -> ay
 
-  static double output[3];
+================================================================================
+================================================================================
+*/
+void IBSElementTable(map<string, vector<double>> &twissdata,
+                     vector<IBSElementOptics> &elements) {
+  IBSElementColumns cols;
+  IBSElementColumnsSetup(0, twissdata, cols);
 
   int n = twissdata["L"].size();
+  auto angle = twissdata.find("ANGLE");
+  if (angle != twissdata.end() && angle->second.size() == (size_t)n) {
+    cols.angle = angle->second.data();
+  }
+  auto k1l = twissdata.find("K1L");
+  if (k1l != twissdata.end() && k1l->second.size() == (size_t)n) {
+    cols.k1l = k1l->second.data();
+  }
+  auto k1sl = twissdata.find("K1SL");
+  if (k1sl != twissdata.end() && k1sl->second.size() == (size_t)n) {
+    cols.k1sl = k1sl->second.data();
+  }
 
-#pragma omp parallel for shared(twissdata) reduction(+ : alfap0, alfax0, alfay0)
+  elements.clear();
   for (int i = 0; i < n; i++) {
-    double l = twissdata["L"][i];
-    double bx = twissdata["BETX"][i];
-    double by = twissdata["BETY"][i];
-    double dx = twissdata["DX"][i];
-    double dpx = twissdata["DPX"][i];
-    double ax = twissdata["ALFX"][i];
-    double ay = twissdata["ALFY"][i];
-    double dy = betar * twissdata["DY"][i];
-    double dpy = betar * twissdata["DPY"][i];
-
-    double integrals[3];
-
-    MadxInt(pnumber, ex, ey, sigs, betar * betar * dponp, gamma, bx, by, ax, ay,
-            dx, dpx, dy, dpy, integrals);
-
-    double clog[2];
-    twclog(pnumber, bx, by, dx, 0.0, ex, ey, r0, gamma, charge, en0, amass,
-           dponp, sigs, clog);
+    if (cols.l[i] == 0.0) {
+      continue;
+    }
+    IBSElementOptics e;
+    IBSElementLoad(cols, i, e);
+    elements.push_back(e);
+  }
+}
+
+bool IBSRatesElements(int model, const BeamState &state,
+                      map<string, double> &twissheader,
+                      const IBSElementRing &ring,
+                      Span<const IBSElementOptics> elements, double r0,
+                      double aatom, Span<double> out) {
+  PerfRegion perf("IBSRatesElements", elements.size(), "model");
+  if (out.size() < 3) {
+    return false;
+  }
+  out[0] = 0.0;
+  out[1] = 0.0;
+  out[2] = 0.0;
+  if (model < 1 || model > 13) {
+    return false;
+  }
+
+  double pnumber = state.pnumber;
+  double ex = state.ex;
+  double ey = state.ey;
+  double sigs = state.sigs;
+  double dponp = state.dponp;
+
+  // the smooth approximation has no lattice sum
+  if (model == 1) {
+    double *ibs = PiwinskiSmooth(pnumber, ex, ey, sigs, dponp, twissheader, r0);
+    out[0] = ibs[0];
+    out[1] = ibs[1];
+    out[2] = ibs[2];
+    return true;
+  }
+
+  const IBSElementOptics *e = elements.data();
+  double alfap0 = 0.0;
+  double alfax0 = 0.0;
+  double alfay0 = 0.0;
+
+  int n = elements.size();
+#pragma omp parallel for reduction(+ : alfap0, alfax0, alfay0)
+  for (int i = 0; i < n; i++) {
+    double terms[3];
+    IBSElementKernel(model, ring, e[i], pnumber, ex, ey, sigs, dponp,
+                     twissheader, r0, aatom, terms);
+    alfap0 += terms[0];
+    alfax0 += terms[1];
+    alfay0 += terms[2];
+  }
+
+  double sum[3] = {alfap0, alfax0, alfay0};
+  double rates[3];
+  IBSElementNormalize(model, ring, pnumber, ex, ey, sigs, dponp, r0, sum,
+                      rates);
+  out[0] = rates[0];
+  out[1] = rates[1];
+  out[2] = rates[2];
+  return true;
+}
+/*
+================================================================================
+================================================================================
+IBS GROWTH RATES OF THE SELECTED MODEL
+
+  Dispatches to the model functions using the same numbering as the ODE.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : caller provided output, the pointer version adapts
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13, same numbering as in ODE)
+    - const BeamState &state
+        particle number, emittances, bunch length and energy spread (same
+        convention as the selected model)
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number (only used by the tailcut models)
+    - Span<double> out
+        output view, at least 3 entries
+
+  Returns:
+  --------
+    bool
+        false for unknown models (zero rates) or a too short output
+    Span<double> out
+        IBS GROWTH RATES
+        0 -> al
+        1 -> ax
+        2 -> ay
 
-    alfap0 += l * integrals[0] * clog[1];
-    alfax0 += l * integrals[1] * clog[1];
-    alfay0 += l * integrals[2] * clog[1];
+================================================================================
+================================================================================
+*/
+bool IBSRates(int model, const BeamState &state,
+              map<string, double> &twissheader,
+              map<string, vector<double>> &twissdata, double r0, double aatom,
+              Span<double> out) {
+  if (out.size() < 3) {
+    return false;
   }
 
-  alfap0 /= circ;
-  alfax0 /= circ;
-  alfay0 /= circ;
+  double pnumber = state.pnumber;
+  double ex = state.ex;
+  double ey = state.ey;
+  double sigs = state.sigs;
+  double dponp = state.dponp;
+
+  double *ibs;
+  switch (model) {
+  case 1:
+    ibs = PiwinskiSmooth(pnumber, ex, ey, sigs, dponp, twissheader, r0);
+    break;
+  case 2:
+    ibs = PiwinskiLattice(pnumber, ex, ey, sigs, dponp, twissheader,
+                          twissdata, r0);
+    break;
+  case 3:
+    ibs = PiwinskiLatticeModified(pnumber, ex, ey, sigs, dponp, twissheader,
+                                  twissdata, r0);
+    break;
+  case 4:
+    ibs = Nagaitsev(pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0);
+    break;
+  case 5:
+    ibs = Nagaitsevtailcut(pnumber, ex, ey, sigs, dponp, twissheader,
+                           twissdata, r0, aatom);
+    break;
+  case 6:
+    ibs = ibsmadx(pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0,
+                  false);
+    break;
+  case 7:
+    ibs = ibsmadxtailcut(pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                         r0, aatom);
+    break;
+  case 8:
+    ibs = BjorkenMtingwa2(pnumber, ex, ey, sigs, dponp, twissheader,
+                          twissdata, r0);
+    break;
+  case 9:
+    ibs = BjorkenMtingwa(pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                         r0);
+    break;
+  case 10:
+    ibs = BjorkenMtingwatailcut(pnumber, ex, ey, sigs, dponp, twissheader,
+                                twissdata, r0, aatom);
+    break;
+  case 11:
+    ibs = ConteMartini(pnumber, ex, ey, sigs, dponp, twissheader, twissdata,
+                       r0);
+    break;
+  case 12:
+    ibs = ConteMartinitailcut(pnumber, ex, ey, sigs, dponp, twissheader,
+                              twissdata, r0, aatom);
+    break;
+  case 13:
+    ibs = MadxIBS(pnumber, ex, ey, sigs, dponp, twissheader, twissdata, r0);
+    break;
+  default:
+    out[0] = 0.0;
+    out[1] = 0.0;
+    out[2] = 0.0;
+    return false;
+  }
 
-  output[0] = alfap0 / 2.0;
-  output[1] = alfax0 / 2.0;
-  output[2] = alfay0 / 2.0;
+  out[0] = ibs[0];
+  out[1] = ibs[1];
+  out[2] = ibs[2];
+  return true;
+}
 
+// growth rates in a buffer of the calling thread
+double *IBSRates(int model, double pnumber, double ex, double ey, double sigs,
+                 double dponp, map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, double r0,
+                 double aatom) {
+  static thread_local double output[3];
+  BeamState state = {pnumber, ex, ey, sigs, dponp};
+  IBSRates(model, state, twissheader, twissdata, r0, aatom, output);
   return output;
-}
\ No newline at end of file
+}
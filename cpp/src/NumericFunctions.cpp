@@ -1,4 +1,5 @@
 #include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
 #include <algorithm>
 #include <cmath>
 #include <complex>
@@ -598,6 +599,7 @@ METHOD TO GET THE SYNCHRONUOUS PHASE.
 double SynchronuousPhase(double target, double init_phi, double U0,
                          double charge, int nrf, double harmon[],
                          double voltages[], double epsilon) {
+  PerfRegion perf("SynchronuousPhase", 1, "rf");
   // Set the initial option prices and volatility
   double y = VeffRFeVRadlosses(init_phi, U0, charge, nrf, harmon, voltages);
   double x = init_phi;
@@ -993,6 +995,7 @@ REMARK:
 
   HISTORY:
     - 06/08/2021 : initial version (Tom)
+    - 18/10/2026 : columns written in place, no copies on repeated updates
 
 ================================================================================
   Arguments:
@@ -1009,29 +1012,62 @@ REMARK:
 ================================================================================
  */
 void updateTwiss(map<string, vector<double>> &table) {
+  PerfRegion perf("updateTwiss", table["L"].size(), "lattice");
   // get length of table to reserve the vector sizes
   int size = table["L"].size();
 
-  vector<double> rho(size), k(size), I1(size), I2(size), I3(size), I4x(size),
-      I4y(size), I5x(size), I5y(size), gammax(size), gammay(size), hx(size),
-      hy(size);
+  // input columns, looked up once
+  vector<double> &angles = table["ANGLE"];
+  vector<double> &ls = table["L"];
+  vector<double> &bxs = table["BETX"];
+  vector<double> &bys = table["BETY"];
+  vector<double> &axs = table["ALFX"];
+  vector<double> &ays = table["ALFY"];
+  vector<double> &dxs = table["DX"];
+  vector<double> &dpxs = table["DPX"];
+  vector<double> &dys = table["DY"];
+  vector<double> &dpys = table["DPY"];
+  vector<double> &k1ls = table["K1L"];
+  vector<double> &k1sls = table["K1SL"];
+
+  // the new columns are written in place, repeated updates of the same table
+  // reuse their storage
+  vector<double> &rho = table["rho"];
+  vector<double> &k = table["k"];
+  vector<double> &gammax = table["gammax"];
+  vector<double> &gammay = table["gammay"];
+  vector<double> &hx = table["hx"];
+  vector<double> &hy = table["hy"];
+  vector<double> &I1 = table["I1"];
+  vector<double> &I2 = table["I2"];
+  vector<double> &I3 = table["I3"];
+  vector<double> &I4x = table["I4x"];
+  vector<double> &I4y = table["I4y"];
+  vector<double> &I5x = table["I5x"];
+  vector<double> &I5y = table["I5y"];
+  vector<double> *columns[13] = {&rho, &k,  &gammax, &gammay, &hx,
+                                 &hy,  &I1, &I2,     &I3,     &I4x,
+                                 &I4y, &I5x, &I5y};
+  for (int c = 0; c < 13; c++) {
+    columns[c]->assign(size, 0.0);
+  }
 
   complex<double> kc, k2c, klc;
 
   // calculate the new columns
   for (int i = 0; i < size; i++) {
-    double angle = table["ANGLE"][i];
-    double l = table["L"][i];
-    double bx = table["BETX"][i];
-    double by = table["BETY"][i];
-    double ax = table["ALFX"][i];
-    double ay = table["ALFY"][i];
-    double dx = table["DX"][i];
-    double dpx = table["DPX"][i];
-    double dy = table["DY"][i];
-    double dpy = table["DPY"][i];
-    double k1l = table["K1L"][i];
-    double k1sl = table["K1SL"][i];
+    double angle = angles[i];
+    double l = ls[i];
+    double bx = bxs[i];
+    double by = bys[i];
+    double ax = axs[i];
+    double ay = ays[i];
+    double dx = dxs[i];
+    double dpx = dpxs[i];
+    double dy = dys[i];
+    double dpy = dpys[i];
+    double k1l = k1ls[i];
+    double k1sl = k1sls[i];
     double e1 = angle / 2.0;
     double e2 = angle / 2.0;
     double rhoi2, rhoi3;
@@ -1120,23 +1156,6 @@ void updateTwiss(map<string, vector<double>> &table) {
 
     I5y[i] = (rho[i] == 0) ? 0.0 : hy[i] * l / rhoi3;
   }
-
-  // extend the map table
-  table["rho"] = rho;
-  table["k"] = k;
-
-  table["gammax"] = gammax;
-  table["gammay"] = gammay;
-  table["hx"] = hx;
-  table["hy"] = hy;
-
-  table["I1"] = I1;
-  table["I2"] = I2;
-  table["I3"] = I3;
-  table["I4x"] = I4x;
-  table["I4y"] = I4y;
-  table["I5x"] = I5x;
-  table["I5y"] = I5y;
 }
 
 /*
@@ -1,14 +1,20 @@
+#include "../include/ibs_bits/Autotune.hpp"
 #include "../include/ibs_bits/CoulombLogFunctions.hpp"
 #include "../include/ibs_bits/Integrators.hpp"
 #include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/OrdDiffEq.hpp"
 #include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
 #include "../include/ibs_bits/RadiationDamping.hpp"
+#include "../include/ibs_bits/SpaceCharge.hpp"
 #include "../include/ibs_bits/twiss.hpp"
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <math.h>
+#include <numeric>
 #include <stdio.h>
 #include <string>
 #include <vector>
@@ -31,6 +37,7 @@ void printline(string key, double value, string units) {
 // write data to file
 void WriteToFile(string filename, vector<double> &t, vector<double> &ex,
                  vector<double> &ey, vector<double> &sigs) {
+  PerfRegion perf("WriteToFile", t.size(), "io");
 
   ofstream csvfile(filename);
 
@@ -52,6 +59,148 @@ void WriteToFile(string filename, vector<double> &t, vector<double> &ex,
   csvfile.close();
 }
 
+/*
+================================================================================
+  RING QUANTITIES OF THE ODE THAT DO NOT DEPEND ON THE BEAM STATE. THEY ARE
+  CALCULATED ONCE AND SHARED BY ALL INTEGRATION SEGMENTS OF A RUN.
+================================================================================
+*/
+void ODERingFromIntegrals(map<string, double> &twiss, const double *radint,
+                          int nrf, double harmon[], double voltages[],
+                          int couplingpercentage, ODERing &ring) {
+  if (couplingpercentage > 100 || couplingpercentage < 0) {
+    couplingpercentage = 0;
+  }
+  ring.coupling = (double)couplingpercentage / 100.0;
+
+  ring.gamma = twiss["GAMMA"];
+  ring.gammatr = twiss["GAMMATR"];
+  double pc = twiss["PC"];
+  double charge = twiss["CHARGE"];
+  double len = twiss["LENGTH"];
+
+  ring.aatom = emass / pmass;
+  ring.r0 = ParticleRadius(1, ring.aatom);
+  double betar = BetaRelativisticFromGamma(ring.gamma);
+  ring.omega = 2.0 * pi * betar * clight / len;
+  double neta = eta(ring.gamma, ring.gammatr);
+
+  ring.U0 = RadiationLossesPerTurn(twiss, radint[1], ring.aatom);
+  ring.phis = SynchronuousPhase(0.0, 173, ring.U0, charge, nrf, harmon,
+                                voltages, 1.0e-6);
+  ring.qs = SynchrotronTune(ring.omega, ring.U0, charge, nrf, harmon, voltages,
+                            ring.phis, neta, pc);
+  ring.omegas = ring.qs * ring.omega;
+
+  double integrals[7];
+  copy(radint, radint + 7, integrals);
+  double *equi =
+      RadiationDampingLifeTimesAndEquilibriumEmittancesWithPartitionNumbers(
+          twiss, integrals, ring.aatom, ring.qs);
+  ring.tauradx = equi[0];
+  ring.taurady = equi[1];
+  ring.taurads = equi[2];
+  ring.ex0 = equi[3];
+  ring.ey0 = max(ring.coupling * equi[3], equi[4]);
+  ring.sige0 = sqrt(equi[5]);
+  ring.sigs0 = equi[6];
+}
+
+void ODERingSetup(map<string, double> &twiss,
+                  map<string, vector<double>> &twissdata, int nrf,
+                  double harmon[], double voltages[], int couplingpercentage,
+                  ODERing &ring) {
+  double *radint = RadiationDampingLattice(twissdata);
+  ODERingFromIntegrals(twiss, radint, nrf, harmon, voltages,
+                       couplingpercentage, ring);
+}
+
+// right hand side of the "der" or "rlx" equations with the growth rates ibs
+void ODERingDerivatives(const ODERing &ring, const string &method,
+                        const double *ibs, double ex, double ey, double sige,
+                        double *F) {
+  if (method == "rlx") {
+    double xfactor = 1.0 / (1.0 - ring.tauradx * ibs[1]);
+    double yfactor = 1.0 / (1.0 - ring.taurady * ibs[2]);
+    double sfactor = 1.0 / (1.0 - ring.taurads * ibs[0]);
+
+    F[0] = xfactor * ring.ex0 - ex;
+    F[1] = ((1.0 - ring.coupling) * yfactor + ring.coupling * xfactor) *
+               ring.ey0 -
+           ey;
+    F[2] = sfactor * ring.sige0 - sige;
+  } else {
+    F[0] = -(ex - ring.ex0) * 2. / ring.tauradx + ex * 2.0 * ibs[1];
+    F[1] = -(ey - ring.ey0) * 2. / ring.taurady + ey * 2.0 * ibs[2];
+    F[2] = -(sige - ring.sige0) / ring.taurads + sige * ibs[0];
+  }
+}
+
+// one step of the "der" or "rlx" equations with the amplitude growth rates ibs
+void ODERingStep(const ODERing &ring, const string &method, const double *ibs,
+                 double ddt, double ex, double ey, double sige, double &exn,
+                 double &eyn, double &sigen) {
+  double F[3];
+  ODERingDerivatives(ring, method, ibs, ex, ey, sige, F);
+  exn = ex + ddt * F[0];
+  eyn = ey + ddt * F[1];
+  sigen = sige + ddt * F[2];
+}
+
+/*
+================================================================================
+  STEP SIZE, STEP LIMIT AND STOP CRITERION OF THE AUTO TIME STEP, SHARED BY
+  THE ODE RUNS AND THE RESUMABLE ODEStepper.
+================================================================================
+*/
+double ODEAutoTimeStep(const ODERing &ring, const string &method,
+                       const double *ibs) {
+  double ddt = min(ring.tauradx, ring.taurady);
+  ddt = min(ddt, ring.taurads);
+  ddt = min(ddt, 1.0 / ibs[0]);
+  ddt = min(ddt, 1.0 / ibs[1]);
+  ddt = min(ddt, 1.0 / ibs[2]);
+  ddt /= 2.0;
+
+  // the relaxation form takes four times the step
+  if (method == "rlx") {
+    ddt *= 4.;
+  }
+  return ddt;
+}
+
+int ODEAutoMaxSteps(const ODERing &ring, const double *ibs, double &taum,
+                    double &dtmin) {
+  // safetey max steps
+  int MaxSteps = 10000;
+
+  // get max tau limited to max 1.0 sec
+  taum = max(ring.tauradx, ring.taurady);
+  taum = max(taum, ring.taurads);
+  taum = max(taum, 1.0 / ibs[0]);
+  taum = max(taum, 1.0 / ibs[1]);
+  taum = max(taum, 1.0 / ibs[2]);
+  taum = min(taum, 1.0);
+
+  dtmin = min(ring.tauradx, ring.taurady);
+  dtmin = min(dtmin, ring.taurads);
+  dtmin = min(dtmin, 1.0 / ibs[0]);
+  dtmin = min(dtmin, 1.0 / ibs[1]);
+  dtmin = min(dtmin, 1.0 / ibs[2]);
+
+  int ms = (int)(10 * taum / dtmin);
+  return min(ms, MaxSteps);
+}
+
+bool ODEAutoContinue(int i, int maxsteps, const vector<double> &ex,
+                     const vector<double> &ey, const vector<double> &sigs,
+                     double threshold) {
+  return i < maxsteps &&
+         (fabs((ex[i] - ex[i - 1]) / ex[i - 1]) > threshold ||
+          fabs((ey[i] - ey[i - 1]) / ey[i - 1]) > threshold ||
+          fabs((sigs[i] - sigs[i - 1]) / sigs[i - 1]) > threshold);
+}
+
 /*
 ================================================================================
 ================================================================================
@@ -70,6 +219,7 @@ AS EQUILIBRIA DO NOT NECESSARILY EXIST A SAFETY MAX STEPS OF 10000 IS APPLIED.
                     * ADDED TWO METHODS TO PERFORM SIMULATION
                       + USING RELAXATION (EQ. 47 IN REF)
                       + USING DERIVATIVES (BMAD REF)
+    - 18/10/2026 : ENERGY SPREAD HISTORY WRITTEN TO THE CALLER'S VECTOR
 
   REFS:
     - BMAD SOURCE CODE - based on ibs_mod.f90 and ibs_ring.f90
@@ -107,8 +257,8 @@ AS EQUILIBRIA DO NOT NECESSARILY EXIST A SAFETY MAX STEPS OF 10000 IS APPLIED.
         vector of bunch lengths sigma s - as input : single initial value in the
         vector
     - vector<double> &sige
-        vector of energy spreads sigma E - as input : single initial value in
-        the vector
+        vector of energy spreads sigma E - previous contents are replaced, the
+        initial value follows from sigs and the rf
     - int model
         integer to select the IBS models
     - double pnumber
@@ -138,14 +288,15 @@ AS EQUILIBRIA DO NOT NECESSARILY EXIST A SAFETY MAX STEPS OF 10000 IS APPLIED.
 ================================================================================
 */
 
-void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
-         int nrf, double harmon[], double voltages[], vector<double> &t,
-         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
-         vector<double> sige, int model, double pnumber, int couplingpercentage,
-         double threshold, string method, bool debug_output) {
-
-  // safetey max steps
-  int MaxSteps = 10000;
+static void ODEAutoStep(map<string, double> &twiss,
+                        map<string, vector<double>> &twissdata, int nrf,
+                        double harmon[], double voltages[], vector<double> &t,
+                        vector<double> &ex, vector<double> &ey,
+                        vector<double> &sigs, vector<double> &sige, int model,
+                        double pnumber, int couplingpercentage,
+                        double threshold, string method, bool debug_output,
+                        vector<double> *dqx, vector<double> *dqy) {
+  PerfRegion perf("ODE", 0, "ode");
 
   // sanitize limit settings
   if (!(method == "rlx" || method == "der")) {
@@ -162,83 +313,40 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
     threshold = 1e-4;
   }
 
-  if (couplingpercentage > 100 || couplingpercentage < 0) {
-    couplingpercentage = 0;
-  }
-
-  // rescale coupling percentage
-  double coupling = (double)couplingpercentage / 100.0;
-
-  // Radiation integrals
-  double twiss_rad[6];
-  double *radint;
-
-  double gamma = twiss["GAMMA"];
-  double pc = twiss["PC"];
-  double gammatr = twiss["GAMMATR"];
-  double mass = twiss["MASS"];
-  double charge = twiss["CHARGE"];
-  double q1 = twiss["Q1"];
-  double len = twiss["LENGTH"];
-
-  double aatom = emass / pmass;
-  double betar = BetaRelativisticFromGamma(gamma);
-  double r0 = ParticleRadius(1, aatom);
-  double trev = len / (betar * clight);
-  double frev = 1.0 / trev;
-  double omega = 2.0 * pi * frev;
-  double neta = eta(gamma, gammatr);
-  double epsilon = 1.0e-6;
-
-  // get radiation integrals
-  radint = RadiationDampingLattice(twissdata);
-
-  // Longitudinal Parameters
-  double U0 = RadiationLossesPerTurn(twiss, radint[1], aatom);
-  double phis =
-      SynchronuousPhase(0.0, 173, U0, charge, nrf, harmon, voltages, epsilon);
-  double qs =
-      SynchrotronTune(omega, U0, charge, nrf, harmon, voltages, phis, neta, pc);
-  double omegas = qs * omega;
-
-  // equilibria
-  double *equi =
-      RadiationDampingLifeTimesAndEquilibriumEmittancesWithPartitionNumbers(
-          twiss, radint, aatom, qs);
-
-  double tauradx, taurady, taurads, sigeoe2;
+  // ring quantities and radiation equilibria
+  ODERing ring;
+  ODERingSetup(twiss, twissdata, nrf, harmon, voltages, couplingpercentage,
+               ring);
+  double r0 = ring.r0;
+  double aatom = ring.aatom;
 
-  tauradx = equi[0];
-  taurady = equi[1];
-  taurads = equi[2];
-  sigeoe2 = equi[5];
-
-  double ey0_coupled = max(coupling * equi[3], equi[4]);
-  double sige0 = sigefromsigs(omega, equi[6], qs, gamma, gammatr);
+  double sige0 =
+      sigefromsigs(ring.omega, ring.sigs0, ring.qs, ring.gamma, ring.gammatr);
 
   if (debug_output) {
       cyan();
       printf("Radiation Damping Times\n");
       printf("=======================\n");
-      printline("Tau_rad_x", tauradx, "s");
-      printline("Tau_rad_y", taurady, "s");
-      printline("Tau_rad_s", taurads, "s");
+      printline("Tau_rad_x", ring.tauradx, "s");
+      printline("Tau_rad_y", ring.taurady, "s");
+      printline("Tau_rad_s", ring.taurads, "s");
 
       blue();
       printf("\nLongitudinal Parameters\n");
       printf("=======================\n");
-      printline("Synchrotron Tune", qs, "");
-      printline("Synchrotron Freq", omegas, "Hz");
-      printline("SigEOE2", sigeoe2, "");
-      printline("SigEOE ", sqrt(sigeoe2), "");
-      printline("eta", eta(gamma, gammatr), "");
+      printline("Synchrotron Tune", ring.qs, "");
+      printline("Synchrotron Freq", ring.omegas, "Hz");
+      printline("SigEOE2", ring.sige0 * ring.sige0, "");
+      printline("SigEOE ", ring.sige0, "");
+      printline("eta", eta(ring.gamma, ring.gammatr), "");
       printline("Sigs", sigs[0], "");
-      printline("Sigs_inf ", equi[6], "");
+      printline("Sigs_inf ", ring.sigs0, "");
       printline("SigE0 ", sige0, "");
   };
 
-  sige0 = SigeFromRFAndSigs(equi[6], U0, charge, nrf, harmon, voltages, gamma,
-                            gammatr, pc, len, phis, false);
+  sige0 = SigeFromRFAndSigs(ring.sigs0, ring.U0, twiss["CHARGE"], nrf, harmon,
+                            voltages, ring.gamma, ring.gammatr, twiss["PC"],
+                            twiss["LENGTH"], ring.phis, false);
 
   if (debug_output) {
       // check value
@@ -247,94 +355,35 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
       reset_color_output();
   };
 
-  // write first sige and sige2
-  vector<double> sige2;
-  sige.push_back(sige0);
-  sige2.push_back(sige[0] * sige[0]);
+  // the history of the caller is replaced and grows with its output vectors,
+  // such that stepping does not allocate if these are reserved
+  sige.reserve(t.capacity());
+  sige.assign(1, sige0);
 
   // loop variable
   int i = 0;
 
   // ibs growth rates
   double *ibs;
-  double aes, aex, aey;
+  double rates[3];
 
-  // initial ibs growth rates
-  switch (model) {
-  case 1:
-    ibs = PiwinskiSmooth(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, r0);
-    break;
-  case 2:
-    ibs = PiwinskiLattice(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                          twissdata, r0);
-    break;
-  case 3:
-    ibs = PiwinskiLatticeModified(pnumber, ex[0], ey[0], sigs[0], sige[0],
-                                  twiss, twissdata, r0);
-    break;
-  case 4:
-    ibs = Nagaitsev(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata,
-                    r0);
-    break;
-  case 5:
-    ibs = Nagaitsevtailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                           twissdata, r0, aatom);
-    break;
-  case 6:
-    ibs = ibsmadx(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata, r0,
-                  false);
-    break;
-  case 7:
-    ibs = ibsmadxtailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                         twissdata, r0, aatom);
-    break;
-  case 8:
-    ibs = BjorkenMtingwa2(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                          twissdata, r0);
-    break;
-  case 9:
-    ibs = BjorkenMtingwa(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                         twissdata, r0);
-    break;
-  case 10:
-    ibs = BjorkenMtingwatailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                                twissdata, r0, aatom);
-    break;
-  case 11:
-    ibs = ConteMartini(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                       twissdata, r0);
-    break;
-  case 12:
-    ibs = ConteMartinitailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                              twissdata, r0, aatom);
-    break;
-  case 13:
-    ibs =
-        MadxIBS(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata, r0);
-    break;
+  // tune shifts are recorded for every point of the trajectory
+  if (dqx != NULL) {
+    dqx->clear();
+    dqy->clear();
   }
 
-  // get max tau limited to max 1.0 sec
-  double taum = max(tauradx, taurady);
-  taum = max(taum, taurads);
-  taum = max(taum, 1.0 / ibs[0]);
-  taum = max(taum, 1.0 / ibs[1]);
-  taum = max(taum, 1.0 / ibs[2]);
-  taum = min(taum, 1.0);
-
-  // get min to auto derive stepsize
-  double ddt = min(tauradx, taurady);
-  ddt = min(ddt, taurads);
-  ddt = min(ddt, 1.0 / ibs[0]);
-  ddt = min(ddt, 1.0 / ibs[1]);
-  ddt = min(ddt, 1.0 / ibs[2]);
+  // apply the tuned execution configuration for the run
+  AutotuneScope tuned(model, pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
+                      twissdata, r0, aatom);
 
-  // reduce the step still a bit
-  // ddt /= 2.0;
+  // initial ibs growth rates
+  ibs = IBSRates(model, pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
+                 twissdata, r0, aatom);
 
-  // define max numer of steps
-  int ms = (int)(10 * taum / ddt);
-  ms = min(ms, MaxSteps);
+  // define max numer of steps from the slowest and fastest time constants
+  double taum, ddt;
+  int ms = ODEAutoMaxSteps(ring, ibs, taum, ddt);
 
   if (debug_output){
       // print initial IBS summary
@@ -345,7 +394,7 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
       printf("\nMax tau : %12.6e\n", taum);
       printf("dt      : %12.6e\n", ddt);
       printf("Max step: %i\n\n", ms);
-      printf("Coupling: %12.6f\n\n", coupling);
+      printf("Coupling: %12.6f\n\n", ring.coupling);
       reset_color_output();
   };
 
@@ -371,151 +420,46 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
       std::cout << "]" << int((double)i / ms * 100) << " %\r";
       std::cout.flush();
     };
-    // update timestep
-    ddt = min(tauradx, taurady);
-    ddt = min(ddt, taurads);
-    ddt = min(ddt, 1.0 / ibs[0]);
-    ddt = min(ddt, 1.0 / ibs[1]);
-    ddt = min(ddt, 1.0 / ibs[2]);
-    ddt /= 2.0;
-
-    // ibs growth rates update
-    switch (model) {
-    case 1:
-      ibs = PiwinskiSmooth(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 2:
-      ibs = PiwinskiLattice(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                            twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 3:
-      ibs = PiwinskiLatticeModified(pnumber, ex[i], ey[i], sigs[i], sige[i],
-                                    twiss, twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 4:
-      ibs = Nagaitsev(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                      r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 5:
-      ibs = Nagaitsevtailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                             twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 6:
-      ibs = ibsmadx(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                    r0, false);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 7:
-      ibs = ibsmadxtailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                           twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 8:
-      ibs = BjorkenMtingwa2(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                            twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 9:
-      ibs = BjorkenMtingwa(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                           twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 10:
-      ibs = BjorkenMtingwatailcut(pnumber, ex[i], ey[i], sigs[i], sige[i],
-                                  twiss, twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 11:
-      ibs = ConteMartini(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                         twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 12:
-      ibs = ConteMartinitailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                                twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 13:
-      ibs = MadxIBS(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                    r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
+    // update timestep from the rates of the previous point
+    ddt = ODEAutoTimeStep(ring, method, ibs);
+
+    // ibs growth rates update, fused with the Laslett tune shifts if these
+    // are recorded
+    if (dqx != NULL) {
+      double dq[2];
+      IBSRatesWithTuneShift(model, pnumber, ex[i], ey[i], sigs[i], sige[i],
+                            twiss, twissdata, r0, aatom, rates, dq);
+      dqx->push_back(dq[0]);
+      dqy->push_back(dq[1]);
+      ibs = rates;
+    } else {
+      ibs = IBSRates(model, pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
+                     twissdata, r0, aatom);
     }
 
     // increase loop variable
     i++;
 
-    if (method == "rlx") {
-      ddt *= 4.;
-      double ratio_x = tauradx * aex;
-      double ratio_y = taurady * aey;
-      double ratio_s = taurads * aes;
-
-      double xfactor = 1.0 / (1.0 - ratio_x);
-      double yfactor = 1.0 / (1.0 - ratio_y);
-      double sfactor = 1.0 / (1.0 - ratio_s);
-
-      t.push_back(t[i - 1] + ddt);
-      ex.push_back(ex[i - 1] + ddt * (xfactor * equi[3] - ex[i - 1]));
-      ey.push_back(ey[i - 1] +
-                   ddt * (((1.0 - coupling) * yfactor + coupling * xfactor) *
-                              ey0_coupled -
-                          ey[i - 1]));
-      sige.push_back(sige[i - 1] +
-                     ddt * (sfactor * sqrt(equi[5]) - sige[i - 1]));
-      sige2.push_back(sige[i] * sige[i]);
-      sigs.push_back(sigsfromsige(sige[i], gamma, gammatr, omegas));
-    } else {
-      double dxdt =
-          -(ex[i - 1] - equi[3]) * 2. / tauradx + ex[i - 1] * 2.0 * aex;
-      double dydt =
-          -(ey[i - 1] - ey0_coupled) * 2. / taurady + ey[i - 1] * 2.0 * aey;
-      double dedt =
-          -(sige[i - 1] - sqrt(equi[5])) / taurads + sige[i - 1] * aes;
-
-      t.push_back(t[i - 1] + ddt);
-      ex.push_back(ex[i - 1] + ddt * dxdt);
-      ey.push_back(ey[i - 1] + ddt * dydt);
-      sige.push_back(sige[i - 1] + ddt * dedt);
-      sige2.push_back(sige[i] * sige[i]);
-      sigs.push_back(sigsfromsige(sige[i], gamma, gammatr, omegas));
-    }
+    double exn, eyn, sigen;
+    ODERingStep(ring, method, ibs, ddt, ex[i - 1], ey[i - 1], sige[i - 1], exn,
+                eyn, sigen);
+    t.push_back(t[i - 1] + ddt);
+    ex.push_back(exn);
+    ey.push_back(eyn);
+    sige.push_back(sigen);
+    sigs.push_back(sigsfromsige(sigen, ring.gamma, ring.gammatr, ring.omegas));
 
     // while condition
-  } while (i < ms && (fabs((ex[i] - ex[i - 1]) / ex[i - 1]) > threshold ||
-                      fabs((ey[i] - ey[i - 1]) / ey[i - 1]) > threshold ||
-                      fabs((sigs[i] - sigs[i - 1]) / sigs[i - 1]) > threshold));
+  } while (ODEAutoContinue(i, ms, ex, ey, sigs, threshold));
+  perf.SetElements(i);
+
+  // tune shifts at the final state
+  if (dqx != NULL) {
+    double *dq = LaslettTuneShift(pnumber, ex[i], ey[i], sigs[i], sige[i],
+                                  twiss, twissdata, r0);
+    dqx->push_back(dq[0]);
+    dqy->push_back(dq[1]);
+  }
 
   if (debug_output) {
       // end progressbar
@@ -537,14 +481,33 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
 void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
          int nrf, double harmon[], double voltages[], vector<double> &t,
          vector<double> &ex, vector<double> &ey, vector<double> &sigs,
-         vector<double> sige, int model, double pnumber, int nsteps,
+         vector<double> &sige, int model, double pnumber,
+         int couplingpercentage, double threshold, string method,
+         bool debug_output) {
+  ODEAutoStep(twiss, twissdata, nrf, harmon, voltages, t, ex, ey, sigs, sige,
+              model, pnumber, couplingpercentage, threshold, method,
+              debug_output, NULL, NULL);
+}
+
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> &sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, bool debug_output,
+         vector<double> &dqx, vector<double> &dqy) {
+  ODEAutoStep(twiss, twissdata, nrf, harmon, voltages, t, ex, ey, sigs, sige,
+              model, pnumber, couplingpercentage, threshold, method,
+              debug_output, &dqx, &dqy);
+}
+
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> &sige, int model, double pnumber, int nsteps,
          double stepsize, int couplingpercentage, string method, bool debug_output) {
+  PerfRegion perf("ODE", 0, "ode");
 
   // sanitize limit settings
-  if (couplingpercentage > 100 || couplingpercentage < 0) {
-    couplingpercentage = 0;
-  }
-
   if (!(method == "rlx" || method == "der")) {
     method = "der";
 
@@ -555,94 +518,68 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
     };
   }
 
-  double coupling = (double)couplingpercentage / 100.0;
-
-  // Radiation integrals
-  double gamma = twiss["GAMMA"];
-  double pc = twiss["PC"];
-  double gammatr = twiss["GAMMATR"];
-  double mass = twiss["MASS"];
-  double charge = twiss["CHARGE"];
-  double q1 = twiss["Q1"];
-  double len = twiss["LENGTH"];
-  double twiss_rad[6];
-
-  double aatom = emass / pmass;
-  double betar = BetaRelativisticFromGamma(gamma);
-  double r0 = ParticleRadius(1, aatom);
-  double trev = len / (betar * clight);
-  double frev = 1.0 / trev;
-  double omega = 2.0 * pi * frev;
-  double neta = eta(gamma, gammatr);
-  double epsilon = 1.0e-6;
+  // ring quantities and radiation equilibria
+  ODERing ring;
+  ODERingSetup(twiss, twissdata, nrf, harmon, voltages, couplingpercentage,
+               ring);
+  double r0 = ring.r0;
+  double aatom = ring.aatom;
   double ddt = stepsize;
 
-  double *radint;
-  radint = RadiationDampingLattice(twissdata);
-
-  // Longitudinal Parameters
-  double U0 = RadiationLossesPerTurn(twiss, radint[1], aatom);
-  double phis =
-      SynchronuousPhase(0.0, 173, U0, charge, nrf, harmon, voltages, epsilon);
-  double qs =
-      SynchrotronTune(omega, U0, charge, nrf, harmon, voltages, phis, neta, pc);
-  double omegas = qs * omega;
-
-  // equilibria
-  double *equi =
-      RadiationDampingLifeTimesAndEquilibriumEmittancesWithPartitionNumbers(
-          twiss, radint, aatom, qs);
-
-  double tauradx, taurady, taurads, sigeoe2;
-  tauradx = equi[0];
-  taurady = equi[1];
-  taurads = equi[2];
-  sigeoe2 = equi[5];
-
-  double ey0_coupled = max(coupling * equi[3], equi[4]);
-
   if (debug_output) {
       cyan();
       printf("Radiation Damping Times\n");
       printf("=======================\n");
-      printf("%-30s %20.6e (%s)\n", "Tx :", tauradx, "");
-      printf("%-30s %20.6e (%s)\n", "Ty :", taurady, "");
-      printf("%-30s %20.6e (%s)\n", "Ts :", taurads, "");
+      printf("%-30s %20.6e (%s)\n", "Tx :", ring.tauradx, "");
+      printf("%-30s %20.6e (%s)\n", "Ty :", ring.taurady, "");
+      printf("%-30s %20.6e (%s)\n", "Ts :", ring.taurads, "");
 
       blue();
       printf("\nLongitudinal Parameters\n");
       printf("=======================\n");
-      printf("%-20s : %20.6e (%s)\n", "qs", qs, "");
-      printf("%-20s : %20.6e (%s)\n", "synch freq", omegas, "");
-      printf("%-20s : %20.6e (%s)\n", "SigEOE2", sigeoe2, "");
-      printf("%-20s : %20.6e (%s)\n", "SigEOE", sqrt(sigeoe2), "");
-      printf("%-20s : %20.6e (%s)\n", "eta", eta(gamma, gammatr), "");
+      printf("%-20s : %20.6e (%s)\n", "qs", ring.qs, "");
+      printf("%-20s : %20.6e (%s)\n", "synch freq", ring.omegas, "");
+      printf("%-20s : %20.6e (%s)\n", "SigEOE2", ring.sige0 * ring.sige0, "");
+      printf("%-20s : %20.6e (%s)\n", "SigEOE", ring.sige0, "");
+      printf("%-20s : %20.6e (%s)\n", "eta", eta(ring.gamma, ring.gammatr),
+             "");
       printf("%-20s : %20.6e (%s)\n", "Sigs", sigs[0], "");
-      printf("%-20s : %20.6e (%s)\n", "Sigsinf", equi[6], "");
+      printf("%-20s : %20.6e (%s)\n", "Sigsinf", ring.sigs0, "");
       reset_color_output();
   };
 
-  double sige0 = sigefromsigs(omega, equi[6], qs, gamma, gammatr);
+  double charge = twiss["CHARGE"];
+  double pc = twiss["PC"];
+  double len = twiss["LENGTH"];
+  double sige0 =
+      sigefromsigs(ring.omega, ring.sigs0, ring.qs, ring.gamma, ring.gammatr);
 
   if (debug_output) {
       printf("%-20s : %20.6e (%s)\n", "Sige0", sige0, "");
   };
-      
-  sige0 = SigeFromRFAndSigs(equi[6], U0, charge, nrf, harmon, voltages, gamma,
-                            gammatr, pc, len, phis, false);
+
+  sige0 = SigeFromRFAndSigs(ring.sigs0, ring.U0, charge, nrf, harmon, voltages,
+                            ring.gamma, ring.gammatr, pc, len, ring.phis,
+                            false);
 
   if (debug_output) {
       printf("%-20s : %20.6e (%s)\n", "Sige0 - check", sige0, "");
       reset_color_output();
   };
 
-  sige0 = SigeFromRFAndSigs(sigs[0], U0, charge, nrf, harmon, voltages, gamma,
-                            gammatr, pc, len, phis, false);
+  sige0 = SigeFromRFAndSigs(sigs[0], ring.U0, charge, nrf, harmon, voltages,
+                            ring.gamma, ring.gammatr, pc, len, ring.phis,
+                            false);
 
-  // write first sige and sige2
-  vector<double> sige2;
-  sige.push_back(sige0);
-  sige2.push_back(sige[0] * sige[0]);
+  // write first sige, all histories are allocated once for the fixed number
+  // of steps
+  size_t npoints = max(nsteps, 0) + 1;
+  t.reserve(npoints);
+  ex.reserve(npoints);
+  ey.reserve(npoints);
+  sigs.reserve(npoints);
+  sige.reserve(npoints);
+  sige.assign(1, sige0);
 
   // loop variable
   int i = 0;
@@ -651,60 +588,13 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
   double *ibs;
   double aes, aex, aey;
 
+  // apply the tuned execution configuration for the run
+  AutotuneScope tuned(model, pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
+                      twissdata, r0, aatom);
+
   // initial ibs growth rates
-  switch (model) {
-  case 1:
-    ibs = PiwinskiSmooth(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, r0);
-    break;
-  case 2:
-    ibs = PiwinskiLattice(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                          twissdata, r0);
-    break;
-  case 3:
-    ibs = PiwinskiLatticeModified(pnumber, ex[0], ey[0], sigs[0], sige[0],
-                                  twiss, twissdata, r0);
-    break;
-  case 4:
-    ibs = Nagaitsev(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata,
-                    r0);
-    break;
-  case 5:
-    ibs = Nagaitsevtailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                           twissdata, r0, aatom);
-    break;
-  case 6:
-    ibs = ibsmadx(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata, r0,
-                  false);
-    break;
-  case 7:
-    ibs = ibsmadxtailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                         twissdata, r0, aatom);
-    break;
-  case 8:
-    ibs = BjorkenMtingwa2(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                          twissdata, r0);
-    break;
-  case 9:
-    ibs = BjorkenMtingwa(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                         twissdata, r0);
-    break;
-  case 10:
-    ibs = BjorkenMtingwatailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                                twissdata, r0, aatom);
-    break;
-  case 11:
-    ibs = ConteMartini(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                       twissdata, r0);
-    break;
-  case 12:
-    ibs = ConteMartinitailcut(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
-                              twissdata, r0, aatom);
-    break;
-  case 13:
-    ibs =
-        MadxIBS(pnumber, ex[0], ey[0], sigs[0], sige[0], twiss, twissdata, r0);
-    break;
-  }
+  ibs = IBSRates(model, pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
+                 twissdata, r0, aatom);
 
   if (debug_output) {
       printouts(ibs);
@@ -734,144 +624,33 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
     };
 
     // ibs growth rates update
-    switch (model) {
-    case 1:
-      ibs = PiwinskiSmooth(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 2:
-      ibs = PiwinskiLattice(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                            twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 3:
-      ibs = PiwinskiLatticeModified(pnumber, ex[i], ey[i], sigs[i], sige[i],
-                                    twiss, twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 4:
-      ibs = Nagaitsev(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                      r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 5:
-      ibs = Nagaitsevtailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                             twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 6:
-      ibs = ibsmadx(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                    r0, false);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 7:
-      ibs = ibsmadxtailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                           twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 8:
-      ibs = BjorkenMtingwa2(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                            twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 9:
-      ibs = BjorkenMtingwa(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                           twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 10:
-      ibs = BjorkenMtingwatailcut(pnumber, ex[i], ey[i], sigs[i], sige[i],
-                                  twiss, twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 11:
-      ibs = ConteMartini(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                         twissdata, r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 12:
-      ibs = ConteMartinitailcut(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
-                                twissdata, r0, aatom);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    case 13:
-      ibs = MadxIBS(pnumber, ex[i], ey[i], sigs[i], sige[i], twiss, twissdata,
-                    r0);
-      aes = ibs[0];
-      aex = ibs[1];
-      aey = ibs[2];
-      break;
-    }
+    ibs = IBSRates(model, pnumber, ex[i], ey[i], sigs[i], sige[i], twiss,
+                   twissdata, r0, aatom);
+    aes = ibs[0];
+    aex = ibs[1];
+    aey = ibs[2];
 
     // increase loop variable
     i++;
 
-    if (method == "rlx") {
-      double ratio_x = tauradx * aex;
-      double ratio_y = taurady * aey;
-      double ratio_s = taurads * aes;
-
-      // avoid negative emit
-      if (ratio_x >= 1 || ratio_y >= 1 || ratio_s >= 1) {
-        ddt /= 2.0;
-      }
-
-      double xfactor = 1.0 / (1.0 - ratio_x);
-      double yfactor = 1.0 / (1.0 - ratio_y);
-      double sfactor = 1.0 / (1.0 - ratio_s);
-
-      t.push_back(t[i - 1] + ddt);
-      ex.push_back(ex[i - 1] + ddt * (xfactor * equi[3] - ex[i - 1]));
-      ey.push_back(ey[i - 1] +
-                   ddt * (((1.0 - coupling) * yfactor + coupling * xfactor) *
-                              ey0_coupled -
-                          ey[i - 1]));
-      sige.push_back(sige[i - 1] +
-                     ddt * (sfactor * sqrt(equi[5]) - sige[i - 1]));
-      sige2.push_back(sige[i] * sige[i]);
-      sigs.push_back(sigsfromsige(sige[i], gamma, gammatr, omegas));
-    } else {
-      double dxdt =
-          -(ex[i - 1] - equi[3]) * 2. / tauradx + ex[i - 1] * 2.0 * aex;
-      double dydt =
-          -(ey[i - 1] - ey0_coupled) * 2. / taurady + ey[i - 1] * 2.0 * aey;
-      double dedt =
-          -(sige[i - 1] - sqrt(equi[5])) / taurads + sige[i - 1] * aes;
-
-      t.push_back(t[i - 1] + ddt);
-      ex.push_back(ex[i - 1] + ddt * dxdt);
-      ey.push_back(ey[i - 1] + ddt * dydt);
-      sige.push_back(sige[i - 1] + ddt * dedt);
-      sige2.push_back(sige[i] * sige[i]);
-      sigs.push_back(sigsfromsige(sige[i], gamma, gammatr, omegas));
+    // avoid negative emit, the reduced step is kept for the rest of the run
+    if (method == "rlx" && (ring.tauradx * aex >= 1 ||
+                            ring.taurady * aey >= 1 ||
+                            ring.taurads * aes >= 1)) {
+      ddt /= 2.0;
     }
+    double exn, eyn, sigen;
+    ODERingStep(ring, method, ibs, ddt, ex[i - 1], ey[i - 1], sige[i - 1], exn,
+                eyn, sigen);
+    t.push_back(t[i - 1] + ddt);
+    ex.push_back(exn);
+    ey.push_back(eyn);
+    sige.push_back(sigen);
+    sigs.push_back(sigsfromsige(sigen, ring.gamma, ring.gammatr, ring.omegas));
 
     // while condition
   } while (i < nsteps);
+  perf.SetElements(i);
 
   if (debug_output) {
       // end progressbar
@@ -889,3 +668,1051 @@ void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
       reset_color_output();
   };
 }
+
+/*
+================================================================================
+================================================================================
+METHOD TO SIMULATE THE IBS EMITTANCE GROWTH IN HADRON AND ION RINGS, WITHOUT
+RADIATION DAMPING AND QUANTUM EXCITATION.
+
+THE TIME STEP IS ADAPTED TO THE IBS GROWTH RATES AT THE START OF THE STEP SUCH
+THAT NEITHER THE EMITTANCES NOR THE ENERGY SPREAD CHANGE BY MORE THAN THE
+RELATIVE TOLERANCE IN A SINGLE STEP. EACH STEP GROWS THE
+BEAM EXPONENTIALLY WITH THE MEAN OF THE RATES AT THE START AND AT A PREDICTED
+END OF THE STEP (TWO MODEL EVALUATIONS PER STEP).
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header map
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers of the rf systems
+    - double voltages[]
+        voltages of the rf systems
+    - vector<double> &t
+        vector of timestamps - as input : single initial value in the vector
+    - vector<double> &ex
+        vector of horizontal emittance - as input : single initial value in the
+        vector
+    - vector<double> &ey
+        vector of vertical emittance - as input : single initial value in the
+        vector
+    - vector<double> &sigs
+        vector of bunch lengths sigma s - as input : single initial value in the
+        vector
+    - vector<double> sige
+        vector of energy spreads sigma E
+    - int model
+        integer to select the IBS models
+    - double pnumber
+        number of particles in the bunch
+    - double charge
+        particle charge in units of the elementary charge
+    - double aatom
+        particle mass in units of the proton mass
+    - double tmax
+        simulated time
+    - double tolerance
+        maximum relative change of the emittances and the energy spread per
+        step
+
+  Returns:
+  --------
+    - vector<double> &t
+        vector of timestamps
+    - vector<double> &ex
+        vector of horizontal emittance
+    - vector<double> &ey
+        vector of vertical emittance
+    - vector<double> &sigs
+        vector of bunch lengths sigma s
+================================================================================
+================================================================================
+*/
+void ODEHadron(map<string, double> &twiss,
+               map<string, vector<double>> &twissdata, int nrf,
+               double harmon[], double voltages[], vector<double> &t,
+               vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+               vector<double> sige, int model, double pnumber, double charge,
+               double aatom, double tmax, double tolerance,
+               bool debug_output) {
+  PerfRegion perf("ODEHadron", 0, "ode");
+
+  // safety max steps
+  int MaxSteps = 10000;
+
+  // sanitize limit settings
+  if (tolerance > 0.5 || tolerance < 1.0e-6) {
+    tolerance = 0.05;
+  }
+
+  // the Coulomb logarithms take the species from the header
+  map<string, double> header = twiss;
+  header["CHARGE"] = charge;
+  header["MASS"] = aatom * pmass;
+
+  double gamma = header["GAMMA"];
+  double pc = header["PC"];
+  double gammatr = header["GAMMATR"];
+  double len = header["LENGTH"];
+
+  double betar = BetaRelativisticFromGamma(gamma);
+  double r0 = ParticleRadius(charge, aatom);
+  double trev = len / (betar * clight);
+  double frev = 1.0 / trev;
+  double omega = 2.0 * pi * frev;
+  double neta = fabs(eta(gamma, gammatr));
+  double epsilon = 1.0e-6;
+
+  // Longitudinal Parameters, no energy loss per turn
+  double phis =
+      SynchronuousPhase(0.0, 173, 0.0, charge, nrf, harmon, voltages, epsilon);
+  double qs = SynchrotronTune(omega, 0.0, charge, nrf, harmon, voltages, phis,
+                              neta, pc);
+  double omegas = qs * omega;
+
+  // inverse of sigsfromsige
+  sige.clear();
+  sige.reserve(t.capacity());
+  sige.push_back(sigs[0] * omegas * betar * betar / (clight * neta));
+
+  if (debug_output) {
+    blue();
+    printf("Longitudinal Parameters\n");
+    printf("=======================\n");
+    printline("Synchrotron Tune", qs, "");
+    printline("Synchrotron Freq", omegas, "Hz");
+    printline("eta", neta, "");
+    printline("Sigs", sigs[0], "");
+    printline("SigE0 ", sige[0], "");
+    reset_color_output();
+  };
+
+  // apply the tuned execution configuration for the run
+  AutotuneScope tuned(model, pnumber, ex[0], ey[0], sigs[0], sige[0], header,
+                      twissdata, r0, aatom);
+
+  int i = 0;
+  double *ibs;
+  double a0[3], a1[3];
+  do {
+    ibs = IBSRates(model, pnumber, ex[i], ey[i], sigs[i], sige[i], header,
+                   twissdata, r0, aatom);
+    copy(ibs, ibs + 3, a0);
+
+    // emittances grow with twice the amplitude growth rates
+    double rmax = max(fabs(a0[0]), 2.0 * fabs(a0[1]));
+    rmax = max(rmax, 2.0 * fabs(a0[2]));
+
+    double ddt = tmax - t[i];
+    if (rmax * ddt > tolerance) {
+      ddt = tolerance / rmax;
+    }
+
+    // predictor with the rates at the start of the step
+    double expred = ex[i] * exp(2.0 * a0[1] * ddt);
+    double eypred = ey[i] * exp(2.0 * a0[2] * ddt);
+    double sigepred = sige[i] * exp(a0[0] * ddt);
+    double sigspred = sigsfromsige(sigepred, gamma, gammatr, omegas);
+    ibs = IBSRates(model, pnumber, expred, eypred, sigspred, sigepred, header,
+                   twissdata, r0, aatom);
+    copy(ibs, ibs + 3, a1);
+
+    // corrector with the mean rates over the step
+    double aes = 0.5 * (a0[0] + a1[0]);
+    double aex = 0.5 * (a0[1] + a1[1]);
+    double aey = 0.5 * (a0[2] + a1[2]);
+
+    i++;
+
+    t.push_back(t[i - 1] + ddt);
+    ex.push_back(ex[i - 1] * exp(2.0 * aex * ddt));
+    ey.push_back(ey[i - 1] * exp(2.0 * aey * ddt));
+    sige.push_back(sige[i - 1] * exp(aes * ddt));
+    sigs.push_back(sigsfromsige(sige[i], gamma, gammatr, omegas));
+  } while (i < MaxSteps && t[i] < tmax);
+  perf.SetElements(i);
+
+  if (debug_output) {
+    blue();
+    printf("%-20s : %i\n", "Steps", i);
+    printf("%-20s : %12.6e\n", "Final ex", ex[ex.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final ey", ey[ey.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final sigs", sigs[sigs.size() - 1]);
+    reset_color_output();
+  };
+}
+
+ODEScratch &ThreadODEScratch(double ex0, double ey0, double sigs0) {
+  static thread_local ODEScratch scratch;
+  scratch.t.assign(1, 0.0);
+  scratch.ex.assign(1, ex0);
+  scratch.ey.assign(1, ey0);
+  scratch.sigs.assign(1, sigs0);
+  scratch.sige.clear();
+  return scratch;
+}
+
+/*
+================================================================================
+  RELATIVE LOSS RATE -dN/dt / N OF A LOSS MODEL
+================================================================================
+*/
+static double ODELossRate(const LossModel &losses, double t, double pnumber,
+                          double ex, double ey, double sigs) {
+  double rate = 0.0;
+
+  // tabulated rate, linear interpolation and constant outside the table
+  size_t m = min(losses.time.size(), losses.rate.size());
+  if (m == 1 || (m > 1 && t <= losses.time[0])) {
+    rate += losses.rate[0];
+  } else if (m > 1 && t >= losses.time[m - 1]) {
+    rate += losses.rate[m - 1];
+  } else if (m > 1) {
+    size_t k = upper_bound(losses.time.begin(), losses.time.begin() + m, t) -
+               losses.time.begin();
+    double w = (t - losses.time[k - 1]) / (losses.time[k] - losses.time[k - 1]);
+    rate += (1.0 - w) * losses.rate[k - 1] + w * losses.rate[k];
+  }
+
+  if (losses.taugas > 0.0) {
+    rate += 1.0 / losses.taugas;
+  }
+
+  // Touschek rate proportional to the density N / (sqrt(ex ey) sigs)
+  if (losses.tautouschek > 0.0 && losses.pnumber0 > 0.0) {
+    rate += (pnumber / losses.pnumber0) *
+            sqrt(losses.ex0 * losses.ey0 / (ex * ey)) * (losses.sigs0 / sigs) /
+            losses.tautouschek;
+  }
+  return rate;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO SIMULATE THE EMITTANCE EVOLUTION WITH INJECTION (TOP-UP) EVENTS AND
+PARTICLE LOSSES.
+
+  BETWEEN EVENTS THE ODE IS INTEGRATED WITH THE AUTO TIME STEP UNTIL THE
+  RELATIVE CHANGES DROP BELOW THE THRESHOLD. AT EQUILIBRIUM THE BEAM FOLLOWS
+  THE POPULATION N(t) IN STEPS OF AT MOST dnmax RELATIVE CHANGE (OR JUMPS TO
+  THE NEXT EVENT WITHOUT LOSSES) AND RELAXES TO THE NEW EQUILIBRIUM.
+
+  WITH LOSSES THE GROWTH RATES ARE ONLY RECALCULATED IF THE BEAM STATE MOVED
+  BY MORE THAN THE THRESHOLD SINCE THE LAST EVALUATION. OTHERWISE THE LAST
+  RATES ARE SCALED WITH N AND THE COULOMB LOG (N ONLY FOR THE PIWINSKI
+  MODELS), WHICH IS EXACT FOR THE PREFACTOR AT FIXED EMITTANCES.
+
+  AT AN EVENT THE INJECTED PARTICLES ARE ADDED AND THE SECOND MOMENTS
+  (EMITTANCES AND SIGE^2) ARE MIXED WEIGHTED WITH THE PARTICLE NUMBERS. THE
+  LATTICE AND RF DATA ARE ONLY CALCULATED ONCE.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header map
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers of the rf systems
+    - double voltages[]
+        voltages of the rf systems
+    - vector<double> &t
+        vector of timestamps - as input : single initial value in the vector
+    - vector<double> &ex
+        vector of horizontal emittance - as input : single initial value in the
+        vector
+    - vector<double> &ey
+        vector of vertical emittance - as input : single initial value in the
+        vector
+    - vector<double> &sigs
+        vector of bunch lengths sigma s - as input : single initial value in the
+        vector
+    - vector<double> sige
+        vector of energy spreads sigma E
+    - int model
+        integer to select the IBS models
+    - double pnumber
+        initial number of particles in the bunch
+    - int couplingpercentage
+        horizontal betatron coupling
+    - double threshold
+        relative change per step below which the beam is at equilibrium
+    - string method
+        method to use : rlx or der
+    - vector<InjectionEvent> events
+        injections, sorted by time
+    - LossModel losses
+        particle losses
+    - double tmax
+        end time of the simulation
+    - vector<double> &n
+        output variable - number of particles for every time step
+
+  Returns:
+  --------
+    - vector<double> &t
+        vector of timestamps, event times appear twice (before and after)
+    - vector<double> &ex
+        vector of horizontal emittance
+    - vector<double> &ey
+        vector of vertical emittance
+    - vector<double> &sigs
+        vector of bunch lengths sigma s
+    - vector<double> &n
+        vector of particle numbers
+================================================================================
+================================================================================
+*/
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, vector<InjectionEvent> events,
+         const LossModel &losses, double tmax, vector<double> &n,
+         bool debug_output) {
+  PerfRegion perf("ODE", 0, "ode");
+
+  // safety max steps
+  int MaxSteps = 1000000;
+
+  // sanitize limit settings
+  if (!(method == "rlx" || method == "der")) {
+    method = "der";
+  }
+  if (threshold > 1.0 || threshold < 1.0e-6) {
+    threshold = 1e-4;
+  }
+  double dnmax = losses.dnmax;
+  if (dnmax > 0.5 || dnmax < 1.0e-6) {
+    dnmax = 0.01;
+  }
+
+  ODERing ring;
+  ODERingSetup(twiss, twissdata, nrf, harmon, voltages, couplingpercentage,
+               ring);
+
+  sort(events.begin(), events.end(),
+       [](const InjectionEvent &a, const InjectionEvent &b) {
+         return a.time < b.time;
+       });
+
+  sige.clear();
+  sige.reserve(t.capacity());
+  sige.push_back(
+      sigefromsigs(ring.omega, sigs[0], ring.qs, ring.gamma, ring.gammatr));
+  n.clear();
+  n.reserve(t.capacity());
+  n.push_back(pnumber);
+
+  // apply the tuned execution configuration for the run
+  AutotuneScope tuned(model, pnumber, ex[0], ey[0], sigs[0], sige[0], twiss,
+                      twissdata, ring.r0, ring.aatom);
+
+  // last full rate evaluation, rescaled with N while the state is unchanged
+  bool cached = false;
+  double cex = 0.0, cey = 0.0, csigs = 0.0, cn = 0.0, cclog = 0.0;
+  double crates[3] = {0.0, 0.0, 0.0};
+  int nfull = 0, nscaled = 0;
+
+  size_t e = 0;
+  int i = 0;
+  bool equilibrium = false;
+  while (t[i] < tmax && i < MaxSteps) {
+    double tnext = tmax;
+    if (e < events.size()) {
+      tnext = min(tnext, max(events[e].time, t[i]));
+    }
+
+    double loss = ODELossRate(losses, t[i], n[i], ex[i], ey[i], sigs[i]);
+    bool lossy = loss > 0.0 && n[i] > 0.0;
+
+    double exn = ex[i], eyn = ey[i], sigen = sige[i], nn = n[i];
+    bool stepped = !equilibrium;
+    if (equilibrium) {
+      // stationary until the next event or until N changed by dnmax
+      double dt = tnext - t[i];
+      if (lossy) {
+        dt = min(dt, dnmax / loss);
+        nn = n[i] * exp(-loss * dt);
+        equilibrium = false;
+      }
+      t.push_back(t[i] + dt);
+    } else {
+      double ibs[3];
+      if (lossy && cached && fabs(ex[i] / cex - 1.0) <= threshold &&
+          fabs(ey[i] / cey - 1.0) <= threshold &&
+          fabs(sigs[i] / csigs - 1.0) <= threshold) {
+        double scale = (n[i] / cn) *
+                       ModelCoulombLog(model, n[i], ex[i], ey[i], twiss,
+                                       sige[i], sigs[i], ring.tauradx,
+                                       ring.taurady, ring.taurads, ring.r0) /
+                       cclog;
+        for (int k = 0; k < 3; k++) {
+          ibs[k] = crates[k] * scale;
+        }
+        nscaled++;
+      } else {
+        double *rates = IBSRates(model, n[i], ex[i], ey[i], sigs[i], sige[i],
+                                 twiss, twissdata, ring.r0, ring.aatom);
+        copy(rates, rates + 3, ibs);
+        nfull++;
+        if (lossy) {
+          copy(rates, rates + 3, crates);
+          cex = ex[i];
+          cey = ey[i];
+          csigs = sigs[i];
+          cn = n[i];
+          cclog = ModelCoulombLog(model, n[i], ex[i], ey[i], twiss, sige[i],
+                                  sigs[i], ring.tauradx, ring.taurady,
+                                  ring.taurads, ring.r0);
+          cached = true;
+        }
+      }
+
+      double ddt = ODEAutoTimeStep(ring, method, ibs);
+      ddt = min(ddt, tnext - t[i]);
+
+      ODERingStep(ring, method, ibs, ddt, ex[i], ey[i], sige[i], exn, eyn,
+                  sigen);
+      if (lossy) {
+        nn = n[i] * exp(-loss * ddt);
+      }
+      t.push_back(t[i] + ddt);
+    }
+    ex.push_back(exn);
+    ey.push_back(eyn);
+    sige.push_back(sigen);
+    sigs.push_back(sigsfromsige(sigen, ring.gamma, ring.gammatr, ring.omegas));
+    n.push_back(nn);
+    i++;
+
+    if (stepped) {
+      equilibrium = fabs((ex[i] - ex[i - 1]) / ex[i - 1]) <= threshold &&
+                    fabs((ey[i] - ey[i - 1]) / ey[i - 1]) <= threshold &&
+                    fabs((sigs[i] - sigs[i - 1]) / sigs[i - 1]) <= threshold;
+    }
+
+    // injections at this time, mixing the second moments
+    while (e < events.size() && events[e].time <= t[i]) {
+      const InjectionEvent &ev = events[e];
+      // a negative number removes particles without changing the moments
+      double ntot = max(n[i] + ev.pnumber, 0.0);
+      double w = ev.pnumber > 0.0 ? ev.pnumber / ntot : 0.0;
+      double sigeinj = sigefromsigs(ring.omega, ev.sigs, ring.qs, ring.gamma,
+                                    ring.gammatr);
+
+      t.push_back(t[i]);
+      ex.push_back((1.0 - w) * ex[i] + w * ev.ex);
+      ey.push_back((1.0 - w) * ey[i] + w * ev.ey);
+      sige.push_back(
+          sqrt((1.0 - w) * sige[i] * sige[i] + w * sigeinj * sigeinj));
+      sigs.push_back(
+          sigsfromsige(sige[i + 1], ring.gamma, ring.gammatr, ring.omegas));
+      n.push_back(ntot);
+      i++;
+      e++;
+      equilibrium = false;
+    }
+  }
+  perf.SetElements(i);
+
+  if (debug_output) {
+    blue();
+    printf("%-20s : %i\n", "Steps", i);
+    printf("%-20s : %zu\n", "Injections", e);
+    printf("%-20s : %i\n", "Full rate evals", nfull);
+    printf("%-20s : %i\n", "Scaled rate evals", nscaled);
+    printf("%-20s : %12.6e\n", "Final N", n[n.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final ex", ex[ex.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final ey", ey[ey.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final sigs", sigs[sigs.size() - 1]);
+    reset_color_output();
+  };
+}
+
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, vector<InjectionEvent> events,
+         double tmax, vector<double> &n, bool debug_output) {
+  ODE(twiss, twissdata, nrf, harmon, voltages, t, ex, ey, sigs, sige, model,
+      pnumber, couplingpercentage, threshold, method, events, LossModel(), tmax,
+      n, debug_output);
+}
+
+/*
+================================================================================
+  OPTICS RAMP : LINEAR INTERPOLATION OF THE PREPARED LATTICES OF A RAMP
+
+  THE BASE OPTICS COLUMNS AND THE NUMERIC HEADER VALUES COMMON TO ALL LATTICES
+  ARE INTERPOLATED INTO A WORKING COPY, THE DERIVED COLUMNS ARE RECALCULATED
+  WITH updateTwiss. THE RADIATION INTEGRALS ARE INTERPOLATED WITH THE SAME
+  WEIGHT, SUCH THAT THE RING QUANTITIES FOLLOW THE OPTICS CONSISTENTLY.
+================================================================================
+*/
+struct ODERampWork {
+  map<string, double> twiss;
+  map<string, vector<double>> twissdata;
+  vector<double *> headerout;
+  vector<vector<const double *>> headerin;
+  vector<vector<double> *> columnout;
+  vector<vector<const vector<double> *>> columnin;
+  vector<array<double, 7>> radint;
+  // number of lattices used, the shortest of the ramp vectors
+  size_t knots = 0;
+  // segment and weight of the current working lattice
+  size_t segment = 0;
+  double time = 0.0;
+};
+
+// index of the first knot after time, 0 before and knots after the ramp
+static size_t ODERampSegment(const OpticsRamp &ramp, const ODERampWork &work,
+                             double time) {
+  return upper_bound(ramp.time.begin(), ramp.time.begin() + work.knots, time) -
+         ramp.time.begin();
+}
+
+// the ramp is only read, lattices without the derived columns are prepared
+// on a copy for their radiation integrals
+static void ODERampSetup(const OpticsRamp &ramp, ODERampWork &work) {
+  static const char *derived[13] = {"rho", "k",   "gammax", "gammay", "hx",
+                                    "hy",  "I1",  "I2",     "I3",     "I4x",
+                                    "I4y", "I5x", "I5y"};
+  size_t nk = work.knots;
+  size_t n = ramp.twissdata[0].count("L") ? ramp.twissdata[0].at("L").size()
+                                          : 0;
+
+  work.radint.resize(nk);
+  for (size_t k = 0; k < nk; k++) {
+    const map<string, vector<double>> *table = &ramp.twissdata[k];
+    map<string, vector<double>> prepared;
+    if (table->count("I5y") == 0) {
+      prepared = *table;
+      updateTwiss(prepared);
+      table = &prepared;
+    }
+    for (int j = 0; j < 7; j++) {
+      const vector<double> &column = table->at(derived[6 + j]);
+      work.radint[k][j] = accumulate(column.begin(), column.end(), 0.0);
+    }
+  }
+
+  work.twiss = ramp.twiss[0];
+  work.twissdata = ramp.twissdata[0];
+
+  for (auto &entry : work.twiss) {
+    vector<const double *> in;
+    for (size_t k = 0; k < nk; k++) {
+      auto it = ramp.twiss[k].find(entry.first);
+      if (it == ramp.twiss[k].end()) {
+        break;
+      }
+      in.push_back(&it->second);
+    }
+    if (in.size() == nk) {
+      work.headerout.push_back(&entry.second);
+      work.headerin.push_back(in);
+    }
+  }
+
+  for (auto &entry : work.twissdata) {
+    if (find(derived, derived + 13, entry.first) != derived + 13) {
+      continue;
+    }
+    vector<const vector<double> *> in;
+    for (size_t k = 0; k < nk; k++) {
+      auto it = ramp.twissdata[k].find(entry.first);
+      if (it == ramp.twissdata[k].end() || it->second.size() != n) {
+        break;
+      }
+      in.push_back(&it->second);
+    }
+    if (in.size() == nk && entry.second.size() == n) {
+      work.columnout.push_back(&entry.second);
+      work.columnin.push_back(in);
+    }
+  }
+}
+
+// interpolate the working lattice and the ring quantities at time
+static void ODERampUpdate(const OpticsRamp &ramp, ODERampWork &work,
+                          double time, int nrf, double harmon[],
+                          double voltages[], int couplingpercentage,
+                          ODERing &ring) {
+  size_t nk = work.knots;
+  size_t seg = ODERampSegment(ramp, work, time);
+  size_t a = seg == 0 ? 0 : seg - 1;
+  size_t b = seg == nk ? nk - 1 : seg;
+  double w = 0.0;
+  if (a != b) {
+    w = (time - ramp.time[a]) / (ramp.time[b] - ramp.time[a]);
+  }
+
+  for (size_t c = 0; c < work.headerout.size(); c++) {
+    *work.headerout[c] =
+        (1.0 - w) * *work.headerin[c][a] + w * *work.headerin[c][b];
+  }
+  for (size_t c = 0; c < work.columnout.size(); c++) {
+    double *out = work.columnout[c]->data();
+    const double *ina = work.columnin[c][a]->data();
+    const double *inb = work.columnin[c][b]->data();
+    size_t n = work.columnout[c]->size();
+    for (size_t j = 0; j < n; j++) {
+      out[j] = (1.0 - w) * ina[j] + w * inb[j];
+    }
+  }
+  updateTwiss(work.twissdata);
+
+  double radint[7];
+  for (int j = 0; j < 7; j++) {
+    radint[j] = (1.0 - w) * work.radint[a][j] + w * work.radint[b][j];
+  }
+  ODERingFromIntegrals(work.twiss, radint, nrf, harmon, voltages,
+                       couplingpercentage, ring);
+
+  work.segment = seg;
+  work.time = time;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO SIMULATE THE EMITTANCE EVOLUTION DURING AN OPTICS RAMP (E.G. A BETA
+SQUEEZE OR AN ENERGY RAMP) GIVEN AS A SEQUENCE OF PREPARED LATTICES.
+
+  THE OPTICS, HEADER VALUES AND RADIATION INTEGRALS ARE INTERPOLATED LINEARLY
+  IN TIME BETWEEN THE LATTICES AND HELD CONSTANT BEFORE THE FIRST AND AFTER THE
+  LAST ONE. THE WORKING LATTICE IS REFRESHED WHENEVER THE INTERPOLATION WEIGHT
+  CHANGED BY dwmax, THE RING QUANTITIES (DAMPING TIMES, EQUILIBRIUM EMITTANCES,
+  SYNCHROTRON TUNE) ARE RECALCULATED WITH IT.
+
+  THE ODE IS INTEGRATED WITH THE AUTO TIME STEP UNTIL THE RELATIVE CHANGES
+  DROP BELOW THE THRESHOLD, NO STEP CROSSES A LATTICE REFRESH OR A LATTICE
+  TIME. AT EQUILIBRIUM THE OPTICS ADVANCE TO THE NEXT REFRESH (OR JUMP TO THE
+  START OF THE RAMP OR TO tmax) AND THE BEAM RELAXES TO THE NEW EQUILIBRIUM.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - const OpticsRamp &ramp
+        lattices and their times, not modified
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers of the rf systems
+    - double voltages[]
+        voltages of the rf systems
+    - vector<double> &t
+        vector of timestamps - as input : single initial value in the vector
+    - vector<double> &ex
+        vector of horizontal emittance - as input : single initial value in the
+        vector
+    - vector<double> &ey
+        vector of vertical emittance - as input : single initial value in the
+        vector
+    - vector<double> &sigs
+        vector of bunch lengths sigma s - as input : single initial value in the
+        vector
+    - vector<double> sige
+        vector of energy spreads sigma E
+    - int model
+        integer to select the IBS models
+    - double pnumber
+        number of particles in the bunch
+    - int couplingpercentage
+        horizontal betatron coupling
+    - double threshold
+        relative change per step below which the beam is at equilibrium
+    - string method
+        method to use : rlx or der
+    - double tmax
+        end time of the simulation
+
+  Returns:
+  --------
+    - vector<double> &t
+        vector of timestamps
+    - vector<double> &ex
+        vector of horizontal emittance
+    - vector<double> &ey
+        vector of vertical emittance
+    - vector<double> &sigs
+        vector of bunch lengths sigma s
+================================================================================
+================================================================================
+*/
+void ODE(const OpticsRamp &ramp, int nrf, double harmon[], double voltages[],
+         vector<double> &t, vector<double> &ex, vector<double> &ey,
+         vector<double> &sigs, vector<double> sige, int model, double pnumber,
+         int couplingpercentage, double threshold, string method, double tmax,
+         bool debug_output) {
+  PerfRegion perf("ODE", 0, "ode");
+
+  size_t nk = min(ramp.time.size(),
+                  min(ramp.twiss.size(), ramp.twissdata.size()));
+  if (nk == 0) {
+    return;
+  }
+
+  // safety max steps
+  int MaxSteps = 1000000;
+
+  // sanitize limit settings
+  if (!(method == "rlx" || method == "der")) {
+    method = "der";
+  }
+  if (threshold > 1.0 || threshold < 1.0e-6) {
+    threshold = 1e-4;
+  }
+  double dwmax = ramp.dwmax;
+  if (dwmax > 0.5 || dwmax < 1.0e-6) {
+    dwmax = 0.01;
+  }
+
+  ODERampWork work;
+  work.knots = nk;
+  ODERampSetup(ramp, work);
+
+  ODERing ring;
+  ODERampUpdate(ramp, work, t[0], nrf, harmon, voltages, couplingpercentage,
+                ring);
+  int nlattice = 1;
+
+  sige.clear();
+  sige.reserve(t.capacity());
+  sige.push_back(
+      sigefromsigs(ring.omega, sigs[0], ring.qs, ring.gamma, ring.gammatr));
+
+  // apply the tuned execution configuration for the run
+  AutotuneScope tuned(model, pnumber, ex[0], ey[0], sigs[0], sige[0],
+                      work.twiss, work.twissdata, ring.r0, ring.aatom);
+
+  int i = 0;
+  bool equilibrium = false;
+  while (t[i] < tmax && i < MaxSteps) {
+    size_t seg = work.segment;
+    // length of the current lattice interval, 0 outside the ramp
+    double span = 0.0;
+    if (seg > 0 && seg < nk) {
+      span = ramp.time[seg] - ramp.time[seg - 1];
+    }
+
+    // next refresh of the working lattice : the optics changed by dwmax or
+    // the next lattice is reached
+    double tnext = tmax;
+    if (seg == 0) {
+      tnext = min(tnext, ramp.time[0]);
+    } else if (seg < nk) {
+      tnext = min(tnext, min(work.time + dwmax * span, ramp.time[seg]));
+    }
+
+    double exn = ex[i], eyn = ey[i], sigen = sige[i];
+    bool stepped = !equilibrium;
+    if (equilibrium) {
+      // stationary until the next refresh
+      t.push_back(max(tnext, t[i]));
+    } else {
+      double *ibs = IBSRates(model, pnumber, ex[i], ey[i], sigs[i], sige[i],
+                             work.twiss, work.twissdata, ring.r0, ring.aatom);
+
+      double ddt = ODEAutoTimeStep(ring, method, ibs);
+
+      // the step ends at the next refresh at the latest
+      double tn = t[i] + ddt;
+      if (tn >= tnext) {
+        tn = tnext;
+        ddt = tnext - t[i];
+      }
+
+      ODERingStep(ring, method, ibs, ddt, ex[i], ey[i], sige[i], exn, eyn,
+                  sigen);
+      t.push_back(tn);
+    }
+
+    // refresh the lattice if the interpolation weight moved by dwmax
+    size_t segn = ODERampSegment(ramp, work, t[i + 1]);
+    bool refresh = segn != seg;
+    if (!refresh && span > 0.0) {
+      refresh = (t[i + 1] - work.time) >= dwmax * span * (1.0 - 1e-9);
+    }
+    if (refresh) {
+      ODERampUpdate(ramp, work, t[i + 1], nrf, harmon, voltages,
+                    couplingpercentage, ring);
+      nlattice++;
+      equilibrium = false;
+    }
+
+    ex.push_back(exn);
+    ey.push_back(eyn);
+    sige.push_back(sigen);
+    sigs.push_back(sigsfromsige(sigen, ring.gamma, ring.gammatr, ring.omegas));
+    i++;
+
+    if (stepped && !refresh) {
+      equilibrium = fabs((ex[i] - ex[i - 1]) / ex[i - 1]) <= threshold &&
+                    fabs((ey[i] - ey[i - 1]) / ey[i - 1]) <= threshold &&
+                    fabs((sigs[i] - sigs[i - 1]) / sigs[i - 1]) <= threshold;
+    }
+  }
+  perf.SetElements(i);
+
+  if (debug_output) {
+    blue();
+    printf("%-20s : %i\n", "Steps", i);
+    printf("%-20s : %i\n", "Lattice updates", nlattice);
+    printf("%-20s : %12.6e\n", "Final ex", ex[ex.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final ey", ey[ey.size() - 1]);
+    printf("%-20s : %12.6e\n", "Final sigs", sigs[sigs.size() - 1]);
+    reset_color_output();
+  };
+}
+
+/*
+================================================================================
+  RESIDUAL OF THE "der" EQUATIONS OF MOTION
+
+    F0 = -2 (ex - ex_rad) / tau_x + 2 ex a_x
+    F1 = -2 (ey - ey_rad) / tau_y + 2 ey a_y
+    F2 = -(sige - sige_rad) / tau_s + sige a_s
+
+  OR OF THE "rlx" EQUATIONS, WITH f_i = 1 / (1 - tau_i a_i) AND COUPLING c
+
+    F0 = f_x ex_rad - ex
+    F1 = ((1 - c) f_y + c f_x) ey_rad - ey
+    F2 = f_s sige_rad - sige
+
+  AT STATE u = (ex, ey, sigs) AND PARAMETERS p = (pnumber, coupling percentage,
+  RF voltage scale, energy in GeV). THE RF AND ENERGY DEPENDENT RING QUANTITIES
+  ARE RECALCULATED FOR EVERY EVALUATION, THE RADIATION INTEGRALS ARE SHARED.
+  THE EQUATIONS ARE THOSE OF THE ODE STEP (ODERingDerivatives).
+================================================================================
+*/
+static void EquilibriumResidual(map<string, double> twiss,
+                                map<string, vector<double>> &twissdata,
+                                double *radint, int nrf, double harmon[],
+                                double voltages[], int model,
+                                const string &method, double *u, double *p,
+                                double *F, double *rates) {
+  double mass = twiss["MASS"];
+  twiss["ENERGY"] = p[3];
+  twiss["GAMMA"] = p[3] / mass;
+  twiss["PC"] = sqrt(p[3] * p[3] - mass * mass);
+
+  vector<double> v(voltages, voltages + nrf);
+  for (int k = 0; k < nrf; k++) {
+    v[k] *= p[2];
+  }
+
+  // ring quantities without coupling, the coupling is a parameter
+  ODERing ring;
+  ODERingFromIntegrals(twiss, radint, nrf, harmon, v.data(), 0, ring);
+  ring.coupling = p[1] / 100.0;
+  ring.ey0 = max(ring.coupling * ring.ex0, ring.ey0);
+
+  double sige =
+      sigefromsigs(ring.omega, u[2], ring.qs, ring.gamma, ring.gammatr);
+  double *ibs = IBSRates(model, p[0], u[0], u[1], u[2], sige, twiss,
+                         twissdata, ring.r0, ring.aatom);
+  rates[0] = ibs[0];
+  rates[1] = ibs[1];
+  rates[2] = ibs[2];
+
+  ODERingDerivatives(ring, method, rates, u[0], u[1], sige, F);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE SENSITIVITIES OF THE IBS EQUILIBRIUM WITH RESPECT TO
+BUNCH POPULATION, COUPLING, RF VOLTAGE AND ENERGY.
+
+  IMPLICIT FUNCTION THEOREM AT THE EQUILIBRIUM F(u, p) = 0 :
+
+    du/dp = - (dF/du)^-1 dF/dp
+
+  dF/du AND dF/dp WITH CENTRAL DIFFERENCES (15 RESIDUAL EVALUATIONS). THE
+  RESIDUAL IS THAT OF THE EQUATIONS THE EQUILIBRIUM WAS SOLVED WITH.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+    - 18/10/2026 : residual of the "rlx" equations
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &twissdata
+        twiss table
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers
+    - double voltages[]
+        rf voltages
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - int couplingpercentage
+        coupling in percent
+    - double ex, ey, sigs
+        equilibrium
+    - map<string, vector<double>> &sensitivities
+        output variable - derivatives
+    - const string &method
+        equations of motion, "der" or "rlx" (others are taken as "der")
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void EquilibriumSensitivities(map<string, double> &twiss,
+                              map<string, vector<double>> &twissdata, int nrf,
+                              double harmon[], double voltages[], int model,
+                              double pnumber, int couplingpercentage,
+                              double ex, double ey, double sigs,
+                              map<string, vector<double>> &sensitivities,
+                              const string &method) {
+  PerfRegion perf("EquilibriumSensitivities", 1, "ode");
+  const int nu = 3, np = 4;
+  const int ncases = 1 + 2 * nu + 2 * np;
+
+  double radint[7];
+  double *rad = RadiationDampingLattice(twissdata);
+  copy(rad, rad + 7, radint);
+
+  double u0[nu] = {ex, ey, sigs};
+  double p0[np] = {pnumber, (double)couplingpercentage, 1.0, twiss["ENERGY"]};
+  double hu[nu], hp[np];
+  for (int j = 0; j < nu; j++) {
+    hu[j] = 1.0e-5 * fabs(u0[j]);
+  }
+  hp[0] = 1.0e-5 * pnumber;
+  hp[1] = 1.0e-2;
+  hp[2] = 1.0e-5;
+  hp[3] = 1.0e-6 * p0[3];
+
+  // case 0 : base point, then +- steps in u and p
+  vector<double> F(3 * ncases), R(3 * ncases);
+#pragma omp parallel for shared(twiss, twissdata)
+  for (int c = 0; c < ncases; c++) {
+    double u[nu], p[np];
+    copy(u0, u0 + nu, u);
+    copy(p0, p0 + np, p);
+    if (c > 0 && c <= 2 * nu) {
+      int j = (c - 1) / 2;
+      u[j] += ((c - 1) % 2 == 0) ? hu[j] : -hu[j];
+    } else if (c > 2 * nu) {
+      int j = (c - 1 - 2 * nu) / 2;
+      p[j] += ((c - 1 - 2 * nu) % 2 == 0) ? hp[j] : -hp[j];
+    }
+    EquilibriumResidual(twiss, twissdata, radint, nrf, harmon, voltages, model,
+                        method, u, p, &F[3 * c], &R[3 * c]);
+  }
+
+  // Jacobians
+  double J[nu][nu], Fp[nu][np], Rp[nu][np];
+  for (int i = 0; i < nu; i++) {
+    for (int j = 0; j < nu; j++) {
+      int c = 1 + 2 * j;
+      J[i][j] = (F[3 * c + i] - F[3 * (c + 1) + i]) / (2.0 * hu[j]);
+    }
+    for (int j = 0; j < np; j++) {
+      int c = 1 + 2 * nu + 2 * j;
+      Fp[i][j] = (F[3 * c + i] - F[3 * (c + 1) + i]) / (2.0 * hp[j]);
+      Rp[i][j] = (R[3 * c + i] - R[3 * (c + 1) + i]) / (2.0 * hp[j]);
+    }
+  }
+
+  // solve J du = -Fp for all parameters, Gaussian elimination with pivoting
+  double A[nu][nu + np];
+  for (int i = 0; i < nu; i++) {
+    for (int j = 0; j < nu; j++) {
+      A[i][j] = J[i][j];
+    }
+    for (int j = 0; j < np; j++) {
+      A[i][nu + j] = -Fp[i][j];
+    }
+  }
+  for (int k = 0; k < nu; k++) {
+    int piv = k;
+    for (int i = k + 1; i < nu; i++) {
+      if (fabs(A[i][k]) > fabs(A[piv][k])) {
+        piv = i;
+      }
+    }
+    for (int j = 0; j < nu + np; j++) {
+      swap(A[k][j], A[piv][j]);
+    }
+    for (int i = k + 1; i < nu; i++) {
+      double f = A[i][k] / A[k][k];
+      for (int j = k; j < nu + np; j++) {
+        A[i][j] -= f * A[k][j];
+      }
+    }
+  }
+  double du[nu][np];
+  for (int j = 0; j < np; j++) {
+    for (int i = nu - 1; i >= 0; i--) {
+      double s = A[i][nu + j];
+      for (int k = i + 1; k < nu; k++) {
+        s -= A[i][k] * du[k][j];
+      }
+      du[i][j] = s / A[i][i];
+    }
+  }
+
+  const string keys[nu] = {"DEX", "DEY", "DSIGS"};
+  for (int i = 0; i < nu; i++) {
+    sensitivities[keys[i]] = vector<double>(du[i], du[i] + np);
+  }
+  sensitivities["RATES"] = vector<double>(&R[0], &R[3]);
+  sensitivities["RESIDUAL"] = vector<double>(&F[0], &F[3]);
+  sensitivities["DRATES"].resize(3 * np);
+  for (int k = 0; k < 3; k++) {
+    for (int j = 0; j < np; j++) {
+      sensitivities["DRATES"][np * k + j] = Rp[k][j];
+    }
+  }
+}
+
+void ODE(map<string, double> &twiss, map<string, vector<double>> &twissdata,
+         int nrf, double harmon[], double voltages[], vector<double> &t,
+         vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+         vector<double> sige, int model, double pnumber, int couplingpercentage,
+         double threshold, string method, bool debug_output,
+         map<string, vector<double>> &sensitivities) {
+  ODE(twiss, twissdata, nrf, harmon, voltages, t, ex, ey, sigs, sige, model,
+      pnumber, couplingpercentage, threshold, method, debug_output);
+  EquilibriumSensitivities(twiss, twissdata, nrf, harmon, voltages, model,
+                           pnumber, couplingpercentage, ex.back(), ey.back(),
+                           sigs.back(), sensitivities, method);
+}
@@ -0,0 +1,407 @@
+#include "../include/ibs_bits/ParticleKicks.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+PHILOX4x32-10 COUNTER BASED RANDOM NUMBER GENERATOR
+
+  REF: Salmon et al., Parallel random numbers: as easy as 1, 2, 3, SC11 (2011)
+
+================================================================================
+*/
+static void philox4x32(uint32_t ctr[4], uint32_t key[2]) {
+  const uint32_t M0 = 0xD2511F53;
+  const uint32_t M1 = 0xCD9E8D57;
+  const uint32_t W0 = 0x9E3779B9;
+  const uint32_t W1 = 0xBB67AE85;
+
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+
+  for (int r = 0; r < 10; r++) {
+    uint64_t p0 = (uint64_t)M0 * ctr[0];
+    uint64_t p1 = (uint64_t)M1 * ctr[2];
+    uint32_t c0 = (uint32_t)(p1 >> 32) ^ ctr[1] ^ k0;
+    uint32_t c1 = (uint32_t)p1;
+    uint32_t c2 = (uint32_t)(p0 >> 32) ^ ctr[3] ^ k1;
+    uint32_t c3 = (uint32_t)p0;
+    ctr[0] = c0;
+    ctr[1] = c1;
+    ctr[2] = c2;
+    ctr[3] = c3;
+    k0 += W0;
+    k1 += W1;
+  }
+}
+
+// uniform in (0,1) with 53 bit resolution
+static double uniform53(uint32_t a, uint32_t b) {
+  uint64_t k = ((uint64_t)(a >> 5) << 26) | (b >> 6);
+  return ((double)k + 0.5) / 9007199254740992.0;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO GENERATE FOUR STANDARD NORMAL RANDOM NUMBERS FOR A GIVEN
+(SEED, PARTICLE, TURN, STREAM) COUNTER.
+
+  TWO PHILOX BLOCKS GIVE FOUR 53 BIT UNIFORMS, TRANSFORMED WITH BOX-MULLER.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - unsigned long seed
+        generator key
+    - unsigned long particle
+        particle index
+    - unsigned long turn
+        turn number
+    - unsigned long stream
+        stream index
+    - double* out
+        output array
+
+  Returns:
+  --------
+    double[4] out
+        standard normal random numbers
+
+================================================================================
+================================================================================
+*/
+void GaussianRandomNumbers(unsigned long seed, unsigned long particle,
+                           unsigned long turn, unsigned long stream,
+                           double *out) {
+  uint32_t key[2] = {(uint32_t)seed, (uint32_t)((uint64_t)seed >> 32)};
+  for (uint32_t block = 0; block < 2; block++) {
+    uint32_t ctr[4] = {(uint32_t)particle, (uint32_t)turn, (uint32_t)stream,
+                       block};
+    philox4x32(ctr, key);
+
+    double u1 = uniform53(ctr[0], ctr[1]);
+    double u2 = uniform53(ctr[2], ctr[3]);
+    double r = sqrt(-2.0 * log(u1));
+    out[2 * block] = r * cos(2.0 * pi * u2);
+    out[2 * block + 1] = r * sin(2.0 * pi * u2);
+  }
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE RMS BEAM PARAMETERS OF A MACRO-PARTICLE DISTRIBUTION
+
+  STATISTICAL EMITTANCE OF THE BETATRON COORDINATES
+    xb = x - D dp  pxb = px - D' dp
+    ex = sqrt(<xb^2><pxb^2> - <xb pxb>^2)
+
+  DISPERSION IN THE TWISS TABLE IS W.R.T. PT AND IS SCALED WITH BETA TO DP/P.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int npart
+        number of macro-particles
+    - double* x, px, y, py, z, dp
+        particle coordinates
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - int element
+        reference element
+    - double* moments
+        output array
+
+  Returns:
+  --------
+    double[4] moments
+        0 -> ex
+        1 -> ey
+        2 -> sigs
+        3 -> sige
+
+================================================================================
+================================================================================
+*/
+void BeamMoments(int npart, double *x, double *px, double *y, double *py,
+                 double *z, double *dp, map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, int element,
+                 double *moments) {
+  double betar = BetaRelativisticFromGamma(twissheader["GAMMA"]);
+  double dx = betar * twissdata["DX"][element];
+  double dpx = betar * twissdata["DPX"][element];
+  double dy = betar * twissdata["DY"][element];
+  double dpy = betar * twissdata["DPY"][element];
+
+  // centroids
+  double mx = 0.0, mpx = 0.0, my = 0.0, mpy = 0.0, mz = 0.0, mdp = 0.0;
+#pragma omp parallel for reduction(+ : mx, mpx, my, mpy, mz, mdp)
+  for (int p = 0; p < npart; p++) {
+    mx += x[p] - dx * dp[p];
+    mpx += px[p] - dpx * dp[p];
+    my += y[p] - dy * dp[p];
+    mpy += py[p] - dpy * dp[p];
+    mz += z[p];
+    mdp += dp[p];
+  }
+  mx /= npart;
+  mpx /= npart;
+  my /= npart;
+  mpy /= npart;
+  mz /= npart;
+  mdp /= npart;
+
+  // second order central moments
+  double sxx = 0.0, sxpx = 0.0, spxpx = 0.0;
+  double syy = 0.0, sypy = 0.0, spypy = 0.0;
+  double szz = 0.0, sdd = 0.0;
+#pragma omp parallel for reduction(+ : sxx, sxpx, spxpx, syy, sypy, spypy, szz, sdd)
+  for (int p = 0; p < npart; p++) {
+    double xb = x[p] - dx * dp[p] - mx;
+    double pxb = px[p] - dpx * dp[p] - mpx;
+    double yb = y[p] - dy * dp[p] - my;
+    double pyb = py[p] - dpy * dp[p] - mpy;
+    sxx += xb * xb;
+    sxpx += xb * pxb;
+    spxpx += pxb * pxb;
+    syy += yb * yb;
+    sypy += yb * pyb;
+    spypy += pyb * pyb;
+    szz += (z[p] - mz) * (z[p] - mz);
+    sdd += (dp[p] - mdp) * (dp[p] - mdp);
+  }
+
+  moments[0] = sqrt(max(sxx * spxpx - sxpx * sxpx, 0.0)) / npart;
+  moments[1] = sqrt(max(syy * spypy - sypy * sypy, 0.0)) / npart;
+  moments[2] = sqrt(szz / npart);
+  moments[3] = sqrt(sdd / npart);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO APPLY RANDOM IBS MOMENTUM KICKS
+
+  KICK VARIANCES (AMPLITUDE GROWTH RATES a, TIME INTERVAL dt):
+    <dpx^2> = 4 ax ex dt / betx
+    <dpy^2> = 4 ay ey dt / bety
+    <ddp^2> = 4 as sige^2 dt
+
+  THE MOMENTUM KICK IS COMPENSATED BY THE DISPERSION, SUCH THAT ONLY THE
+  BETATRON MOMENTA RECEIVE THE TRANSVERSE KICKS.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int npart
+        number of macro-particles
+    - double* x, px, y, py, dp
+        particle coordinates (updated in place)
+    - double* rates
+        amplitude growth rates (al, ax, ay)
+    - double* moments
+        ex, ey, sigs, sige
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - int element
+        element where the kick is applied
+    - double dt
+        time interval
+    - unsigned long seed, turn, stream
+        random number counter
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void IBSKick(int npart, double *x, double *px, double *y, double *py,
+             double *dp, double *rates, double *moments,
+             map<string, double> &twissheader,
+             map<string, vector<double>> &twissdata, int element, double dt,
+             unsigned long seed, unsigned long turn, unsigned long stream) {
+  double betar = BetaRelativisticFromGamma(twissheader["GAMMA"]);
+  double bx = twissdata["BETX"][element];
+  double by = twissdata["BETY"][element];
+  double dx = betar * twissdata["DX"][element];
+  double dpx = betar * twissdata["DPX"][element];
+  double dy = betar * twissdata["DY"][element];
+  double dpy = betar * twissdata["DPY"][element];
+
+  // rms kick strengths
+  double ks = sqrt(max(4.0 * rates[0] * moments[3] * moments[3] * dt, 0.0));
+  double kx = sqrt(max(4.0 * rates[1] * moments[0] * dt / bx, 0.0));
+  double ky = sqrt(max(4.0 * rates[2] * moments[1] * dt / by, 0.0));
+
+#pragma omp parallel for
+  for (int p = 0; p < npart; p++) {
+    double r[4];
+    GaussianRandomNumbers(seed, p, turn, stream, r);
+
+    double ddp = ks * r[0];
+    dp[p] += ddp;
+    x[p] += dx * ddp;
+    px[p] += dpx * ddp + kx * r[1];
+    y[p] += dy * ddp;
+    py[p] += dpy * ddp + ky * r[2];
+  }
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO APPLY THE IBS KICK OF ONE TURN AT A REFERENCE ELEMENT
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - int npart
+        number of macro-particles
+    - double* x, px, y, py, z, dp
+        particle coordinates (updated in place)
+    - double pnumber
+        number of real particles
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - int element
+        reference element
+    - unsigned long seed, turn
+        random number counter
+    - double* rates
+        output array
+
+  Returns:
+  --------
+    double[3] rates
+        IBS GROWTH RATES USED FOR THE KICK
+        0 -> al
+        1 -> ax
+        2 -> ay
+
+================================================================================
+================================================================================
+*/
+void IBSKickTurn(int model, int npart, double *x, double *px, double *y,
+                 double *py, double *z, double *dp, double pnumber,
+                 map<string, double> &twissheader,
+                 map<string, vector<double>> &twissdata, double r0,
+                 double aatom, int element, unsigned long seed,
+                 unsigned long turn, double *rates) {
+  double betar = BetaRelativisticFromGamma(twissheader["GAMMA"]);
+  double trev = twissheader["LENGTH"] / (betar * clight);
+
+  double moments[4];
+  BeamMoments(npart, x, px, y, py, z, dp, twissheader, twissdata, element,
+              moments);
+
+  double *ibs = IBSRates(model, pnumber, moments[0], moments[1], moments[2],
+                         moments[3], twissheader, twissdata, r0, aatom);
+  rates[0] = ibs[0];
+  rates[1] = ibs[1];
+  rates[2] = ibs[2];
+
+  IBSKick(npart, x, px, y, py, dp, rates, moments, twissheader, twissdata,
+          element, trev, seed, turn, 0);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO APPLY THE IBS KICK OF A SINGLE ELEMENT
+
+  THE ELEMENT CONTRIBUTION TO THE RATES IS APPLIED OVER ONE REVOLUTION PERIOD,
+  EACH ELEMENT USES ITS OWN RANDOM STREAM (ELEMENT INDEX + 1).
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - int i
+        element index
+    - int npart
+        number of macro-particles
+    - double* x, px, y, py, dp
+        particle coordinates at element i (updated in place)
+    - double* moments
+        ex, ey, sigs, sige
+    - double pnumber
+        number of real particles
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - unsigned long seed, turn
+        random number counter
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void IBSKickElement(int model, int i, int npart, double *x, double *px,
+                    double *y, double *py, double *dp, double *moments,
+                    double pnumber, map<string, double> &twissheader,
+                    map<string, vector<double>> &twissdata, double r0,
+                    double aatom, unsigned long seed, unsigned long turn) {
+  double betar = BetaRelativisticFromGamma(twissheader["GAMMA"]);
+  double trev = twissheader["LENGTH"] / (betar * clight);
+
+  double rates[3];
+  IBSElementRates(model, i, pnumber, moments[0], moments[1], moments[2],
+                  moments[3], twissheader, twissdata, r0, aatom, rates);
+
+  IBSKick(npart, x, px, y, py, dp, rates, moments, twissheader, twissdata, i,
+          trev, seed, turn, i + 1);
+}
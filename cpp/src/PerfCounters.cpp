@@ -0,0 +1,235 @@
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include "../include/ibs_bits/Trace.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char *perf_names[PERF_NCOUNTERS] = {
+    "CYCLES",     "INSTRUCTIONS", "CACHE_MISSES",
+    "L1D_MISSES", "DTLB_MISSES",  "BRANCH_MISSES"};
+
+struct PerfAccumulator {
+  double calls = 0.0;
+  double elements = 0.0;
+  double time = 0.0;
+  double counters[PERF_NCOUNTERS] = {0.0};
+  bool available[PERF_NCOUNTERS] = {false};
+};
+
+static atomic<bool> perf_enabled(false);
+static mutex perf_mutex;
+static map<string, PerfAccumulator> perf_regions;
+
+/*
+================================================================================
+  PER THREAD COUNTER GROUP
+
+  THE FIRST COUNTER THAT CAN BE OPENED IS THE GROUP LEADER, ALL COUNTERS ARE
+  READ WITH ONE SYSTEM CALL (PERF_FORMAT_GROUP). ONLY USER SPACE IS COUNTED.
+================================================================================
+*/
+struct PerfThreadCounters {
+  bool initialised = false;
+  int leader = -1;
+  int fds[PERF_NCOUNTERS];
+  int slot[PERF_NCOUNTERS];
+  int nopen = 0;
+
+  void open() {
+    initialised = true;
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      fds[k] = -1;
+      slot[k] = -1;
+    }
+#ifdef __linux__
+    const uint32_t types[PERF_NCOUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    const uint64_t configs[PERF_NCOUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[k];
+      attr.config = configs[k];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+      if (fd < 0) {
+        continue;
+      }
+      if (leader < 0) {
+        leader = fd;
+      }
+      fds[k] = fd;
+      slot[k] = nopen++;
+    }
+#endif
+  }
+
+  // counter values, false if no counter is available
+  bool read(uint64_t *values) {
+    if (!initialised) {
+      open();
+    }
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      values[k] = 0;
+    }
+#ifdef __linux__
+    if (leader < 0) {
+      return false;
+    }
+    uint64_t buffer[1 + PERF_NCOUNTERS];
+    ssize_t size = ::read(leader, buffer, sizeof(buffer));
+    if (size < (ssize_t)sizeof(uint64_t) || (int)buffer[0] != nopen) {
+      return false;
+    }
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      if (slot[k] >= 0) {
+        values[k] = buffer[1 + slot[k]];
+      }
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  ~PerfThreadCounters() {
+#ifdef __linux__
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      if (initialised && fds[k] >= 0) {
+        close(fds[k]);
+      }
+    }
+#endif
+  }
+};
+
+static thread_local PerfThreadCounters perf_thread;
+
+static double PerfNow() {
+  return chrono::duration<double>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool PerfCountersEnable(bool enable) {
+  perf_enabled = enable;
+  uint64_t values[PERF_NCOUNTERS];
+  return perf_thread.read(values);
+}
+
+bool PerfCountersEnabled() { return perf_enabled; }
+
+void PerfCountersReset() {
+  lock_guard<mutex> lock(perf_mutex);
+  perf_regions.clear();
+}
+
+PerfRegion::PerfRegion(const char *name, long elements, const char *category)
+    : name(name), category(category), elements(elements),
+      counting(perf_enabled), tracing(TraceEnabled()) {
+  if (counting) {
+    perf_thread.read(start);
+  }
+  if (counting || tracing) {
+    start_time = PerfNow();
+  }
+}
+
+PerfRegion::~PerfRegion() {
+  if (!(counting || tracing)) {
+    return;
+  }
+  double stop_time = PerfNow();
+  if (tracing) {
+    TraceRecord(name, category, start_time, stop_time, elements);
+  }
+  if (!counting) {
+    return;
+  }
+  uint64_t stop[PERF_NCOUNTERS];
+  perf_thread.read(stop);
+
+  lock_guard<mutex> lock(perf_mutex);
+  PerfAccumulator &acc = perf_regions[name];
+  acc.calls += 1.0;
+  acc.elements += elements;
+  acc.time += stop_time - start_time;
+  for (int k = 0; k < PERF_NCOUNTERS; k++) {
+    if (perf_thread.slot[k] >= 0) {
+      acc.counters[k] += (double)(stop[k] - start[k]);
+      acc.available[k] = true;
+    }
+  }
+}
+
+void PerfCountersReport(map<string, map<string, double>> &report) {
+  lock_guard<mutex> lock(perf_mutex);
+  report.clear();
+  for (auto &region : perf_regions) {
+    PerfAccumulator &acc = region.second;
+    map<string, double> &r = report[region.first];
+    double nel = max(acc.elements, 1.0);
+    r["CALLS"] = acc.calls;
+    r["ELEMENTS"] = acc.elements;
+    r["TIME"] = acc.time;
+    r["TIME_PER_ELEMENT"] = acc.time / nel;
+    for (int k = 0; k < PERF_NCOUNTERS; k++) {
+      if (acc.available[k]) {
+        r[perf_names[k]] = acc.counters[k];
+        r[string(perf_names[k]) + "_PER_ELEMENT"] = acc.counters[k] / nel;
+      }
+    }
+    if (acc.available[0] && acc.available[1] && acc.counters[0] > 0.0) {
+      r["IPC"] = acc.counters[1] / acc.counters[0];
+    }
+  }
+}
+
+void PerfCountersPrint() {
+  map<string, map<string, double>> report;
+  PerfCountersReport(report);
+
+  printf("%-24s %10s %12s %12s %12s %12s %6s %10s %10s %10s %10s\n", "REGION",
+         "CALLS", "ELEMENTS", "NS/ELEM", "CYC/ELEM", "INS/ELEM", "IPC",
+         "LLC/ELEM", "L1D/ELEM", "DTLB/ELEM", "BR/ELEM");
+  for (auto &region : report) {
+    map<string, double> &r = region.second;
+    auto get = [&r](string key) {
+      return r.count(key) ? r[key] : NAN;
+    };
+    printf("%-24s %10.0f %12.0f %12.2f %12.1f %12.1f %6.2f %10.2f %10.2f "
+           "%10.2f %10.2f\n",
+           region.first.c_str(), r["CALLS"], r["ELEMENTS"],
+           1.0e9 * r["TIME_PER_ELEMENT"], get("CYCLES_PER_ELEMENT"),
+           get("INSTRUCTIONS_PER_ELEMENT"), get("IPC"),
+           get("CACHE_MISSES_PER_ELEMENT"), get("L1D_MISSES_PER_ELEMENT"),
+           get("DTLB_MISSES_PER_ELEMENT"), get("BRANCH_MISSES_PER_ELEMENT"));
+  }
+}
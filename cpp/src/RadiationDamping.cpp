@@ -1,5 +1,6 @@
 #include "../include/ibs_bits/RadiationDamping.hpp"
 #include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
 #include <iostream>
 #include <map>
 #include <math.h>
@@ -97,7 +98,7 @@ double *RadiationDampingApprox(double latticeLength, double gamma,
                                double gammaTransition,
                                double dipoleBendingRadius, double betax,
                                double betay) {
-  static double radiationIntegrals[7];
+  static thread_local double radiationIntegrals[7];
 
   // Courant-Snyder optical functions
   double alphax = 0.0;
@@ -164,7 +165,8 @@ METHOD TO CALCULATE RADIATION INTEGRALS
 ================================================================================
 */
 double *RadiationDampingLattice(map<string, vector<double>> &table) {
-  static double radiationIntegrals[7];
+  PerfRegion perf("RadiationDampingLattice", table["L"].size(), "lattice");
+  static thread_local double radiationIntegrals[7];
   radiationIntegrals[0] =
       accumulate(table["I1"].begin(), table["I1"].end(), 0.0);
   radiationIntegrals[1] =
@@ -238,7 +240,7 @@ double *RadiationDampingLifeTimesAndEquilibriumEmittancesWithPartitionNumbers(
   const double hbar = 1.0545718176461565e-34;
   const double electron_volt_joule_relationship = 1.602176634e-19;
 
-  static double output[9];
+  static thread_local double output[9];
 
   double gamma = twissheadermap["GAMMA"];
   double gammatr = twissheadermap["GAMMATR"];
@@ -393,7 +395,7 @@ double *RadiationCriticalEnergy(double rho, double gamma, double omega) {
   const double twoOthree = 2.0 / 3.0;
   const double gamma3 = gamma * gamma * gamma;
 
-  static double output[5];
+  static thread_local double output[5];
 
   output[0] = (1.0 / twoOthree) * c / rho * gamma3;
   output[1] = 1.0 / gamma * pow(output[0] / omega, 1.0 / 3.0);
@@ -451,7 +453,7 @@ double *RadiationDampingElement(double l, double bx, double by, double dx,
                                 double dpx, double dy, double dpy, double ax,
                                 double ay, double angle, double k1l,
                                 double k1sl) {
-  static double radiationIntegrals[6];
+  static thread_local double radiationIntegrals[6];
   double I2 = 0.0;
   double I3 = 0.0;
   double I4x = 0.0;
@@ -0,0 +1,183 @@
+#include "../include/ibs_bits/RangeQueries.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *radiation_columns[7] = {"I1",  "I2",  "I3", "I4x",
+                                           "I4y", "I5x", "I5y"};
+
+/*
+================================================================================
+================================================================================
+METHOD TO STORE THE PREFIX SUMS OF THE ELEMENT CONTRIBUTIONS TO THE IBS GROWTH
+RATES AND THE RADIATION INTEGRALS.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - IBSPrefixSums &prefix
+        output variable - prefix sums
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void BuildIBSPrefixSums(int model, double pnumber, double ex, double ey,
+                        double sigs, double dponp,
+                        map<string, double> &twissheader,
+                        map<string, vector<double>> &twissdata, double r0,
+                        double aatom, IBSPrefixSums &prefix) {
+  int n = twissdata["L"].size();
+  PerfRegion perf("BuildIBSPrefixSums", n, "model");
+
+  prefix.model = model;
+  prefix.circumference = twissheader["LENGTH"];
+  prefix.length = twissdata["L"];
+
+  // element exit positions, from the lengths if the S column is not loaded
+  if (twissdata.count("S") != 0) {
+    prefix.s = twissdata["S"];
+  } else {
+    prefix.s.resize(n);
+    double s = 0.0;
+    for (int i = 0; i < n; i++) {
+      s += prefix.length[i];
+      prefix.s[i] = s;
+    }
+  }
+  prefix.rates.assign(3 * (n + 1), 0.0);
+  prefix.radiation.assign(7 * (n + 1), 0.0);
+
+  // element contributions, stored shifted by one element
+#pragma omp parallel for shared(twissdata, prefix)
+  for (int i = 0; i < n; i++) {
+    IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                    twissdata, r0, aatom, &prefix.rates[3 * (i + 1)]);
+  }
+
+  for (int k = 0; k < 7; k++) {
+    if (twissdata.count(radiation_columns[k]) == 0) {
+      continue;
+    }
+    vector<double> &col = twissdata[radiation_columns[k]];
+    for (int i = 0; i < n; i++) {
+      prefix.radiation[7 * (i + 1) + k] = col[i];
+    }
+  }
+
+  for (int i = 1; i <= n; i++) {
+    for (int k = 0; k < 3; k++) {
+      prefix.rates[3 * i + k] += prefix.rates[3 * (i - 1) + k];
+    }
+    for (int k = 0; k < 7; k++) {
+      prefix.radiation[7 * i + k] += prefix.radiation[7 * (i - 1) + k];
+    }
+  }
+}
+
+// sums over [first, last) of the prefix arrays, wrapping if last < first
+static void RangeDifference(const IBSPrefixSums &prefix, double first,
+                            double last, const double *lower,
+                            const double *upper, double *rates,
+                            double *radiation) {
+  size_t n = prefix.s.size();
+  const double *total_rates = &prefix.rates[3 * n];
+  const double *total_radiation = &prefix.radiation[7 * n];
+  bool wrap = last < first;
+
+  for (int k = 0; k < 3; k++) {
+    rates[k] = upper[k] - lower[k] + (wrap ? total_rates[k] : 0.0);
+  }
+  for (int k = 0; k < 7; k++) {
+    radiation[k] =
+        upper[3 + k] - lower[3 + k] + (wrap ? total_radiation[k] : 0.0);
+  }
+}
+
+void IBSRangeByIndex(const IBSPrefixSums &prefix, int first, int last,
+                     double *rates, double *radiation) {
+  int n = prefix.s.size();
+  first = max(0, min(first, n));
+  last = max(0, min(last, n));
+
+  double lower[10], upper[10];
+  for (int k = 0; k < 3; k++) {
+    lower[k] = prefix.rates[3 * first + k];
+    upper[k] = prefix.rates[3 * last + k];
+  }
+  for (int k = 0; k < 7; k++) {
+    lower[3 + k] = prefix.radiation[7 * first + k];
+    upper[3 + k] = prefix.radiation[7 * last + k];
+  }
+  RangeDifference(prefix, first, last, lower, upper, rates, radiation);
+}
+
+/*
+================================================================================
+  CUMULATIVE SUMS UP TO POSITION x (3 RATES FOLLOWED BY 7 RADIATION INTEGRALS).
+  THE ELEMENT CONTAINING x CONTRIBUTES WITH THE FRACTION OF ITS LENGTH BEFORE x.
+================================================================================
+*/
+static void PrefixAt(const IBSPrefixSums &prefix, double x, double *out) {
+  size_t n = prefix.s.size();
+  size_t i =
+      lower_bound(prefix.s.begin(), prefix.s.end(), x) - prefix.s.begin();
+
+  double f = 0.0;
+  if (i < n && prefix.length[i] > 0.0) {
+    f = (x - (prefix.s[i] - prefix.length[i])) / prefix.length[i];
+    f = max(0.0, min(f, 1.0));
+  }
+  size_t j = (i < n) ? i + 1 : i;
+
+  for (int k = 0; k < 3; k++) {
+    out[k] = prefix.rates[3 * i + k] +
+             f * (prefix.rates[3 * j + k] - prefix.rates[3 * i + k]);
+  }
+  for (int k = 0; k < 7; k++) {
+    out[3 + k] =
+        prefix.radiation[7 * i + k] +
+        f * (prefix.radiation[7 * j + k] - prefix.radiation[7 * i + k]);
+  }
+}
+
+void IBSRangeByS(const IBSPrefixSums &prefix, double s0, double s1,
+                 double *rates, double *radiation) {
+  double lower[10], upper[10];
+  PrefixAt(prefix, s0, lower);
+  PrefixAt(prefix, s1, upper);
+  RangeDifference(prefix, s0, s1, lower, upper, rates, radiation);
+}
@@ -0,0 +1,763 @@
+#include "../include/ibs_bits/SDDS.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+enum SDDSType {
+  SDDS_DOUBLE,
+  SDDS_FLOAT,
+  SDDS_LONG64,
+  SDDS_ULONG64,
+  SDDS_LONG,
+  SDDS_ULONG,
+  SDDS_SHORT,
+  SDDS_USHORT,
+  SDDS_STRING,
+  SDDS_CHARACTER,
+  SDDS_INVALID
+};
+
+struct SDDSDefinition {
+  string name;
+  int type;
+  bool fixed;
+  string fixedvalue;
+};
+
+static int SDDSTypeFromName(const string &name) {
+  static const char *names[SDDS_INVALID] = {
+      "double", "float",  "long64", "ulong64", "long",
+      "ulong",  "short",  "ushort", "string",  "character"};
+  for (int k = 0; k < SDDS_INVALID; k++) {
+    if (name == names[k]) {
+      return k;
+    }
+  }
+  return SDDS_INVALID;
+}
+
+static bool SDDSIsText(int type) {
+  return type == SDDS_STRING || type == SDDS_CHARACTER;
+}
+
+// bytes of a binary value, strings take at least their length prefix
+static size_t SDDSMinimumSize(int type) {
+  static const size_t sizes[SDDS_INVALID] = {8, 4, 8, 8, 4, 4, 2, 2, 4, 1};
+  return sizes[type];
+}
+
+static bool SDDSIsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool SDDSLittleEndianHost() {
+  const uint16_t one = 1;
+  unsigned char first;
+  memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+/*
+================================================================================
+  NAMELIST OF THE HEADER : &group key=value, key="quoted value", ... &end
+================================================================================
+*/
+static bool SDDSNamelist(string_view text, size_t &pos, string &group,
+                         map<string, string> &fields) {
+  fields.clear();
+  size_t start = ++pos;
+  while (pos < text.size() && !SDDSIsSpace(text[pos])) {
+    pos++;
+  }
+  group = string(text.substr(start, pos - start));
+
+  while (true) {
+    while (pos < text.size() && (SDDSIsSpace(text[pos]) || text[pos] == ',')) {
+      pos++;
+    }
+    if (pos >= text.size()) {
+      return false;
+    }
+    if (text.compare(pos, 4, "&end") == 0) {
+      pos += 4;
+      return true;
+    }
+
+    size_t eq = text.find('=', pos);
+    if (eq == string_view::npos) {
+      return false;
+    }
+    string_view key = text.substr(pos, eq - pos);
+    while (!key.empty() && SDDSIsSpace(key.back())) {
+      key.remove_suffix(1);
+    }
+    pos = eq + 1;
+    while (pos < text.size() && SDDSIsSpace(text[pos])) {
+      pos++;
+    }
+
+    string value;
+    if (pos < text.size() && text[pos] == '"') {
+      pos++;
+      while (pos < text.size() && text[pos] != '"') {
+        if (text[pos] == '\\' && pos + 1 < text.size()) {
+          pos++;
+        }
+        value += text[pos++];
+      }
+      pos++;
+    } else {
+      while (pos < text.size() && !SDDSIsSpace(text[pos]) &&
+             text[pos] != ',' && text[pos] != '&') {
+        value += text[pos++];
+      }
+    }
+    fields[string(key)] = value;
+  }
+}
+
+/*
+================================================================================
+  BINARY DATA
+================================================================================
+*/
+struct SDDSBinaryReader {
+  string_view buffer;
+  size_t pos;
+  bool swap;
+
+  bool read(void *out, size_t size) {
+    if (pos + size > buffer.size()) {
+      return false;
+    }
+    memcpy(out, buffer.data() + pos, size);
+    if (swap) {
+      reverse((unsigned char *)out, (unsigned char *)out + size);
+    }
+    pos += size;
+    return true;
+  }
+
+  template <typename T> bool number(double &value) {
+    T v;
+    if (!read(&v, sizeof(T))) {
+      return false;
+    }
+    value = (double)v;
+    return true;
+  }
+
+  bool value(int type, double &num, string &str) {
+    switch (type) {
+    case SDDS_DOUBLE:
+      return number<double>(num);
+    case SDDS_FLOAT:
+      return number<float>(num);
+    case SDDS_LONG64:
+      return number<int64_t>(num);
+    case SDDS_ULONG64:
+      return number<uint64_t>(num);
+    case SDDS_LONG:
+      return number<int32_t>(num);
+    case SDDS_ULONG:
+      return number<uint32_t>(num);
+    case SDDS_SHORT:
+      return number<int16_t>(num);
+    case SDDS_USHORT:
+      return number<uint16_t>(num);
+    case SDDS_CHARACTER:
+      if (pos + 1 > buffer.size()) {
+        return false;
+      }
+      str.assign(1, buffer[pos++]);
+      return true;
+    case SDDS_STRING: {
+      int32_t length;
+      if (!read(&length, sizeof(length)) || length < 0 ||
+          pos + length > buffer.size()) {
+        return false;
+      }
+      str.assign(buffer.data() + pos, length);
+      pos += length;
+      return true;
+    }
+    }
+    return false;
+  }
+};
+
+/*
+================================================================================
+  ASCII DATA : ONE LINE PER PARAMETER, OPTIONAL ROW COUNT, WHITESPACE SEPARATED
+  ROWS. LINES STARTING WITH ! ARE COMMENTS.
+================================================================================
+*/
+struct SDDSAsciiReader {
+  string_view buffer;
+  size_t pos;
+
+  void skipcomments() {
+    while (pos < buffer.size() && buffer[pos] == '!') {
+      size_t eol = buffer.find('\n', pos);
+      pos = (eol == string_view::npos) ? buffer.size() : eol + 1;
+    }
+  }
+
+  bool line(string_view &out) {
+    skipcomments();
+    if (pos >= buffer.size()) {
+      return false;
+    }
+    size_t eol = buffer.find('\n', pos);
+    if (eol == string_view::npos) {
+      eol = buffer.size();
+    }
+    out = buffer.substr(pos, eol - pos);
+    pos = eol + 1;
+    while (!out.empty() && SDDSIsSpace(out.back())) {
+      out.remove_suffix(1);
+    }
+    while (!out.empty() && SDDSIsSpace(out.front())) {
+      out.remove_prefix(1);
+    }
+    return true;
+  }
+
+  // true if the rest of the current line and the next line are blank
+  bool endofpage() {
+    size_t p = pos;
+    while (p < buffer.size() && buffer[p] != '\n' && SDDSIsSpace(buffer[p])) {
+      p++;
+    }
+    if (p < buffer.size() && buffer[p] == '\n') {
+      p++;
+    }
+    while (p < buffer.size() && buffer[p] != '\n' && SDDSIsSpace(buffer[p])) {
+      p++;
+    }
+    return p >= buffer.size() || buffer[p] == '\n';
+  }
+
+  bool token(string &out) {
+    while (true) {
+      while (pos < buffer.size() && SDDSIsSpace(buffer[pos])) {
+        pos++;
+      }
+      if (pos < buffer.size() && buffer[pos] == '!' &&
+          (pos == 0 || buffer[pos - 1] == '\n')) {
+        skipcomments();
+        continue;
+      }
+      break;
+    }
+    if (pos >= buffer.size()) {
+      return false;
+    }
+    out.clear();
+    if (buffer[pos] == '"') {
+      pos++;
+      while (pos < buffer.size() && buffer[pos] != '"') {
+        if (buffer[pos] == '\\' && pos + 1 < buffer.size()) {
+          pos++;
+        }
+        out += buffer[pos++];
+      }
+      pos++;
+    } else {
+      while (pos < buffer.size() && !SDDSIsSpace(buffer[pos])) {
+        out += buffer[pos++];
+      }
+    }
+    return true;
+  }
+};
+
+static string SDDSUnquote(string_view text) {
+  if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+    text = text.substr(1, text.size() - 2);
+  }
+  string out;
+  for (size_t k = 0; k < text.size(); k++) {
+    if (text[k] == '\\' && k + 1 < text.size()) {
+      k++;
+    }
+    out += text[k];
+  }
+  return out;
+}
+
+static bool SDDSNumber(const string &text, double &value) {
+  char *end;
+  value = strtod(text.c_str(), &end);
+  return !text.empty() && end == text.c_str() + text.size();
+}
+
+static void SDDSStoreParameter(const SDDSDefinition &def, double num,
+                               const string &str, SDDSPage &page) {
+  if (SDDSIsText(def.type)) {
+    page.stringparameters[def.name] = str;
+  } else {
+    page.parameters[def.name] = num;
+  }
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO PARSE THE FIRST PAGE OF AN SDDS FILE FROM MEMORY.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+  REF:
+    - M. BORLAND, A SELF-DESCRIBING FILE PROTOCOL FOR SIMULATION INTEGRATION
+      AND SHARED POSTPROCESSORS, PAC 1995
+
+================================================================================
+  Arguments:
+  ----------
+    - string_view buffer
+        content of the SDDS file
+    - SDDSPage &page
+        output variable - parameters and columns
+
+  Returns:
+  --------
+    bool
+      true on success
+
+================================================================================
+================================================================================
+*/
+bool ParseSDDS(string_view buffer, SDDSPage &page) {
+  PerfRegion perf("ParseSDDS", 0, "io");
+
+  page = SDDSPage();
+  if (buffer.compare(0, 4, "SDDS") != 0) {
+    return false;
+  }
+
+  vector<SDDSDefinition> parameters, columns;
+  bool bigendian = !SDDSLittleEndianHost();
+  bool binary = true, norowcounts = false, columnmajor = false;
+  int headerlines = 0;
+
+  // header
+  size_t pos = buffer.find('\n');
+  if (pos == string_view::npos) {
+    return false;
+  }
+  pos++;
+  bool hasdata = false;
+  while (!hasdata) {
+    while (pos < buffer.size() && SDDSIsSpace(buffer[pos])) {
+      pos++;
+    }
+    if (pos >= buffer.size()) {
+      return false;
+    }
+
+    if (buffer[pos] == '!') {
+      size_t eol = buffer.find('\n', pos);
+      string_view comment = buffer.substr(pos, eol - pos);
+      if (comment.find("big-endian") != string_view::npos) {
+        bigendian = true;
+      } else if (comment.find("little-endian") != string_view::npos) {
+        bigendian = false;
+      }
+      pos = (eol == string_view::npos) ? buffer.size() : eol + 1;
+      continue;
+    }
+    if (buffer[pos] != '&') {
+      return false;
+    }
+
+    string group;
+    map<string, string> fields;
+    if (!SDDSNamelist(buffer, pos, group, fields)) {
+      return false;
+    }
+
+    if (group == "parameter" || group == "column") {
+      SDDSDefinition def;
+      def.name = fields["name"];
+      def.type = SDDSTypeFromName(fields["type"]);
+      def.fixed = fields.count("fixed_value") != 0;
+      def.fixedvalue = fields["fixed_value"];
+      if (def.name.empty() || def.type == SDDS_INVALID) {
+        return false;
+      }
+      (group == "column" ? columns : parameters).push_back(def);
+    } else if (group == "array" || group == "include") {
+      return false;
+    } else if (group == "data") {
+      binary = fields["mode"] != "ascii";
+      norowcounts = atoi(fields["no_row_counts"].c_str()) != 0;
+      columnmajor = atoi(fields["column_major_order"].c_str()) != 0;
+      headerlines = atoi(fields["additional_header_lines"].c_str());
+      hasdata = true;
+    }
+  }
+
+  // data starts on the line after &data
+  pos = buffer.find('\n', pos);
+  pos = (pos == string_view::npos) ? buffer.size() : pos + 1;
+
+  // output columns
+  vector<vector<double> *> numeric(columns.size(), NULL);
+  vector<vector<string> *> text(columns.size(), NULL);
+  for (size_t c = 0; c < columns.size(); c++) {
+    if (SDDSIsText(columns[c].type)) {
+      text[c] = &page.stringcolumns[columns[c].name];
+    } else {
+      numeric[c] = &page.columns[columns[c].name];
+    }
+  }
+
+  // fixed value parameters are not part of the data
+  for (size_t p = 0; p < parameters.size(); p++) {
+    if (parameters[p].fixed) {
+      double num = 0.0;
+      SDDSNumber(parameters[p].fixedvalue, num);
+      SDDSStoreParameter(parameters[p], num, parameters[p].fixedvalue, page);
+    }
+  }
+
+  double num;
+  string str;
+  if (binary) {
+    SDDSBinaryReader reader = {buffer, pos,
+                               bigendian == SDDSLittleEndianHost()};
+
+    int64_t rows;
+    int32_t rows32;
+    if (!reader.read(&rows32, sizeof(rows32))) {
+      return false;
+    }
+    rows = rows32;
+    if (rows32 == INT32_MIN && !reader.read(&rows, sizeof(rows))) {
+      return false;
+    }
+    if (rows < 0) {
+      return false;
+    }
+
+    for (size_t p = 0; p < parameters.size(); p++) {
+      if (parameters[p].fixed) {
+        continue;
+      }
+      if (!reader.value(parameters[p].type, num, str)) {
+        return false;
+      }
+      SDDSStoreParameter(parameters[p], num, str, page);
+    }
+
+    // the row count is checked against the remaining data before allocating
+    size_t rowsize = 0;
+    for (size_t c = 0; c < columns.size(); c++) {
+      rowsize += SDDSMinimumSize(columns[c].type);
+    }
+    if (rowsize > 0 &&
+        (uint64_t)rows > (buffer.size() - reader.pos) / rowsize) {
+      return false;
+    }
+
+    for (size_t c = 0; c < columns.size(); c++) {
+      if (numeric[c] != NULL) {
+        numeric[c]->resize(rows);
+      } else {
+        text[c]->resize(rows);
+      }
+    }
+
+    if (columnmajor) {
+      for (size_t c = 0; c < columns.size(); c++) {
+        // native doubles are copied as one block
+        if (columns[c].type == SDDS_DOUBLE && !reader.swap) {
+          size_t size = rows * sizeof(double);
+          if (reader.pos + size > buffer.size()) {
+            return false;
+          }
+          memcpy(numeric[c]->data(), buffer.data() + reader.pos, size);
+          reader.pos += size;
+          continue;
+        }
+        for (int64_t r = 0; r < rows; r++) {
+          if (!reader.value(columns[c].type, num, str)) {
+            return false;
+          }
+          if (numeric[c] != NULL) {
+            (*numeric[c])[r] = num;
+          } else {
+            (*text[c])[r] = str;
+          }
+        }
+      }
+    } else {
+      for (int64_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < columns.size(); c++) {
+          if (!reader.value(columns[c].type, num, str)) {
+            return false;
+          }
+          if (numeric[c] != NULL) {
+            (*numeric[c])[r] = num;
+          } else {
+            (*text[c])[r] = str;
+          }
+        }
+      }
+    }
+    perf.SetElements(rows);
+    return true;
+  }
+
+  SDDSAsciiReader reader = {buffer, pos};
+  string_view line;
+  for (int k = 0; k < headerlines; k++) {
+    if (!reader.line(line)) {
+      return false;
+    }
+  }
+
+  for (size_t p = 0; p < parameters.size(); p++) {
+    if (parameters[p].fixed) {
+      continue;
+    }
+    if (!reader.line(line)) {
+      return false;
+    }
+    str = SDDSUnquote(line);
+    num = 0.0;
+    if (!SDDSIsText(parameters[p].type) && !SDDSNumber(str, num)) {
+      return false;
+    }
+    SDDSStoreParameter(parameters[p], num, str, page);
+  }
+
+  int64_t rows = -1;
+  if (!norowcounts) {
+    if (!reader.line(line) || !SDDSNumber(string(line), num)) {
+      return false;
+    }
+    rows = (int64_t)num;
+  }
+
+  int64_t r = 0;
+  while (rows < 0 ? !reader.endofpage() : r < rows) {
+    for (size_t c = 0; c < columns.size(); c++) {
+      if (!reader.token(str)) {
+        // a page without row count may end with the file
+        return rows < 0 && c == 0;
+      }
+      if (numeric[c] != NULL) {
+        if (!SDDSNumber(str, num)) {
+          return false;
+        }
+        numeric[c]->push_back(num);
+      } else {
+        text[c]->push_back(str);
+      }
+    }
+    r++;
+  }
+  perf.SetElements(r);
+  return true;
+}
+
+bool ReadSDDS(string filename, SDDSPage &page) {
+  ifstream file(filename, ios::binary | ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+  string buffer(file.tellg(), '\0');
+  file.seekg(0, ios::beg);
+  if (!file.read(&buffer[0], buffer.size())) {
+    return false;
+  }
+  return ParseSDDS(buffer, page);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO MAP AN ELEGANT TWISS OUTPUT ONTO THE TWISS HEADER AND TABLE OF THE
+MADX TFS LOADERS.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - SDDSPage &twiss
+        elegant twiss_output page
+    - SDDSPage *parameters
+        elegant parameters output page, NULL if not available
+    - map<string, double> &header
+        output variable - twiss header
+    - map<string, vector<double>> &table
+        output variable - twiss table
+
+  Returns:
+  --------
+    bool
+      true if all optics columns were found
+
+================================================================================
+================================================================================
+*/
+bool ElegantTwissToMaps(SDDSPage &twiss, SDDSPage *parameters,
+                        map<string, double> &header,
+                        map<string, vector<double>> &table) {
+  static const char *names[8][2] = {
+      {"betax", "BETX"}, {"alphax", "ALFX"}, {"betay", "BETY"},
+      {"alphay", "ALFY"}, {"etax", "DX"},    {"etaxp", "DPX"},
+      {"etay", "DY"},     {"etayp", "DPY"}};
+
+  header = twiss.parameters;
+  table.clear();
+
+  if (twiss.columns.count("s") == 0) {
+    return false;
+  }
+  vector<double> &s = twiss.columns["s"];
+  int n = s.size();
+
+  table["S"] = s;
+  vector<double> &l = table["L"];
+  l.resize(n);
+  for (int i = 0; i < n; i++) {
+    l[i] = (i == 0) ? s[0] : s[i] - s[i - 1];
+  }
+  for (int k = 0; k < 8; k++) {
+    if (twiss.columns.count(names[k][0]) == 0) {
+      table.clear();
+      return false;
+    }
+    table[names[k][1]] = twiss.columns[names[k][0]];
+  }
+
+  vector<double> &angle = table["ANGLE"];
+  vector<double> &k1l = table["K1L"];
+  vector<double> &k2l = table["K2L"];
+  angle.assign(n, 0.0);
+  k1l.assign(n, 0.0);
+  k2l.assign(n, 0.0);
+  table["K1SL"].assign(n, 0.0);
+  table["K2SL"].assign(n, 0.0);
+  vector<double> &e1 = table["E1"];
+  vector<double> &e2 = table["E2"];
+  e1.assign(n, 0.0);
+  e2.assign(n, 0.0);
+
+  // element strengths, joined on name and occurence
+  if (parameters != NULL &&
+      parameters->stringcolumns.count("ElementName") != 0 &&
+      parameters->stringcolumns.count("ElementParameter") != 0 &&
+      parameters->columns.count("ParameterValue") != 0 &&
+      twiss.stringcolumns.count("ElementName") != 0) {
+    vector<string> &pname = parameters->stringcolumns["ElementName"];
+    vector<string> &pkey = parameters->stringcolumns["ElementParameter"];
+    vector<double> &pvalue = parameters->columns["ParameterValue"];
+    vector<double> *pocc = parameters->columns.count("ElementOccurence")
+                               ? &parameters->columns["ElementOccurence"]
+                               : NULL;
+    vector<string> &tname = twiss.stringcolumns["ElementName"];
+    vector<double> *tocc = twiss.columns.count("ElementOccurence")
+                               ? &twiss.columns["ElementOccurence"]
+                               : NULL;
+
+    map<pair<string, int>, array<double, 5>> strengths;
+    for (size_t k = 0; k < pname.size(); k++) {
+      int slot = (pkey[k] == "ANGLE") ? 0
+                 : (pkey[k] == "K1")  ? 1
+                 : (pkey[k] == "K2")  ? 2
+                 : (pkey[k] == "E1")  ? 3
+                 : (pkey[k] == "E2")  ? 4
+                                      : -1;
+      if (slot < 0) {
+        continue;
+      }
+      int occ = (pocc != NULL) ? (int)(*pocc)[k] : 1;
+      strengths[{pname[k], occ}][slot] = pvalue[k];
+    }
+
+    for (int i = 0; i < n; i++) {
+      int occ = (tocc != NULL) ? (int)(*tocc)[i] : 1;
+      auto it = strengths.find({tname[i], occ});
+      if (it == strengths.end()) {
+        continue;
+      }
+      angle[i] = it->second[0];
+      k1l[i] = it->second[1] * l[i];
+      k2l[i] = it->second[2] * l[i];
+      e1[i] = it->second[3];
+      e2[i] = it->second[4];
+    }
+  }
+
+  // ring parameters under the MADX names
+  double pcentral = 0.0;
+  if (twiss.parameters.count("pCentral") != 0) {
+    pcentral = twiss.parameters["pCentral"];
+  } else if (twiss.columns.count("pCentral0") != 0 && n > 0) {
+    pcentral = twiss.columns["pCentral0"][0];
+  }
+  double gamma = sqrt(1.0 + pcentral * pcentral);
+  header["MASS"] = emass;
+  // elegant tracks electrons unless the file states the charge
+  header["CHARGE"] = twiss.parameters.count("CHARGE") != 0
+                         ? twiss.parameters["CHARGE"]
+                         : -1.0;
+  header["GAMMA"] = gamma;
+  header["PC"] = pcentral * emass;
+  header["ENERGY"] = gamma * emass;
+  header["LENGTH"] = (n > 0) ? s[n - 1] : 0.0;
+
+  static const char *aliases[10][2] = {
+      {"nux", "Q1"},      {"nuy", "Q2"},      {"dnux/dp", "DQ1"},
+      {"dnuy/dp", "DQ2"}, {"alphac", "ALFA"}, {"I1", "SYNCH_1"},
+      {"I2", "SYNCH_2"},  {"I3", "SYNCH_3"},  {"I4", "SYNCH_4"},
+      {"I5", "SYNCH_5"}};
+  for (int k = 0; k < 10; k++) {
+    if (twiss.parameters.count(aliases[k][0]) != 0) {
+      header[aliases[k][1]] = twiss.parameters[aliases[k][0]];
+    }
+  }
+  if (header.count("ALFA") != 0 && header["ALFA"] > 0.0) {
+    header["GAMMATR"] = 1.0 / sqrt(header["ALFA"]);
+  }
+
+  return true;
+}
+
+bool ReadElegantTwiss(string filename, map<string, double> &header,
+                      map<string, vector<double>> &table,
+                      string parameterfile) {
+  PerfRegion perf("ReadElegantTwiss", 0, "io");
+  SDDSPage twiss, parameters;
+  if (!ReadSDDS(filename, twiss)) {
+    return false;
+  }
+  if (!parameterfile.empty() && !ReadSDDS(parameterfile, parameters)) {
+    return false;
+  }
+  bool ok = ElegantTwissToMaps(
+      twiss, parameterfile.empty() ? NULL : &parameters, header, table);
+  perf.SetElements(table["L"].size());
+  return ok;
+}
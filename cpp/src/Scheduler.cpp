@@ -0,0 +1,270 @@
+#include "../include/ibs_bits/Scheduler.hpp"
+#include "../include/ibs_bits/Arena.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+RESUMABLE ODE RUN WITH THE AUTO TIME STEP.
+
+  THE RING QUANTITIES ARE CALCULATED WITH ODERingSetup AS IN ODE, THE RUN
+  THEN ALTERNATES BETWEEN A GROWTH RATE REQUEST AND A STEP :
+
+    INITIAL  : rates of the initial state -> max steps, first step
+    STEPPING : rates of state i -> step i + 1 or DONE
+
+  THE TIME STEP OF A STEP USES THE RATES OF THE PREVIOUS REQUEST, AS IN ODE.
+  STEP SIZE, STEP LIMIT, UPDATE AND STOP CRITERION ARE THE SHARED HELPERS OF
+  ODE (ODEAutoTimeStep, ODEAutoMaxSteps, ODERingStep, ODEAutoContinue).
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header
+    - map<string, vector<double>> &twissdata
+        twiss data as map of double vectors
+    - int nrf
+        number of rf systems
+    - double[] harmon
+        array of the harmonic numbers of the rf systems
+    - double[] voltages
+        array of the voltages of the rf systems
+    - double ex0
+        initial horizontal emittance
+    - double ey0
+        initial vertical emittance
+    - double sigs0
+        initial bunch length
+    - int model
+        integer to select the IBS models
+    - double pnumber
+        number of particles in the bunch
+    - int couplingpercentage
+        horizontal betatron coupling
+    - double threshold
+        cutoff for relative changes in the values
+    - string method
+        method to use : rlx or der
+    - double t0
+        initial time
+
+================================================================================
+================================================================================
+*/
+ODEStepper::ODEStepper(map<string, double> &twiss,
+                       map<string, vector<double>> &twissdata, int nrf,
+                       double harmon[], double voltages[], double ex0,
+                       double ey0, double sigs0, int model, double pnumber,
+                       int couplingpercentage, double threshold, string method,
+                       double t0) {
+  // sanitize limit settings as in ODE
+  this->method = (method == "rlx") ? "rlx" : "der";
+  if (threshold > 1.0 || threshold < 1.0e-6) {
+    threshold = 1e-4;
+  }
+  this->threshold = threshold;
+
+  // ring quantities and radiation equilibria as in ODE
+  ODERingSetup(twiss, twissdata, nrf, harmon, voltages, couplingpercentage,
+               ring);
+
+  // initial energy spread from the radiation equilibrium, as in ODE
+  double sige0 = SigeFromRFAndSigs(ring.sigs0, ring.U0, twiss["CHARGE"], nrf,
+                                   harmon, voltages, ring.gamma, ring.gammatr,
+                                   twiss["PC"], twiss["LENGTH"], ring.phis,
+                                   false);
+
+  t.assign(1, t0);
+  ex.assign(1, ex0);
+  ey.assign(1, ey0);
+  sigs.assign(1, sigs0);
+  sige.assign(1, sige0);
+
+  request.twiss = &twiss;
+  request.twissdata = &twissdata;
+  request.model = model;
+  request.r0 = ring.r0;
+  request.aatom = ring.aatom;
+  request.pnumber = pnumber;
+  request.ex = ex0;
+  request.ey = ey0;
+  request.sigs = sigs0;
+  request.sige = sige0;
+
+  maxsteps = 0;
+  phase = INITIAL;
+}
+
+void ODEStepper::Resume(const double *rates) {
+  if (phase == INITIAL) {
+    // max number of steps from the slowest and fastest time constants
+    double taum, dtmin;
+    maxsteps = ODEAutoMaxSteps(ring, rates, taum, dtmin);
+
+    // the first step of ODE requests the initial state again
+    copy(rates, rates + 3, ibs);
+    phase = STEPPING;
+  }
+  if (phase == STEPPING) {
+    Step(rates);
+  }
+}
+
+void ODEStepper::Step(const double *rates) {
+  // time step from the rates of the previous request
+  double ddt = ODEAutoTimeStep(ring, method, ibs);
+  copy(rates, rates + 3, ibs);
+
+  size_t i = t.size() - 1;
+  double exn, eyn, sigen;
+  ODERingStep(ring, method, rates, ddt, ex[i], ey[i], sige[i], exn, eyn,
+              sigen);
+  t.push_back(t[i] + ddt);
+  ex.push_back(exn);
+  ey.push_back(eyn);
+  sige.push_back(sigen);
+  sigs.push_back(sigsfromsige(sigen, ring.gamma, ring.gammatr, ring.omegas));
+
+  // stop criterion of ODE
+  if (ODEAutoContinue((int)(i + 1), maxsteps, ex, ey, sigs, threshold)) {
+    request.ex = ex[i + 1];
+    request.ey = ey[i + 1];
+    request.sigs = sigs[i + 1];
+    request.sige = sige[i + 1];
+  } else {
+    phase = DONE;
+  }
+}
+
+// requests that can share a lattice pass
+static bool ODESameBatch(const ODERateRequest &a, const ODERateRequest &b) {
+  return a.twissdata == b.twissdata && a.twiss == b.twiss &&
+         a.model == b.model && a.r0 == b.r0 && a.aatom == b.aatom;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO RUN ODE STEPPERS TO COMPLETION WITH BATCHED GROWTH RATES.
+
+  EVERY ROUND COLLECTS THE PENDING REQUESTS, GROUPS THEM BY LATTICE AND MODEL
+  AND SERVES EVERY GROUP WITH ONE IBSRatesBatch PASS. FINISHED STEPPERS LEAVE
+  THE ROUNDS, SUCH THAT RUNS OF DIFFERENT LENGTH NEED NO SYNCHRONISATION.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - vector<ODEStepper> &steppers
+        runs to complete
+    - int maxbatch
+        maximum number of requests per pass, 0 for no limit
+
+  Returns:
+  --------
+    ODEScheduleStats
+        number of passes, requests and largest batch
+
+================================================================================
+================================================================================
+*/
+ODEScheduleStats ODESchedule(vector<ODEStepper> &steppers, int maxbatch) {
+  PerfRegion perf("ODESchedule", steppers.size(), "ode");
+
+  ODEScheduleStats stats = {0, 0, 0};
+  size_t limit = maxbatch > 0 ? (size_t)maxbatch : steppers.size();
+
+  vector<size_t> pending;
+  pending.reserve(steppers.size());
+  while (true) {
+    pending.clear();
+    for (size_t s = 0; s < steppers.size(); s++) {
+      if (!steppers[s].Done()) {
+        pending.push_back(s);
+      }
+    }
+    if (pending.empty()) {
+      break;
+    }
+
+    // group the requests on the same lattice and model
+    stable_sort(pending.begin(), pending.end(), [&](size_t a, size_t b) {
+      const ODERateRequest &ra = steppers[a].Request();
+      const ODERateRequest &rb = steppers[b].Request();
+      if (ra.twissdata != rb.twissdata) {
+        return less<void *>()(ra.twissdata, rb.twissdata);
+      }
+      if (ra.twiss != rb.twiss) {
+        return less<void *>()(ra.twiss, rb.twiss);
+      }
+      if (ra.model != rb.model) {
+        return ra.model < rb.model;
+      }
+      if (ra.r0 != rb.r0) {
+        return ra.r0 < rb.r0;
+      }
+      return ra.aatom < rb.aatom;
+    });
+
+    size_t begin = 0;
+    while (begin < pending.size()) {
+      const ODERateRequest &first = steppers[pending[begin]].Request();
+      size_t end = begin + 1;
+      while (end < pending.size() && end - begin < limit &&
+             ODESameBatch(first, steppers[pending[end]].Request())) {
+        end++;
+      }
+      int nb = end - begin;
+
+      ArenaScope scope;
+      double *state = ThreadArena().Allocate<double>(5 * nb);
+      double *rates = ThreadArena().Allocate<double>(3 * nb);
+      double *pnumber = state;
+      double *ex = state + nb;
+      double *ey = state + 2 * nb;
+      double *sigs = state + 3 * nb;
+      double *sige = state + 4 * nb;
+      for (int k = 0; k < nb; k++) {
+        const ODERateRequest &r = steppers[pending[begin + k]].Request();
+        pnumber[k] = r.pnumber;
+        ex[k] = r.ex;
+        ey[k] = r.ey;
+        sigs[k] = r.sigs;
+        sige[k] = r.sige;
+      }
+
+      IBSRatesBatch(first.model, nb, pnumber, ex, ey, sigs, sige,
+                    *first.twiss, *first.twissdata, first.r0, first.aatom,
+                    rates);
+      for (int k = 0; k < nb; k++) {
+        steppers[pending[begin + k]].Resume(rates + 3 * k);
+      }
+
+      stats.passes++;
+      stats.requests += nb;
+      stats.maxbatch = max(stats.maxbatch, nb);
+      begin = end;
+    }
+  }
+  perf.SetElements(stats.requests);
+
+  return stats;
+}
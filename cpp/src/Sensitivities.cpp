@@ -0,0 +1,125 @@
+#include "../include/ibs_bits/Sensitivities.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE IBS GROWTH RATES AND THEIR DERIVATIVES WITH RESPECT TO
+THE OPTICS FUNCTIONS OF EVERY ELEMENT.
+
+  d rate / d p_i = d c_i / d p_i  (c_i = contribution of element i)
+
+  CENTRAL DIFFERENCES WITH STEP h = 1e-6 * max(|p_i|, rms(p))
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - double* rates
+        output variable - rates
+    - map<string, vector<double>> &gradients
+        output variable - derivatives per column, 3 entries per element
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void IBSRatesSensitivities(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double *rates,
+                           map<string, vector<double>> &gradients) {
+  const vector<string> columns = {"BETX", "ALFX", "BETY", "ALFY",
+                                  "DX",   "DPX",  "DY",   "DPY"};
+  const double eps = 1.0e-6;
+
+  int n = twissdata["L"].size();
+
+  // column scales for the step size
+  vector<double> scale(columns.size());
+  for (size_t c = 0; c < columns.size(); c++) {
+    vector<double> &col = twissdata[columns[c]];
+    double s2 = 0.0;
+    for (int i = 0; i < n; i++) {
+      s2 += col[i] * col[i];
+    }
+    scale[c] = (s2 > 0.0) ? sqrt(s2 / n) : 1.0;
+    gradients[columns[c]].assign(3 * n, 0.0);
+  }
+
+  double al = 0.0, ax = 0.0, ay = 0.0;
+
+  // elements are independent, each thread only modifies its own element
+#pragma omp parallel for shared(twissdata, gradients) reduction(+ : al, ax, ay)
+  for (int i = 0; i < n; i++) {
+    double out[3], plus[3], minus[3];
+    IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                    twissdata, r0, aatom, out);
+    al += out[0];
+    ax += out[1];
+    ay += out[2];
+
+    // elements without length do not contribute
+    if (twissdata["L"][i] == 0.0 || model == 1) {
+      continue;
+    }
+
+    for (size_t c = 0; c < columns.size(); c++) {
+      double &p = twissdata[columns[c]][i];
+      double p0 = p;
+      double h = eps * max(fabs(p0), scale[c]);
+
+      p = p0 + h;
+      IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                      twissdata, r0, aatom, plus);
+      p = p0 - h;
+      IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                      twissdata, r0, aatom, minus);
+      p = p0;
+
+      vector<double> &grad = gradients[columns[c]];
+      grad[3 * i] = (plus[0] - minus[0]) / (2.0 * h);
+      grad[3 * i + 1] = (plus[1] - minus[1]) / (2.0 * h);
+      grad[3 * i + 2] = (plus[2] - minus[2]) / (2.0 * h);
+    }
+  }
+
+  rates[0] = al;
+  rates[1] = ax;
+  rates[2] = ay;
+}
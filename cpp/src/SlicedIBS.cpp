@@ -0,0 +1,187 @@
+#include "../include/ibs_bits/SlicedIBS.hpp"
+#include "../include/ibs_bits/CoulombLogFunctions.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include "../include/ibs_bits/RadiationDamping.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// integral of the linearly interpolated profile from z[0] to x, cum holds the
+// integrals up to the samples
+static double ProfileIntegral(const vector<double> &z, const vector<double> &p,
+                              const vector<double> &cum, double x) {
+  size_t m = z.size();
+  if (x <= z[0]) {
+    return 0.0;
+  }
+  if (x >= z[m - 1]) {
+    return cum[m - 1];
+  }
+  size_t j = upper_bound(z.begin(), z.end(), x) - z.begin() - 1;
+  double w = (x - z[j]) / (z[j + 1] - z[j]);
+  double px = (1.0 - w) * p[j] + w * p[j + 1];
+  return cum[j] + 0.5 * (x - z[j]) * (p[j] + px);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE IBS GROWTH RATES OF A BUNCH WITH A NON-GAUSSIAN
+LONGITUDINAL PROFILE FROM THE LOCAL RATES OF K SLICES.
+
+  A GAUSSIAN BUNCH OF LENGTH sigs HAS THE MEAN LINE DENSITY
+    <lambda> = N / (2 sqrt(pi) sigs),
+  A SLICE OF DENSITY lambda_k IS THEREFORE EVALUATED AT THE POPULATION
+    N_k = 2 sqrt(pi) sigs lambda_k.
+  THE RATES OF THE GAUSSIAN BUNCH ARE SCALED WITH N_k AND THE COULOMB LOG OF
+  THE MODEL (N_k ONLY FOR THE PIWINSKI MODELS).
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - vector<double> z
+        positions of the profile samples, strictly increasing
+    - vector<double> profile
+        line density at the samples
+    - int nslices
+        number of slices
+    - SliceRates &slices
+        output variable - local rates of the slices
+
+  Returns:
+  --------
+    double [3]
+      bunch averaged rates
+      0 -> longitudinal
+      1 -> horizontal
+      2 -> vertical
+
+================================================================================
+================================================================================
+*/
+double *SlicedIBSRates(int model, double pnumber, double ex, double ey,
+                       double dponp, map<string, double> &twissheader,
+                       map<string, vector<double>> &twissdata, double r0,
+                       double aatom, const vector<double> &z,
+                       const vector<double> &profile, int nslices,
+                       SliceRates &slices) {
+  PerfRegion perf("SlicedIBSRates", twissdata["L"].size(), "model");
+  static thread_local double output[3];
+  output[0] = output[1] = output[2] = 0.0;
+
+  slices.sigs = 0.0;
+  slices.z.clear();
+  slices.weight.clear();
+  slices.density.clear();
+  slices.rates.clear();
+
+  size_t m = z.size();
+  if (m < 2 || profile.size() != m || nslices < 1) {
+    return output;
+  }
+  for (size_t j = 1; j < m; j++) {
+    if (!(z[j] > z[j - 1])) {
+      return output;
+    }
+  }
+
+  // cumulative integral and moments of the profile (trapezoidal rule)
+  vector<double> cum(m, 0.0);
+  double sum1 = 0.0, sum2 = 0.0;
+  for (size_t j = 1; j < m; j++) {
+    double dz = z[j] - z[j - 1];
+    cum[j] = cum[j - 1] + 0.5 * dz * (profile[j - 1] + profile[j]);
+    sum1 += 0.5 * dz * (profile[j - 1] * z[j - 1] + profile[j] * z[j]);
+    sum2 += 0.5 * dz *
+            (profile[j - 1] * z[j - 1] * z[j - 1] + profile[j] * z[j] * z[j]);
+  }
+  double total = cum[m - 1];
+  if (total <= 0.0) {
+    return output;
+  }
+  double mean = sum1 / total;
+  double sigs = sqrt(max(sum2 / total - mean * mean, 0.0));
+  if (sigs <= 0.0) {
+    return output;
+  }
+  slices.sigs = sigs;
+
+  // Gaussian bunch of the same length, the only lattice pass
+  double *ibs = IBSRates(model, pnumber, ex, ey, sigs, dponp, twissheader,
+                         twissdata, r0, aatom);
+  double reference[3] = {ibs[0], ibs[1], ibs[2]};
+
+  // the tailcut logs depend on the radiation damping times of the lattice
+  double taurad[3] = {0.0, 0.0, 0.0};
+  if (model == 5 || model == 7 || model == 10 || model == 12) {
+    double *radint = RadiationDampingLattice(twissdata);
+    double *equi =
+        RadiationDampingLifeTimesAndEquilibriumEmittancesWithPartitionNumbers(
+            twissheader, radint, aatom, 1.0);
+    copy(equi, equi + 3, taurad);
+  }
+  double clog0 =
+      ModelCoulombLog(model, pnumber, ex, ey, twissheader, dponp, sigs,
+                      taurad[0], taurad[1], taurad[2], r0);
+
+  double h = (z[m - 1] - z[0]) / nslices;
+  slices.z.resize(nslices);
+  slices.weight.resize(nslices);
+  slices.density.resize(nslices);
+  slices.rates.assign(3 * nslices, 0.0);
+
+  double lower = 0.0;
+  for (int k = 0; k < nslices; k++) {
+    double zk = z[0] + (k + 0.5) * h;
+    double upper = ProfileIntegral(z, profile, cum, z[0] + (k + 1) * h);
+    double weight = (upper - lower) / total;
+    lower = upper;
+
+    double density = pnumber * weight / h;
+    double nk = 2.0 * sqrt(pi) * sigs * density;
+
+    slices.z[k] = zk;
+    slices.weight[k] = weight;
+    slices.density[k] = density;
+    if (nk <= 0.0) {
+      continue;
+    }
+
+    double clog = ModelCoulombLog(model, nk, ex, ey, twissheader, dponp, sigs,
+                                  taurad[0], taurad[1], taurad[2], r0);
+    double scale = (nk / pnumber) * (clog / clog0);
+    for (int p = 0; p < 3; p++) {
+      slices.rates[3 * k + p] = reference[p] * scale;
+      output[p] += weight * slices.rates[3 * k + p];
+    }
+  }
+
+  return output;
+}
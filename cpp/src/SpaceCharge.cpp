@@ -0,0 +1,186 @@
+#include "../include/ibs_bits/SpaceCharge.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include <map>
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// beam size weighted optics terms of the Laslett sums for one element
+static inline void LaslettElement(double l, double bx, double by, double dx,
+                                  double dy, double ex, double ey,
+                                  double dponp, double &sx, double &sy) {
+  double sigx = sqrt(bx * ex + dx * dx * dponp * dponp);
+  double sigy = sqrt(by * ey + dy * dy * dponp * dponp);
+  sx = l * bx / (sigx * (sigx + sigy));
+  sy = l * by / (sigy * (sigx + sigy));
+}
+
+// -N r0 / ((2 pi)^(3/2) beta^2 gamma^3 sigs)
+static double LaslettFactor(double pnumber, double sigs,
+                            map<string, double> &twissheader, double r0) {
+  double gamma = twissheader["GAMMA"];
+  double betar = BetaRelativisticFromGamma(gamma);
+  return -pnumber * r0 /
+         (pow(2.0 * pi, 1.5) * betar * betar * gamma * gamma * gamma * sigs);
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE MAXIMUM INCOHERENT (LASLETT) SPACE-CHARGE TUNE SHIFTS
+OF A GAUSSIAN BUNCH.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+  REF:
+    - K.Y. NG, PHYSICS OF INTENSITY DEPENDENT BEAM INSTABILITIES, CH. 2
+
+================================================================================
+  Arguments:
+  ----------
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        momentum spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+
+  Returns:
+  --------
+    double [2]
+      0 -> dQx
+      1 -> dQy
+
+================================================================================
+================================================================================
+*/
+double *LaslettTuneShift(double pnumber, double ex, double ey, double sigs,
+                         double dponp, map<string, double> &twissheader,
+                         map<string, vector<double>> &twissdata, double r0) {
+  int n = twissdata["L"].size();
+  PerfRegion perf("LaslettTuneShift", n, "model");
+  static thread_local double output[2];
+
+  vector<double> &l = twissdata["L"];
+  vector<double> &bx = twissdata["BETX"];
+  vector<double> &by = twissdata["BETY"];
+  vector<double> &dx = twissdata["DX"];
+  vector<double> &dy = twissdata["DY"];
+
+  double sumx = 0.0, sumy = 0.0;
+#pragma omp parallel for reduction(+ : sumx, sumy)
+  for (int i = 0; i < n; i++) {
+    double sx, sy;
+    LaslettElement(l[i], bx[i], by[i], dx[i], dy[i], ex, ey, dponp, sx, sy);
+    sumx += sx;
+    sumy += sy;
+  }
+
+  double factor = LaslettFactor(pnumber, sigs, twissheader, r0);
+  output[0] = factor * sumx;
+  output[1] = factor * sumy;
+
+  return output;
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE THE IBS GROWTH RATES AND THE LASLETT TUNE SHIFTS IN ONE
+PASS OVER THE LATTICE.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - int model
+        IBS model (1-13)
+    - double pnumber
+        number of particles
+    - double ex
+        hor emittance
+    - double ey
+        ver emittance
+    - double sigs
+        bunch length
+    - double dponp
+        energy spread
+    - map<string, double> &twissheader
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - double r0
+        classical particle radius
+    - double aatom
+        atomic mass number
+    - double* rates
+        output variable - rates
+    - double* tuneshift
+        output variable - dQx, dQy
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void IBSRatesWithTuneShift(int model, double pnumber, double ex, double ey,
+                           double sigs, double dponp,
+                           map<string, double> &twissheader,
+                           map<string, vector<double>> &twissdata, double r0,
+                           double aatom, double *rates, double *tuneshift) {
+  int n = twissdata["L"].size();
+  PerfRegion perf("IBSRatesWithTuneShift", n, "model");
+
+  vector<double> &l = twissdata["L"];
+  vector<double> &bx = twissdata["BETX"];
+  vector<double> &by = twissdata["BETY"];
+  vector<double> &dx = twissdata["DX"];
+  vector<double> &dy = twissdata["DY"];
+
+  double al = 0.0, ax = 0.0, ay = 0.0;
+  double sumx = 0.0, sumy = 0.0;
+#pragma omp parallel for shared(twissdata)                                     \
+    reduction(+ : al, ax, ay, sumx, sumy)
+  for (int i = 0; i < n; i++) {
+    double out[3];
+    IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, twissheader,
+                    twissdata, r0, aatom, out);
+    al += out[0];
+    ax += out[1];
+    ay += out[2];
+
+    double sx, sy;
+    LaslettElement(l[i], bx[i], by[i], dx[i], dy[i], ex, ey, dponp, sx, sy);
+    sumx += sx;
+    sumy += sy;
+  }
+
+  rates[0] = al;
+  rates[1] = ax;
+  rates[2] = ay;
+
+  double factor = LaslettFactor(pnumber, sigs, twissheader, r0);
+  tuneshift[0] = factor * sumx;
+  tuneshift[1] = factor * sumy;
+}
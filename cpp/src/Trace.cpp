@@ -0,0 +1,120 @@
+#include "../include/ibs_bits/Trace.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  double start;
+  double stop;
+  long elements;
+  int tid;
+};
+
+static atomic<bool> trace_enabled(false);
+static mutex trace_mutex;
+static vector<TraceEvent> trace_buffer;
+static size_t trace_capacity = 0;
+static size_t trace_count = 0;
+static double trace_origin = 0.0;
+static atomic<int> trace_threads(0);
+
+// small consecutive thread ids in order of the first recorded span
+static int TraceThreadId() {
+  static thread_local int tid = trace_threads++;
+  return tid;
+}
+
+void TraceEnable(size_t capacity) {
+  lock_guard<mutex> lock(trace_mutex);
+  capacity = (capacity > 0) ? capacity : 1;
+  if (capacity != trace_capacity) {
+    trace_buffer.clear();
+    trace_buffer.reserve(capacity);
+    trace_capacity = capacity;
+    trace_count = 0;
+  }
+  if (trace_count == 0) {
+    trace_origin = chrono::duration<double>(
+                       chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  }
+  trace_enabled = true;
+}
+
+void TraceDisable() { trace_enabled = false; }
+
+bool TraceEnabled() { return trace_enabled; }
+
+void TraceClear() {
+  lock_guard<mutex> lock(trace_mutex);
+  trace_buffer.clear();
+  trace_count = 0;
+  trace_origin = chrono::duration<double>(
+                     chrono::steady_clock::now().time_since_epoch())
+                     .count();
+}
+
+size_t TraceSize() {
+  lock_guard<mutex> lock(trace_mutex);
+  return trace_buffer.size();
+}
+
+size_t TraceDropped() {
+  lock_guard<mutex> lock(trace_mutex);
+  return trace_count - trace_buffer.size();
+}
+
+void TraceRecord(const char *name, const char *category, double start,
+                 double stop, long elements) {
+  if (!trace_enabled) {
+    return;
+  }
+  TraceEvent event = {name, category, start, stop, elements, TraceThreadId()};
+
+  lock_guard<mutex> lock(trace_mutex);
+  if (trace_buffer.size() < trace_capacity) {
+    trace_buffer.push_back(event);
+  } else {
+    trace_buffer[trace_count % trace_capacity] = event;
+  }
+  trace_count++;
+}
+
+/*
+================================================================================
+  CHROME TRACE EVENT FORMAT, COMPLETE EVENTS ("ph": "X") WITH TIMES IN
+  MICROSECONDS SINCE THE START OF THE TRACE. EVENTS ARE WRITTEN OLDEST FIRST.
+================================================================================
+*/
+bool TraceWrite(string filename) {
+  FILE *file = fopen(filename.c_str(), "w");
+  if (file == NULL) {
+    return false;
+  }
+
+  lock_guard<mutex> lock(trace_mutex);
+  size_t n = trace_buffer.size();
+  size_t first = (trace_count > n) ? trace_count % trace_capacity : 0;
+
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                "\"args\": {\"name\": \"IBSLib\"}}");
+  for (size_t k = 0; k < n; k++) {
+    TraceEvent &e = trace_buffer[(first + k) % n];
+    fprintf(file,
+            ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+            "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d, "
+            "\"args\": {\"elements\": %ld}}",
+            e.name, e.category, 1.0e6 * (e.start - trace_origin),
+            1.0e6 * (e.stop - e.start), e.tid, e.elements);
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
@@ -0,0 +1,522 @@
+#include "../include/ibs_bits/UncertaintyQuantification.hpp"
+#include "../include/ibs_bits/Arena.hpp"
+#include "../include/ibs_bits/Models.hpp"
+#include "../include/ibs_bits/NumericFunctions.hpp"
+#include "../include/ibs_bits/OrdDiffEq.hpp"
+#include "../include/ibs_bits/PerfCounters.hpp"
+#include "../include/ibs_bits/RadiationDamping.hpp"
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+================================================================================
+================================================================================
+SOBOL SEQUENCE
+
+  DIRECTION NUMBERS : S. Joe and F. Y. Kuo, new-joe-kuo-6.21201
+  DIMENSIONS 2-12, DIMENSION 1 IS THE VAN DER CORPUT SEQUENCE.
+
+================================================================================
+*/
+static const int SOBOL_MAXDIM = 12;
+static const int SOBOL_BITS = 32;
+
+// degree, polynomial coefficients, initial direction numbers
+static const unsigned int SOBOL_S[SOBOL_MAXDIM] = {0, 1, 2, 3, 3, 4,
+                                                   4, 5, 5, 5, 5, 5};
+static const unsigned int SOBOL_A[SOBOL_MAXDIM] = {0, 0, 1, 1, 2, 1,
+                                                   4, 2, 4, 7, 11, 13};
+static const unsigned int SOBOL_M[SOBOL_MAXDIM][5] = {
+    {0, 0, 0, 0, 0},  {1, 0, 0, 0, 0},  {1, 3, 0, 0, 0},   {1, 3, 1, 0, 0},
+    {1, 1, 1, 0, 0},  {1, 1, 3, 3, 0},  {1, 3, 5, 13, 0},  {1, 1, 5, 5, 17},
+    {1, 1, 5, 5, 5},  {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1},  {1, 1, 1, 3, 11}};
+
+static void SobolDirections(int d, unsigned int *v) {
+  if (d == 0) {
+    for (int i = 1; i <= SOBOL_BITS; i++) {
+      v[i] = 1u << (SOBOL_BITS - i);
+    }
+    return;
+  }
+  unsigned int s = SOBOL_S[d];
+  unsigned int a = SOBOL_A[d];
+  for (unsigned int i = 1; i <= s; i++) {
+    v[i] = SOBOL_M[d][i - 1] << (SOBOL_BITS - i);
+  }
+  for (unsigned int i = s + 1; i <= (unsigned int)SOBOL_BITS; i++) {
+    v[i] = v[i - s] ^ (v[i - s] >> s);
+    for (unsigned int k = 1; k <= s - 1; k++) {
+      v[i] ^= (((a >> (s - 1 - k)) & 1u) * v[i - k]);
+    }
+  }
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO CALCULATE A POINT OF THE SCRAMBLED SOBOL SEQUENCE
+
+  x_d = (gray code sum of the direction numbers) XOR shift_d
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - unsigned int index
+        index of the point
+    - int dim
+        number of dimensions (max 12)
+    - unsigned int *shift
+        digital shift per dimension
+    - double *out
+        output point
+
+  Returns:
+  --------
+    double[dim] out
+
+================================================================================
+================================================================================
+*/
+void SobolPoint(unsigned int index, int dim, unsigned int *shift,
+                double *out) {
+  unsigned int gray = index ^ (index >> 1);
+  unsigned int v[SOBOL_BITS + 1];
+
+  for (int d = 0; d < dim && d < SOBOL_MAXDIM; d++) {
+    SobolDirections(d, v);
+    unsigned int x = 0;
+    for (int b = 0; b < SOBOL_BITS; b++) {
+      if ((gray >> b) & 1u) {
+        x ^= v[b + 1];
+      }
+    }
+    x ^= shift[d];
+    out[d] = ((double)x + 0.5) / 4294967296.0;
+  }
+}
+
+/*
+================================================================================
+================================================================================
+INVERSE OF THE STANDARD NORMAL CDF
+
+  P. J. Acklam's rational approximation with one Halley refinement step.
+
+================================================================================
+*/
+static double InverseNormalCDF(double p) {
+  const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                       -2.759285104469687e+02, 1.383577518672690e+02,
+                       -3.066479806614716e+01, 2.506628277459239e+00};
+  const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                       -1.556989798598866e+02, 6.680131188771972e+01,
+                       -1.328068155288572e+01};
+  const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                       -2.400758277161838e+00, -2.549732539343734e+00,
+                       4.374664141464968e+00,  2.938163982698783e+00};
+  const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01,
+                       2.445134137142996e+00, 3.754408661907416e+00};
+  const double plow = 0.02425;
+
+  double x;
+  if (p < plow) {
+    double q = sqrt(-2.0 * log(p));
+    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  } else if (p <= 1.0 - plow) {
+    double q = p - 0.5;
+    double r = q * q;
+    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+        q /
+        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+  } else {
+    double q = sqrt(-2.0 * log(1.0 - p));
+    x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+
+  // refinement
+  double e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+  double u = e * sqrt(2.0 * pi) * exp(x * x / 2.0);
+  return x - u / (1.0 + x * u / 2.0);
+}
+
+/*
+================================================================================
+================================================================================
+P2 ALGORITHM FOR STREAMING QUANTILES
+
+  R. Jain and I. Chlamtac, Commun. ACM 28 (1985) 1076
+  FIVE MARKERS, NO SAMPLES ARE STORED AFTER THE FIRST FIVE.
+
+================================================================================
+*/
+struct P2Quantile {
+  double p;
+  int count = 0;
+  double q[5];
+  double n[5];
+  double np[5];
+  double dn[5];
+
+  P2Quantile(double prob) : p(prob) {
+    dn[0] = 0.0;
+    dn[1] = p / 2.0;
+    dn[2] = p;
+    dn[3] = (1.0 + p) / 2.0;
+    dn[4] = 1.0;
+  }
+
+  void add(double x) {
+    if (count < 5) {
+      q[count++] = x;
+      if (count == 5) {
+        sort(q, q + 5);
+        for (int i = 0; i < 5; i++) {
+          n[i] = i;
+        }
+        np[0] = 0.0;
+        np[1] = 2.0 * p;
+        np[2] = 4.0 * p;
+        np[3] = 2.0 + 2.0 * p;
+        np[4] = 4.0;
+      }
+      return;
+    }
+    count++;
+
+    int k;
+    if (x < q[0]) {
+      q[0] = x;
+      k = 0;
+    } else if (x < q[1]) {
+      k = 0;
+    } else if (x < q[2]) {
+      k = 1;
+    } else if (x < q[3]) {
+      k = 2;
+    } else if (x <= q[4]) {
+      k = 3;
+    } else {
+      q[4] = x;
+      k = 3;
+    }
+    for (int i = k + 1; i < 5; i++) {
+      n[i] += 1.0;
+    }
+    for (int i = 0; i < 5; i++) {
+      np[i] += dn[i];
+    }
+
+    // adjust the middle markers
+    for (int i = 1; i < 4; i++) {
+      double d = np[i] - n[i];
+      if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) ||
+          (d <= -1.0 && n[i - 1] - n[i] < -1.0)) {
+        d = (d > 0.0) ? 1.0 : -1.0;
+        double qp = q[i] + d / (n[i + 1] - n[i - 1]) *
+                               ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) /
+                                    (n[i + 1] - n[i]) +
+                                (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) /
+                                    (n[i] - n[i - 1]));
+        if (q[i - 1] < qp && qp < q[i + 1]) {
+          q[i] = qp;
+        } else {
+          int j = i + (int)d;
+          q[i] = q[i] + d * (q[j] - q[i]) / (n[j] - n[i]);
+        }
+        n[i] += d;
+      }
+    }
+  }
+
+  double value() {
+    if (count == 0) {
+      return 0.0;
+    }
+    if (count < 5) {
+      double s[5];
+      copy(q, q + count, s);
+      sort(s, s + count);
+      int idx = (int)round(p * (count - 1));
+      return s[idx];
+    }
+    return q[2];
+  }
+};
+
+/*
+================================================================================
+================================================================================
+SINGLE EVALUATION OF THE MODEL FOR A PARAMETER SET
+
+================================================================================
+*/
+static void UQEvaluate(map<string, double> &twiss,
+                       map<string, vector<double>> &twissdata, int nrf,
+                       double harmon[], double voltages[], int model,
+                       string &mode, double threshold, const double *radint,
+                       double *p, double *out) {
+  PerfRegion perf("UQEvaluate", 1, "scan");
+  // task temporaries from the thread's scratch memory
+  ArenaScope scope;
+  double *v = ThreadArena().Allocate<double>(nrf);
+  for (int k = 0; k < nrf; k++) {
+    v[k] = voltages[k] * p[UQ_VOLTAGE];
+  }
+
+  if (mode == "equilibrium") {
+    ODEScratch &run = ThreadODEScratch(p[UQ_EX], p[UQ_EY], p[UQ_SIGS]);
+    ODE(twiss, twissdata, nrf, harmon, v, run.t, run.ex, run.ey, run.sigs,
+        run.sige, model, p[UQ_PNUMBER], (int)round(p[UQ_COUPLING]), threshold,
+        "der", false);
+    out[0] = run.ex.back();
+    out[1] = run.ey.back();
+    out[2] = run.sigs.back();
+    return;
+  }
+
+  // the synchrotron tune depends on the sampled voltages
+  ODERing ring;
+  ODERingFromIntegrals(twiss, radint, nrf, harmon, v, 0, ring);
+  double sige =
+      sigefromsigs(ring.omega, p[UQ_SIGS], ring.qs, ring.gamma, ring.gammatr);
+
+  double *ibs = IBSRates(model, p[UQ_PNUMBER], p[UQ_EX], p[UQ_EY], p[UQ_SIGS],
+                         sige, twiss, twissdata, ring.r0, ring.aatom);
+  out[0] = ibs[0];
+  out[1] = ibs[1];
+  out[2] = ibs[2];
+}
+
+/*
+================================================================================
+================================================================================
+METHOD FOR QUASI MONTE CARLO UNCERTAINTY PROPAGATION
+
+  SALTELLI SCHEME WITH MATRICES A, B AND AB_j (COLUMN j FROM B):
+    S1_j = mean((f(B) - f0) (f(AB_j) - f(A))) / var
+    ST_j = mean((f(A) - f(AB_j))**2) / (2 var)           (Jansen)
+
+  MEAN AND VARIANCE WITH WELFORD'S ALGORITHM, QUANTILES WITH P2.
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - map<string, double> &twiss
+        twiss header madx
+    - map<string, vector<double>> twissdata
+        twiss table madx
+    - int nrf
+        number of rf systems
+    - double harmon[]
+        harmonic numbers
+    - double voltages[]
+        rf voltages
+    - int model
+        IBS model (1-13)
+    - UQDistribution *distributions
+        parameter distributions
+    - int nsamples
+        number of samples
+    - string sampling
+        sobol or lhs
+    - string mode
+        rates or equilibrium
+    - double threshold
+        ODE threshold
+    - bool sensitivities
+        calculate Sobol indices
+    - vector<double> &quantiles
+        quantile probabilities
+    - unsigned long seed
+        seed
+    - map<string, vector<double>> &results
+        output statistics
+
+  Returns:
+  --------
+    void
+
+================================================================================
+================================================================================
+*/
+void UncertaintyQuantification(map<string, double> &twiss,
+                               map<string, vector<double>> &twissdata, int nrf,
+                               double harmon[], double voltages[], int model,
+                               UQDistribution *distributions, int nsamples,
+                               string sampling, string mode, double threshold,
+                               bool sensitivities, vector<double> &quantiles,
+                               unsigned long seed,
+                               map<string, vector<double>> &results) {
+  const int nout = 3;
+  const int batch = 64;
+
+  // uncertain parameters
+  vector<int> active;
+  for (int j = 0; j < UQ_NPARAMETERS; j++) {
+    if (distributions[j].type != UQ_FIXED) {
+      active.push_back(j);
+    }
+  }
+  int k = active.size();
+  int dim = sensitivities ? 2 * k : k;
+  int nsets = sensitivities ? k + 2 : 1;
+
+  // radiation integrals for the rates mode, the rf dependent ring quantities
+  // are calculated per sample
+  double radint[7];
+  double *rad = RadiationDampingLattice(twissdata);
+  copy(rad, rad + 7, radint);
+
+  // random scrambling or latin hypercube permutations
+  mt19937_64 rng(seed);
+  vector<unsigned int> shift(dim);
+  for (int d = 0; d < dim; d++) {
+    shift[d] = (unsigned int)(rng() >> 32);
+  }
+  vector<vector<int>> perm;
+  uniform_real_distribution<double> uniform(0.0, 1.0);
+  if (sampling == "lhs") {
+    perm.resize(dim);
+    for (int d = 0; d < dim; d++) {
+      perm[d].resize(nsamples);
+      for (int i = 0; i < nsamples; i++) {
+        perm[d][i] = i;
+      }
+      shuffle(perm[d].begin(), perm[d].end(), rng);
+    }
+  }
+
+  // streaming statistics
+  long count = 0;
+  vector<double> mean(nout, 0.0), m2(nout, 0.0);
+  vector<double> s1(nout * UQ_NPARAMETERS, 0.0), st(nout * UQ_NPARAMETERS, 0.0);
+  // outputs are shifted by the first evaluation in the S1 estimator to avoid
+  // cancellation when the variance is small compared to the mean
+  vector<double> offset(nout, 0.0);
+  vector<vector<P2Quantile>> p2(nout);
+  for (int o = 0; o < nout; o++) {
+    for (double prob : quantiles) {
+      p2[o].push_back(P2Quantile(prob));
+    }
+  }
+
+  auto accumulate = [&](double *f) {
+    count++;
+    for (int o = 0; o < nout; o++) {
+      double delta = f[o] - mean[o];
+      mean[o] += delta / count;
+      m2[o] += delta * (f[o] - mean[o]);
+      for (auto &q : p2[o]) {
+        q.add(f[o]);
+      }
+    }
+  };
+
+  vector<double> u(dim);
+  vector<double> params(batch * nsets * UQ_NPARAMETERS);
+  vector<double> outputs(batch * nsets * nout);
+
+  for (int start = 0; start < nsamples; start += batch) {
+    int nb = min(batch, nsamples - start);
+
+    // sample generation is sequential and therefore reproducible
+    for (int b = 0; b < nb; b++) {
+      int i = start + b;
+      if (sampling == "lhs") {
+        for (int d = 0; d < dim; d++) {
+          u[d] = (perm[d][i] + uniform(rng)) / nsamples;
+        }
+      } else {
+        SobolPoint(i, dim, shift.data(), u.data());
+      }
+
+      for (int s = 0; s < nsets; s++) {
+        double *p = &params[(b * nsets + s) * UQ_NPARAMETERS];
+        for (int j = 0; j < UQ_NPARAMETERS; j++) {
+          p[j] = distributions[j].a;
+        }
+        for (int a = 0; a < k; a++) {
+          // set 0 -> A, set 1 -> B, set 2 + j -> A with column j from B
+          int d = (s == 1 || s == 2 + a) ? k + a : a;
+          UQDistribution &dist = distributions[active[a]];
+          double x = u[d];
+          if (dist.type == UQ_UNIFORM) {
+            x = dist.a + (dist.b - dist.a) * x;
+          } else {
+            x = dist.a + dist.b * InverseNormalCDF(x);
+          }
+          p[active[a]] = x;
+        }
+      }
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int e = 0; e < nb * nsets; e++) {
+      UQEvaluate(twiss, twissdata, nrf, harmon, voltages, model, mode,
+                 threshold, radint, &params[e * UQ_NPARAMETERS],
+                 &outputs[e * nout]);
+    }
+
+    // statistics in sample order
+    for (int b = 0; b < nb; b++) {
+      double *fa = &outputs[b * nsets * nout];
+      accumulate(fa);
+      if (!sensitivities) {
+        continue;
+      }
+      double *fb = &outputs[(b * nsets + 1) * nout];
+      accumulate(fb);
+      if (start + b == 0) {
+        copy(fa, fa + nout, offset.begin());
+      }
+      for (int a = 0; a < k; a++) {
+        double *fab = &outputs[(b * nsets + 2 + a) * nout];
+        for (int o = 0; o < nout; o++) {
+          s1[o * UQ_NPARAMETERS + active[a]] +=
+              (fb[o] - offset[o]) * (fab[o] - fa[o]);
+          st[o * UQ_NPARAMETERS + active[a]] +=
+              (fa[o] - fab[o]) * (fa[o] - fab[o]);
+        }
+      }
+    }
+  }
+
+  // results
+  vector<double> variance(nout), qvalues(nout * quantiles.size());
+  for (int o = 0; o < nout; o++) {
+    variance[o] = (count > 1) ? m2[o] / (count - 1) : 0.0;
+    for (size_t q = 0; q < quantiles.size(); q++) {
+      qvalues[o * quantiles.size() + q] = p2[o][q].value();
+    }
+    for (int j = 0; j < UQ_NPARAMETERS; j++) {
+      int idx = o * UQ_NPARAMETERS + j;
+      s1[idx] = (variance[o] > 0.0) ? s1[idx] / nsamples / variance[o] : 0.0;
+      st[idx] =
+          (variance[o] > 0.0) ? st[idx] / (2.0 * nsamples) / variance[o] : 0.0;
+    }
+  }
+
+  results["MEAN"] = mean;
+  results["VARIANCE"] = variance;
+  results["QUANTILES"] = qvalues;
+  results["S1"] = s1;
+  results["ST"] = st;
+  results["NEVALUATIONS"] = {(double)nsamples * nsets};
+}
@@ -1,5 +1,7 @@
+#include "../include/ibs_bits/PerfCounters.hpp"
 #include <algorithm>
 #include <cstdlib>
+#include <errno.h>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -8,12 +10,15 @@
 #include <sstream>
 #include <stdio.h>
 #include <string>
+#include <string_view>
+#include <unistd.h>
 #include <unordered_map>
 #include <vector>
 
 using namespace std;
 
 map<string, double> GetTwissHeader(string filename) {
+  PerfRegion perf("GetTwissHeader", 1, "io");
   vector<string> TWISSHEADERKEYS /* */ {
       "MASS",     "CHARGE",  "ENERGY",  "PC",      "GAMMA",   "KBUNCH",
       "BCURRENT", "SIGE",    "SIGT",    "NPART",   "EX",      "EY",
@@ -60,6 +65,7 @@ map<string, double> GetTwissHeader(string filename) {
 }
 
 vector<vector<double>> GetTable(string filename, vector<string> columns) {
+  PerfRegion perf("GetTable", 0, "io");
   string line;
   ifstream file(filename);
 
@@ -142,6 +148,7 @@ vector<vector<double>> GetTable(string filename, vector<string> columns) {
         // cout << endl;
       }
     }
+    perf.SetElements(output.size());
     return output;
   }
   vector<vector<double>> output(1, vector<double>(1));
@@ -150,9 +157,11 @@ vector<vector<double>> GetTable(string filename, vector<string> columns) {
 }
 
 map<string, vector<double>> GetTwissTableAsMap(string filename) {
+  PerfRegion perf("GetTwissTableAsMap", 0, "io");
   vector<string> TWISSCOLS /* */ {"L",    "BETX",  "ALFX", "BETY", "ALFY",
                                   "DX",   "DPX",   "DY",   "DPY",  "K1L",
-                                  "K1SL", "ANGLE", "K2L",  "K2SL"};
+                                  "K1SL", "ANGLE", "K2L",  "K2SL", "E1",
+                                  "E2"};
   map<string, vector<double>> out;
   map<int, string> columnnames;
 
@@ -213,5 +222,191 @@ map<string, vector<double>> GetTwissTableAsMap(string filename) {
     }
   }
   file.close();
+  perf.SetElements(out["L"].size());
   return out;
 }
+
+/*
+================================================================================
+  TOKENIZER FOR ONE TFS LINE, QUOTED STRINGS ARE ONE TOKEN
+================================================================================
+*/
+static bool TfsNextToken(string_view &line, string_view &token) {
+  size_t i = 0;
+  while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+    i++;
+  }
+  if (i == line.size()) {
+    line = string_view();
+    return false;
+  }
+  size_t j = i;
+  if (line[i] == '"') {
+    j = line.find('"', i + 1);
+    j = (j == string_view::npos) ? line.size() : j + 1;
+  } else {
+    while (j < line.size() && line[j] != ' ' && line[j] != '\t') {
+      j++;
+    }
+  }
+  token = line.substr(i, j - i);
+  line = line.substr(j);
+  return true;
+}
+
+static bool TfsNumber(string_view token, double &value) {
+  char buffer[64];
+  if (token.empty() || token.size() >= sizeof(buffer)) {
+    return false;
+  }
+  token.copy(buffer, token.size());
+  buffer[token.size()] = '\0';
+  char *end;
+  value = strtod(buffer, &end);
+  return end == buffer + token.size();
+}
+
+/*
+================================================================================
+================================================================================
+METHOD TO PARSE A MADX TFS TWISS OUTPUT FROM MEMORY IN ONE PASS.
+
+  @ NAME FORMAT VALUE   -> HEADER (NUMERIC FORMATS ONLY)
+  * NAME NAME ...       -> COLUMN NAMES
+  $ FORMAT FORMAT ...   -> COLUMN FORMATS
+  OTHER LINES           -> TABLE ROWS
+
+================================================================================
+  HISTORY:
+    - 18/10/2026 : initial version
+
+================================================================================
+  Arguments:
+  ----------
+    - string_view buffer
+        content of the Twiss file
+    - map<string, double> &header
+        output variable - twiss header
+    - map<string, vector<double>> &table
+        output variable - twiss table
+
+  Returns:
+  --------
+    bool
+      true if a table was found and all rows could be parsed
+
+================================================================================
+================================================================================
+*/
+bool ParseTwiss(string_view buffer, map<string, double> &header,
+                map<string, vector<double>> &table) {
+  static const vector<string> TWISSCOLS = {
+      "L",   "BETX", "ALFX", "BETY",  "ALFY", "DX",   "DPX", "DY",
+      "DPY", "K1L",  "K1SL", "ANGLE", "K2L",  "K2SL", "E1",  "E2"};
+  PerfRegion perf("ParseTwiss", 0, "io");
+
+  header.clear();
+  table.clear();
+
+  // table column -> output column, NULL for skipped columns
+  vector<vector<double> *> columns;
+  bool hascolumns = false;
+
+  size_t pos = 0;
+  while (pos < buffer.size()) {
+    size_t eol = buffer.find('\n', pos);
+    if (eol == string_view::npos) {
+      eol = buffer.size();
+    }
+    string_view line = buffer.substr(pos, eol - pos);
+    pos = eol + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    string_view token;
+    if (!TfsNextToken(line, token)) {
+      continue;
+    }
+
+    if (token == "@") {
+      string_view name, format, value;
+      if (TfsNextToken(line, name) && TfsNextToken(line, format) &&
+          TfsNextToken(line, value) && format.find('s') == string_view::npos) {
+        double v;
+        if (TfsNumber(value, v)) {
+          header[string(name)] = v;
+        }
+      }
+    } else if (token == "*") {
+      columns.clear();
+      while (TfsNextToken(line, token)) {
+        string name(token);
+        bool keep =
+            find(TWISSCOLS.begin(), TWISSCOLS.end(), name) != TWISSCOLS.end();
+        columns.push_back(keep ? &table[name] : NULL);
+      }
+      hascolumns = true;
+    } else if (token == "$") {
+      continue;
+    } else {
+      if (!hascolumns) {
+        return false;
+      }
+      size_t c = 0;
+      do {
+        if (c >= columns.size()) {
+          return false;
+        }
+        if (columns[c] != NULL) {
+          double v;
+          if (!TfsNumber(token, v)) {
+            return false;
+          }
+          columns[c]->push_back(v);
+        }
+        c++;
+      } while (TfsNextToken(line, token));
+      if (c != columns.size()) {
+        return false;
+      }
+    }
+  }
+
+  perf.SetElements(table["L"].size());
+  return hascolumns;
+}
+
+bool ReadTwiss(string filename, map<string, double> &header,
+               map<string, vector<double>> &table) {
+  ifstream file(filename, ios::binary | ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+  string buffer(file.tellg(), '\0');
+  file.seekg(0, ios::beg);
+  if (!file.read(&buffer[0], buffer.size())) {
+    return false;
+  }
+  return ParseTwiss(buffer, header, table);
+}
+
+bool ReadTwissFromDescriptor(int fd, map<string, double> &header,
+                             map<string, vector<double>> &table) {
+  string buffer;
+  char chunk[65536];
+  while (true) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    buffer.append(chunk, n);
+  }
+  return ParseTwiss(buffer, header, table);
+}
@@ -0,0 +1,199 @@
+#include <atomic>
+#include <ibs>
+#include <map>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+void red() { printf("\033[1;31m"); }
+void green() { printf("\033[1;32m"); }
+void blue() { printf("\033[1;34m"); }
+void reset() { printf("\033[0m"); }
+
+/*
+================================================================================
+HEAP ALLOCATION COUNTER
+
+  The global operator new of the executable replaces the one of the library,
+  every C++ heap allocation of the library is counted.
+================================================================================
+*/
+static std::atomic<long> allocations(0);
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+static void check(const char *name, long count) {
+  printf("%-40s : %6ld ", name, count);
+  if (count == 0) {
+    green();
+    printf("OK\n");
+  } else {
+    red();
+    printf("FAILED\n");
+    failures++;
+  }
+  reset();
+}
+
+int main() {
+  /*
+  ================================================================================
+  INPUT
+  ================================================================================
+  */
+  // Twiss
+  string twissfilename = "../src/b2_design_lattice_1996.twiss";
+
+  // atomic mass
+  double aatom = emass / pmass;
+
+  // rf
+  int nrf = 1;
+  double harmon[1] = {400.};
+  double voltages[1] = {-4. * 375e3};
+
+  // beam
+  double pnumber = 1e10;
+  double ex = 5e-9;
+  double ey = 1e-10;
+  double sigs = 0.005;
+  double sige = 7e-4;
+
+  map<string, double> twissheadermap = GetTwissHeader(twissfilename);
+  map<string, vector<double>> twisstablemap = GetTwissTableAsMap(twissfilename);
+  updateTwiss(twisstablemap);
+
+  double r0 = ParticleRadius(1, aatom);
+  double rates[3], errors[3];
+
+  /*
+  ================================================================================
+  WARM UP (thread arenas and buffers grow to their working set)
+  ================================================================================
+  */
+  for (int model = 1; model <= 13; model++) {
+    IBSRates(model, pnumber, ex, ey, sigs, sige, twissheadermap, twisstablemap,
+             r0, aatom);
+  }
+  ImportanceSampledRates(4, pnumber, ex, ey, sigs, sige, twissheadermap,
+                         twisstablemap, r0, aatom, 0.01, 1, rates, errors);
+
+  vector<double> t, exs, eys, sigss, siges;
+  t.reserve(10000);
+  exs.reserve(10000);
+  eys.reserve(10000);
+  sigss.reserve(10000);
+
+  auto autostep = [&]() {
+    t.assign(1, 0.0);
+    exs.assign(1, ex);
+    eys.assign(1, ey);
+    sigss.assign(1, sigs);
+    ODE(twissheadermap, twisstablemap, nrf, harmon, voltages, t, exs, eys,
+        sigss, siges, 4, pnumber, 5, 1e-4, "der", false);
+  };
+  autostep();
+
+  // span based interface on an owning lattice
+  Lattice lattice;
+  ReadLattice(twissfilename, lattice);
+  BeamState state = {pnumber, ex, ey, sigs, sige};
+  double pnumbers[4] = {pnumber, 2 * pnumber, 3 * pnumber, 4 * pnumber};
+  double exs4[4] = {ex, ex, ex, ex};
+  double eys4[4] = {ey, ey, ey, ey};
+  double sigss4[4] = {sigs, sigs, sigs, sigs};
+  double siges4[4] = {sige, sige, sige, sige};
+  BeamStates states = {pnumbers, exs4, eys4, sigss4, siges4};
+  double batch[12];
+  ODEResult result;
+  auto spanapi = [&]() {
+    for (int model = 1; model <= 13; model++) {
+      IBSRates(model, state, lattice, r0, aatom, rates);
+    }
+    IBSRatesBatch(4, states, lattice, r0, aatom,
+                  MatrixView<double>(batch, 4, 3));
+    RunODE(lattice, harmon, voltages, pnumber, ex, ey, sigs, 4, 5, 1e-4,
+           "der", result);
+  };
+  spanapi();
+
+  auto scantask = [&]() {
+    ODEScratch &run = ThreadODEScratch(ex, ey, sigs);
+    ODE(twissheadermap, twisstablemap, nrf, harmon, voltages, run.t, run.ex,
+        run.ey, run.sigs, run.sige, 4, pnumber, 5, 1e-4, "der", false);
+  };
+  scantask();
+
+  /*
+  ================================================================================
+  STEADY STATE ALLOCATIONS
+  ================================================================================
+  */
+  blue();
+  printf("Heap allocations in steady state\n");
+  printf("================================\n");
+  reset();
+
+  long start = allocations;
+  for (int model = 1; model <= 13; model++) {
+    IBSRates(model, pnumber, ex, ey, sigs, sige, twissheadermap, twisstablemap,
+             r0, aatom);
+  }
+  check("IBSRates (models 1-13)", allocations - start);
+
+  start = allocations;
+  ImportanceSampledRates(4, pnumber, ex, ey, sigs, sige, twissheadermap,
+                         twisstablemap, r0, aatom, 0.01, 2, rates, errors);
+  check("ImportanceSampledRates", allocations - start);
+
+  start = allocations;
+  updateTwiss(twisstablemap);
+  check("updateTwiss (prepared table)", allocations - start);
+
+  PeriodicLinearOptics(twissheadermap, twisstablemap);
+  start = allocations;
+  PeriodicLinearOptics(twissheadermap, twisstablemap);
+  check("PeriodicLinearOptics (prepared table)", allocations - start);
+
+  start = allocations;
+  autostep();
+  check("ODE auto step (reserved outputs)", allocations - start);
+
+  start = allocations;
+  scantask();
+  check("ODE scan task (thread buffers)", allocations - start);
+
+  start = allocations;
+  spanapi();
+  check("Span interface (lattice, reused result)", allocations - start);
+
+  // the fixed step ODE allocates its histories once, the count must not
+  // depend on the number of steps
+  long perrun[2];
+  int nsteps[2] = {100, 1000};
+  for (int k = 0; k < 2; k++) {
+    vector<double> tf = {0.0}, exf = {ex}, eyf = {ey}, sigsf = {sigs}, sigef;
+    start = allocations;
+    ODE(twissheadermap, twisstablemap, nrf, harmon, voltages, tf, exf, eyf,
+        sigsf, sigef, 4, pnumber, nsteps[k], 1e-3, 5, "der", false);
+    perrun[k] = allocations - start;
+  }
+  check("ODE fixed step (1000 vs 100 steps)", perrun[1] - perrun[0]);
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include <ibs_bits/IBSCApi.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int main(void) {
+  const char *twissfilename = "../src/b2_design_lattice_1996.twiss";
+  const double emass = 0.51099895000e-3;
+  const double pmass = 0.93827208816;
+
+  IBSContext *ctx = ibs_create_from_file(twissfilename);
+  if (ctx == NULL) {
+    printf("Could not read %s\n", twissfilename);
+    return 1;
+  }
+  printf("Elements in lattice : %i\n", ibs_number_of_elements(ctx));
+
+  // Nagaitsev model, electrons
+  if (ibs_set_model(ctx, 4, 1e10, 1.0, emass / pmass) != IBS_OK) {
+    printf("Could not set model\n");
+    ibs_destroy(ctx);
+    return 1;
+  }
+
+  /*
+  ================================================================================
+  RATES FOR A FEW SETS OF MOMENTS, AS A TRACKER WOULD REQUEST EVERY N TURNS
+  ================================================================================
+  */
+  double rates[3];
+  for (int i = 0; i < 5; i++) {
+    double ex = 5e-9 * (1.0 + 0.1 * i);
+    ibs_set_moments(ctx, ex, 1e-10, 0.005, 7e-4);
+
+    clock_t start = clock();
+    ibs_evaluate(ctx, rates);
+    double first = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    ibs_evaluate(ctx, rates);
+    double cached = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("ex %12.6e : %12.6e %12.6e %12.6e (%8.2e s, cached %8.2e s)\n", ex,
+           rates[0], rates[1], rates[2], first, cached);
+  }
+
+  /*
+  ================================================================================
+  KICK A SMALL DISTRIBUTION
+  ================================================================================
+  */
+  int npart = 1000;
+  double *coords = calloc(5 * npart, sizeof(double));
+  int status = ibs_kick(ctx, npart, coords, coords + npart, coords + 2 * npart,
+                        coords + 3 * npart, coords + 4 * npart, 1e-6, 42, 0);
+
+  double spx = 0.0;
+  for (int p = 0; p < npart; p++) {
+    spx += coords[npart + p] * coords[npart + p];
+  }
+  printf("Kick status %i, rms px after kick : %12.6e\n", status,
+         sqrt(spx / npart));
+
+  free(coords);
+  ibs_destroy(ctx);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <ibs>
+#include <ibs_bits/IBSCApi.h>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+void red() { printf("\033[1;31m"); }
+void green() { printf("\033[1;32m"); }
+void blue() { printf("\033[1;34m"); }
+void reset() { printf("\033[0m"); }
+
+static int failures = 0;
+
+// largest deviation relative to the largest rate
+static double deviation(const double *a, const double *b) {
+  double scale = 0.0;
+  double diff = 0.0;
+  for (int j = 0; j < 3; j++) {
+    scale = fmax(scale, fabs(b[j]));
+    diff = fmax(diff, fabs(a[j] - b[j]));
+  }
+  return scale > 0.0 ? diff / scale : diff;
+}
+
+static void check(const char *name, double error) {
+  printf("%-40s : %10.3e ", name, error);
+  if (error <= 1e-12) {
+    green();
+    printf("OK\n");
+  } else {
+    red();
+    printf("FAILED\n");
+    failures++;
+  }
+  reset();
+}
+
+// header of the species as set by ibs_set_model
+static void species(map<string, double> &header, double charge,
+                    double aatom) {
+  double mass = aatom * pmass;
+  header["CHARGE"] = charge;
+  header["MASS"] = mass;
+  header["ENERGY"] = header["GAMMA"] * mass;
+  header["PC"] = mass * sqrt(header["GAMMA"] * header["GAMMA"] - 1.0);
+}
+
+int main() {
+  /*
+  ================================================================================
+  INPUT
+  ================================================================================
+  */
+  string twissfilename = "../src/b2_design_lattice_1996.twiss";
+
+  double pnumber = 1e10;
+  double ex[2] = {5e-9, 8e-9};
+  double ey[2] = {1e-10, 3e-10};
+  double sigs[2] = {0.005, 0.004};
+  double sige[2] = {7e-4, 9e-4};
+
+  map<string, double> twissheadermap = GetTwissHeader(twissfilename);
+  map<string, vector<double>> twisstablemap = GetTwissTableAsMap(twissfilename);
+  updateTwiss(twisstablemap);
+
+  IBSContext *ctx = ibs_create_from_file(twissfilename.c_str());
+  if (ctx == NULL) {
+    printf("Could not read %s\n", twissfilename.c_str());
+    return 1;
+  }
+
+  char name[64];
+  double rates[3];
+
+  /*
+  ================================================================================
+  C API RATES AGAINST THE MODEL FUNCTIONS, ELECTRONS
+  ================================================================================
+  */
+  blue();
+  printf("C API against IBSRates\n");
+  printf("======================\n");
+  reset();
+
+  double aatom = emass / pmass;
+  double r0 = ParticleRadius(1.0, aatom);
+  species(twissheadermap, 1.0, aatom);
+  for (int model = 1; model <= 13; model++) {
+    ibs_set_model(ctx, model, pnumber, 1.0, aatom);
+    double error = 0.0;
+    for (int k = 0; k < 2; k++) {
+      ibs_set_moments(ctx, ex[k], ey[k], sigs[k], sige[k]);
+      ibs_evaluate(ctx, rates);
+      double *ibs = IBSRates(model, pnumber, ex[k], ey[k], sigs[k], sige[k],
+                             twissheadermap, twisstablemap, r0, aatom);
+      error = fmax(error, deviation(rates, ibs));
+    }
+    snprintf(name, sizeof(name), "ibs_evaluate model %d", model);
+    check(name, error);
+  }
+
+  // the element contributions add up to the rates
+  ibs_set_model(ctx, 4, pnumber, 1.0, aatom);
+  ibs_set_moments(ctx, ex[0], ey[0], sigs[0], sige[0]);
+  ibs_evaluate(ctx, rates);
+  double sum[3] = {0.0, 0.0, 0.0};
+  int n = ibs_number_of_elements(ctx);
+  for (int i = 0; i < n; i++) {
+    double contribution[3];
+    ibs_element_rates(ctx, i, contribution);
+    sum[0] += contribution[0];
+    sum[1] += contribution[1];
+    sum[2] += contribution[2];
+  }
+  check("ibs_element_rates summed (model 4)", deviation(sum, rates));
+
+  /*
+  ================================================================================
+  SPECIES OF THE HEADER FOLLOW ibs_set_model, PROTONS
+  ================================================================================
+  */
+  species(twissheadermap, 1.0, 1.0);
+  r0 = ParticleRadius(1.0, 1.0);
+  for (int model : {4, 7, 9}) {
+    ibs_set_model(ctx, model, pnumber, 1.0, 1.0);
+    ibs_set_moments(ctx, ex[1], ey[1], sigs[1], sige[1]);
+    ibs_evaluate(ctx, rates);
+    double *ibs = IBSRates(model, pnumber, ex[1], ey[1], sigs[1], sige[1],
+                           twissheadermap, twisstablemap, r0, 1.0);
+    snprintf(name, sizeof(name), "ibs_evaluate protons model %d", model);
+    check(name, deviation(rates, ibs));
+  }
+
+  ibs_destroy(ctx);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <ibs>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+void red() { printf("\033[1;31m"); }
+void blue() { printf("\033[1;34m"); }
+void cyan() { printf("\033[1;36m"); }
+void reset() { printf("\033[0m"); }
+
+int main() {
+  /*
+  ================================================================================
+  INPUT
+  ================================================================================
+  */
+  // Twiss
+  string twissfilename = "../src/b2_design_lattice_1996.twiss";
+
+  // atomic mass
+  double aatom = emass / pmass;
+
+  // beam
+  int npart = 1000000;
+  int nturns = 10;
+  double pnumber = 1e10;
+  double ex = 5e-9;
+  double ey = 1e-10;
+  double sigs = 0.005;
+  double sige = 7e-4;
+  int element = 0;
+  unsigned long seed = 42;
+
+  map<string, double> twissheadermap;
+  map<string, vector<double>> twisstablemap;
+
+  twissheadermap = GetTwissHeader(twissfilename);
+  twisstablemap = GetTwissTableAsMap(twissfilename);
+  updateTwiss(twisstablemap);
+
+  double r0 = ParticleRadius(1, aatom);
+
+  /*
+  ================================================================================
+  MATCHED GAUSSIAN DISTRIBUTION AT THE REFERENCE ELEMENT
+  ================================================================================
+  */
+  double bx = twisstablemap["BETX"][element];
+  double ax = twisstablemap["ALFX"][element];
+  double by = twisstablemap["BETY"][element];
+  double ay = twisstablemap["ALFY"][element];
+
+  vector<double> x(npart), px(npart), y(npart), py(npart), z(npart),
+      dp(npart);
+  for (int p = 0; p < npart; p++) {
+    double r[4], s[4];
+    GaussianRandomNumbers(seed + 1, p, 0, 0, r);
+    GaussianRandomNumbers(seed + 1, p, 0, 1, s);
+    x[p] = sqrt(bx * ex) * r[0];
+    px[p] = sqrt(ex / bx) * (r[1] - ax * r[0]);
+    y[p] = sqrt(by * ey) * r[2];
+    py[p] = sqrt(ey / by) * (r[3] - ay * r[2]);
+    z[p] = sigs * s[0];
+    dp[p] = sige * s[1];
+  }
+
+  double moments[4];
+  BeamMoments(npart, x.data(), px.data(), y.data(), py.data(), z.data(),
+              dp.data(), twissheadermap, twisstablemap, element, moments);
+
+  blue();
+  printf("Initial distribution (%i macro-particles)\n", npart);
+  printf("%-20s : %12.6e\n", "ex", moments[0]);
+  printf("%-20s : %12.6e\n", "ey", moments[1]);
+  printf("%-20s : %12.6e\n", "sigs", moments[2]);
+  printf("%-20s : %12.6e\n", "sige", moments[3]);
+  reset();
+
+  /*
+  ================================================================================
+  TURN BY TURN KICKS (NAGAITSEV RATES)
+  ================================================================================
+  */
+  double rates[3];
+  cyan();
+  printf("\n%-6s %14s %14s %14s %10s\n", "turn", "1/tau_s", "1/tau_x",
+         "1/tau_y", "time [s]");
+  for (int turn = 0; turn < nturns; turn++) {
+    auto start = std::chrono::steady_clock::now();
+    IBSKickTurn(4, npart, x.data(), px.data(), y.data(), py.data(), z.data(),
+                dp.data(), pnumber, twissheadermap, twisstablemap, r0, aatom,
+                element, seed, turn, rates);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    printf("%-6i %14.6e %14.6e %14.6e %10.4f\n", turn, rates[0], rates[1],
+           rates[2], elapsed.count());
+  }
+  reset();
+
+  BeamMoments(npart, x.data(), px.data(), y.data(), py.data(), z.data(),
+              dp.data(), twissheadermap, twisstablemap, element, moments);
+
+  red();
+  printf("\nAfter %i turns\n", nturns);
+  printf("%-20s : %12.6e\n", "ex", moments[0]);
+  printf("%-20s : %12.6e\n", "ey", moments[1]);
+  printf("%-20s : %12.6e\n", "sigs", moments[2]);
+  printf("%-20s : %12.6e\n", "sige", moments[3]);
+  reset();
+
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <ibs>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+void red() { printf("\033[1;31m"); }
+void blue() { printf("\033[1;34m"); }
+void reset() { printf("\033[0m"); }
+
+int main() {
+  /*
+  ================================================================================
+  INPUT
+  ================================================================================
+  */
+  // Twiss
+  string twissfilename = "../src/b2_design_lattice_1996.twiss";
+
+  // atomic mass
+  double aatom = emass / pmass;
+
+  // beam
+  double pnumber = 1e10;
+  double ex = 5e-9;
+  double ey = 1e-10;
+  double sigs = 0.005;
+  double sige = 7e-4;
+  int repeat = 10;
+
+  /*
+  ================================================================================
+  PROFILING MODE
+  ================================================================================
+  */
+  bool hardware = PerfCountersEnable(true);
+  if (!hardware) {
+    red();
+    printf("Hardware counters not available, only wall time is recorded.\n");
+    reset();
+  }
+
+  map<string, double> twissheadermap = GetTwissHeader(twissfilename);
+  map<string, vector<double>> twisstablemap = GetTwissTableAsMap(twissfilename);
+  updateTwiss(twisstablemap);
+
+  double r0 = ParticleRadius(1, aatom);
+
+  for (int r = 0; r < repeat; r++) {
+    for (int model = 1; model <= 13; model++) {
+      IBSRates(model, pnumber, ex, ey, sigs, sige, twissheadermap,
+               twisstablemap, r0, aatom);
+    }
+  }
+
+  PerfCountersEnable(false);
+
+  blue();
+  printf("Counters per element\n");
+  printf("====================\n");
+  reset();
+  PerfCountersPrint();
+
+  return 0;
+}
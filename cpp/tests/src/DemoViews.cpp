@@ -0,0 +1,181 @@
+#include <ibs>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+void red() { printf("\033[1;31m"); }
+void green() { printf("\033[1;32m"); }
+void blue() { printf("\033[1;34m"); }
+void reset() { printf("\033[0m"); }
+
+static int failures = 0;
+
+// largest deviation relative to the largest value
+static double deviation(const double *a, const double *b, size_t n) {
+  double scale = 0.0;
+  double diff = 0.0;
+  for (size_t j = 0; j < n; j++) {
+    scale = fmax(scale, fabs(b[j]));
+    diff = fmax(diff, fabs(a[j] - b[j]));
+  }
+  return scale > 0.0 ? diff / scale : diff;
+}
+
+// trajectories must be non empty and of the same length
+static double deviation(const vector<double> &a, const vector<double> &b) {
+  if (a.empty() || a.size() != b.size()) {
+    return INFINITY;
+  }
+  return deviation(a.data(), b.data(), a.size());
+}
+
+static void check(const char *name, double error) {
+  printf("%-40s : %10.3e ", name, error);
+  if (error <= 1e-12) {
+    green();
+    printf("OK\n");
+  } else {
+    red();
+    printf("FAILED\n");
+    failures++;
+  }
+  reset();
+}
+
+int main() {
+  /*
+  ================================================================================
+  INPUT
+  ================================================================================
+  */
+  string twissfilename = "../src/b2_design_lattice_1996.twiss";
+
+  const int n = 3;
+  double pnumber[n] = {1e10, 3e10, 5e10};
+  double ex[n] = {5e-9, 8e-9, 2e-9};
+  double ey[n] = {1e-10, 3e-10, 5e-11};
+  double sigs[n] = {0.005, 0.004, 0.006};
+  double sige[n] = {7e-4, 9e-4, 5e-4};
+
+  double harmon[1] = {400.};
+  double voltages[1] = {-4. * 375e3};
+
+  double aatom = emass / pmass;
+  double r0 = ParticleRadius(1.0, aatom);
+
+  // legacy maps and the lattice are read independently
+  map<string, double> twissheadermap = GetTwissHeader(twissfilename);
+  map<string, vector<double>> twisstablemap = GetTwissTableAsMap(twissfilename);
+  updateTwiss(twisstablemap);
+
+  Lattice lattice;
+  if (!ReadLattice(twissfilename, lattice)) {
+    printf("Could not read %s\n", twissfilename.c_str());
+    return 1;
+  }
+
+  char name[64];
+
+  /*
+  ================================================================================
+  VIEW RATES AGAINST THE MAP RATES
+  ================================================================================
+  */
+  blue();
+  printf("IBSRates on a lattice\n");
+  printf("=====================\n");
+  reset();
+
+  for (int model = 1; model <= 13; model++) {
+    double error = 0.0;
+    for (int k = 0; k < n; k++) {
+      BeamState state = {pnumber[k], ex[k], ey[k], sigs[k], sige[k]};
+      double rates[3];
+      IBSRates(model, state, lattice, r0, aatom, rates);
+      double *ibs = IBSRates(model, pnumber[k], ex[k], ey[k], sigs[k], sige[k],
+                             twissheadermap, twisstablemap, r0, aatom);
+      error = fmax(error, deviation(rates, ibs, 3));
+    }
+    snprintf(name, sizeof(name), "IBSRates view model %d", model);
+    check(name, error);
+  }
+
+  /*
+  ================================================================================
+  BATCH RATES INTO STRIDED VIEWS
+  ================================================================================
+  */
+  blue();
+  printf("IBSRatesBatch\n");
+  printf("=============\n");
+  reset();
+
+  BeamStates states;
+  states.pnumber = pnumber;
+  states.ex = ex;
+  states.ey = ey;
+  states.sigs = sigs;
+  states.dponp = sige;
+
+  // padded rows (row stride 4) and column major (row stride 1), the padding
+  // must not be written
+  const double pad = -1.0;
+  for (int model = 1; model <= 13; model++) {
+    vector<double> padded(4 * n, pad);
+    vector<double> colmajor(3 * n, pad);
+    IBSRatesBatch(model, states, lattice, r0, aatom,
+                  MatrixView<double>(padded.data(), n, 3, 4, 1));
+    IBSRatesBatch(model, states, lattice, r0, aatom,
+                  MatrixView<double>(colmajor.data(), n, 3, 1, n));
+
+    double error = 0.0;
+    for (int k = 0; k < n; k++) {
+      double *ibs = IBSRates(model, pnumber[k], ex[k], ey[k], sigs[k], sige[k],
+                             twissheadermap, twisstablemap, r0, aatom);
+      double column[3] = {colmajor[k], colmajor[n + k], colmajor[2 * n + k]};
+      error = fmax(error, deviation(&padded[4 * k], ibs, 3));
+      error = fmax(error, deviation(column, ibs, 3));
+      error = fmax(error, fabs(padded[4 * k + 3] - pad));
+    }
+    snprintf(name, sizeof(name), "IBSRatesBatch strided model %d", model);
+    check(name, error);
+  }
+
+  /*
+  ================================================================================
+  RunODE AGAINST THE MAP ODE
+  ================================================================================
+  */
+  blue();
+  printf("RunODE\n");
+  printf("======\n");
+  reset();
+
+  for (string method : {"der", "rlx"}) {
+    ODEResult result;
+    RunODE(lattice, harmon, voltages, pnumber[1], ex[0], ey[0], sigs[0], 4, 5,
+           1e-4, method, result);
+
+    vector<double> t = {0.0}, exa = {ex[0]}, eya = {ey[0]}, sigsa = {sigs[0]};
+    vector<double> sigea;
+    ODE(twissheadermap, twisstablemap, 1, harmon, voltages, t, exa, eya, sigsa,
+        sigea, 4, pnumber[1], 5, 1e-4, method, false);
+
+    snprintf(name, sizeof(name), "RunODE %s t", method.c_str());
+    check(name, deviation(result.t, t));
+    snprintf(name, sizeof(name), "RunODE %s ex", method.c_str());
+    check(name, deviation(result.ex, exa));
+    snprintf(name, sizeof(name), "RunODE %s ey", method.c_str());
+    check(name, deviation(result.ey, eya));
+    snprintf(name, sizeof(name), "RunODE %s sigs", method.c_str());
+    check(name, deviation(result.sigs, sigsa));
+    snprintf(name, sizeof(name), "RunODE %s sige", method.c_str());
+    check(name, deviation(result.sige, sigea));
+    snprintf(name, sizeof(name), "RunODE %s sige for every t", method.c_str());
+    check(name, result.sige.size() == result.t.size() ? 0.0 : 1.0);
+  }
+
+  return failures == 0 ? 0 : 1;
+}
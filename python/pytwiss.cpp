@@ -24,6 +24,77 @@ PYBIND11_MODULE(IBSLib, m) {
   m.def("GetTwissTable", &GetTwissTableAsMap, "Get the twiss data table.",
         py::arg("filename"));
 
+  m.def("ParseTwiss",
+        [](py::bytes data) {
+          char *ptr;
+          Py_ssize_t size;
+          PyBytes_AsStringAndSize(data.ptr(), &ptr, &size);
+          map<string, double> header;
+          map<string, vector<double>> table;
+          if (!ParseTwiss(string_view(ptr, size), header, table)) {
+            throw py::value_error("invalid Twiss data");
+          }
+          return py::make_tuple(header, table);
+        },
+        "Parse Twiss header and table from bytes in one pass.",
+        py::arg("data"));
+
+  m.def("ReadTwiss",
+        [](string filename) {
+          map<string, double> header;
+          map<string, vector<double>> table;
+          if (!ReadTwiss(filename, header, table)) {
+            throw py::value_error("invalid Twiss file " + filename);
+          }
+          return py::make_tuple(header, table);
+        },
+        "Read Twiss header and table in one pass.", py::arg("filename"));
+
+  m.def("ReadTwissFromDescriptor",
+        [](int fd) {
+          map<string, double> header;
+          map<string, vector<double>> table;
+          bool ok;
+          {
+            py::gil_scoped_release release;
+            ok = ReadTwissFromDescriptor(fd, header, table);
+          }
+          if (!ok) {
+            throw py::value_error("invalid Twiss data");
+          }
+          return py::make_tuple(header, table);
+        },
+        "Read Twiss header and table from a file descriptor or pipe.",
+        py::arg("fd"));
+
+  m.def("ReadSDDS",
+        [](string filename) {
+          SDDSPage page;
+          if (!ReadSDDS(filename, page)) {
+            throw py::value_error("invalid SDDS file " + filename);
+          }
+          py::dict res;
+          res["parameters"] = page.parameters;
+          res["stringparameters"] = page.stringparameters;
+          res["columns"] = page.columns;
+          res["stringcolumns"] = page.stringcolumns;
+          return res;
+        },
+        "Read the first page of a binary or ASCII SDDS file.",
+        py::arg("filename"));
+
+  m.def("ReadElegantTwiss",
+        [](string filename, string parameterfile) {
+          map<string, double> header;
+          map<string, vector<double>> table;
+          if (!ReadElegantTwiss(filename, header, table, parameterfile)) {
+            throw py::value_error("invalid elegant twiss file " + filename);
+          }
+          return py::make_tuple(header, table);
+        },
+        "Read an elegant twiss output (SDDS) as Twiss header and table.",
+        py::arg("filename"), py::arg("parameterfile") = "");
+
   m.def("updateTwiss",
         [](map<string, vector<double>> &table) {
           updateTwiss(table);
@@ -32,6 +103,18 @@ PYBIND11_MODULE(IBSLib, m) {
         "Extend Twiss Table with rad int, CS gamma, curly H and rho.",
         py::arg("table"));
 
+  m.def("PeriodicLinearOptics",
+        [](map<string, double> &header, map<string, vector<double>> &table) {
+          if (!PeriodicLinearOptics(header, table)) {
+            throw py::value_error("no stable periodic solution");
+          }
+          return py::make_tuple(header, table);
+        },
+        "Recompute the periodic uncoupled optics from L, ANGLE and K1L (E1, "
+        "E2, HGAP and FINT if present) and extend the table as updateTwiss. "
+        "Q1, Q2, ALFA and GAMMATR of the header are updated.",
+        py::arg("twissheader"), py::arg("table"));
+
   m.def("printTwissColumn", &printTwissMap, "Print Twiss column",
         py::arg("columnName"), py::arg("twissTableMap"));
   /*
@@ -493,6 +576,18 @@ int n) { return simpson(ibsintegrand, ax, bx, a, b, c, al, bl, n);
         py::arg("alphax"), py::arg("alphay"), py::arg("dispersionx"),
         py::arg("dispersionx_der"), py::arg("dispersiony"),
         py::arg("dispersiony_der"), py::arg("tau"));
+  m.def("integral_dispersion_free",
+        [](double c3, double cy, double cl, py::array_t<double> tau) {
+          double alpha[3];
+          DispersionFreeInt(c3, cy, cl, alpha);
+          auto buf_tau = tau.request();
+          double *ptr_tau = static_cast<double *>(buf_tau.ptr);
+          ptr_tau[0] = alpha[0];
+          ptr_tau[1] = alpha[1];
+          ptr_tau[2] = alpha[2];
+        },
+        "Closed form Bjorken-Mtingwa integral for dispersion-free elements",
+        py::arg("c3"), py::arg("cy"), py::arg("cl"), py::arg("tau"));
   /*
 ================================================================================
                  IBS MODELS
@@ -743,6 +838,574 @@ int n) { return simpson(ibsintegrand, ax, bx, a, b, c, al, bl, n);
         py::arg("twissHeaderMap"), py::arg("twissTableMap"),
         py::arg("classicalRadius"), py::arg("outputArray"));
 
+  m.def("IBSElementRates",
+        [](int model, int i, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom,
+           py::array_t<double> out) {
+          auto buf_out = out.request();
+          double *ptr_out = static_cast<double *>(buf_out.ptr);
+          IBSElementRates(model, i, pnumber, ex, ey, sigs, dponp, header,
+                          table, r0, aatom, ptr_out);
+        },
+        "Contribution of a single element to the IBS growth rates.",
+        py::arg("model"), py::arg("element"), py::arg("pnumber"),
+        py::arg("emitx"), py::arg("emity"), py::arg("bunchLength"),
+        py::arg("dpop"), py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"),
+        py::arg("outputArray"));
+
+  m.def("ImportanceSampledRates",
+        [](int model, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom,
+           double relerr, unsigned long seed, py::array_t<double> out,
+           py::array_t<double> err) {
+          auto buf_out = out.request();
+          double *ptr_out = static_cast<double *>(buf_out.ptr);
+          auto buf_err = err.request();
+          double *ptr_err = static_cast<double *>(buf_err.ptr);
+          return ImportanceSampledRates(model, pnumber, ex, ey, sigs, dponp,
+                                        header, table, r0, aatom, relerr, seed,
+                                        ptr_out, ptr_err);
+        },
+        "IBS growth rates from importance sampled lattice elements.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"),
+        py::arg("relativeError"), py::arg("seed"), py::arg("outputArray"),
+        py::arg("errorArray"));
+
+  m.def("IBSRates",
+        [](int model, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom,
+           py::array_t<double> out) {
+          double *ibs;
+          ibs = IBSRates(model, pnumber, ex, ey, sigs, dponp, header, table, r0,
+                         aatom);
+
+          auto buf_out = out.request();
+          double *ptr_out = static_cast<double *>(buf_out.ptr);
+          ptr_out[0] = ibs[0];
+          ptr_out[1] = ibs[1];
+          ptr_out[2] = ibs[2];
+        },
+        "IBS growth rates of the selected model.", py::arg("model"),
+        py::arg("pnumber"), py::arg("emitx"), py::arg("emity"),
+        py::arg("bunchLength"), py::arg("dpop"), py::arg("twissHeaderMap"),
+        py::arg("twissTableMap"), py::arg("classicalRadius"),
+        py::arg("AtomicMassNumber"), py::arg("outputArray"));
+
+  m.def("IBSRatesBatch",
+        [](int model, vector<double> pnumber, vector<double> ex,
+           vector<double> ey, vector<double> sigs, vector<double> dponp,
+           map<string, double> &header, map<string, vector<double>> &table,
+           double r0, double aatom) {
+          size_t n = pnumber.size();
+          if (ex.size() != n || ey.size() != n || sigs.size() != n ||
+              dponp.size() != n) {
+            throw py::value_error("one value per state expected");
+          }
+          vector<double> out(3 * n);
+          IBSRatesBatch(model, n, pnumber.data(), ex.data(), ey.data(),
+                        sigs.data(), dponp.data(), header, table, r0, aatom,
+                        out.data());
+          return out;
+        },
+        "IBS growth rates of many beam states in one lattice pass, entry "
+        "3 * k + j is rate j of state k.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"));
+
+  m.def("GaussianRandomNumbers",
+        [](unsigned long seed, unsigned long particle, unsigned long turn,
+           unsigned long stream) {
+          vector<double> out(4);
+          GaussianRandomNumbers(seed, particle, turn, stream, out.data());
+          return out;
+        },
+        "Four standard normal numbers from the counter based generator.",
+        py::arg("seed"), py::arg("particle"), py::arg("turn"),
+        py::arg("stream"));
+
+  m.def("BeamMoments",
+        [](py::array_t<double> x, py::array_t<double> px, py::array_t<double> y,
+           py::array_t<double> py_, py::array_t<double> z,
+           py::array_t<double> dp, map<string, double> &header,
+           map<string, vector<double>> &table, int element,
+           py::array_t<double> out) {
+          BeamMoments(x.size(), x.mutable_data(), px.mutable_data(),
+                      y.mutable_data(), py_.mutable_data(), z.mutable_data(),
+                      dp.mutable_data(), header, table, element,
+                      out.mutable_data());
+        },
+        "Rms beam parameters (ex, ey, sigs, sige) of a particle distribution.",
+        py::arg("x"), py::arg("px"), py::arg("y"), py::arg("py"), py::arg("z"),
+        py::arg("dp"), py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("element"), py::arg("outputArray"));
+
+  m.def("IBSKick",
+        [](py::array_t<double> x, py::array_t<double> px, py::array_t<double> y,
+           py::array_t<double> py_, py::array_t<double> dp,
+           py::array_t<double> rates, py::array_t<double> moments,
+           map<string, double> &header, map<string, vector<double>> &table,
+           int element, double dt, unsigned long seed, unsigned long turn,
+           unsigned long stream) {
+          IBSKick(x.size(), x.mutable_data(), px.mutable_data(),
+                  y.mutable_data(), py_.mutable_data(), dp.mutable_data(),
+                  rates.mutable_data(), moments.mutable_data(), header, table,
+                  element, dt, seed, turn, stream);
+        },
+        "Apply IBS kicks for given growth rates to a particle distribution.",
+        py::arg("x"), py::arg("px"), py::arg("y"), py::arg("py"), py::arg("dp"),
+        py::arg("rates"), py::arg("moments"), py::arg("twissHeaderMap"),
+        py::arg("twissTableMap"), py::arg("element"), py::arg("dt"),
+        py::arg("seed"), py::arg("turn"), py::arg("stream") = 0);
+
+  m.def("IBSKickTurn",
+        [](int model, py::array_t<double> x, py::array_t<double> px,
+           py::array_t<double> y, py::array_t<double> py_,
+           py::array_t<double> z, py::array_t<double> dp, double pnumber,
+           map<string, double> &header, map<string, vector<double>> &table,
+           double r0, double aatom, int element, unsigned long seed,
+           unsigned long turn, py::array_t<double> out) {
+          IBSKickTurn(model, x.size(), x.mutable_data(), px.mutable_data(),
+                      y.mutable_data(), py_.mutable_data(), z.mutable_data(),
+                      dp.mutable_data(), pnumber, header, table, r0, aatom,
+                      element, seed, turn, out.mutable_data());
+        },
+        "Apply the IBS kick of one turn to a particle distribution.",
+        py::arg("model"), py::arg("x"), py::arg("px"), py::arg("y"),
+        py::arg("py"), py::arg("z"), py::arg("dp"), py::arg("pnumber"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"),
+        py::arg("element"), py::arg("seed"), py::arg("turn"),
+        py::arg("outputArray"));
+
+  m.def("IBSRatesSensitivities",
+        [](int model, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom,
+           py::array_t<double> out) {
+          map<string, vector<double>> gradients;
+          IBSRatesSensitivities(model, pnumber, ex, ey, sigs, dponp, header,
+                                table, r0, aatom, out.mutable_data(),
+                                gradients);
+          return gradients;
+        },
+        "IBS growth rates and their derivatives with respect to the element "
+        "optics (3 entries per element).",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"),
+        py::arg("outputArray"));
+
+  m.def("UncertaintyQuantification",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, int model,
+           vector<vector<double>> distributions, int nsamples, string sampling,
+           string mode, double threshold, bool sensitivities,
+           vector<double> quantiles, unsigned long seed) {
+          vector<UQDistribution> dist(UQ_NPARAMETERS);
+          for (int j = 0; j < UQ_NPARAMETERS; j++) {
+            dist[j].type = (int)distributions.at(j).at(0);
+            dist[j].a = distributions.at(j).at(1);
+            dist[j].b = distributions.at(j).at(2);
+          }
+          map<string, vector<double>> results;
+          UncertaintyQuantification(twiss, twissdata, h.size(), h.data(),
+                                    v.data(), model, dist.data(), nsamples,
+                                    sampling, mode, threshold, sensitivities,
+                                    quantiles, seed, results);
+          return results;
+        },
+        "Quasi Monte Carlo uncertainty propagation. Distributions are "
+        "(type, a, b) for pnumber, coupling, voltage scale, ex, ey and sigs, "
+        "with type 0 fixed, 1 uniform and 2 normal.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("model"), py::arg("distributions"),
+        py::arg("nsamples"), py::arg("sampling") = "sobol",
+        py::arg("mode") = "rates", py::arg("threshold") = 1e-4,
+        py::arg("sensitivities") = true,
+        py::arg("quantiles") = vector<double>{0.05, 0.5, 0.95},
+        py::arg("seed") = 0);
+
+  m.def("EquilibriumSensitivities",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, int model, double pnumber,
+           int couplingpercentage, double ex, double ey, double sigs,
+           string method) {
+          map<string, vector<double>> sensitivities;
+          EquilibriumSensitivities(twiss, twissdata, h.size(), h.data(),
+                                   v.data(), model, pnumber,
+                                   couplingpercentage, ex, ey, sigs,
+                                   sensitivities, method);
+          return sensitivities;
+        },
+        "Derivatives of the equilibrium with respect to pnumber, coupling, "
+        "voltage scale and energy.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("model"), py::arg("pnumber"),
+        py::arg("couplingPercentage"), py::arg("ex"), py::arg("ey"),
+        py::arg("sigs"), py::arg("method") = "der");
+
+  m.def("FitModelSensitivities",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, int model, double pnumber,
+           vector<double> p, double t0, double ex0, double ey0, double sigs0,
+           vector<double> times) {
+          if (p.size() != FIT_NPARAMETERS) {
+            throw py::value_error("three parameters expected");
+          }
+          vector<double> out, dout;
+          FitModelSensitivities(twiss, twissdata, h.size(), h.data(), v.data(),
+                                model, pnumber, p.data(), t0, ex0, ey0, sigs0,
+                                times, out, dout);
+          map<string, vector<double>> res;
+          res["out"] = move(out);
+          res["dout"] = move(dout);
+          return res;
+        },
+        "Emittance evolution at the given times and its derivatives with "
+        "respect to coupling (percent), population factor and Coulomb log "
+        "factor.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("model"), py::arg("pnumber"),
+        py::arg("parameters"), py::arg("t0"), py::arg("ex0"), py::arg("ey0"),
+        py::arg("sigs0"), py::arg("times"));
+
+  m.def("FitEmittanceEvolution",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, int model, double pnumber,
+           double t0, double ex0, double ey0, double sigs0,
+           vector<double> time, vector<double> ex, vector<double> ey,
+           vector<double> sigs, vector<double> exerr, vector<double> eyerr,
+           vector<double> sigserr, vector<bool> free,
+           vector<vector<double>> starts, int maxiter, double tolerance) {
+          if (free.size() != FIT_NPARAMETERS) {
+            throw py::value_error("three free flags expected");
+          }
+          FitMeasurement data;
+          data.time = move(time);
+          data.ex = move(ex);
+          data.ey = move(ey);
+          data.sigs = move(sigs);
+          data.exerr = move(exerr);
+          data.eyerr = move(eyerr);
+          data.sigserr = move(sigserr);
+          bool flags[FIT_NPARAMETERS];
+          copy(free.begin(), free.end(), flags);
+          vector<double> p0;
+          for (auto &start : starts) {
+            if (start.size() != FIT_NPARAMETERS) {
+              throw py::value_error("three start values expected");
+            }
+            p0.insert(p0.end(), start.begin(), start.end());
+          }
+          vector<FitResult> results;
+          FitEmittanceEvolution(twiss, twissdata, h.size(), h.data(),
+                                v.data(), model, pnumber, t0, ex0, ey0, sigs0,
+                                data, flags, p0, maxiter, tolerance, results);
+          py::list res;
+          for (auto &fit : results) {
+            py::dict d;
+            d["start"] = vector<double>(fit.start, fit.start + FIT_NPARAMETERS);
+            d["parameters"] = vector<double>(fit.parameters,
+                                             fit.parameters + FIT_NPARAMETERS);
+            d["covariance"] = vector<double>(
+                fit.covariance,
+                fit.covariance + FIT_NPARAMETERS * FIT_NPARAMETERS);
+            d["chi2"] = fit.chi2;
+            d["nresiduals"] = fit.nresiduals;
+            d["iterations"] = fit.iterations;
+            d["evaluations"] = fit.evaluations;
+            d["rateevaluations"] = fit.rateevaluations;
+            d["converged"] = fit.converged;
+            res.append(d);
+          }
+          return res;
+        },
+        "Levenberg-Marquardt fit of coupling (percent), population factor and "
+        "Coulomb log factor to a measured emittance evolution, one result per "
+        "start sorted by chi2. Empty series are not fitted, empty errors give "
+        "relative residuals.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("model"), py::arg("pnumber"),
+        py::arg("t0"), py::arg("ex0"), py::arg("ey0"), py::arg("sigs0"),
+        py::arg("time"), py::arg("ex"), py::arg("ey"), py::arg("sigs"),
+        py::arg("exerr") = vector<double>(),
+        py::arg("eyerr") = vector<double>(),
+        py::arg("sigserr") = vector<double>(),
+        py::arg("free") = vector<bool>{true, false, true},
+        py::arg("starts") = vector<vector<double>>{{5.0, 1.0, 1.0}},
+        py::arg("maxiter") = 50, py::arg("tolerance") = 1e-8);
+
+  m.def("PerfCountersEnable", &PerfCountersEnable,
+        "Enable the profiling mode, returns True if hardware counters are "
+        "available.",
+        py::arg("enable") = true);
+  m.def("PerfCountersEnabled", &PerfCountersEnabled,
+        "State of the profiling mode.");
+  m.def("PerfCountersReset", &PerfCountersReset,
+        "Clear the accumulated profiling regions.");
+  m.def(
+      "PerfCountersReport",
+      []() {
+        map<string, map<string, double>> report;
+        PerfCountersReport(report);
+        return report;
+      },
+      "Accumulated wall time and hardware counters per region.");
+
+  m.def("TraceEnable", &TraceEnable,
+        "Start recording timeline spans in a ring buffer.",
+        py::arg("capacity") = 1 << 20);
+  m.def("TraceDisable", &TraceDisable, "Stop recording timeline spans.");
+  m.def("TraceEnabled", &TraceEnabled, "Tracing state.");
+  m.def("TraceClear", &TraceClear, "Remove all recorded spans.");
+  m.def("TraceSize", &TraceSize, "Number of recorded spans.");
+  m.def("TraceDropped", &TraceDropped,
+        "Number of spans overwritten in the ring buffer.");
+  m.def("TraceWrite", &TraceWrite,
+        "Write the spans in Chrome trace event JSON format.",
+        py::arg("filename"));
+
+  py::class_<AutotuneConfig>(m, "AutotuneConfig")
+      .def(py::init<>())
+      .def_readwrite("threads", &AutotuneConfig::threads)
+      .def_readwrite("seconds", &AutotuneConfig::seconds);
+
+  m.def("LatticeSignature", &LatticeSignature,
+        "Hash of the lattice used as autotuning cache key.",
+        py::arg("twissTableMap"));
+  m.def("AutotuneEnable", &AutotuneEnable,
+        "Apply the autotuner automatically in the ODE runs.",
+        py::arg("enable") = true);
+  m.def("AutotuneEnabled", &AutotuneEnabled, "Automatic tuning state.");
+  m.def("AutotuneSetCacheFile", &AutotuneSetCacheFile,
+        "Set the autotuning cache file, empty for the default.",
+        py::arg("filename"));
+  m.def("AutotuneCacheFile", &AutotuneCacheFile,
+        "Autotuning cache file in use.");
+  m.def(
+      "AutotuneLookup",
+      [](int model, map<string, vector<double>> &table) -> py::object {
+        AutotuneConfig config;
+        if (!AutotuneLookup(model, table, config)) {
+          return py::none();
+        }
+        return py::cast(config);
+      },
+      "Cached configuration for this host, lattice and model or None.",
+      py::arg("model"), py::arg("twissTableMap"));
+  m.def("AutotuneApply", &AutotuneApply,
+        "Apply an execution configuration.", py::arg("config"));
+  m.def("Autotune", &Autotune,
+        "Select, cache and apply the fastest execution configuration.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"),
+        py::arg("force") = false);
+
+  m.def(
+      "ThreadArenaStats",
+      []() {
+        ScratchArena &arena = ThreadArena();
+        map<string, size_t> res;
+        res["blocks"] = arena.Blocks();
+        res["capacity"] = arena.Capacity();
+        res["used"] = arena.Used();
+        return res;
+      },
+      "Blocks, capacity and bytes in use of the calling thread's scratch "
+      "arena.");
+
+  // prefix sums are only created by BuildIBSPrefixSums, an empty prefix has
+  // no entries for the range queries
+  py::class_<IBSPrefixSums>(m, "IBSPrefixSums")
+      .def_readonly("model", &IBSPrefixSums::model)
+      .def_readonly("circumference", &IBSPrefixSums::circumference)
+      .def_readonly("s", &IBSPrefixSums::s)
+      .def_readonly("length", &IBSPrefixSums::length)
+      .def_readonly("rates", &IBSPrefixSums::rates)
+      .def_readonly("radiation", &IBSPrefixSums::radiation);
+
+  m.def("BuildIBSPrefixSums",
+        [](int model, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom) {
+          IBSPrefixSums prefix;
+          BuildIBSPrefixSums(model, pnumber, ex, ey, sigs, dponp, header, table,
+                             r0, aatom, prefix);
+          return prefix;
+        },
+        "Prefix sums of the element contributions and radiation integrals.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"));
+
+  m.def("IBSRangeByIndex",
+        [](IBSPrefixSums &prefix, vector<int> first, vector<int> last) {
+          if (first.size() != last.size()) {
+            throw py::value_error("one value per range expected");
+          }
+          map<string, vector<vector<double>>> res;
+          for (size_t k = 0; k < first.size(); k++) {
+            vector<double> rates(3), radiation(7);
+            IBSRangeByIndex(prefix, first[k], last[k], rates.data(),
+                            radiation.data());
+            res["rates"].push_back(rates);
+            res["radiation"].push_back(radiation);
+          }
+          return res;
+        },
+        "Contributions of the element ranges [first, last), one row per "
+        "range.",
+        py::arg("prefix"), py::arg("first"), py::arg("last"));
+
+  m.def("IBSRangeByS",
+        [](IBSPrefixSums &prefix, vector<double> s0, vector<double> s1) {
+          if (s0.size() != s1.size()) {
+            throw py::value_error("one value per range expected");
+          }
+          map<string, vector<vector<double>>> res;
+          for (size_t k = 0; k < s0.size(); k++) {
+            vector<double> rates(3), radiation(7);
+            IBSRangeByS(prefix, s0[k], s1[k], rates.data(), radiation.data());
+            res["rates"].push_back(rates);
+            res["radiation"].push_back(radiation);
+          }
+          return res;
+        },
+        "Contributions of the lattice sections [s0, s1), one row per "
+        "section.",
+        py::arg("prefix"), py::arg("s0"), py::arg("s1"));
+
+  py::class_<SliceRates>(m, "SliceRates")
+      .def(py::init<>())
+      .def_readonly("sigs", &SliceRates::sigs)
+      .def_readonly("z", &SliceRates::z)
+      .def_readonly("weight", &SliceRates::weight)
+      .def_readonly("density", &SliceRates::density)
+      .def_readonly("rates", &SliceRates::rates);
+
+  m.def("SlicedIBSRates",
+        [](int model, double pnumber, double ex, double ey, double dponp,
+           map<string, double> &header, map<string, vector<double>> &table,
+           double r0, double aatom, vector<double> z, vector<double> profile,
+           int nslices) {
+          SliceRates slices;
+          double *rates =
+              SlicedIBSRates(model, pnumber, ex, ey, dponp, header, table, r0,
+                             aatom, z, profile, nslices, slices);
+          return py::make_tuple(vector<double>(rates, rates + 3), slices);
+        },
+        "Bunch averaged IBS growth rates of a longitudinal line-density "
+        "profile and the local rates of its slices.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("dpop"), py::arg("twissHeaderMap"),
+        py::arg("twissTableMap"), py::arg("classicalRadius"),
+        py::arg("AtomicMassNumber"), py::arg("z"), py::arg("profile"),
+        py::arg("nslices"));
+
+  m.def("LaslettTuneShift",
+        [](double pnumber, double ex, double ey, double sigs, double dponp,
+           map<string, double> &header, map<string, vector<double>> &table,
+           double r0) {
+          double *dq = LaslettTuneShift(pnumber, ex, ey, sigs, dponp, header,
+                                        table, r0);
+          return vector<double>{dq[0], dq[1]};
+        },
+        "Incoherent (Laslett) space-charge tune shifts (dQx, dQy).",
+        py::arg("pnumber"), py::arg("emitx"), py::arg("emity"),
+        py::arg("bunchLength"), py::arg("dpop"), py::arg("twissHeaderMap"),
+        py::arg("twissTableMap"), py::arg("classicalRadius"));
+
+  m.def("IBSRatesWithTuneShift",
+        [](int model, double pnumber, double ex, double ey, double sigs,
+           double dponp, map<string, double> &header,
+           map<string, vector<double>> &table, double r0, double aatom) {
+          vector<double> rates(3), dq(2);
+          IBSRatesWithTuneShift(model, pnumber, ex, ey, sigs, dponp, header,
+                                table, r0, aatom, rates.data(), dq.data());
+          map<string, vector<double>> res;
+          res["rates"] = move(rates);
+          res["tuneshift"] = move(dq);
+          return res;
+        },
+        "IBS growth rates and Laslett tune shifts in one lattice pass.",
+        py::arg("model"), py::arg("pnumber"), py::arg("emitx"),
+        py::arg("emity"), py::arg("bunchLength"), py::arg("dpop"),
+        py::arg("twissHeaderMap"), py::arg("twissTableMap"),
+        py::arg("classicalRadius"), py::arg("AtomicMassNumber"));
+
+  py::class_<EquilibriumMap>(m, "EquilibriumMap")
+      .def(py::init<>())
+      .def_readonly("model", &EquilibriumMap::model)
+      .def_property_readonly("axes",
+                             [](EquilibriumMap &emap) {
+                               return vector<vector<double>>{
+                                   emap.axes[0], emap.axes[1], emap.axes[2]};
+                             })
+      .def_readonly("values", &EquilibriumMap::values)
+      .def_readonly("curvatures", &EquilibriumMap::curvatures);
+
+  m.def("BuildEquilibriumMap",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, int model, double ex0,
+           double ey0, double sigs0, vector<double> lower, vector<double> upper,
+           vector<int> ninitial, double tolerance, int maxnodes,
+           double threshold) {
+          EquilibriumMap emap;
+          BuildEquilibriumMap(twiss, twissdata, h.size(), h.data(), v.data(),
+                              model, ex0, ey0, sigs0, lower.data(),
+                              upper.data(), ninitial.data(), tolerance,
+                              maxnodes, threshold, emap);
+          return emap;
+        },
+        "Equilibria on an adaptive grid in (pnumber, coupling, voltage scale).",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("model"), py::arg("ex0"),
+        py::arg("ey0"), py::arg("sigs0"), py::arg("lower"), py::arg("upper"),
+        py::arg("ninitial"), py::arg("tolerance") = 1e-3,
+        py::arg("maxnodes") = 1000, py::arg("threshold") = 1e-4);
+
+  m.def("EquilibriumMapLookup",
+        [](EquilibriumMap &emap, double pnumber, double coupling,
+           double voltage) {
+          vector<double> out(3), error(3);
+          EquilibriumMapLookup(emap, pnumber, coupling, voltage, out.data(),
+                               error.data());
+          map<string, vector<double>> res;
+          res["values"] = move(out);
+          res["errors"] = move(error);
+          return res;
+        },
+        "Interpolated equilibrium (ex, ey, sigs) with error estimate.",
+        py::arg("emap"), py::arg("pnumber"), py::arg("coupling"),
+        py::arg("voltage"));
+
+  m.def("WriteEquilibriumMap", &WriteEquilibriumMap,
+        "Write an equilibrium map to a binary file.", py::arg("filename"),
+        py::arg("emap"));
+
+  m.def("ReadEquilibriumMap",
+        [](string filename) {
+          EquilibriumMap emap;
+          if (!ReadEquilibriumMap(filename, emap)) {
+            throw std::runtime_error("invalid equilibrium map " + filename);
+          }
+          return emap;
+        },
+        "Read an equilibrium map from a binary file.", py::arg("filename"));
+
   m.def("runODE",
         [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
            vector<double> h, vector<double> v, vector<double> &t,
@@ -752,10 +1415,10 @@ int n) { return simpson(ibsintegrand, ax, bx, a, b, c, al, bl, n);
           ODE(twiss, twissdata, h.size(), h.data(), v.data(), t, ex, ey, sigs,
               sige, model, pnumber, couplingpercentage, threshold, method, debug_output);
           map<string, vector<double>> res;
-          res["t"] = t;
-          res["ex"] = ex;
-          res["ey"] = ey;
-          res["sigs"] = sigs;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
           return res;
         },
         "Run ODE simulation using auto time step.", py::arg("twissheader"),
@@ -764,6 +1427,183 @@ int n) { return simpson(ibsintegrand, ax, bx, a, b, c, al, bl, n);
         py::arg("sige"), py::arg("model"), py::arg("pnumber"),
         py::arg("couplingPercentage"), py::arg("threshold"),
         py::arg("simulationMethod"), py::arg("debug_output")=false);
+  m.def("runODEHadron",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, vector<double> &t,
+           vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+           vector<double> sige, int model, double pnumber, double charge,
+           double aatom, double tmax, double tolerance, bool debug_output) {
+          ODEHadron(twiss, twissdata, h.size(), h.data(), v.data(), t, ex, ey,
+                    sigs, sige, model, pnumber, charge, aatom, tmax, tolerance,
+                    debug_output);
+          map<string, vector<double>> res;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
+          return res;
+        },
+        "Run ODE simulation for hadron and ion rings without radiation "
+        "damping, with time steps adapted to the IBS growth rates.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("t"), py::arg("ex"), py::arg("ey"),
+        py::arg("sigs"), py::arg("sige"), py::arg("model"), py::arg("pnumber"),
+        py::arg("charge"), py::arg("AtomicMassNumber"), py::arg("tmax"),
+        py::arg("tolerance") = 0.05, py::arg("debug_output") = false);
+  m.def("runODEWithInjections",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, vector<double> &t,
+           vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+           vector<double> sige, int model, double pnumber,
+           int couplingpercentage, double threshold, string method,
+           vector<tuple<double, double, double, double, double>> events,
+           double tmax, vector<double> loss_time, vector<double> loss_rate,
+           double taugas, double tautouschek,
+           tuple<double, double, double, double> touschek_reference,
+           double dnmax, bool debug_output) {
+          vector<InjectionEvent> schedule;
+          for (auto &e : events) {
+            schedule.push_back({get<0>(e), get<1>(e), get<2>(e), get<3>(e),
+                                get<4>(e)});
+          }
+          LossModel losses;
+          losses.time = loss_time;
+          losses.rate = loss_rate;
+          losses.taugas = taugas;
+          losses.tautouschek = tautouschek;
+          losses.pnumber0 = get<0>(touschek_reference);
+          losses.ex0 = get<1>(touschek_reference);
+          losses.ey0 = get<2>(touschek_reference);
+          losses.sigs0 = get<3>(touschek_reference);
+          losses.dnmax = dnmax;
+          vector<double> n;
+          ODE(twiss, twissdata, h.size(), h.data(), v.data(), t, ex, ey, sigs,
+              sige, model, pnumber, couplingpercentage, threshold, method,
+              schedule, losses, tmax, n, debug_output);
+          map<string, vector<double>> res;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
+          res["n"] = move(n);
+          return res;
+        },
+        "Run ODE simulation up to tmax with injection events given as tuples "
+        "(time, pnumber, ex, ey, sigs) and particle losses from a table of "
+        "relative loss rates, a gas lifetime and a Touschek lifetime at the "
+        "reference state (pnumber, ex, ey, sigs).",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("t"), py::arg("ex"), py::arg("ey"),
+        py::arg("sigs"), py::arg("sige"), py::arg("model"), py::arg("pnumber"),
+        py::arg("couplingPercentage"), py::arg("threshold"),
+        py::arg("simulationMethod"), py::arg("events"), py::arg("tmax"),
+        py::arg("loss_time") = vector<double>(),
+        py::arg("loss_rate") = vector<double>(), py::arg("taugas") = 0.0,
+        py::arg("tautouschek") = 0.0,
+        py::arg("touschek_reference") = make_tuple(0.0, 0.0, 0.0, 0.0),
+        py::arg("dnmax") = 0.01, py::arg("debug_output") = false);
+  m.def("runODEWithOpticsRamp",
+        [](vector<double> times, vector<map<string, double>> twiss,
+           vector<map<string, vector<double>>> twissdata, vector<double> h,
+           vector<double> v, vector<double> &t, vector<double> &ex,
+           vector<double> &ey, vector<double> &sigs, vector<double> sige,
+           int model, double pnumber, int couplingpercentage, double threshold,
+           string method, double tmax, double dwmax, bool debug_output) {
+          OpticsRamp ramp;
+          ramp.time = move(times);
+          ramp.twiss = move(twiss);
+          ramp.twissdata = move(twissdata);
+          ramp.dwmax = dwmax;
+          ODE(ramp, h.size(), h.data(), v.data(), t, ex, ey, sigs, sige, model,
+              pnumber, couplingpercentage, threshold, method, tmax,
+              debug_output);
+          map<string, vector<double>> res;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
+          return res;
+        },
+        "Run ODE simulation up to tmax through an optics ramp given as "
+        "lattices (twiss headers and tables) at increasing times, interpolated "
+        "linearly between them.",
+        py::arg("times"), py::arg("twissheaders"), py::arg("twisstables"),
+        py::arg("harmonic_rf"), py::arg("voltages_rf"), py::arg("t"),
+        py::arg("ex"), py::arg("ey"), py::arg("sigs"), py::arg("sige"),
+        py::arg("model"), py::arg("pnumber"), py::arg("couplingPercentage"),
+        py::arg("threshold"), py::arg("simulationMethod"), py::arg("tmax"),
+        py::arg("dwmax") = 0.01, py::arg("debug_output") = false);
+  m.def("runODEEnsemble",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, vector<double> ex0,
+           vector<double> ey0, vector<double> sigs0, vector<double> pnumber,
+           vector<int> couplingpercentage, int model, double threshold,
+           string method, int maxbatch) {
+          size_t n = ex0.size();
+          if (ey0.size() != n || sigs0.size() != n || pnumber.size() != n ||
+              couplingpercentage.size() != n) {
+            throw py::value_error("one value per run expected");
+          }
+          vector<ODEStepper> steppers;
+          steppers.reserve(n);
+          for (size_t k = 0; k < n; k++) {
+            steppers.emplace_back(twiss, twissdata, h.size(), h.data(),
+                                  v.data(), ex0[k], ey0[k], sigs0[k], model,
+                                  pnumber[k], couplingpercentage[k], threshold,
+                                  method);
+          }
+          ODEScheduleStats stats = ODESchedule(steppers, maxbatch);
+          py::list runs;
+          for (auto &stepper : steppers) {
+            map<string, vector<double>> res;
+            res["t"] = move(stepper.t);
+            res["ex"] = move(stepper.ex);
+            res["ey"] = move(stepper.ey);
+            res["sigs"] = move(stepper.sigs);
+            runs.append(res);
+          }
+          py::dict info;
+          info["passes"] = stats.passes;
+          info["requests"] = stats.requests;
+          info["maxbatch"] = stats.maxbatch;
+          return py::make_tuple(runs, info);
+        },
+        "Run many ODE simulations with auto time step on one lattice, the "
+        "growth rates of all runs are calculated together in batched lattice "
+        "passes. Returns the trajectories and the pass statistics.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("ex0"), py::arg("ey0"),
+        py::arg("sigs0"), py::arg("pnumber"), py::arg("couplingPercentage"),
+        py::arg("model"), py::arg("threshold"), py::arg("simulationMethod"),
+        py::arg("maxbatch") = 0);
+  m.def("runODEWithTuneShift",
+        [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
+           vector<double> h, vector<double> v, vector<double> &t,
+           vector<double> &ex, vector<double> &ey, vector<double> &sigs,
+           vector<double> sige, int model, double pnumber,
+           int couplingpercentage, double threshold, string method,
+           bool debug_output) {
+          vector<double> dqx, dqy;
+          ODE(twiss, twissdata, h.size(), h.data(), v.data(), t, ex, ey, sigs,
+              sige, model, pnumber, couplingpercentage, threshold, method,
+              debug_output, dqx, dqy);
+          map<string, vector<double>> res;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
+          res["sige"] = move(sige);
+          res["dqx"] = move(dqx);
+          res["dqy"] = move(dqy);
+          return res;
+        },
+        "Run ODE simulation using auto time step and record the Laslett tune "
+        "shifts.",
+        py::arg("twissheader"), py::arg("twisstable"), py::arg("harmonic_rf"),
+        py::arg("voltages_rf"), py::arg("t"), py::arg("ex"), py::arg("ey"),
+        py::arg("sigs"), py::arg("sige"), py::arg("model"), py::arg("pnumber"),
+        py::arg("couplingPercentage"), py::arg("threshold"),
+        py::arg("simulationMethod"), py::arg("debug_output") = false);
   m.def("runODE",
         [](map<string, double> &twiss, map<string, vector<double>> &twissdata,
            vector<double> h, vector<double> v, vector<double> &t,
@@ -774,10 +1614,10 @@ int n) { return simpson(ibsintegrand, ax, bx, a, b, c, al, bl, n);
               sige, model, pnumber, nsteps, stepsize, couplingpercentage,
               method, debug_output);
           map<string, vector<double>> res;
-          res["t"] = t;
-          res["ex"] = ex;
-          res["ey"] = ey;
-          res["sigs"] = sigs;
+          res["t"] = move(t);
+          res["ex"] = move(ex);
+          res["ey"] = move(ey);
+          res["sigs"] = move(sigs);
           return res;
         },
         "Run ODE simulation with fixed number of steps and stepsize.",
@@ -0,0 +1,33 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Shared lattice fixture and reference beam of the C++ module tests.
+"""
+
+import os
+
+import IBSLib as ibslib
+import pytest
+
+THIS_DIR = os.path.dirname(os.path.abspath(__file__))
+my_twiss_file = os.path.join(THIS_DIR, "b2_design_lattice_1996.twiss")
+
+# electron beam in the B2 design lattice
+aatom = ibslib.electron_mass / ibslib.proton_mass
+r0 = ibslib.particle_radius(1, aatom)
+
+pnumber = 1e10
+ex = 5e-9
+ey = 1e-10
+sigs = 0.005
+dpop = 7e-4
+
+
+@pytest.fixture
+def twiss():
+    """Twiss header and table with the columns added by updateTwiss."""
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+    return twissheader, twisstable
@@ -322,6 +322,340 @@ def test_cpp_ode2_rlx():
     assert abs((res["sigs"][-1] - sigsfinal) / sigsfinal) < ode_threshold
 
 
+def test_cpp_equilibrium_sensitivities():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+
+    def equilibrium(pnumber, voltage):
+        res = ibslib.runODE(
+            twissheader, twisstable, harmon, [voltage], [0.0], [5e-9],
+            [1e-10], [5e-3], [], 4, pnumber, 10, 1e-6, "der",
+        )
+        return np.array([res["ex"][-1], res["ey"][-1], res["sigs"][-1]])
+
+    u = equilibrium(3e10, voltages[0])
+    sens = ibslib.EquilibriumSensitivities(
+        twissheader, twisstable, harmon, voltages, 4, 3e10, 10, *u
+    )
+    derivatives = np.array([sens["DEX"], sens["DEY"], sens["DSIGS"]])
+
+    # compare with reruns of the ODE at perturbed bunch population and voltage
+    dn = (equilibrium(3.3e10, voltages[0]) - equilibrium(2.7e10, voltages[0])) / 6e9
+    dv = (
+        equilibrium(3e10, 1.01 * voltages[0])
+        - equilibrium(3e10, 0.99 * voltages[0])
+    ) / 0.02
+
+    assert np.allclose(derivatives[:, 0], dn, rtol=1e-3)
+    assert np.allclose(derivatives[[0, 2], 2], dv[[0, 2]], rtol=1e-3)
+    assert len(sens["DRATES"]) == 12
+
+
+def test_cpp_equilibrium_sensitivities_rlx():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+
+    def equilibrium(pnumber):
+        res = ibslib.runODE(
+            twissheader, twisstable, harmon, voltages, [0.0], [5e-9],
+            [1e-10], [5e-3], [], 4, pnumber, 10, 1e-7, "rlx",
+        )
+        return np.array([res["ex"][-1], res["ey"][-1], res["sigs"][-1]])
+
+    # the coupled vertical equilibrium differs between "der" and "rlx"
+    u = equilibrium(3e10)
+    sens = ibslib.EquilibriumSensitivities(
+        twissheader, twisstable, harmon, voltages, 4, 3e10, 10, *u,
+        method="rlx",
+    )
+    derivatives = np.array([sens["DEX"], sens["DEY"], sens["DSIGS"]])
+
+    dn = (equilibrium(3.3e10) - equilibrium(2.7e10)) / 6e9
+    assert np.allclose(derivatives[:, 0], dn, rtol=5e-2)
+
+
+def test_cpp_ode_hadron():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    # protons at gamma = 8 in the same lattice
+    gamma = 8.0
+    twissheader["GAMMA"] = gamma
+    twissheader["PC"] = ibslib.proton_mass * np.sqrt(gamma**2 - 1)
+    twissheader["ENERGY"] = ibslib.proton_mass * gamma
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+    tmax = 3600.0
+
+    def run(tolerance):
+        return ibslib.runODEHadron(
+            twissheader,
+            twisstable,
+            harmon,
+            voltages,
+            [0.0],
+            [5e-9],
+            [5e-10],
+            [0.05],
+            [],
+            4,
+            1e11,
+            1.0,
+            1.0,
+            tmax,
+            tolerance,
+        )
+
+    res = run(0.05)
+    ref = run(0.01)
+
+    assert res["t"][-1] == pytest.approx(tmax)
+    assert len(res["t"]) < 200
+    assert np.all(np.diff(res["ex"]) > 0)
+    for key in ["ex", "ey", "sigs"]:
+        assert abs(res[key][-1] / ref[key][-1] - 1) < 1e-3
+
+
+def test_cpp_ode_injections():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+
+    def run(events, tmax):
+        return ibslib.runODEWithInjections(
+            twissheader,
+            twisstable,
+            harmon,
+            voltages,
+            [0.0],
+            [5e-9],
+            [5e-10],
+            [0.005],
+            [],
+            4,
+            1e10,
+            5,
+            1e-4,
+            "der",
+            events,
+            tmax,
+        )
+
+    # one hour of top-up every minute
+    events = [(60.0 * k, 1e8, 2e-8, 2e-9, 0.01) for k in range(1, 61)]
+    res = run(events, 3600.0)
+    ref = run([], 3600.0)
+
+    t = np.array(res["t"])
+    n = np.array(res["n"])
+    assert t[-1] == pytest.approx(3600.0)
+    assert n[-1] == pytest.approx(1e10 + 60 * 1e8)
+    assert np.all(np.diff(t) >= 0)
+
+    # before and after each injection
+    k = np.where(np.diff(t) == 0)[0]
+    assert len(k) == 60
+    assert np.all(np.array(res["ex"])[k + 1] > np.array(res["ex"])[k])
+
+    # without events the beam stays at the equilibrium of the plain ODE
+    assert ref["ex"][-1] == pytest.approx(ref["ex"][-2])
+    assert len(ref["t"]) < 100
+
+
+# the Piwinski models scale with N only between rate evaluations
+@pytest.mark.parametrize("model", [1, 4])
+def test_cpp_ode_losses(model):
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+    tmax = 4 * 3600.0
+
+    # gas lifetime of one hour, four hour store
+    res = ibslib.runODEWithInjections(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        [0.0],
+        [5e-9],
+        [5e-10],
+        [0.005],
+        [],
+        model,
+        5e10,
+        5,
+        1e-4,
+        "der",
+        [],
+        tmax,
+        taugas=3600.0,
+    )
+    assert res["t"][-1] == pytest.approx(tmax)
+    assert res["n"][-1] == pytest.approx(5e10 * np.exp(-4.0), rel=1e-9)
+    assert np.all(np.diff(res["n"]) <= 0)
+
+    # the beam follows the equilibrium of the final population
+    ref = ibslib.runODE(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        [0.0],
+        [res["ex"][-1]],
+        [res["ey"][-1]],
+        [res["sigs"][-1]],
+        [],
+        model,
+        res["n"][-1],
+        5,
+        1e-6,
+        "der",
+    )
+    for key in ["ex", "ey", "sigs"]:
+        assert res[key][-1] == pytest.approx(ref[key][-1], rel=1e-4)
+
+
+def test_cpp_ode_optics_ramp():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    # detuned optics with larger beta and dispersion
+    squeezed = dict(twisstable)
+    squeezed["BETX"] = [1.5 * b for b in twisstable["BETX"]]
+    squeezed["DX"] = [1.3 * d for d in twisstable["DX"]]
+    squeezed = ibslib.updateTwiss(squeezed)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+
+    def equilibrium(table):
+        return ibslib.runODE(
+            twissheader,
+            table,
+            harmon,
+            voltages,
+            [0.0],
+            [5e-9],
+            [1e-10],
+            [0.005],
+            [],
+            4,
+            1e10,
+            5,
+            1e-6,
+            "der",
+        )
+
+    start = equilibrium(twisstable)
+    end = equilibrium(squeezed)
+
+    res = ibslib.runODEWithOpticsRamp(
+        [0.5, 1.5],
+        [twissheader, twissheader],
+        [twisstable, squeezed],
+        harmon,
+        voltages,
+        [0.0],
+        [5e-9],
+        [1e-10],
+        [0.005],
+        [],
+        4,
+        1e10,
+        5,
+        1e-4,
+        "der",
+        3.0,
+    )
+    assert res["t"][-1] == pytest.approx(3.0)
+
+    # equilibrium of the first lattice before, of the last one after the ramp
+    before = np.searchsorted(res["t"], 0.5) - 1
+    for key in ["ex", "ey", "sigs"]:
+        assert res[key][before] == pytest.approx(start[key][-1], rel=1e-3)
+        assert res[key][-1] == pytest.approx(end[key][-1], rel=1e-3)
+
+    # the horizontal emittance grows monotonically with the optics
+    t = np.array(res["t"])
+    during = (t >= 0.5) & (t <= 1.5)
+    assert np.all(np.diff(np.array(res["ex"])[during]) >= 0)
+
+    # no step crosses a lattice time or an update of the working lattice
+    assert 0.5 in t and 1.5 in t
+    assert np.all(np.diff(t[during]) <= 0.01 * (1 + 1e-9))
+
+
+def test_cpp_ode_ensemble():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+
+    harmon = [400.0]
+    voltages = [-4.0 * 375e3]
+    ex0 = [5e-9, 2e-9, 5e-9]
+    pnumber = [3.2e10, 1e10, 2e10]
+    coupling = [10, 5, 1]
+
+    runs, stats = ibslib.runODEEnsemble(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        ex0,
+        [1e-10] * 3,
+        [0.005] * 3,
+        pnumber,
+        coupling,
+        4,
+        ode_threshold,
+        "rlx",
+    )
+
+    # every round serves all unfinished runs with one lattice pass
+    assert stats["maxbatch"] == 3
+    assert stats["requests"] == sum(len(run["t"]) - 1 for run in runs)
+    assert stats["passes"] == max(len(run["t"]) - 1 for run in runs)
+
+    # same trajectories as the individual runs
+    for k, run in enumerate(runs):
+        res = ibslib.runODE(
+            twissheader,
+            twisstable,
+            harmon,
+            voltages,
+            [0.0],
+            [ex0[k]],
+            [1e-10],
+            [0.005],
+            [],
+            4,
+            pnumber[k],
+            coupling[k],
+            ode_threshold,
+            "rlx",
+        )
+        assert len(run["t"]) == len(res["t"])
+        for key in ["t", "ex", "ey", "sigs"]:
+            assert np.allclose(run[key], res[key], rtol=1e-10)
+
+
 # ==============================================================================
 # The code below is for debugging a particular test in eclipse/pydev.
 # (otherwise all tests are normally run with pytest)
@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module Arena.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+
+from tests.conftest import aatom, r0
+
+
+def sampled(twiss, seed):
+    twissheader, twisstable = twiss
+    out = np.zeros(3)
+    err = np.zeros(3)
+    ibslib.ImportanceSampledRates(
+        4,
+        1e10,
+        5e-9,
+        1e-10,
+        0.005,
+        7e-4,
+        twissheader,
+        twisstable,
+        r0,
+        aatom,
+        0.01,
+        seed,
+        out,
+        err,
+    )
+    return out
+
+
+def test_cpp_arena_released_per_call(twiss):
+    sampled(twiss, 1)
+    stats = ibslib.ThreadArenaStats()
+
+    # temporaries are released at the end of the call, the blocks are kept
+    assert stats["used"] == 0
+    assert stats["capacity"] > 0
+
+    # repeated calls reuse the blocks
+    for seed in range(2, 10):
+        sampled(twiss, seed)
+    assert ibslib.ThreadArenaStats() == stats
+
+
+def test_cpp_arena_results(twiss):
+    # results do not depend on the state of the arena
+    a = sampled(twiss, 3)
+    sampled(twiss, 4)
+    b = sampled(twiss, 3)
+    assert np.array_equal(a, b)
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module Autotune.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+@pytest.fixture
+def twiss(twiss, tmp_path):
+    # shared lattice with a private tuning cache
+    ibslib.AutotuneSetCacheFile(str(tmp_path / "autotune"))
+    yield twiss
+    ibslib.AutotuneEnable(False)
+    ibslib.AutotuneSetCacheFile("")
+
+
+def test_cpp_autotune_caches_winner(twiss):
+    twissheader, twisstable = twiss
+    assert ibslib.AutotuneLookup(4, twisstable) is None
+
+    config = ibslib.Autotune(
+        4, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom
+    )
+    assert config.threads >= 1
+    assert config.seconds > 0
+
+    cached = ibslib.AutotuneLookup(4, twisstable)
+    assert cached.threads == config.threads
+    assert ibslib.AutotuneLookup(9, twisstable) is None
+
+    # a cached entry is applied without measuring again
+    again = ibslib.Autotune(
+        4, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom
+    )
+    assert again.threads == config.threads
+    assert again.seconds == pytest.approx(config.seconds, rel=1e-5)
+
+
+def test_cpp_autotune_signature_depends_on_lattice(twiss):
+    twissheader, twisstable = twiss
+    signature = ibslib.LatticeSignature(twisstable)
+    assert signature == ibslib.LatticeSignature(twisstable)
+
+    twisstable["BETX"][10] *= 1.01
+    assert signature != ibslib.LatticeSignature(twisstable)
+
+
+def test_cpp_autotune_applied_in_ode(twiss):
+    twissheader, twisstable = twiss
+    ibslib.AutotuneEnable(True)
+
+    res = ibslib.runODE(
+        twissheader, twisstable, [400.0], [-4 * 375e3], [0.0], [ex], [ey],
+        [sigs], [], 4, pnumber, 8, 1e-4, "der",
+    )
+
+    assert len(res["t"]) > 1
+    assert ibslib.AutotuneLookup(4, twisstable) is not None
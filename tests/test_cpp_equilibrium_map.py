@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module EquilibriumMap.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+harmon = [400.0]
+voltages = [-4.0 * 375e3]
+
+
+@pytest.fixture
+def emap(twiss):
+    twissheader, twisstable = twiss
+    return ibslib.BuildEquilibriumMap(
+        twissheader, twisstable, harmon, voltages, 4, 5e-9, 1e-10, 5e-3,
+        [1e10, 5, 0.8], [4e10, 15, 1.2], [3, 3, 3], tolerance=2e-3,
+        maxnodes=200,
+    )
+
+
+def equilibrium(twiss, pnumber, coupling, voltage):
+    twissheader, twisstable = twiss
+    res = ibslib.runODE(
+        twissheader, twisstable, harmon, [v * voltage for v in voltages],
+        [0.0], [5e-9], [1e-10], [5e-3], [], 4, pnumber, coupling, 1e-4, "der",
+    )
+    return np.array([res["ex"][-1], res["ey"][-1], res["sigs"][-1]])
+
+
+def test_cpp_equilibrium_map_nodes(twiss, emap):
+    axes = emap.axes
+    assert len(emap.values) == 3 * np.prod([len(a) for a in axes])
+    assert all(np.all(np.diff(a) > 0) for a in axes)
+
+    # the map reproduces the equilibria at the nodes without error
+    res = ibslib.EquilibriumMapLookup(emap, axes[0][1], axes[1][1], axes[2][1])
+    expected = equilibrium(twiss, axes[0][1], int(axes[1][1]), axes[2][1])
+    assert np.allclose(res["values"], expected, rtol=1e-12)
+    assert np.allclose(res["errors"], 0.0)
+
+
+def test_cpp_equilibrium_map_interpolation(twiss, emap):
+    res = ibslib.EquilibriumMapLookup(emap, 2.3e10, 8, 1.07)
+    expected = equilibrium(twiss, 2.3e10, 8, 1.07)
+    assert np.allclose(res["values"], expected, rtol=5e-3)
+    assert np.all(np.array(res["errors"]) <= 5e-3 * expected)
+
+
+def test_cpp_equilibrium_map_file(emap, tmp_path):
+    filename = str(tmp_path / "equilibrium.map")
+    assert ibslib.WriteEquilibriumMap(filename, emap)
+    loaded = ibslib.ReadEquilibriumMap(filename)
+    assert loaded.model == emap.model
+    assert loaded.axes == emap.axes
+    assert loaded.values == emap.values
+    a = ibslib.EquilibriumMapLookup(emap, 3.1e10, 12, 0.93)
+    b = ibslib.EquilibriumMapLookup(loaded, 3.1e10, 12, 0.93)
+    assert a == b
@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module Fitting.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+harmon = [400.0]
+voltages = [-4.0 * 375e3]
+model = 4
+pnumber = 5e10
+ex0 = 5e-9
+ey0 = 1e-10
+sigs0 = 0.005
+times = np.linspace(0.0, 0.04, 41)
+ptrue = [7.3, 1.0, 1.2]
+
+
+def evolution(twiss, p):
+    twissheader, twisstable = twiss
+    return ibslib.FitModelSensitivities(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        model,
+        pnumber,
+        p,
+        0.0,
+        ex0,
+        ey0,
+        sigs0,
+        times,
+    )
+
+
+def test_cpp_fit_sensitivities(twiss):
+    base = evolution(twiss, ptrue)
+    out = np.array(base["out"]).reshape(-1, 3)
+    dout = np.array(base["dout"]).reshape(-1, 3, 3)
+
+    # forward sensitivities agree with finite differences of the model
+    for j in range(3):
+        p = list(ptrue)
+        h = 1e-4 * p[j]
+        p[j] += h
+        shifted = np.array(evolution(twiss, p)["out"]).reshape(-1, 3)
+        fd = (shifted - out) / h
+        atol = 1e-3 * np.abs(fd).max()
+        assert np.allclose(dout[:, :, j], fd, rtol=1e-3, atol=atol)
+
+
+def test_cpp_fit_integer_coupling_matches_ode(twiss):
+    twissheader, twisstable = twiss
+    ref = ibslib.runODE(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        [0.0],
+        [ex0],
+        [ey0],
+        [sigs0],
+        [],
+        model,
+        pnumber,
+        7,
+        1e-6,
+        "der",
+    )
+    out = np.array(evolution(twiss, [7.0, 1.0, 1.0])["out"]).reshape(-1, 3)
+    assert out[-1, 0] == pytest.approx(ref["ex"][-1], rel=1e-3)
+    assert out[-1, 1] == pytest.approx(ref["ey"][-1], rel=1e-3)
+    assert out[-1, 2] == pytest.approx(ref["sigs"][-1], rel=1e-3)
+
+
+def test_cpp_fit_recovers_parameters(twiss):
+    twissheader, twisstable = twiss
+    out = np.array(evolution(twiss, ptrue)["out"]).reshape(-1, 3)
+    noise = 1.0 + 0.002 * np.sin(17.0 * np.arange(len(times)))
+
+    results = ibslib.FitEmittanceEvolution(
+        twissheader,
+        twisstable,
+        harmon,
+        voltages,
+        model,
+        pnumber,
+        0.0,
+        ex0,
+        ey0,
+        sigs0,
+        times,
+        out[:, 0] * noise,
+        out[:, 1] * noise,
+        out[:, 2] / noise,
+        free=[True, False, True],
+        starts=[[1.0, 1.0, 1.0], [20.0, 1.0, 0.7], [50.0, 1.0, 2.0]],
+    )
+    assert len(results) == 3
+    assert results[0]["chi2"] <= results[-1]["chi2"]
+
+    best = results[0]
+    assert best["converged"]
+    assert best["parameters"][0] == pytest.approx(ptrue[0], rel=1e-2)
+    assert best["parameters"][1] == ptrue[1]
+    assert best["parameters"][2] == pytest.approx(ptrue[2], rel=1e-2)
+    assert best["evaluations"] < 30
+
+    # fixed parameters have no covariance
+    cov = np.array(best["covariance"]).reshape(3, 3)
+    assert np.all(cov[1, :] == 0.0)
+    assert cov[0, 0] > 0.0 and cov[2, 2] > 0.0
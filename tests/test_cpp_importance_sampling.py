@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module ImportanceSampling.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+@pytest.mark.parametrize("model", range(1, 14))
+def test_cpp_element_rates_sum_to_model(twiss, model):
+    twissheader, twisstable = twiss
+
+    expected = np.zeros(3)
+    ibslib.IBSRates(
+        model, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, expected
+    )
+
+    total = np.zeros(3)
+    out = np.zeros(3)
+    for i in range(len(twisstable["L"])):
+        ibslib.IBSElementRates(
+            model, i, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, out
+        )
+        total += out
+
+    assert np.allclose(total, expected, rtol=1e-10)
+
+
+def test_cpp_importance_sampled_rates(twiss):
+    twissheader, twisstable = twiss
+
+    expected = np.zeros(3)
+    ibslib.ConteMartiniSimpsonDecade(
+        pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, expected
+    )
+
+    rates = np.zeros(3)
+    errors = np.zeros(3)
+    nevaluated = ibslib.ImportanceSampledRates(
+        11, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, 0.5, 42, rates, errors
+    )
+
+    assert 0 < nevaluated < len(twisstable["L"])
+    assert np.all(np.abs(rates - expected) <= 3.0 * errors)
+
+
+def test_cpp_importance_sampled_rates_exact_fallback(twiss):
+    twissheader, twisstable = twiss
+
+    expected = np.zeros(3)
+    ibslib.ConteMartiniSimpsonDecade(
+        pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, expected
+    )
+
+    rates = np.zeros(3)
+    errors = np.zeros(3)
+    nevaluated = ibslib.ImportanceSampledRates(
+        11, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, 1e-3, 42, rates, errors
+    )
+
+    assert nevaluated == len(twisstable["L"])
+    assert np.allclose(rates, expected, rtol=1e-10)
+    assert np.all(errors == 0.0)
@@ -180,3 +180,37 @@ def test_cpp_integral_zimmerman():
     print(tau)
     expected = [1.66573660e01, 1.88712328e03, 9.15404495e-03]
     assert np.allclose(tau, expected)
+
+
+def test_cpp_integral_dispersion_free():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    pnumber = 1e10
+    ex = 5e-9
+    ey = 1e-10
+    sigs = 0.005
+    sige = 7e-4
+    gammas = twissheader["GAMMA"]
+    len = twissheader["LENGTH"]
+    bxavg = len / (2.0 * ibslib.pi * twissheader["Q1"])
+    byavg = len / (2.0 * ibslib.pi * twissheader["Q2"])
+
+    # closed form against the Simpson decades with a negligible dispersion
+    tau = np.zeros(3)
+    ibslib.integral_dispersion_free(
+        bxavg / ex, byavg / ey, (gammas / sige) ** 2, tau
+    )
+    reference = np.zeros(3)
+    ibslib.integrator_twsint(
+        pnumber, ex, ey, sigs, sige, gammas, bxavg, byavg, 1, 2, 1e-12, 0, 0, 0,
+        reference,
+    )
+    assert np.allclose(tau, reference, rtol=1e-4)
+
+    # the integrators take the closed form for zero dispersion
+    for integral in [ibslib.integral_conte_martini, ibslib.integral_zimmerman]:
+        zero = np.zeros(3)
+        integral(
+            pnumber, ex, ey, sigs, sige, gammas, bxavg, byavg, 1, 2, 0, 0, 0, 0,
+            zero,
+        )
+        assert np.allclose(zero, tau)
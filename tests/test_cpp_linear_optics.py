@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module LinearOptics.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, my_twiss_file, r0
+
+
+@pytest.fixture
+def twiss():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    return twissheader, twisstable
+
+
+def test_cpp_linear_optics_reproduces_madx(twiss):
+    twissheader, twisstable = twiss
+    header, table = ibslib.PeriodicLinearOptics(
+        dict(twissheader), dict(twisstable)
+    )
+
+    for key in ["BETX", "ALFX", "BETY", "ALFY", "DX", "DPX"]:
+        assert np.allclose(table[key], twisstable[key], rtol=1e-6, atol=1e-7)
+    for key in ["Q1", "Q2", "ALFA", "GAMMATR"]:
+        assert header[key] == pytest.approx(twissheader[key], rel=1e-6)
+
+    # prepared for the models
+    reference = ibslib.updateTwiss(twisstable)
+    for key in ["I2", "I5x", "hx"]:
+        assert np.allclose(table[key], reference[key], rtol=1e-5, atol=1e-12)
+
+
+def test_cpp_linear_optics_quadrupole_knob(twiss):
+    twissheader, twisstable = twiss
+    header, table = ibslib.PeriodicLinearOptics(
+        dict(twissheader), dict(twisstable)
+    )
+
+    # stronger focusing quadrupoles raise the horizontal tune
+    knob = dict(table)
+    knob["K1L"] = [k * 1.002 if k > 0 else k for k in table["K1L"]]
+    kheader, ktable = ibslib.PeriodicLinearOptics(dict(header), knob)
+    assert kheader["Q1"] > header["Q1"]
+    assert not np.allclose(ktable["BETX"], table["BETX"])
+
+    rates = np.zeros(3)
+    ibslib.IBSRates(
+        4, 1e10, 5e-9, 1e-10, 0.005, 7e-4, kheader, ktable, r0, aatom, rates
+    )
+    assert np.all(np.isfinite(rates))
+
+
+def test_cpp_linear_optics_unstable(twiss):
+    twissheader, twisstable = twiss
+    table = dict(twisstable)
+    table["K1L"] = [5.0 * k for k in twisstable["K1L"]]
+    with pytest.raises(ValueError):
+        ibslib.PeriodicLinearOptics(dict(twissheader), table)
@@ -125,7 +125,24 @@ def test_cpp_updateTwiss():
     print(tw.keys())
 
     assert sorted(list(twiss.keys())) == sorted(
-        ["ALFX", "ALFY", "ANGLE", "BETX", "BETY", "DPX", "DPY", "DX", "DY", "K1L", "K1SL", "L"]
+        [
+            "ALFX",
+            "ALFY",
+            "ANGLE",
+            "BETX",
+            "BETY",
+            "DPX",
+            "DPY",
+            "DX",
+            "DY",
+            "E1",
+            "E2",
+            "K1L",
+            "K1SL",
+            "K2L",
+            "K2SL",
+            "L",
+        ]
     )
     assert sorted(list(tw.keys())) == sorted(
         [
@@ -138,6 +155,8 @@ def test_cpp_updateTwiss():
             "DPY",
             "DX",
             "DY",
+            "E1",
+            "E2",
             "I1",
             "I2",
             "I3",
@@ -147,6 +166,8 @@ def test_cpp_updateTwiss():
             "I5y",
             "K1L",
             "K1SL",
+            "K2L",
+            "K2SL",
             "L",
             "gammax",
             "gammay",
@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module ParticleKicks.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import dpop, ex, ey, sigs
+
+npart = 200000
+
+
+def matched_beam(twisstable, element):
+    rng = np.random.default_rng(1)
+    bx = twisstable["BETX"][element]
+    by = twisstable["BETY"][element]
+    ax = twisstable["ALFX"][element]
+    ay = twisstable["ALFY"][element]
+
+    xn, pxn, yn, pyn, z, dp = rng.standard_normal((6, npart))
+    x = np.sqrt(bx * ex) * xn
+    px = np.sqrt(ex / bx) * (pxn - ax * xn)
+    y = np.sqrt(by * ey) * yn
+    py = np.sqrt(ey / by) * (pyn - ay * yn)
+    dp = dpop * dp
+    x += twisstable["DX"][element] * dp
+    px += twisstable["DPX"][element] * dp
+    y += twisstable["DY"][element] * dp
+    py += twisstable["DPY"][element] * dp
+    return x, px, y, py, sigs * z, dp
+
+
+def test_cpp_gaussian_random_numbers_are_reproducible():
+    a = np.array([ibslib.GaussianRandomNumbers(3, p, 0, 0) for p in range(1000)])
+    b = np.array([ibslib.GaussianRandomNumbers(3, p, 0, 0) for p in range(1000)])
+    c = np.array([ibslib.GaussianRandomNumbers(3, p, 1, 0) for p in range(1000)])
+
+    assert np.array_equal(a, b)
+    assert not np.array_equal(a, c)
+    assert abs(np.mean(a)) < 0.05
+    assert abs(np.std(a) - 1.0) < 0.05
+
+
+def test_cpp_beam_moments(twiss):
+    twissheader, twisstable = twiss
+    beam = matched_beam(twisstable, 0)
+
+    moments = np.zeros(4)
+    ibslib.BeamMoments(*beam, twissheader, twisstable, 0, moments)
+
+    assert np.allclose(moments, [ex, ey, sigs, dpop], rtol=1e-2)
+
+
+def test_cpp_ibs_kick_emittance_growth(twiss):
+    twissheader, twisstable = twiss
+    x, px, y, py, z, dp = matched_beam(twisstable, 0)
+
+    moments = np.zeros(4)
+    ibslib.BeamMoments(x, px, y, py, z, dp, twissheader, twisstable, 0, moments)
+
+    rates = np.array([100.0, 200.0, 300.0])
+    dt = 1e-4
+    ibslib.IBSKick(x, px, y, py, dp, rates, moments, twissheader, twisstable, 0, dt, 42, 0)
+
+    after = np.zeros(4)
+    ibslib.BeamMoments(x, px, y, py, z, dp, twissheader, twisstable, 0, after)
+
+    # no betatron or synchrotron motion between kicks: the full kick variance
+    # stays in the momenta
+    assert after[0] / moments[0] == pytest.approx(np.sqrt(1.0 + 4.0 * rates[1] * dt), rel=2e-3)
+    assert after[1] / moments[1] == pytest.approx(np.sqrt(1.0 + 4.0 * rates[2] * dt), rel=2e-3)
+    assert (after[3] / moments[3]) ** 2 == pytest.approx(1.0 + 4.0 * rates[0] * dt, rel=2e-3)
+
+
+def one_turn(x, px, dp, beta, alpha, dx, dpx, tune):
+    # linear betatron rotation at the element, the dispersive part is kept
+    mu = 2.0 * np.pi * tune
+    gamma = (1.0 + alpha * alpha) / beta
+    xb = x - dx * dp
+    pxb = px - dpx * dp
+    xn = (np.cos(mu) + alpha * np.sin(mu)) * xb + beta * np.sin(mu) * pxb
+    pxn = -gamma * np.sin(mu) * xb + (np.cos(mu) - alpha * np.sin(mu)) * pxb
+    return xn + dx * dp, pxn + dpx * dp
+
+
+def test_cpp_ibs_kick_emittance_growth_rate_with_alpha(twiss):
+    twissheader, twisstable = twiss
+    alfx = np.abs(twisstable["ALFX"])
+    alfy = np.abs(twisstable["ALFY"])
+    element = int(np.argmax(np.minimum(alfx, alfy)))
+    assert min(alfx[element], alfy[element]) > 5.0
+
+    x, px, y, py, z, dp = matched_beam(twisstable, element)
+    rates = np.array([100.0, 200.0, 300.0])
+    dt = 1e-5
+    nturns = 100
+
+    moments = np.zeros(4)
+    ibslib.BeamMoments(x, px, y, py, z, dp, twissheader, twisstable, element, moments)
+    initial = moments.copy()
+
+    for turn in range(nturns):
+        ibslib.IBSKick(x, px, y, py, dp, rates, moments, twissheader, twisstable, element, dt, 42, turn)
+        x[:], px[:] = one_turn(
+            x, px, dp, twisstable["BETX"][element], twisstable["ALFX"][element],
+            twisstable["DX"][element], twisstable["DPX"][element], 0.31,
+        )
+        y[:], py[:] = one_turn(
+            y, py, dp, twisstable["BETY"][element], twisstable["ALFY"][element],
+            twisstable["DY"][element], twisstable["DPY"][element], 0.17,
+        )
+        ibslib.BeamMoments(x, px, y, py, z, dp, twissheader, twisstable, element, moments)
+
+    # the emittances grow with twice the amplitude growth rates
+    assert moments[0] / initial[0] == pytest.approx((1.0 + 2.0 * rates[1] * dt) ** nturns, rel=2e-2)
+    assert moments[1] / initial[1] == pytest.approx((1.0 + 2.0 * rates[2] * dt) ** nturns, rel=2e-2)
+
+
+def test_cpp_ibs_kick_turn_is_reproducible(twiss):
+    twissheader, twisstable = twiss
+    r0 = ibslib.particle_radius(1, ibslib.electron_mass / ibslib.proton_mass)
+
+    beams = [matched_beam(twisstable, 0), matched_beam(twisstable, 0)]
+    rates = [np.zeros(3), np.zeros(3)]
+    for beam, out in zip(beams, rates):
+        ibslib.IBSKickTurn(
+            4, *beam, 1e10, twissheader, twisstable, r0,
+            ibslib.electron_mass / ibslib.proton_mass, 0, 42, 7, out
+        )
+
+    assert np.all(rates[0] > 0.0)
+    assert np.array_equal(rates[0], rates[1])
+    for a, b in zip(beams[0], beams[1]):
+        assert np.array_equal(a, b)
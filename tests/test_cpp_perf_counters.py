@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module PerfCounters.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+
+from tests.conftest import my_twiss_file
+
+
+def test_cpp_perf_counters_regions():
+    ibslib.PerfCountersReset()
+    hardware = ibslib.PerfCountersEnable(True)
+    assert ibslib.PerfCountersEnabled()
+
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+    aatom = ibslib.electron_mass / ibslib.proton_mass
+    r0 = ibslib.particle_radius(1, aatom)
+    out = np.zeros(3)
+    for _ in range(3):
+        ibslib.IBSRates(4, 1e10, 5e-9, 1e-10, 5e-3, 7e-4, twissheader,
+                        twisstable, r0, aatom, out)
+
+    ibslib.PerfCountersEnable(False)
+    report = ibslib.PerfCountersReport()
+
+    n = len(twisstable["L"])
+    assert report["GetTwissTableAsMap"]["ELEMENTS"] == n
+    assert report["updateTwiss"]["ELEMENTS"] == n
+    assert report["Nagaitsev"]["CALLS"] == 3
+    assert report["Nagaitsev"]["ELEMENTS"] == 3 * n
+    assert report["Nagaitsev"]["TIME"] > 0.0
+
+    if hardware:
+        assert report["Nagaitsev"]["IPC"] > 0.0
+        assert np.isclose(
+            report["Nagaitsev"]["CYCLES_PER_ELEMENT"],
+            report["Nagaitsev"]["CYCLES"] / (3 * n),
+        )
+
+    # nothing is recorded while disabled
+    ibslib.IBSRates(4, 1e10, 5e-9, 1e-10, 5e-3, 7e-4, twissheader, twisstable,
+                    r0, aatom, out)
+    assert ibslib.PerfCountersReport()["Nagaitsev"]["CALLS"] == 3
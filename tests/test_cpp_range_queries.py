@@ -0,0 +1,61 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module RangeQueries.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+@pytest.fixture
+def prefix(twiss):
+    twissheader, twisstable = twiss
+    rates = np.zeros(3)
+    ibslib.IBSRates(
+        4, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, rates
+    )
+    p = ibslib.BuildIBSPrefixSums(
+        4, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom
+    )
+    return p, rates
+
+
+def test_cpp_range_full_ring(prefix):
+    p, rates = prefix
+    n = len(p.s)
+    res = ibslib.IBSRangeByIndex(p, [0], [n])
+    assert np.allclose(res["rates"][0], rates, rtol=1e-12)
+
+
+def test_cpp_range_sections_add_up(prefix):
+    p, rates = prefix
+    c = p.circumference
+    cuts = [0.0, 0.13 * c, 0.5 * c, 0.77 * c, c]
+    res = ibslib.IBSRangeByS(p, cuts[:-1], cuts[1:])
+    assert np.allclose(np.sum(res["rates"], axis=0), rates, rtol=1e-12)
+    assert np.allclose(
+        np.sum(res["radiation"], axis=0), np.array(p.radiation[-7:]), rtol=1e-12
+    )
+
+
+def test_cpp_range_wraps_around(prefix):
+    p, rates = prefix
+    c = p.circumference
+    res = ibslib.IBSRangeByS(p, [0.8 * c, 0.3 * c], [0.3 * c, 0.8 * c])
+    assert np.allclose(np.sum(res["rates"], axis=0), rates, rtol=1e-12)
+
+    res = ibslib.IBSRangeByIndex(p, [400, 100], [100, 400])
+    assert np.allclose(np.sum(res["rates"], axis=0), rates, rtol=1e-12)
+
+
+def test_cpp_range_mismatched_lengths(prefix):
+    p, _ = prefix
+    with pytest.raises(ValueError):
+        ibslib.IBSRangeByIndex(p, [0, 100], [100])
+    with pytest.raises(ValueError):
+        ibslib.IBSRangeByS(p, [0.0], [1.0, 2.0])
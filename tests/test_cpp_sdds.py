@@ -0,0 +1,178 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module SDDS.
+"""
+
+import struct
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import my_twiss_file
+
+# elegant column -> TFS column
+elegant_columns = {
+    "betax": "BETX",
+    "alphax": "ALFX",
+    "etax": "DX",
+    "etaxp": "DPX",
+    "betay": "BETY",
+    "alphay": "ALFY",
+    "etay": "DY",
+    "etayp": "DPY",
+}
+
+
+def write_sdds(filename, parameters, columns, mode, endian="<", column_major=False, nrows=None):
+    """Minimal SDDS writer for double, long and string data, nrows overrides
+    the row count of the binary data."""
+    formats = {"double": "d", "long": "i"}
+    size = len(next(iter(columns.values()))[1])
+    nrows = size if nrows is None else nrows
+
+    text = "SDDS1\n"
+    if mode == "binary":
+        text += "!# %s-endian\n" % ("little" if endian == "<" else "big")
+    text += '&description text="Twiss parameters", contents="", &end\n'
+    for name, (kind, _) in parameters.items():
+        text += "&parameter name=%s, type=%s, &end\n" % (name, kind)
+    for name, (kind, _) in columns.items():
+        text += '&column name=%s, units="m", type=%s, &end\n' % (name, kind)
+    text += "&data mode=%s, column_major_order=%d, &end\n" % (mode, column_major)
+
+    if mode == "ascii":
+        lines = [str(value) for _, value in parameters.values()]
+        lines.append(str(nrows))
+        for i in range(size):
+            row = []
+            for kind, values in columns.values():
+                row.append('"%s"' % values[i] if kind == "string" else repr(values[i]))
+            lines.append(" ".join(row))
+        data = ("\n".join(lines) + "\n").encode()
+    else:
+
+        def pack(kind, value):
+            if kind == "string":
+                return struct.pack(endian + "i", len(value)) + value.encode()
+            return struct.pack(endian + formats[kind], value)
+
+        data = struct.pack(endian + "i", nrows)
+        for kind, value in parameters.values():
+            data += pack(kind, value)
+        if column_major:
+            for kind, values in columns.values():
+                for value in values:
+                    data += pack(kind, value)
+        else:
+            for i in range(size):
+                for kind, values in columns.values():
+                    data += pack(kind, values[i])
+
+    with open(filename, "wb") as f:
+        f.write(text.encode() + data)
+
+
+@pytest.fixture
+def lattice():
+    header, table = ibslib.ReadTwiss(my_twiss_file)
+    s = np.cumsum(table["L"])
+
+    parameters = {
+        "pCentral": ("double", header["PC"] / ibslib.electron_mass),
+        "nux": ("double", header["Q1"]),
+        "alphac": ("double", header["ALFA"]),
+        "Step": ("long", 1),
+    }
+    columns = {"s": ("double", list(s))}
+    for name, column in elegant_columns.items():
+        columns[name] = ("double", table[column])
+    columns["ElementName"] = ("string", ["E%d" % i for i in range(len(s))])
+    columns["ElementOccurence"] = ("long", [1] * len(s))
+    return header, table, parameters, columns
+
+
+@pytest.mark.parametrize("mode, endian", [("binary", "<"), ("binary", ">"), ("ascii", "<")])
+def test_cpp_read_elegant_twiss(tmp_path, lattice, mode, endian):
+    header, table, parameters, columns = lattice
+    filename = str(tmp_path / "lattice.twi")
+    write_sdds(filename, parameters, columns, mode, endian)
+
+    page = ibslib.ReadSDDS(filename)
+    assert page["parameters"]["Step"] == 1
+    assert page["stringcolumns"]["ElementName"][3] == "E3"
+
+    elegant_header, elegant_table = ibslib.ReadElegantTwiss(filename)
+    for column in ["L"] + list(elegant_columns.values()):
+        assert np.allclose(elegant_table[column], table[column], atol=1e-12)
+    assert elegant_header["GAMMA"] == pytest.approx(header["GAMMA"], rel=1e-8)
+    assert elegant_header["LENGTH"] == pytest.approx(header["LENGTH"])
+    assert elegant_header["Q1"] == header["Q1"]
+    assert elegant_header["GAMMATR"] == pytest.approx(header["GAMMATR"], rel=1e-8)
+
+
+@pytest.mark.parametrize("endian", ["<", ">"])
+def test_cpp_read_sdds_column_major(tmp_path, lattice, endian):
+    header, table, parameters, columns = lattice
+    filename = str(tmp_path / "lattice.twi")
+    write_sdds(filename, parameters, columns, "binary", endian, column_major=True)
+
+    page = ibslib.ReadSDDS(filename)
+    assert page["parameters"]["Step"] == 1
+    assert page["stringcolumns"]["ElementName"] == columns["ElementName"][1]
+    assert np.array_equal(page["columns"]["ElementOccurence"], columns["ElementOccurence"][1])
+
+    _, elegant_table = ibslib.ReadElegantTwiss(filename)
+    for column in elegant_columns.values():
+        assert np.array_equal(elegant_table[column], table[column])
+
+
+def test_cpp_read_sdds_row_count_beyond_data(tmp_path, lattice):
+    _, _, parameters, columns = lattice
+    filename = str(tmp_path / "lattice.twi")
+    write_sdds(filename, parameters, columns, "binary", nrows=2**31 - 1)
+
+    with pytest.raises(ValueError):
+        ibslib.ReadSDDS(filename)
+
+
+def test_cpp_elegant_charge_parameter(tmp_path, lattice):
+    _, _, parameters, columns = lattice
+    filename = str(tmp_path / "lattice.twi")
+    write_sdds(filename, parameters, columns, "binary")
+    assert ibslib.ReadElegantTwiss(filename)[0]["CHARGE"] == -1.0
+
+    parameters["CHARGE"] = ("double", 1.0)
+    write_sdds(filename, parameters, columns, "binary")
+    assert ibslib.ReadElegantTwiss(filename)[0]["CHARGE"] == 1.0
+
+
+def test_cpp_elegant_parameters_join(tmp_path, lattice):
+    header, table, parameters, columns = lattice
+    filename = str(tmp_path / "lattice.twi")
+    write_sdds(filename, parameters, columns, "binary")
+
+    names, keys, values, occurences = [], [], [], []
+    for i, (angle, k1l, length) in enumerate(zip(table["ANGLE"], table["K1L"], table["L"])):
+        names += ["E%d" % i, "E%d" % i]
+        keys += ["ANGLE", "K1"]
+        values += [angle, k1l / length if length > 0 else 0.0]
+        occurences += [1, 1]
+    parameterfile = str(tmp_path / "lattice.param")
+    write_sdds(
+        parameterfile,
+        {},
+        {
+            "ElementName": ("string", names),
+            "ElementParameter": ("string", keys),
+            "ParameterValue": ("double", values),
+            "ElementOccurence": ("long", occurences),
+        },
+        "binary",
+    )
+
+    _, elegant_table = ibslib.ReadElegantTwiss(filename, parameterfile)
+    assert np.allclose(elegant_table["ANGLE"], table["ANGLE"], atol=1e-12)
+    assert np.allclose(elegant_table["K1L"], table["K1L"], atol=1e-12)
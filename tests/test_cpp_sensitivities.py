@@ -0,0 +1,47 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module Sensitivities.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+def model_rates(model, twissheader, twisstable):
+    out = np.zeros(3)
+    ibslib.IBSRates(model, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, out)
+    return out
+
+
+@pytest.mark.parametrize("model", [4, 9, 11])
+def test_cpp_sensitivities_match_finite_differences(twiss, model):
+    twissheader, twisstable = twiss
+
+    rates = np.zeros(3)
+    gradients = ibslib.IBSRatesSensitivities(
+        model, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, rates
+    )
+
+    assert np.allclose(rates, model_rates(model, twissheader, twisstable), rtol=1e-12)
+
+    for column in ["BETX", "DX", "DPX", "BETY"]:
+        grad = np.array(gradients[column]).reshape(-1, 3)
+        assert grad.shape == (len(twisstable["L"]), 3)
+
+        for element in [5, 100, 333]:
+            value = twisstable[column][element]
+            h = 1e-4 * max(abs(value), 1e-2)
+
+            twisstable[column][element] = value + h
+            plus = model_rates(model, twissheader, twisstable)
+            twisstable[column][element] = value - h
+            minus = model_rates(model, twissheader, twisstable)
+            twisstable[column][element] = value
+
+            expected = (plus - minus) / (2.0 * h)
+            assert np.allclose(grad[element], expected, rtol=1e-3, atol=1e-9 * np.abs(rates))
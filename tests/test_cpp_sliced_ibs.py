@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module SlicedIBS.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+def gaussian_rates(twiss, model, length):
+    twissheader, twisstable = twiss
+    rates = np.zeros(3)
+    ibslib.IBSRates(
+        model, pnumber, ex, ey, length, dpop, twissheader, twisstable, r0, aatom, rates
+    )
+    return rates
+
+
+def sliced_rates(twiss, model, z, profile, nslices):
+    twissheader, twisstable = twiss
+    return ibslib.SlicedIBSRates(
+        model,
+        pnumber,
+        ex,
+        ey,
+        dpop,
+        twissheader,
+        twisstable,
+        r0,
+        aatom,
+        z,
+        profile,
+        nslices,
+    )
+
+
+# the tailcut Coulomb log changes with the slice population, such that the
+# slices only reproduce the Gaussian rates approximately
+@pytest.mark.parametrize("model, rtol", [(1, 2e-3), (4, 2e-3), (5, 1e-2), (6, 2e-3)])
+def test_cpp_sliced_gaussian(twiss, model, rtol):
+    z = np.linspace(-6 * sigs, 6 * sigs, 2001)
+    profile = np.exp(-(z**2) / (2 * sigs**2))
+    rates, slices = sliced_rates(twiss, model, z, profile, 100)
+
+    assert slices.sigs == pytest.approx(sigs, rel=1e-6)
+    assert np.sum(slices.weight) == pytest.approx(1.0)
+    assert len(slices.rates) == 300
+    assert np.allclose(rates, gaussian_rates(twiss, model, sigs), rtol=rtol)
+
+    # the core of the bunch grows faster than the tails
+    local = np.array(slices.rates).reshape(-1, 3)
+    assert np.argmax(local[:, 1]) in (49, 50)
+
+
+def test_cpp_sliced_flat_top(twiss):
+    # a flat bunch has a higher mean density than a Gaussian of the same rms
+    length = np.sqrt(12.0) * sigs
+    z = np.linspace(-length / 2, length / 2, 2001)
+    rates, slices = sliced_rates(twiss, 4, z, np.ones_like(z), 50)
+
+    ratio = rates / gaussian_rates(twiss, 4, slices.sigs)
+    assert np.allclose(ratio, 2 * np.sqrt(np.pi) / np.sqrt(12.0), rtol=1e-3)
+
+
+def test_cpp_sliced_invalid_profile(twiss):
+    rates, slices = sliced_rates(twiss, 4, [0.0, 1.0], [0.0, 0.0], 10)
+    assert np.all(np.array(rates) == 0.0)
+    assert len(slices.z) == 0
+
+    # positions must be strictly increasing
+    z = [0.0, 2.0, 1.0, 3.0]
+    rates, slices = sliced_rates(twiss, 4, z, [1.0, 1.0, 1.0, 1.0], 10)
+    assert np.all(np.array(rates) == 0.0)
+    assert len(slices.z) == 0
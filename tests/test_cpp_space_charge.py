@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module SpaceCharge.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+from tests.conftest import aatom, dpop, ex, ey, pnumber, r0, sigs
+
+
+@pytest.mark.parametrize("model", [1, 4, 9, 13])
+def test_cpp_fused_rates_match_model(twiss, model):
+    twissheader, twisstable = twiss
+    rates = np.zeros(3)
+    ibslib.IBSRates(
+        model, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom, rates
+    )
+    res = ibslib.IBSRatesWithTuneShift(
+        model, pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0, aatom
+    )
+    dq = ibslib.LaslettTuneShift(
+        pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0
+    )
+
+    assert np.allclose(res["rates"], rates, rtol=1e-12)
+    assert np.allclose(res["tuneshift"], dq, rtol=1e-12)
+    assert dq[0] < 0.0 and dq[1] < 0.0
+
+
+def test_cpp_tune_shift_scales_with_intensity(twiss):
+    twissheader, twisstable = twiss
+    dq1 = ibslib.LaslettTuneShift(
+        pnumber, ex, ey, sigs, dpop, twissheader, twisstable, r0
+    )
+    dq2 = ibslib.LaslettTuneShift(
+        2 * pnumber, ex, ey, 2 * sigs, dpop, twissheader, twisstable, r0
+    )
+    assert np.allclose(dq1, dq2, rtol=1e-12)
+
+
+def test_cpp_ode_tune_shift_trajectory(twiss):
+    twissheader, twisstable = twiss
+    h = [400.0]
+    v = [-4 * 375e3]
+
+    ref = ibslib.runODE(
+        twissheader, twisstable, h, v, [0.0], [ex], [ey], [sigs], [], 4,
+        pnumber, 8, 1e-4, "der",
+    )
+    res = ibslib.runODEWithTuneShift(
+        twissheader, twisstable, h, v, [0.0], [ex], [ey], [sigs], [], 4,
+        pnumber, 8, 1e-4, "der",
+    )
+
+    assert len(res["dqx"]) == len(res["t"])
+    assert len(res["dqy"]) == len(res["t"])
+    assert len(res["sige"]) == len(res["t"])
+    assert np.allclose(res["ex"], ref["ex"], rtol=1e-12)
+    assert np.allclose(res["sigs"], ref["sigs"], rtol=1e-12)
+
+    dq = ibslib.LaslettTuneShift(
+        pnumber, res["ex"][-1], res["ey"][-1], res["sigs"][-1], res["sige"][-1],
+        twissheader, twisstable, r0,
+    )
+    assert np.allclose([res["dqx"][-1], res["dqy"][-1]], dq, rtol=1e-12)
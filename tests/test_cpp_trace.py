@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module Trace.
+"""
+
+import json
+
+import IBSLib as ibslib
+
+from tests.conftest import my_twiss_file
+
+
+def run_ode():
+    twissheader = ibslib.GetTwissHeader(my_twiss_file)
+    twisstable = ibslib.GetTwissTable(my_twiss_file)
+    twisstable = ibslib.updateTwiss(twisstable)
+    ibslib.runODE(
+        twissheader, twisstable, [400.0], [-4.0 * 375e3], [0.0], [5e-9],
+        [1e-10], [5e-3], [], 4, 1e10, 10, 1e-4, "der",
+    )
+
+
+def test_cpp_trace_export(tmp_path):
+    ibslib.TraceClear()
+    ibslib.TraceEnable()
+    run_ode()
+    ibslib.TraceDisable()
+
+    filename = str(tmp_path / "trace.json")
+    assert ibslib.TraceWrite(filename)
+    with open(filename) as f:
+        events = json.load(f)["traceEvents"]
+
+    spans = [e for e in events if e["ph"] == "X"]
+    assert len(spans) == ibslib.TraceSize()
+    names = {e["name"] for e in spans}
+    for name in ["GetTwissTableAsMap", "updateTwiss", "SynchronuousPhase",
+                 "Nagaitsev", "ODE"]:
+        assert name in names
+    assert all(e["dur"] >= 0.0 for e in spans)
+
+    # the ODE span encloses the model evaluations
+    ode = next(e for e in spans if e["name"] == "ODE")
+    for e in spans:
+        if e["name"] == "Nagaitsev":
+            assert ode["ts"] <= e["ts"] <= ode["ts"] + ode["dur"]
+
+
+def test_cpp_trace_ring_buffer():
+    ibslib.TraceClear()
+    ibslib.TraceEnable(16)
+    run_ode()
+    ibslib.TraceDisable()
+    assert ibslib.TraceSize() == 16
+    assert ibslib.TraceDropped() > 0
+
+    # nothing is recorded while disabled
+    size, dropped = ibslib.TraceSize(), ibslib.TraceDropped()
+    run_ode()
+    assert (ibslib.TraceSize(), ibslib.TraceDropped()) == (size, dropped)
+    ibslib.TraceClear()
@@ -60,6 +60,33 @@ def test_GetTwissHeader():
     assert expected == actual
 
 
+def test_ParseTwiss():
+    header = ibslib.GetTwissHeader(my_twiss_file)
+    table = ibslib.GetTwissTable(my_twiss_file)
+
+    with open(my_twiss_file, "rb") as f:
+        data = f.read()
+    parsed_header, parsed_table = ibslib.ParseTwiss(data)
+
+    assert parsed_table == table
+    for key, value in header.items():
+        assert parsed_header[key] == value
+
+
+def test_ReadTwissFromDescriptor():
+    _, table = ibslib.ReadTwiss(my_twiss_file)
+
+    with open(my_twiss_file, "rb") as f:
+        fd = os.dup(f.fileno())
+    try:
+        header, piped_table = ibslib.ReadTwissFromDescriptor(fd)
+    finally:
+        os.close(fd)
+
+    assert piped_table == table
+    assert header["LENGTH"] == 240.0
+
+
 if __name__ == "__main__":
     twissheader = ibslib.GetTwissHeader("b2_design_lattice_1996.twiss")
     print(twissheader)
@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+Tests for C++ module UncertaintyQuantification.
+"""
+
+import IBSLib as ibslib
+import numpy as np
+import pytest
+
+FIXED, UNIFORM, NORMAL = 0, 1, 2
+
+
+distributions = [
+    (UNIFORM, 2e10, 4e10),
+    (FIXED, 10, 0),
+    (NORMAL, 1.0, 0.05),
+    (FIXED, 5e-9, 0),
+    (FIXED, 1e-10, 0),
+    (FIXED, 5e-3, 0),
+]
+
+
+@pytest.mark.parametrize("sampling", ["sobol", "lhs"])
+def test_cpp_uq_rates(twiss, sampling):
+    twissheader, twisstable = twiss
+
+    res = ibslib.UncertaintyQuantification(
+        twissheader, twisstable, [400.0], [-4.0 * 375e3], 4, distributions, 256,
+        sampling=sampling, seed=7,
+    )
+
+    # growth rates are close to linear in the bunch population
+    s1 = np.array(res["S1"]).reshape(3, 6)
+    st = np.array(res["ST"]).reshape(3, 6)
+    assert np.all(s1[:, 0] > 0.8)
+    assert np.all(st[:, 0] > 0.8)
+    assert np.all(st[:, [1, 3, 4, 5]] == 0.0)
+
+    quantiles = np.array(res["QUANTILES"]).reshape(3, 3)
+    assert np.all(np.diff(quantiles, axis=1) > 0.0)
+    assert np.allclose(quantiles[:, 1], res["MEAN"], rtol=0.05)
+    assert res["NEVALUATIONS"][0] == 256 * 4
+
+
+def test_cpp_uq_is_reproducible(twiss):
+    twissheader, twisstable = twiss
+
+    runs = [
+        ibslib.UncertaintyQuantification(
+            twissheader, twisstable, [400.0], [-4.0 * 375e3], 4, distributions, 64, seed=3
+        )
+        for _ in range(2)
+    ]
+
+    assert runs[0] == runs[1]